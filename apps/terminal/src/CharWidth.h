@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+// Terminal column width of a code point (wcwidth-style): 0 for combining and format
+// characters, 2 for East Asian wide/fullwidth (CJK, emoji presentation), 1 otherwise.
+namespace CharWidth {
+
+    int        lookup(uint32_t codePoint);
+
+    inline int width(uint32_t codePoint) {
+        // Fast path: nothing below U+0300 is zero- or double-width
+        if (codePoint < 0x300)
+            return 1;
+        return lookup(codePoint);
+    }
+
+} // namespace CharWidth
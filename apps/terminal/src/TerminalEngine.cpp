@@ -3,6 +3,8 @@
 #include <QDebug>
 #include <QSocketNotifier>
 #include <QCoreApplication>
+#include <QVarLengthArray>
+#include <algorithm>
 
 #include <unistd.h>
 #include <fcntl.h>
@@ -27,7 +29,11 @@ TerminalEngine::TerminalEngine(QObject *parent)
     , m_notifier(nullptr)
     , m_title("Terminal")
     , m_screen(new TerminalScreen(this))
-    , m_state(Normal) {
+    , m_parser(this)
+    , m_applicationCursorKeys(false)
+    , m_bracketedPaste(false)
+    , m_lineDrawing(false)
+    , m_savedLineDrawing(false) {
     qDebug() << "[TerminalEngine] Created";
 }
 
@@ -79,157 +85,276 @@ void TerminalEngine::start(const QString &shell) {
 }
 
 void TerminalEngine::onReadActivated() {
-    char    buffer[4096];
-    ssize_t bytesRead = read(m_masterFd, buffer, sizeof(buffer));
+    // Drain what the PTY has buffered (bounded, so a flood can't starve the event loop)
+    static constexpr int kMaxBytesPerActivation = 64 * 1024;
 
-    if (bytesRead > 0) {
-        processOutput(QByteArray(buffer, bytesRead));
-    } else if (bytesRead <= 0 && errno != EAGAIN) {
-        terminate();
+    char                 buffer[4096];
+    int                  total = 0;
+
+    while (total < kMaxBytesPerActivation) {
+        ssize_t bytesRead = read(m_masterFd, buffer, sizeof(buffer));
+
+        if (bytesRead > 0) {
+            processOutput(QByteArray::fromRawData(buffer, bytesRead));
+            total += bytesRead;
+        } else {
+            if (bytesRead < 0 && errno == EINTR)
+                continue;
+            if (bytesRead == 0 || errno != EAGAIN)
+                terminate();
+            break;
+        }
     }
 }
 
 void TerminalEngine::processOutput(const QByteArray &data) {
-    for (char ch : data) {
-        if (m_state == Normal) {
-            if (ch == '\x1b') {
-                m_state = Escape;
-            } else if (ch == '\r') {
+    m_parser.feed(data.constData(), data.size());
+}
+
+void TerminalEngine::print(const uint32_t *codePoints, int count) {
+    if (!m_lineDrawing) {
+        m_screen->putChars(codePoints, count);
+        return;
+    }
+
+    // DEC Special Graphics: 0x5F-0x7E are line-drawing and symbol glyphs
+    static const uint16_t kSpecialGraphics[32] = {
+        0x00A0, 0x25C6, 0x2592, 0x2409, 0x240C, 0x240D, 0x240A, 0x00B0,
+        0x00B1, 0x2424, 0x240B, 0x2518, 0x2510, 0x250C, 0x2514, 0x253C,
+        0x23BA, 0x23BB, 0x2500, 0x23BC, 0x23BD, 0x251C, 0x2524, 0x2534,
+        0x252C, 0x2502, 0x2264, 0x2265, 0x03C0, 0x2260, 0x00A3, 0x00B7};
+
+    QVarLengthArray<uint32_t, 1024> mapped(codePoints, codePoints + count);
+    for (uint32_t &codePoint : mapped) {
+        if (codePoint >= 0x5F && codePoint <= 0x7E)
+            codePoint = kSpecialGraphics[codePoint - 0x5F];
+    }
+    m_screen->putChars(mapped.constData(), count);
+}
+
+void TerminalEngine::execute(uint8_t control) {
+    switch (control) {
+        case '\r': m_screen->setCursorX(0); break;
+        case '\n':
+        case '\v':
+        case '\f': m_screen->newLine(); break;
+        case '\b': m_screen->backspace(); break;
+        case '\t': {
+            // Simple tab handling (every 8 chars)
+            int x       = m_screen->cursorX();
+            int nextTab = (x / 8 + 1) * 8;
+            m_screen->setCursorX(nextTab);
+            break;
+        }
+        default: break; // Bell, SO/SI and the rest are ignored
+    }
+}
+
+void TerminalEngine::escDispatch(const VtParser &parser, uint8_t final) {
+    if (parser.intermediateCount() == 0) {
+        switch (final) {
+            case '7': // DECSC
+                m_screen->saveCursor();
+                m_savedLineDrawing = m_lineDrawing;
+                break;
+            case '8': // DECRC
+                m_screen->restoreCursor();
+                m_lineDrawing = m_savedLineDrawing;
+                break;
+            case 'D': m_screen->newLine(); break; // IND
+            case 'E':                             // NEL
                 m_screen->setCursorX(0);
-            } else if (ch == '\n') {
                 m_screen->newLine();
-            } else if (ch == '\b') {
-                m_screen->backspace();
-            } else if (ch == '\t') {
-                // Simple tab handling (every 8 chars)
-                int x       = m_screen->cursorX();
-                int nextTab = (x / 8 + 1) * 8;
-                m_screen->setCursorX(nextTab);
-            } else if (ch == '\a') {
-                // Bell - ignore
-            } else if (static_cast<unsigned char>(ch) >= 32) {
-                m_screen->putChar(ch);
-            }
-        } else {
-            parseEscapeSequence(ch);
+                break;
+            case 'M': m_screen->reverseIndex(); break; // RI
+            case 'c':                                  // RIS
+                m_screen->reset();
+                m_applicationCursorKeys = false;
+                m_bracketedPaste        = false;
+                m_lineDrawing           = false;
+                m_savedLineDrawing      = false;
+                break;
+            default: break; // ST, keypad modes
         }
+    } else if (parser.intermediate(0) == '(') {
+        // G0 character set: '0' is DEC Special Graphics, anything else is treated as ASCII
+        m_lineDrawing = (final == '0');
+    } else if (parser.intermediate(0) == '#' && final == '8') {
+        m_screen->fillWithAlignmentPattern(); // DECALN
     }
 }
 
-void TerminalEngine::parseEscapeSequence(char ch) {
-    if (m_state == Escape) {
-        if (ch == '[') {
-            m_state = CSI;
-            m_sequenceBuffer.clear();
-            m_params.clear();
-        } else if (ch == ']') {
-            m_state = OSC;
-            m_sequenceBuffer.clear();
-        } else if (ch == '(' || ch == ')') {
-            m_state = Charset;
-        } else {
-            // Unknown escape sequence, reset
-            m_state = Normal;
-        }
-    } else if (m_state == CSI) {
-        if (isdigit(ch)) {
-            m_sequenceBuffer.append(ch);
-        } else if (ch == ';') {
-            m_params.append(m_sequenceBuffer.toInt());
-            m_sequenceBuffer.clear();
-        } else if (ch >= 0x40 && ch <= 0x7E) {
-            // Final byte
-            m_params.append(m_sequenceBuffer.toInt());
-            handleCSI(QString(ch));
-            m_state = Normal;
-        }
-    } else if (m_state == OSC) {
-        if (ch == '\a' || ch == '\x9c') { // BEL or ST
-            handleOSC(m_sequenceBuffer);
-            m_state = Normal;
-        } else {
-            m_sequenceBuffer.append(ch);
+void TerminalEngine::csiDispatch(const VtParser &parser, uint8_t final) {
+    const char marker = parser.privateMarker();
+
+    if (marker == '?') {
+        if (final == 'h' || final == 'l') {
+            for (int i = 0; i < parser.paramCount(); ++i)
+                setPrivateMode(parser.rawParam(i), final == 'h');
         }
-    } else if (m_state == Charset) {
-        // Ignore charset selection
-        m_state = Normal;
+        return;
+    }
+    if (marker == '>') {
+        if (final == 'c')
+            reply("\x1b[>1;10;0c"); // Secondary DA
+        return;
+    }
+    if (marker != 0 || parser.intermediateCount() > 0)
+        return;
+
+    const int count = parser.param(0, 1);
+
+    switch (final) {
+        case 'm': selectGraphicRendition(parser); break;
+        case 'A': m_screen->moveCursorRelative(0, -count); break;              // CUU
+        case 'B': m_screen->moveCursorRelative(0, count); break;               // CUD
+        case 'C': m_screen->moveCursorRelative(count, 0); break;               // CUF
+        case 'D': m_screen->moveCursorRelative(-count, 0); break;              // CUB
+        case 'E': m_screen->moveCursor(0, m_screen->cursorY() + count); break; // CNL
+        case 'F': m_screen->moveCursor(0, m_screen->cursorY() - count); break; // CPL
+        case 'G':
+        case '`': m_screen->setCursorX(count - 1); break; // CHA
+        case 'd': m_screen->setCursorY(count - 1); break; // VPA
+        case 'H':
+        case 'f': m_screen->moveCursor(parser.param(1, 1) - 1, parser.param(0, 1) - 1); break;
+        case 'J': // ED (3, erase scrollback, is not supported)
+            if (parser.rawParam(0) <= 2)
+                m_screen->clearScreen(parser.rawParam(0));
+            break;
+        case 'K': m_screen->clearLine(parser.rawParam(0)); break; // EL
+        case 'L': m_screen->insertLines(count); break;            // IL
+        case 'M': m_screen->deleteLines(count); break;            // DL
+        case 'P': m_screen->deleteChars(count); break;            // DCH
+        case '@': m_screen->insertChars(count); break;            // ICH
+        case 'X': m_screen->eraseChars(count); break;             // ECH
+        case 'S': m_screen->scrollUp(count); break;               // SU
+        case 'T': m_screen->scrollDown(count); break;             // SD
+        case 'r':                                                 // DECSTBM
+            m_screen->setScrollRegion(parser.param(0, 1) - 1,
+                                      parser.param(1, m_screen->rows()) - 1);
+            break;
+        case 's': m_screen->saveCursor(); break;
+        case 'u': m_screen->restoreCursor(); break;
+        case 'n': // DSR
+            if (parser.rawParam(0) == 5) {
+                reply("\x1b[0n");
+            } else if (parser.rawParam(0) == 6) {
+                reply("\x1b[" + QByteArray::number(m_screen->cursorY() + 1) + ';' +
+                      QByteArray::number(std::min(m_screen->cursorX(), m_screen->cols() - 1) + 1) +
+                      'R');
+            }
+            break;
+        case 'c': // Primary DA: VT220 with ANSI color
+            if (parser.rawParam(0) == 0)
+                reply("\x1b[?62;22c");
+            break;
+        default: break;
     }
 }
 
-void TerminalEngine::handleCSI(const QString &seq) {
-    int p1 = m_params.value(0, 0);
-    int p2 = m_params.value(1, 0);
+void TerminalEngine::selectGraphicRendition(const VtParser &parser) {
+    const int count = parser.paramCount();
+    if (count == 0) {
+        m_screen->resetStyle();
+        return;
+    }
 
-    if (seq == "m") { // SGR - Select Graphic Rendition
-        if (m_params.isEmpty()) {
+    for (int i = 0; i < count; ++i) {
+        const int param = parser.rawParam(i);
+        if (param == 0)
             m_screen->resetStyle();
-        } else {
-            for (int param : m_params) {
-                if (param == 0)
-                    m_screen->resetStyle();
-                else if (param == 1)
-                    m_screen->setBold(true);
-                else if (param == 7)
-                    m_screen->setInverse(true);
-                else if (param == 22)
-                    m_screen->setBold(false);
-                else if (param == 27)
-                    m_screen->setInverse(false);
-                else if (param >= 30 && param <= 37) {
-                    // Standard FG
-                    const uint32_t colors[] = {0xFF000000, 0xFFCC0000, 0xFF4E9A06, 0xFFC4A000,
-                                               0xFF3465A4, 0xFF75507B, 0xFF06989A, 0xFFD3D7CF};
-                    m_screen->setFgColor(colors[param - 30]);
-                } else if (param >= 40 && param <= 47) {
-                    // Standard BG
-                    const uint32_t colors[] = {0xFF000000, 0xFFCC0000, 0xFF4E9A06, 0xFFC4A000,
-                                               0xFF3465A4, 0xFF75507B, 0xFF06989A, 0xFFD3D7CF};
-                    m_screen->setBgColor(colors[param - 40]);
-                } else if (param == 39)
-                    m_screen->setFgColor(0xFFFFFFFF); // Default FG
-                else if (param == 49)
-                    m_screen->setBgColor(0xFF000000); // Default BG
-                else if (param >= 90 && param <= 97) {
-                    // Bright FG
-                    const uint32_t colors[] = {0xFF555753, 0xFFEF2929, 0xFF8AE234, 0xFFFCE94F,
-                                               0xFF729FCF, 0xFFAD7FA8, 0xFF34E2E2, 0xFFEEEEEC};
-                    m_screen->setFgColor(colors[param - 90]);
-                }
+        else if (param == 1)
+            m_screen->setBold(true);
+        else if (param == 3)
+            m_screen->setItalic(true);
+        else if (param == 4)
+            m_screen->setUnderline(true);
+        else if (param == 7)
+            m_screen->setInverse(true);
+        else if (param == 22)
+            m_screen->setBold(false);
+        else if (param == 23)
+            m_screen->setItalic(false);
+        else if (param == 24)
+            m_screen->setUnderline(false);
+        else if (param == 27)
+            m_screen->setInverse(false);
+        else if (param >= 30 && param <= 37)
+            m_screen->setFgColor(param - 30); // Standard FG
+        else if (param >= 40 && param <= 47)
+            m_screen->setBgColor(param - 40); // Standard BG
+        else if (param == 39)
+            m_screen->setFgColor(TerminalCell::DefaultFg);
+        else if (param == 49)
+            m_screen->setBgColor(TerminalCell::DefaultBg);
+        else if (param >= 90 && param <= 97)
+            m_screen->setFgColor(param - 90 + 8); // Bright FG
+        else if (param >= 100 && param <= 107)
+            m_screen->setBgColor(param - 100 + 8); // Bright BG
+        else if ((param == 38 || param == 48) && i + 1 < count) {
+            // Extended color: 5;n (256-color palette) or 2;r;g;b (24-bit)
+            const bool fg = (param == 38);
+            if (parser.rawParam(i + 1) == 5 && i + 2 < count) {
+                const int index = std::clamp(parser.rawParam(i + 2), 0, 255);
+                if (fg)
+                    m_screen->setFgColor(index);
+                else
+                    m_screen->setBgColor(index);
+                i += 2;
+            } else if (parser.rawParam(i + 1) == 2 && i + 4 < count) {
+                const uint32_t rgb = (std::clamp(parser.rawParam(i + 2), 0, 255) << 16) |
+                    (std::clamp(parser.rawParam(i + 3), 0, 255) << 8) |
+                    std::clamp(parser.rawParam(i + 4), 0, 255);
+                if (fg)
+                    m_screen->setFgRgb(rgb);
+                else
+                    m_screen->setBgRgb(rgb);
+                i += 4;
             }
         }
-    } else if (seq == "A") { // Cursor Up
-        m_screen->moveCursorRelative(0, -std::max(1, p1));
-    } else if (seq == "B") { // Cursor Down
-        m_screen->moveCursorRelative(0, std::max(1, p1));
-    } else if (seq == "C") { // Cursor Forward
-        m_screen->moveCursorRelative(std::max(1, p1), 0);
-    } else if (seq == "D") { // Cursor Back
-        m_screen->moveCursorRelative(-std::max(1, p1), 0);
-    } else if (seq == "H" || seq == "f") { // Cursor Position
-        int row = std::max(1, p1) - 1;
-        int col = std::max(1, p2) - 1;
-        m_screen->moveCursor(col, row);
-    } else if (seq == "J") { // Erase in Display
-        m_screen->clearScreen(p1);
-    } else if (seq == "K") { // Erase in Line
-        m_screen->clearLine(p1);
-    } else if (seq == "P") { // Delete Characters
-        m_screen->deleteChars(std::max(1, p1));
-    } else if (seq == "@") { // Insert Characters
-        m_screen->insertChars(std::max(1, p1));
     }
 }
 
-void TerminalEngine::handleOSC(const QString &seq) {
-    if (seq.startsWith("0;") || seq.startsWith("2;")) {
-        int semi = seq.indexOf(';');
-        if (semi != -1) {
-            m_title = seq.mid(semi + 1);
-            emit titleChanged();
-        }
+void TerminalEngine::setPrivateMode(int mode, bool enabled) {
+    switch (mode) {
+        case 1: m_applicationCursorKeys = enabled; break;    // DECCKM
+        case 7: m_screen->setAutoWrap(enabled); break;       // DECAWM
+        case 25: m_screen->setCursorVisible(enabled); break; // DECTCEM
+        case 47:
+        case 1047: m_screen->setAlternateScreen(enabled); break;
+        case 1048:
+            if (enabled)
+                m_screen->saveCursor();
+            else
+                m_screen->restoreCursor();
+            break;
+        case 1049: // Alternate screen with the primary cursor saved around it
+            if (enabled) {
+                m_screen->saveCursor();
+                m_screen->setAlternateScreen(true);
+            } else {
+                m_screen->setAlternateScreen(false);
+                m_screen->restoreCursor();
+            }
+            break;
+        case 2004: m_bracketedPaste = enabled; break;
+        default: break;
     }
 }
 
+void TerminalEngine::oscDispatch(const char *data, int length) {
+    // Window title: "0;title" or "2;title"
+    if (length >= 2 && (data[0] == '0' || data[0] == '2') && data[1] == ';') {
+        m_title = QString::fromUtf8(data + 2, length - 2);
+        emit titleChanged();
+    }
+}
+
+void TerminalEngine::reply(const QByteArray &data) {
+    if (m_masterFd != -1)
+        write(m_masterFd, data.constData(), data.size());
+}
+
 void TerminalEngine::sendInput(const QString &text) {
     if (m_masterFd != -1) {
         QByteArray data = text.toUtf8();
@@ -237,11 +362,25 @@ void TerminalEngine::sendInput(const QString &text) {
     }
 }
 
+void TerminalEngine::paste(const QString &text) {
+    if (!m_bracketedPaste) {
+        sendInput(text);
+        return;
+    }
+
+    // Pasted text must not be able to end the bracket early
+    QByteArray data = text.toUtf8();
+    data.replace("\x1b[201~", "");
+    reply("\x1b[200~" + data + "\x1b[201~");
+}
+
 void TerminalEngine::sendKey(int key, const QString &text, int modifiers) {
     if (m_masterFd == -1)
         return;
 
     QByteArray data;
+    // Application cursor keys (DECCKM) send SS3 sequences instead of CSI
+    const char *cursorPrefix = m_applicationCursorKeys ? "\x1bO" : "\x1b[";
 
     if (modifiers & Qt::ControlModifier) {
         if (key >= Qt::Key_A && key <= Qt::Key_Z) {
@@ -260,19 +399,19 @@ void TerminalEngine::sendKey(int key, const QString &text, int modifiers) {
         else if (key == Qt::Key_Tab)
             data.append('\t');
         else if (key == Qt::Key_Up)
-            data.append("\x1b[A");
+            data.append(cursorPrefix).append('A');
         else if (key == Qt::Key_Down)
-            data.append("\x1b[B");
+            data.append(cursorPrefix).append('B');
         else if (key == Qt::Key_Right)
-            data.append("\x1b[C");
+            data.append(cursorPrefix).append('C');
         else if (key == Qt::Key_Left)
-            data.append("\x1b[D");
+            data.append(cursorPrefix).append('D');
         else if (key == Qt::Key_Escape)
             data.append('\x1b');
         else if (key == Qt::Key_Home)
-            data.append("\x1b[H");
+            data.append(cursorPrefix).append('H');
         else if (key == Qt::Key_End)
-            data.append("\x1b[F");
+            data.append(cursorPrefix).append('F');
         else if (key == Qt::Key_PageUp)
             data.append("\x1b[5~");
         else if (key == Qt::Key_PageDown)
@@ -318,6 +457,13 @@ void TerminalEngine::resize(int cols, int rows) {
     }
 }
 
+void TerminalEngine::setScrollbackLines(int lines) {
+    if (lines == m_screen->scrollbackLines())
+        return;
+    m_screen->setScrollbackLines(lines);
+    emit scrollbackLinesChanged();
+}
+
 void TerminalEngine::sendSignal(int signal) {
     if (m_pid > 0)
         kill(m_pid, signal);
@@ -5,16 +5,19 @@
 #include <QString>
 #include <QtQmlIntegration>
 #include "TerminalScreen.h"
+#include "VtParser.h"
 
 class QSocketNotifier;
 
-class TerminalEngine : public QObject {
+class TerminalEngine : public QObject, private VtParser::Handler {
     Q_OBJECT
     QML_ELEMENT
 
     Q_PROPERTY(bool running READ running NOTIFY runningChanged)
     Q_PROPERTY(QString title READ title NOTIFY titleChanged)
     Q_PROPERTY(TerminalScreen *screen READ screen CONSTANT)
+    Q_PROPERTY(int scrollbackLines READ scrollbackLines WRITE setScrollbackLines NOTIFY
+                   scrollbackLinesChanged)
 
   public:
     explicit TerminalEngine(QObject *parent = nullptr);
@@ -29,9 +32,15 @@ class TerminalEngine : public QObject {
     TerminalScreen *screen() const {
         return m_screen;
     }
+    int scrollbackLines() const {
+        return m_screen->scrollbackLines();
+    }
+    void             setScrollbackLines(int lines);
 
     Q_INVOKABLE void start(const QString &shell = "");
     Q_INVOKABLE void sendInput(const QString &text);
+    // Like sendInput, but bracketed when the application asked for it (mode 2004)
+    Q_INVOKABLE void paste(const QString &text);
     Q_INVOKABLE void sendKey(int key, const QString &text, int modifiers = 0);
     Q_INVOKABLE void terminate();
     Q_INVOKABLE void resize(int cols, int rows);
@@ -42,36 +51,40 @@ class TerminalEngine : public QObject {
     Q_INVOKABLE void sendMouseRelease(int x, int y, int button);
     Q_INVOKABLE void sendMouseMove(int x, int y, int buttons);
 
+    // Feeds program output through the parser (the PTY reader, tests and benchmarks)
+    void             processOutput(const QByteArray &data);
+
   signals:
     void runningChanged();
     void titleChanged();
+    void scrollbackLinesChanged();
     void finished(int exitCode);
 
   private slots:
     void onReadActivated();
 
   private:
-    void             processOutput(const QByteArray &data);
-    void             parseEscapeSequence(char ch);
-    void             handleCSI(const QString &seq);
-    void             handleOSC(const QString &seq);
+    // VtParser::Handler
+    void             print(const uint32_t *codePoints, int count) override;
+    void             execute(uint8_t control) override;
+    void             escDispatch(const VtParser &parser, uint8_t final) override;
+    void             csiDispatch(const VtParser &parser, uint8_t final) override;
+    void             oscDispatch(const char *data, int length) override;
+
+    void             selectGraphicRendition(const VtParser &parser);
+    void             setPrivateMode(int mode, bool enabled);
+    void             reply(const QByteArray &data);
 
     int              m_masterFd;
     pid_t            m_pid;
     QSocketNotifier *m_notifier;
     QString          m_title;
     TerminalScreen  *m_screen;
+    VtParser         m_parser;
 
-    // ANSI parser state
-    enum State {
-        Normal,
-        Escape,
-        CSI,    // Control Sequence Introducer [
-        OSC,    // Operating System Command ]
-        Charset // ( or )
-    };
-
-    State        m_state;
-    QString      m_sequenceBuffer;
-    QVector<int> m_params;
+    // Modes the engine itself acts on
+    bool             m_applicationCursorKeys; // DECCKM
+    bool             m_bracketedPaste;
+    bool             m_lineDrawing;      // G0 is the DEC Special Graphics set
+    bool             m_savedLineDrawing; // Saved with the cursor (DECSC)
 };
@@ -0,0 +1,77 @@
+#include "TerminalGlyphAtlas.h"
+#include "TerminalScreen.h"
+#include <QPainter>
+#include <QtMath>
+
+// Atlas dimensions in device pixels; when it fills up it is simply flushed
+static constexpr int kAtlasSize = 1024;
+
+void TerminalGlyphAtlas::setFont(const QFont &font, qreal cellWidth, qreal cellHeight,
+                                 qreal ascent, qreal devicePixelRatio) {
+    m_font       = font;
+    m_boldFont   = font;
+    m_boldFont.setBold(true);
+    m_cellWidth  = cellWidth;
+    m_cellHeight = cellHeight;
+    m_ascent     = ascent;
+    m_dpr        = devicePixelRatio;
+
+    m_slotSize    = QSize(qCeil(cellWidth * 2 * m_dpr), qCeil(cellHeight * m_dpr));
+    m_slotColumns = std::max(1, kAtlasSize / std::max(1, m_slotSize.width()));
+    const int slotRows = std::max(1, kAtlasSize / std::max(1, m_slotSize.height()));
+    m_slotCount        = m_slotColumns * slotRows;
+
+    m_image = QImage(m_slotColumns * m_slotSize.width(), slotRows * m_slotSize.height(),
+                     QImage::Format_ARGB32_Premultiplied);
+    clear();
+}
+
+void TerminalGlyphAtlas::clear() {
+    m_slots.clear();
+    m_nextSlot = 0;
+    if (!m_image.isNull())
+        m_image.fill(Qt::transparent);
+}
+
+QRect TerminalGlyphAtlas::rasterize(const Key &key) {
+    if (m_nextSlot >= m_slotCount)
+        clear();
+
+    const int slot = m_nextSlot++;
+    const QRect rect(QPoint((slot % m_slotColumns) * m_slotSize.width(),
+                            (slot / m_slotColumns) * m_slotSize.height()),
+                     m_slotSize);
+
+    QString text;
+    appendCodePoint(text, key.codePoint);
+
+    QPainter painter(&m_image);
+    painter.setClipRect(rect);
+    painter.translate(rect.topLeft());
+    painter.scale(m_dpr, m_dpr);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+    painter.setFont(key.bold ? m_boldFont : m_font);
+    painter.setPen(QColor::fromRgba(key.color));
+    painter.drawText(QPointF(0, m_ascent), text);
+    painter.end();
+
+    m_slots.insert(key, rect);
+    return rect;
+}
+
+void TerminalGlyphAtlas::drawGlyph(QPainter *painter, const QPointF &pos, uint32_t codePoint,
+                                   bool bold, bool wide, QRgb color) {
+    if (m_image.isNull())
+        return;
+
+    const Key key{codePoint, color, bold};
+    auto      it   = m_slots.constFind(key);
+    QRect     slot = (it != m_slots.constEnd()) ? it.value() : rasterize(key);
+
+    // Narrow glyphs only use the left half of their slot
+    if (!wide)
+        slot.setWidth(qCeil(m_cellWidth * m_dpr));
+
+    painter->drawImage(QRectF(pos, QSizeF(slot.width() / m_dpr, slot.height() / m_dpr)), m_image,
+                       QRectF(slot));
+}
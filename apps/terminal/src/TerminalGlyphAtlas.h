@@ -0,0 +1,53 @@
+#pragma once
+
+#include <QFont>
+#include <QHash>
+#include <QImage>
+#include <QRect>
+
+class QPainter;
+
+// CPU-side glyph cache for the terminal renderer.
+// Each (code point, bold, color) combination is rasterized once into a slot of a shared
+// atlas image; rows are then composed by blitting slots instead of shaping text.
+// Only used from the render thread.
+class TerminalGlyphAtlas {
+  public:
+    void setFont(const QFont &font, qreal cellWidth, qreal cellHeight, qreal ascent,
+                 qreal devicePixelRatio);
+    void clear();
+
+    // Draws the glyph with its cell's top-left corner at `pos` (logical coordinates)
+    void drawGlyph(QPainter *painter, const QPointF &pos, uint32_t codePoint, bool bold,
+                   bool wide, QRgb color);
+
+  private:
+    struct Key {
+        uint32_t codePoint;
+        QRgb     color;
+        bool     bold;
+
+        bool     operator==(const Key &other) const {
+            return codePoint == other.codePoint && color == other.color && bold == other.bold;
+        }
+    };
+    friend size_t qHash(const Key &key, size_t seed) {
+        return qHashMulti(seed, key.codePoint, key.color, key.bold);
+    }
+
+    QRect            rasterize(const Key &key);
+
+    QFont            m_font;
+    QFont            m_boldFont;
+    qreal            m_cellWidth  = 0;
+    qreal            m_cellHeight = 0;
+    qreal            m_ascent     = 0;
+    qreal            m_dpr        = 1;
+
+    QImage           m_image;
+    QSize            m_slotSize; // Device pixels; two cells wide so wide glyphs fit
+    int              m_slotColumns = 0;
+    int              m_slotCount   = 0;
+    int              m_nextSlot    = 0;
+    QHash<Key, QRect> m_slots;
+};
@@ -2,17 +2,34 @@
 #include "TerminalEngine.h"
 #include "TerminalScreen.h"
 #include <QPainter>
-#include <QTimer>
+#include <QQuickWindow>
+#include <QSGSimpleRectNode>
+#include <QSGSimpleTextureNode>
+#include <QtMath>
+
+namespace {
+
+    class TerminalRootNode : public QSGNode {
+      public:
+        QSGSimpleRectNode               *background = nullptr;
+        QSGNode                         *rowLayer   = nullptr;
+        QSGNode                         *selection  = nullptr;
+        QSGSimpleRectNode               *cursor     = nullptr;
+        QVector<QSGSimpleTextureNode *> rows; // Indexed by visible row
+    };
+
+} // namespace
 
 TerminalRenderer::TerminalRenderer(QQuickItem *parent)
-    : QQuickPaintedItem(parent)
+    : QQuickItem(parent)
     , m_terminal(nullptr)
     , m_screen(nullptr)
     , m_charWidth(10)
     , m_charHeight(20)
-    , m_ascent(15) {
+    , m_ascent(15)
+    , m_rowsInvalid(true)
+    , m_atlasDpr(0) {
     setFlag(ItemHasContents, true);
-    setAntialiasing(true);
 
     // Default font - try to find a good monospace font
     QStringList fonts = {"Cascadia Code", "Fira Code", "Roboto Mono", "Courier New", "Monospace"};
@@ -56,7 +73,7 @@ void TerminalRenderer::setTerminal(TerminalEngine *terminal) {
     }
 
     emit terminalChanged();
-    update();
+    invalidateRows();
 }
 
 void TerminalRenderer::setFont(const QFont &font) {
@@ -65,7 +82,7 @@ void TerminalRenderer::setFont(const QFont &font) {
     m_font = font;
     updateCharSize();
     emit fontChanged();
-    update();
+    invalidateRows();
 }
 
 void TerminalRenderer::setTextColor(const QColor &color) {
@@ -73,7 +90,7 @@ void TerminalRenderer::setTextColor(const QColor &color) {
         return;
     m_textColor = color;
     emit textColorChanged();
-    update();
+    invalidateRows();
 }
 
 void TerminalRenderer::setBackgroundColor(const QColor &color) {
@@ -81,7 +98,7 @@ void TerminalRenderer::setBackgroundColor(const QColor &color) {
         return;
     m_backgroundColor = color;
     emit backgroundColorChanged();
-    update();
+    invalidateRows();
 }
 
 void TerminalRenderer::setSelectionColor(const QColor &color) {
@@ -100,14 +117,6 @@ void TerminalRenderer::updateCharSize() {
     emit charSizeChanged();
 }
 
-void TerminalRenderer::onScreenChanged() {
-    update();
-}
-
-void TerminalRenderer::onCursorChanged() {
-    update();
-}
-
 void TerminalRenderer::select(int startX, int startY, int endX, int endY) {
     if (m_screen) {
         m_screen->setSelection(startX, startY, endX, endY);
@@ -142,140 +151,160 @@ QPoint TerminalRenderer::positionToGrid(qreal x, qreal y) {
     return QPoint(col, row);
 }
 
-void TerminalRenderer::paint(QPainter *painter) {
-    if (!m_screen)
-        return;
+void TerminalRenderer::invalidateRows() {
+    m_rowsInvalid = true;
+    update();
+}
+
+QImage TerminalRenderer::renderRow(const TerminalCell *cells, qreal dpr) {
+    const int cols = m_snapshot.cols;
+    QImage    image(qCeil(cols * m_charWidth * dpr), qCeil(m_charHeight * dpr),
+                    QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(dpr);
+    image.fill(Qt::transparent);
+
+    QPainter painter(&image);
+
+    int      x = 0;
+    while (x < cols) {
+        const TerminalCell &startCell = cells[x];
+
+        // Find a run of identical styles
+        int                 runEnd = x + 1;
+        while (runEnd < cols && cells[runEnd].sameStyle(startCell))
+            runEnd++;
+
+        const bool   inverse = startCell.has(TerminalCell::Inverse);
+        const QColor fgColor = (startCell.fg == TerminalCell::DefaultFg) ?
+            m_textColor :
+            QColor::fromRgba(m_snapshot.colorValue(startCell.fg));
+        const QColor bgColor = (startCell.bg == TerminalCell::DefaultBg) ?
+            m_backgroundColor :
+            QColor::fromRgba(m_snapshot.colorValue(startCell.bg));
+
+        // Inverse swaps FG and BG
+        const QColor fg = inverse ? bgColor : fgColor;
+        const QColor bg = inverse ? fgColor : bgColor;
+
+        // Background (default background is left to the item's background node)
+        if (startCell.bg != TerminalCell::DefaultBg || inverse) {
+            painter.fillRect(QRectF(x * m_charWidth, 0, (runEnd - x) * m_charWidth, m_charHeight),
+                             bg);
+        }
+
+        // Glyphs
+        const bool bold = startCell.has(TerminalCell::Bold);
+        for (int i = x; i < runEnd; ++i) {
+            const TerminalCell &c = cells[i];
+            if (c.isWideContinuation() || c.codePoint == ' ')
+                continue;
+            m_atlas.drawGlyph(&painter, QPointF(i * m_charWidth, 0), c.codePoint, bold,
+                              c.has(TerminalCell::Wide), fg.rgba());
+        }
+
+        if (startCell.has(TerminalCell::Underline)) {
+            painter.fillRect(QRectF(x * m_charWidth, m_ascent + 1, (runEnd - x) * m_charWidth, 1),
+                             fg);
+        }
 
-    painter->setFont(m_font);
+        x = runEnd;
+    }
 
-    // Lock the screen while we read from it
-    QMutexLocker locker(m_screen->mutex());
+    return image;
+}
 
-    int          cols = m_screen->cols();
-    int          rows = m_screen->rows();
+QSGNode *TerminalRenderer::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *) {
+    auto *root = static_cast<TerminalRootNode *>(oldNode);
+    if (!m_screen || !window()) {
+        delete root;
+        return nullptr;
+    }
 
-    // Draw background
-    painter->fillRect(boundingRect(), m_backgroundColor);
+    if (!root) {
+        root             = new TerminalRootNode;
+        root->background = new QSGSimpleRectNode;
+        root->rowLayer   = new QSGNode;
+        root->selection  = new QSGNode;
+        root->cursor     = new QSGSimpleRectNode;
+        root->appendChildNode(root->background);
+        root->appendChildNode(root->rowLayer);
+        root->appendChildNode(root->selection);
+        root->appendChildNode(root->cursor);
+        m_rowsInvalid = true;
+    }
 
-    // Batch drawing variables
-    QString lineBuffer;
-    lineBuffer.reserve(cols);
+    // Font, colors or pixel density changed: drop cached glyphs and redo every row
+    const qreal dpr = window()->effectiveDevicePixelRatio();
+    bool        full = m_rowsInvalid;
+    if (m_rowsInvalid || !qFuzzyCompare(dpr, m_atlasDpr)) {
+        m_atlas.setFont(m_font, m_charWidth, m_charHeight, m_ascent, dpr);
+        m_atlasDpr    = dpr;
+        m_rowsInvalid = false;
+        full          = true;
+    }
 
-    for (int y = 0; y < rows; ++y) {
-        // Optimization: Skip rows outside view
-        if (y * m_charHeight > height())
-            break;
+    // Copy the damaged rows out of the screen; the lock is released before rasterizing
+    m_screen->takeSnapshot(m_snapshot, full);
+    if (!m_snapshot.full && root->rows.size() != m_snapshot.rows)
+        m_screen->takeSnapshot(m_snapshot, true);
+
+    const TerminalSnapshot &snap = m_snapshot;
+
+    root->background->setRect(boundingRect());
+    root->background->setColor(m_backgroundColor);
 
-        int x = 0;
-        while (x < cols) {
-            const TerminalCell &startCell = m_screen->cell(x, y);
-
-            // 1. Draw Background (if not default)
-            // We can batch background too, but for now let's do per-cell or small runs
-            // Actually, let's find a run of identical styles
-            int runEnd = x + 1;
-            while (runEnd < cols) {
-                const TerminalCell &next = m_screen->cell(runEnd, y);
-                if (next != startCell)
-                    break;
-                runEnd++;
-            }
-
-            // Draw BG for the run
-            if (startCell.bgColor != 0xFF000000 || startCell.inverse) {
-                QColor bg;
-                if (startCell.inverse) {
-                    // Inverse: Use FG as BG
-                    bg =
-                        (startCell.fgColor == 0xFFFFFFFF) ? m_textColor : QColor(startCell.fgColor);
-                } else {
-                    // Normal: Use BG
-                    bg = QColor(startCell.bgColor);
-                }
-
-                QRectF bgRect(x * m_charWidth, y * m_charHeight, (runEnd - x) * m_charWidth,
-                              m_charHeight);
-                painter->fillRect(bgRect, bg);
-            }
-
-            // Draw Selection Overlay
-            // We need to check each cell in the run for selection
-            // Optimization: Check if the whole run is selected or not
-            // But selection boundaries might be in the middle of a style run.
-            // So we iterate.
-            if (m_screen->hasSelection()) {
-                int selStart = x;
-                while (selStart < runEnd) {
-                    if (m_screen->isSelected(selStart, y)) {
-                        int selEnd = selStart + 1;
-                        while (selEnd < runEnd && m_screen->isSelected(selEnd, y)) {
-                            selEnd++;
-                        }
-                        // Draw selection rect
-                        QRectF selRect(selStart * m_charWidth, y * m_charHeight,
-                                       (selEnd - selStart) * m_charWidth, m_charHeight);
-                        painter->fillRect(selRect, m_selectionColor);
-                        selStart = selEnd;
-                    } else {
-                        selStart++;
-                    }
-                }
-            }
-
-            // Draw Cursor (if in this run)
-            if (y == m_screen->cursorY() && m_screen->cursorX() >= x &&
-                m_screen->cursorX() < runEnd) {
-                QRectF cursorRect(m_screen->cursorX() * m_charWidth, y * m_charHeight, m_charWidth,
-                                  m_charHeight);
-                // Cursor color is inverse of text color or a specific cursor color
-                // For now, let's use semi-transparent inverse of background
-                QColor cursorColor = (m_backgroundColor.lightness() > 128) ?
-                    QColor(0, 0, 0, 128) :
-                    QColor(255, 255, 255, 128);
-                painter->fillRect(cursorRect, cursorColor);
-            }
-
-            // 2. Draw Text Batch
-            // Collect characters for this run
-            lineBuffer.clear();
-            bool hasText = false;
-            for (int i = x; i < runEnd; ++i) {
-                uint32_t cp = m_screen->cell(i, y).codePoint;
-                if (cp && cp != ' ') {
-                    lineBuffer.append(QChar(cp));
-                    hasText = true;
-                } else {
-                    lineBuffer.append(' ');
-                }
-            }
-
-            if (hasText) {
-                QColor fg;
-                if (startCell.inverse) {
-                    // Inverse: Use BG as FG
-                    fg = (startCell.bgColor == 0xFF000000) ? m_backgroundColor :
-                                                             QColor(startCell.bgColor);
-                } else {
-                    // Normal: Use FG
-                    fg =
-                        (startCell.fgColor == 0xFFFFFFFF) ? m_textColor : QColor(startCell.fgColor);
-                }
-
-                painter->setPen(fg);
-
-                if (startCell.bold) {
-                    QFont f = m_font;
-                    f.setBold(true);
-                    painter->setFont(f);
-                } else {
-                    painter->setFont(m_font);
-                }
-
-                painter->drawText(QPointF(x * m_charWidth, y * m_charHeight + m_ascent),
-                                  lineBuffer);
-            }
-
-            x = runEnd;
+    // One texture node per visible row
+    while (root->rows.size() > snap.rows) {
+        QSGSimpleTextureNode *node = root->rows.takeLast();
+        root->rowLayer->removeChildNode(node);
+        delete node;
+    }
+    while (root->rows.size() < snap.rows) {
+        auto *node = new QSGSimpleTextureNode;
+        node->setOwnsTexture(true);
+        node->setFiltering(QSGTexture::Nearest);
+        root->rowLayer->appendChildNode(node);
+        root->rows.append(node);
+    }
+
+    // Whole-screen scrolls: reuse the rows that are still on screen
+    if (snap.scrolled > 0)
+        std::rotate(root->rows.begin(), root->rows.begin() + snap.scrolled, root->rows.end());
+
+    for (int i = 0; i < snap.rowIndices.size(); ++i) {
+        const QImage image = renderRow(snap.cells.constData() + i * snap.cols, dpr);
+        root->rows[snap.rowIndices[i]]->setTexture(window()->createTextureFromImage(image));
+    }
+
+    const qreal rowWidth = snap.cols * m_charWidth;
+    for (int y = 0; y < root->rows.size(); ++y) {
+        root->rows[y]->setRect(QRectF(0, y * m_charHeight, rowWidth, m_charHeight));
+    }
+
+    // Selection overlay
+    while (QSGNode *child = root->selection->firstChild()) {
+        root->selection->removeChildNode(child);
+        delete child;
+    }
+    if (snap.hasSelection) {
+        for (int y = snap.selStartY; y <= snap.selEndY; ++y) {
+            const int startX = (y == snap.selStartY) ? snap.selStartX : 0;
+            const int endX   = (y == snap.selEndY) ? snap.selEndX : snap.cols - 1;
+            const QRectF rect(startX * m_charWidth, y * m_charHeight,
+                              (endX - startX + 1) * m_charWidth, m_charHeight);
+            root->selection->appendChildNode(new QSGSimpleRectNode(rect, m_selectionColor));
         }
     }
+
+    // Cursor: semi-transparent inverse of the background
+    if (snap.cursorVisible && snap.cursorX < snap.cols) {
+        root->cursor->setRect(QRectF(snap.cursorX * m_charWidth, snap.cursorY * m_charHeight,
+                                     m_charWidth, m_charHeight));
+    } else {
+        root->cursor->setRect(QRectF());
+    }
+    root->cursor->setColor((m_backgroundColor.lightness() > 128) ? QColor(0, 0, 0, 128) :
+                                                                  QColor(255, 255, 255, 128));
+
+    return root;
 }
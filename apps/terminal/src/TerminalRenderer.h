@@ -1,13 +1,20 @@
 #pragma once
 
-#include <QQuickPaintedItem>
+#include <QQuickItem>
 #include <QFont>
 #include <QFontMetrics>
+#include <QColor>
+#include <QImage>
+#include "TerminalGlyphAtlas.h"
+#include "TerminalScreen.h"
 
-class TerminalScreen;
 class TerminalEngine;
 
-class TerminalRenderer : public QQuickPaintedItem {
+// Scene-graph terminal view.
+// Each screen row is a texture node; on every frame only the rows the screen reports as
+// damaged are re-rasterized (from a snapshot copied out of the screen lock, using a cached
+// glyph atlas) and re-uploaded. Whole-screen scrolls shift the existing row nodes.
+class TerminalRenderer : public QQuickItem {
     Q_OBJECT
     QML_ELEMENT
 
@@ -70,22 +77,28 @@ class TerminalRenderer : public QQuickPaintedItem {
     void selectionColorChanged();
 
   protected:
-    void paint(QPainter *painter) override;
-
-  private slots:
-    void onScreenChanged();
-    void onCursorChanged();
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
 
   private:
-    void            updateCharSize();
-
-    TerminalEngine *m_terminal;
-    TerminalScreen *m_screen;
-    QFont           m_font;
-    QColor          m_textColor;
-    QColor          m_backgroundColor;
-    QColor          m_selectionColor;
-    qreal           m_charWidth;
-    qreal           m_charHeight;
-    qreal           m_ascent;
+    void               updateCharSize();
+    void               invalidateRows();
+    QImage             renderRow(const TerminalCell *cells, qreal dpr);
+
+    TerminalEngine    *m_terminal;
+    TerminalScreen    *m_screen;
+    QFont              m_font;
+    QColor             m_textColor;
+    QColor             m_backgroundColor;
+    QColor             m_selectionColor;
+    qreal              m_charWidth;
+    qreal              m_charHeight;
+    qreal              m_ascent;
+
+    // Set on the GUI thread when every row must be re-rasterized (font, colors, terminal)
+    bool               m_rowsInvalid;
+
+    // Render-thread state (touched only in updatePaintNode, while the GUI thread is blocked)
+    TerminalSnapshot   m_snapshot;
+    TerminalGlyphAtlas m_atlas;
+    qreal              m_atlasDpr;
 };
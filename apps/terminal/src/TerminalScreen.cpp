@@ -1,6 +1,20 @@
 #include "TerminalScreen.h"
+#include "CharWidth.h"
 #include <QDebug>
 #include <algorithm>
+#include <utility>
+
+// ~60 Hz: bursts of output produce at most one repaint request per frame
+static constexpr int kUpdateIntervalMs = 16;
+
+// Growth step for the scrollback ring (rows), so a fresh terminal doesn't pay for
+// history it hasn't produced yet
+static constexpr int kMinRingGrowth = 64;
+
+// Size of the 24-bit color table (cell color indices are 16 bits), and how many colors are
+// approximated after a compaction that freed nothing before compacting again
+static constexpr int kMaxTrueColors        = 0xFFFF - TerminalCell::FirstTrueColor;
+static constexpr int kCompactRetryInterval = 4096;
 
 TerminalScreen::TerminalScreen(QObject *parent)
     : QObject(parent)
@@ -8,29 +22,135 @@ TerminalScreen::TerminalScreen(QObject *parent)
     , m_rows(24)
     , m_cursorX(0)
     , m_cursorY(0)
-    , m_topRow(0)
-    , m_historySize(1000) // 1000 lines of history
-    , m_currentFg(0xFFFFFFFF)
-    , m_currentBg(0xFF000000)
-    , m_currentBold(false)
-    , m_currentInverse(false)
+    , m_scrollTop(0)
+    , m_scrollBottom(23)
+    , m_autoWrap(true)
+    , m_cursorVisible(true)
+    , m_altScreen(false)
+    , m_currentFg(TerminalCell::DefaultFg)
+    , m_currentBg(TerminalCell::DefaultBg)
+    , m_currentAttributes(0)
     , m_hasSelection(false)
     , m_selStartX(0)
     , m_selStartY(0)
     , m_selEndX(0)
-    , m_selEndY(0) {
-    // Initialize grid with history capacity
-    m_grid.resize(m_historySize);
-    for (int i = 0; i < m_historySize; ++i) {
-        m_grid[i].resize(m_cols);
-    }
+    , m_selEndY(0)
+    , m_capacity(0)
+    , m_ringHead(0)
+    , m_lineCount(0)
+    , m_scrollbackLimit(1000) // 1000 lines of history
+    , m_trueColorFallbacks(0)
+    , m_pendingScroll(0)
+    , m_fullDamage(true)
+    , m_screenDirty(false)
+    , m_cursorDirty(false) {
+    // Start with just the visible screen; history is allocated as it is produced
+    reallocate(m_rows);
+    m_lineCount = m_rows;
+    m_dirtyRows.resize(m_rows);
+
+    m_updateTimer.setSingleShot(true);
+    m_updateTimer.setInterval(kUpdateIntervalMs);
+    connect(&m_updateTimer, &QTimer::timeout, this, &TerminalScreen::flushUpdates);
+}
+
+void TerminalScreen::markAllDirty() {
+    m_fullDamage = true;
+}
+
+void TerminalScreen::markScreenChanged() {
+    m_screenDirty = true;
+    if (!m_updateTimer.isActive())
+        m_updateTimer.start();
+}
+
+void TerminalScreen::markCursorChanged() {
+    m_cursorDirty = true;
+    if (!m_updateTimer.isActive())
+        m_updateTimer.start();
+}
+
+void TerminalScreen::flushUpdates() {
+    const bool screenDirty = m_screenDirty;
+    const bool cursorDirty = m_cursorDirty;
+    m_screenDirty          = false;
+    m_cursorDirty          = false;
+
+    if (screenDirty)
+        emit screenChanged();
+    if (cursorDirty)
+        emit cursorChanged();
+}
+
+int TerminalScreen::ringIndex(int y) const {
+    // y is visual row (negative = scrollback); map to ring row
+    int index = m_ringHead + (m_lineCount - m_rows + y);
+    if (index >= m_capacity)
+        index -= m_capacity;
+    return index;
+}
+
+TerminalCell *TerminalScreen::row(int y) {
+    return m_cells.data() + static_cast<qsizetype>(ringIndex(y)) * m_cols;
+}
+
+const TerminalCell *TerminalScreen::row(int y) const {
+    return m_cells.constData() + static_cast<qsizetype>(ringIndex(y)) * m_cols;
 }
 
 TerminalCell &TerminalScreen::cellAt(int x, int y) {
-    // y is visual row (0..m_rows-1)
-    // map to buffer row
-    int bufferRow = (m_topRow + y) % m_historySize;
-    return m_grid[bufferRow][x];
+    return row(y)[x];
+}
+
+TerminalCell TerminalScreen::blankCell() const {
+    TerminalCell blank;
+    blank.bg = m_currentBg;
+    return blank;
+}
+
+void TerminalScreen::clearRow(int y) {
+    TerminalCell *cells = row(y);
+    std::fill(cells, cells + m_cols, blankCell());
+    m_lineFlags[ringIndex(y)] = 0;
+    markRowDirty(y);
+}
+
+void TerminalScreen::reallocate(int capacity) {
+    // Linearize the ring into `capacity` rows, keeping the newest lines
+    const int             keep = std::min(m_lineCount, capacity);
+    QVector<TerminalCell> cells(static_cast<qsizetype>(capacity) * m_cols);
+    QVector<uint8_t>      flags(capacity, 0);
+
+    for (int line = 0; line < keep; ++line) {
+        int from = m_ringHead + (m_lineCount - keep + line);
+        if (from >= m_capacity)
+            from -= m_capacity;
+        std::copy_n(m_cells.constData() + static_cast<qsizetype>(from) * m_cols, m_cols,
+                    cells.data() + static_cast<qsizetype>(line) * m_cols);
+        flags[line] = m_lineFlags[from];
+    }
+
+    m_cells     = std::move(cells);
+    m_lineFlags = std::move(flags);
+    m_capacity  = capacity;
+    m_ringHead  = 0;
+    m_lineCount = keep;
+}
+
+void TerminalScreen::setScrollbackLines(int lines) {
+    QMutexLocker locker(&m_mutex);
+    lines = std::max(0, lines);
+    if (lines == m_scrollbackLimit)
+        return;
+
+    m_scrollbackLimit = lines;
+    if (m_altScreen)
+        swapBuffers();
+    if (m_capacity > m_rows + lines)
+        reallocate(m_rows + lines);
+    if (m_altScreen)
+        swapBuffers();
+    markScreenChanged();
 }
 
 void TerminalScreen::resize(int cols, int rows) {
@@ -44,84 +164,274 @@ void TerminalScreen::resize(int cols, int rows) {
     if (cols == m_cols && rows == m_rows)
         return;
 
-    // Resizing a ring buffer is complex.
-    // For simplicity in this version, we'll clear history on resize or do a naive copy.
-    // Let's do a naive copy to a new grid to keep it clean.
-
-    QVector<QVector<TerminalCell>> newGrid(m_historySize);
-    for (int i = 0; i < m_historySize; ++i) {
-        newGrid[i].resize(cols);
+    if (m_altScreen) {
+        // Reflow the primary screen underneath; the alternate screen's application redraws
+        // on SIGWINCH, so it just gets a blank grid of the new size
+        const int altCursorX = m_cursorX;
+        const int altCursorY = m_cursorY;
+        swapBuffers();
+        m_cursorX = m_savedBuffer.cursorX;
+        m_cursorY = m_savedBuffer.cursorY;
+        reflow(cols, rows);
+        // 1049 saved the primary cursor on entry; keep it on the same reflowed text
+        m_savedBuffer.cursorX = m_cursorX;
+        m_savedBuffer.cursorY = m_cursorY;
+        m_savedCursor.x       = m_cursorX;
+        m_savedCursor.y       = m_cursorY;
+        swapBuffers();
+        resetAlternateBuffer();
+        m_cursorX = std::min(altCursorX, m_cols - 1);
+        m_cursorY = std::min(altCursorY, m_rows - 1);
+    } else {
+        reflow(cols, rows);
     }
+    m_savedCursor.x = std::min(m_savedCursor.x, m_cols - 1);
+    m_savedCursor.y = std::min(m_savedCursor.y, m_rows - 1);
+    m_scrollTop     = 0;
+    m_scrollBottom  = m_rows - 1;
+    m_hasSelection  = false;
+    m_dirtyRows.fill(0);
+    m_dirtyRows.resize(m_rows);
+    markAllDirty();
+
+    markScreenChanged();
+}
+
+void TerminalScreen::reflow(int cols, int rows) {
+    // Rebuild the whole buffer at the new geometry: soft-wrapped rows are joined back into
+    // logical lines and re-wrapped at the new width, so history survives rotation.
+    const TerminalCell blank;
+    const int          cursorLine = m_lineCount - m_rows + m_cursorY;
+
+    // Ring row of stored line `line` (0 = oldest)
+    auto lineRow = [&](int line) {
+        int index = m_ringHead + line;
+        if (index >= m_capacity)
+            index -= m_capacity;
+        return index;
+    };
+    auto lineIsBlank = [&](int line) {
+        const int           index = lineRow(line);
+        const TerminalCell *cells = m_cells.constData() + static_cast<qsizetype>(index) * m_cols;
+        if (m_lineFlags[index] & Wrapped)
+            return false;
+        return std::all_of(cells, cells + m_cols, [&](const TerminalCell &c) { return c == blank; });
+    };
+
+    // Empty lines below the cursor are dropped so content stays anchored to the top
+    int lastLine = m_lineCount - 1;
+    while (lastLine > cursorLine && lineIsBlank(lastLine))
+        --lastLine;
 
-    // Copy visible portion
-    int copyRows = std::min(rows, m_rows);
-    int copyCols = std::min(cols, m_cols);
+    QVector<TerminalCell> out;
+    QVector<uint8_t>      outFlags;
+    out.reserve(static_cast<qsizetype>(lastLine + 1) * cols);
+    outFlags.reserve(lastLine + 1);
 
-    for (int y = 0; y < copyRows; ++y) {
-        for (int x = 0; x < copyCols; ++x) {
-            int oldRow    = (m_topRow + y) % m_historySize;
-            newGrid[y][x] = m_grid[oldRow][x];
+    auto startRow = [&]() {
+        out.resize(out.size() + cols);
+        outFlags.append(0);
+    };
+
+    int                   newCursorRow = -1;
+    int                   newCursorCol = 0;
+    QVector<TerminalCell> logical;
+
+    for (int line = 0; line <= lastLine;) {
+        // Join one logical line
+        logical.clear();
+        int cursorOffset = -1;
+        int first        = line;
+        for (;;) {
+            const int           index = lineRow(line);
+            const TerminalCell *cells =
+                m_cells.constData() + static_cast<qsizetype>(index) * m_cols;
+            if (line == cursorLine)
+                cursorOffset = (line - first) * m_cols + std::min(m_cursorX, m_cols);
+            const qsizetype offset = logical.size();
+            logical.resize(offset + m_cols);
+            std::copy_n(cells, m_cols, logical.data() + offset);
+            const bool wrapped = (m_lineFlags[index] & Wrapped) && line < lastLine;
+            ++line;
+            if (!wrapped)
+                break;
+        }
+        while (!logical.isEmpty() && logical.constLast() == blank)
+            logical.removeLast();
+
+        // Lay it out at the new width
+        startRow();
+        int col = 0;
+        for (int i = 0; i < logical.size(); ++i) {
+            const TerminalCell &c = logical[i];
+            if (c.isWideContinuation()) {
+                if (i == cursorOffset) {
+                    newCursorRow = static_cast<int>(outFlags.size()) - 1;
+                    newCursorCol = col - 1;
+                }
+                continue;
+            }
+
+            const bool wide  = c.has(TerminalCell::Wide) && cols > 1;
+            const int  width = wide ? 2 : 1;
+            if (col + width > cols) {
+                outFlags.last() |= Wrapped;
+                startRow();
+                col = 0;
+            }
+            if (i == cursorOffset) {
+                newCursorRow = static_cast<int>(outFlags.size()) - 1;
+                newCursorCol = col;
+            }
+
+            TerminalCell *dest = out.data() + static_cast<qsizetype>(outFlags.size() - 1) * cols;
+            dest[col]          = c;
+            if (wide) {
+                dest[col + 1]           = c;
+                dest[col + 1].codePoint = 0;
+                dest[col + 1].attributes &= ~TerminalCell::Wide;
+            } else {
+                dest[col].attributes &= ~TerminalCell::Wide;
+            }
+            col += width;
+        }
+
+        if (cursorOffset >= 0 && newCursorRow < 0) {
+            // Cursor sits past the end of the line's content (col == cols is a pending wrap)
+            col += cursorOffset - static_cast<int>(logical.size());
+            while (col > cols) {
+                startRow();
+                col -= cols;
+            }
+            newCursorRow = static_cast<int>(outFlags.size()) - 1;
+            newCursorCol = col;
         }
     }
 
-    m_grid   = newGrid;
-    m_cols   = cols;
-    m_rows   = rows;
-    m_topRow = 0; // Reset top to 0 after resize
+    // Fill the screen and cap the history
+    while (outFlags.size() < rows)
+        startRow();
 
-    // Clamp cursor
-    if (m_cursorX >= m_cols)
-        m_cursorX = m_cols - 1;
-    if (m_cursorY >= m_rows)
-        m_cursorY = m_rows - 1;
+    const int maxLines = rows + m_scrollbackLimit;
+    const int dropped  = std::max(0, static_cast<int>(outFlags.size()) - maxLines);
+    if (dropped > 0) {
+        out.remove(0, static_cast<qsizetype>(dropped) * cols);
+        outFlags.remove(0, dropped);
+    }
+
+    m_cells     = std::move(out);
+    m_lineFlags = std::move(outFlags);
+    m_cols      = cols;
+    m_rows      = rows;
+    m_capacity  = static_cast<int>(m_lineFlags.size());
+    m_ringHead  = 0;
+    m_lineCount = m_capacity;
 
-    emit screenChanged();
+    const int screenTop = m_lineCount - m_rows;
+    m_cursorY           = std::clamp(newCursorRow - dropped - screenTop, 0, m_rows - 1);
+    m_cursorX           = std::clamp(newCursorCol, 0, m_cols);
 }
 
 void TerminalScreen::clear() {
     QMutexLocker locker(&m_mutex);
     for (int y = 0; y < m_rows; ++y) {
-        for (int x = 0; x < m_cols; ++x) {
-            cellAt(x, y)         = TerminalCell();
-            cellAt(x, y).bgColor = m_currentBg;
-        }
+        clearRow(y);
     }
     m_cursorX = 0;
     m_cursorY = 0;
-    emit screenChanged();
+    markScreenChanged();
 }
 
 void TerminalScreen::putChar(uint32_t codePoint) {
     QMutexLocker locker(&m_mutex);
+    writeChar(codePoint);
+    markScreenChanged();
+}
 
-    if (m_cursorX >= m_cols) {
-        m_cursorX = 0;
-        if (m_cursorY < m_rows - 1) {
-            m_cursorY++;
+void TerminalScreen::putChars(const uint32_t *codePoints, int count) {
+    if (count <= 0)
+        return;
+
+    QMutexLocker locker(&m_mutex);
+    for (int i = 0; i < count; ++i) {
+        writeChar(codePoints[i]);
+    }
+    markScreenChanged();
+}
+
+void TerminalScreen::writeChar(uint32_t codePoint) {
+    // Caller holds m_mutex
+    const int width = CharWidth::width(codePoint);
+    if (width == 0) {
+        // Combining marks and format characters don't occupy a cell of their own
+        return;
+    }
+
+    if (m_cursorX + width > m_cols) {
+        if (width > m_cols)
+            return;
+        if (!m_autoWrap) {
+            // Without autowrap the last column is overwritten
+            m_cursorX = m_cols - width;
         } else {
-            scrollUp();
+            // Pending wrap, or a wide character that doesn't fit in the last column
+            if (m_cursorX < m_cols)
+                cellAt(m_cursorX, m_cursorY) = blankCell();
+            m_lineFlags[ringIndex(m_cursorY)] |= Wrapped;
+            m_cursorX = 0;
+            lineFeed();
         }
     }
 
-    TerminalCell &cell = cellAt(m_cursorX, m_cursorY);
+    TerminalCell *cells = row(m_cursorY);
+    markRowDirty(m_cursorY);
+
+    // Overwriting one half of an existing wide character blanks the other half
+    if (m_cursorX > 0 && cells[m_cursorX].isWideContinuation())
+        cells[m_cursorX - 1] = blankCell();
+    const int lastX = m_cursorX + width - 1;
+    if (lastX + 1 < m_cols && cells[lastX].has(TerminalCell::Wide))
+        cells[lastX + 1] = blankCell();
+
+    TerminalCell &cell = cells[m_cursorX];
     cell.codePoint     = codePoint;
-    cell.fgColor       = m_currentFg;
-    cell.bgColor       = m_currentBg;
-    cell.bold          = m_currentBold;
-    cell.inverse       = m_currentInverse;
+    cell.fg            = m_currentFg;
+    cell.bg            = m_currentBg;
+    cell.attributes    = m_currentAttributes | (width == 2 ? TerminalCell::Wide : 0);
 
-    m_cursorX++;
-    emit screenChanged();
+    if (width == 2) {
+        TerminalCell &tail = cells[m_cursorX + 1];
+        tail               = cell;
+        tail.codePoint     = 0;
+        tail.attributes    = m_currentAttributes;
+    }
+
+    m_cursorX += width;
 }
 
 void TerminalScreen::newLine() {
     QMutexLocker locker(&m_mutex);
-    if (m_cursorY < m_rows - 1) {
+    lineFeed();
+    markCursorChanged();
+}
+
+void TerminalScreen::lineFeed() {
+    if (m_cursorY == m_scrollBottom) {
+        scrollRegionUp(1);
+    } else if (m_cursorY < m_rows - 1) {
         m_cursorY++;
-    } else {
-        scrollUp();
     }
-    emit cursorChanged();
+}
+
+void TerminalScreen::reverseIndex() {
+    QMutexLocker locker(&m_mutex);
+    if (m_cursorY == m_scrollTop) {
+        shiftRowsDown(m_scrollTop, m_scrollBottom, 1);
+        markScreenChanged();
+    } else if (m_cursorY > 0) {
+        m_cursorY--;
+    }
+    markCursorChanged();
 }
 
 void TerminalScreen::backspace() {
@@ -132,14 +442,14 @@ void TerminalScreen::backspace() {
         m_cursorY--;
         m_cursorX = m_cols - 1;
     }
-    emit cursorChanged();
+    markCursorChanged();
 }
 
 void TerminalScreen::moveCursor(int x, int y) {
     QMutexLocker locker(&m_mutex);
     m_cursorX = std::clamp(x, 0, m_cols - 1);
     m_cursorY = std::clamp(y, 0, m_rows - 1);
-    emit cursorChanged();
+    markCursorChanged();
 }
 
 void TerminalScreen::moveCursorRelative(int dx, int dy) {
@@ -156,21 +466,25 @@ void TerminalScreen::setCursorY(int y) {
 
 void TerminalScreen::clearLine(int mode) {
     QMutexLocker locker(&m_mutex);
-    int          start = 0;
-    int          end   = m_cols;
+    clearLineLocked(mode);
+    markScreenChanged();
+}
+
+void TerminalScreen::clearLineLocked(int mode) {
+    int start = 0;
+    int end   = m_cols;
 
     if (mode == 0) { // Cursor to end
-        start = m_cursorX;
+        start = std::min(m_cursorX, m_cols);
     } else if (mode == 1) { // Start to cursor
-        end = m_cursorX + 1;
+        end = std::min(m_cursorX + 1, m_cols);
     }
 
-    for (int x = start; x < end; ++x) {
-        TerminalCell &cell = cellAt(x, m_cursorY);
-        cell               = TerminalCell();
-        cell.bgColor       = m_currentBg;
-    }
-    emit screenChanged();
+    TerminalCell *cells = row(m_cursorY);
+    std::fill(cells + start, cells + end, blankCell());
+    markRowDirty(m_cursorY);
+    if (end == m_cols)
+        m_lineFlags[ringIndex(m_cursorY)] &= ~Wrapped;
 }
 
 void TerminalScreen::clearScreen(int mode) {
@@ -179,10 +493,10 @@ void TerminalScreen::clearScreen(int mode) {
     int          endRow   = m_rows;
 
     if (mode == 0) { // Cursor to end
-        clearLine(0);
+        clearLineLocked(0);
         startRow = m_cursorY + 1;
     } else if (mode == 1) { // Start to cursor
-        clearLine(1);
+        clearLineLocked(1);
         endRow = m_cursorY;
     } else if (mode == 2) { // All
         startRow  = 0;
@@ -192,92 +506,476 @@ void TerminalScreen::clearScreen(int mode) {
     }
 
     for (int y = startRow; y < endRow; ++y) {
-        for (int x = 0; x < m_cols; ++x) {
-            TerminalCell &cell = cellAt(x, y);
-            cell               = TerminalCell();
-            cell.bgColor       = m_currentBg;
-        }
+        clearRow(y);
     }
-    emit screenChanged();
+    markScreenChanged();
 }
 
 void TerminalScreen::deleteChars(int count) {
     QMutexLocker locker(&m_mutex);
-    int          remaining = m_cols - m_cursorX;
-    int          toDelete  = std::min(count, remaining);
+    if (m_cursorX >= m_cols)
+        return;
+
+    int           remaining = m_cols - m_cursorX;
+    int           toDelete  = std::min(count, remaining);
+    TerminalCell *cells     = row(m_cursorY);
+
+    std::copy(cells + m_cursorX + toDelete, cells + m_cols, cells + m_cursorX);
+    std::fill(cells + m_cols - toDelete, cells + m_cols, blankCell());
+    markRowDirty(m_cursorY);
+    markScreenChanged();
+}
+
+void TerminalScreen::insertChars(int count) {
+    QMutexLocker locker(&m_mutex);
+    if (m_cursorX >= m_cols)
+        return;
+
+    int           toInsert = std::min(count, m_cols - m_cursorX);
+    TerminalCell *cells    = row(m_cursorY);
+
+    std::copy_backward(cells + m_cursorX, cells + m_cols - toInsert, cells + m_cols);
+    std::fill(cells + m_cursorX, cells + m_cursorX + toInsert, blankCell());
+    markRowDirty(m_cursorY);
+    markScreenChanged();
+}
+
+void TerminalScreen::eraseChars(int count) {
+    QMutexLocker locker(&m_mutex);
+    if (m_cursorX >= m_cols)
+        return;
+
+    TerminalCell *cells = row(m_cursorY);
+    std::fill(cells + m_cursorX, cells + std::min(m_cols, m_cursorX + count), blankCell());
+    markRowDirty(m_cursorY);
+    markScreenChanged();
+}
+
+void TerminalScreen::insertLines(int count) {
+    QMutexLocker locker(&m_mutex);
+    if (m_cursorY < m_scrollTop || m_cursorY > m_scrollBottom)
+        return;
+
+    shiftRowsDown(m_cursorY, m_scrollBottom, count);
+    m_cursorX = 0;
+    markScreenChanged();
+}
+
+void TerminalScreen::deleteLines(int count) {
+    QMutexLocker locker(&m_mutex);
+    if (m_cursorY < m_scrollTop || m_cursorY > m_scrollBottom)
+        return;
+
+    shiftRowsUp(m_cursorY, m_scrollBottom, count);
+    m_cursorX = 0;
+    markScreenChanged();
+}
+
+void TerminalScreen::scrollUp(int count) {
+    QMutexLocker locker(&m_mutex);
+    scrollRegionUp(count);
+    markScreenChanged();
+}
+
+void TerminalScreen::scrollDown(int count) {
+    QMutexLocker locker(&m_mutex);
+    shiftRowsDown(m_scrollTop, m_scrollBottom, count);
+    markScreenChanged();
+}
 
-    for (int x = m_cursorX; x < m_cols - toDelete; ++x) {
-        cellAt(x, m_cursorY) = cellAt(x + toDelete, m_cursorY);
+void TerminalScreen::scrollRegionUp(int count) {
+    if (m_scrollTop == 0 && m_scrollBottom == m_rows - 1) {
+        // Whole screen: rotate the ring so the top lines move into the scrollback
+        count = std::min(count, m_rows);
+        for (int i = 0; i < count; ++i)
+            advanceRing();
+    } else {
+        shiftRowsUp(m_scrollTop, m_scrollBottom, count);
     }
+}
+
+void TerminalScreen::shiftRowsUp(int top, int bottom, int count) {
+    count = std::min(count, bottom - top + 1);
+    for (int y = top; y <= bottom - count; ++y)
+        copyRow(y + count, y);
+    for (int y = bottom - count + 1; y <= bottom; ++y)
+        clearRow(y);
+}
+
+void TerminalScreen::shiftRowsDown(int top, int bottom, int count) {
+    count = std::min(count, bottom - top + 1);
+    for (int y = bottom; y >= top + count; --y)
+        copyRow(y - count, y);
+    for (int y = top; y < top + count; ++y)
+        clearRow(y);
+}
 
-    for (int x = m_cols - toDelete; x < m_cols; ++x) {
-        TerminalCell &cell = cellAt(x, m_cursorY);
-        cell               = TerminalCell();
-        cell.bgColor       = m_currentBg;
+void TerminalScreen::copyRow(int from, int to) {
+    std::copy_n(row(from), m_cols, row(to));
+    m_lineFlags[ringIndex(to)] = m_lineFlags[ringIndex(from)];
+    markRowDirty(to);
+}
+
+void TerminalScreen::fillWithAlignmentPattern() {
+    QMutexLocker locker(&m_mutex);
+    TerminalCell fill;
+    fill.codePoint = 'E';
+    for (int y = 0; y < m_rows; ++y) {
+        TerminalCell *cells = row(y);
+        std::fill(cells, cells + m_cols, fill);
+        m_lineFlags[ringIndex(y)] = 0;
+        markRowDirty(y);
     }
-    emit screenChanged();
+    m_scrollTop    = 0;
+    m_scrollBottom = m_rows - 1;
+    m_cursorX      = 0;
+    m_cursorY      = 0;
+    markScreenChanged();
+    markCursorChanged();
 }
 
-void TerminalScreen::insertChars(int count) {
+void TerminalScreen::setScrollRegion(int top, int bottom) {
     QMutexLocker locker(&m_mutex);
-    for (int x = m_cols - 1; x >= m_cursorX + count; --x) {
-        cellAt(x, m_cursorY) = cellAt(x - count, m_cursorY);
+    top    = std::clamp(top, 0, m_rows - 1);
+    bottom = std::clamp(bottom, 0, m_rows - 1);
+    if (top >= bottom) {
+        // Invalid (or single-line) regions are ignored, as in xterm
+        return;
     }
+    m_scrollTop    = top;
+    m_scrollBottom = bottom;
+    m_cursorX      = 0;
+    m_cursorY      = 0;
+    markCursorChanged();
+}
 
-    for (int x = m_cursorX; x < std::min(m_cursorX + count, m_cols); ++x) {
-        TerminalCell &cell = cellAt(x, m_cursorY);
-        cell               = TerminalCell();
-        cell.bgColor       = m_currentBg;
+void TerminalScreen::setAutoWrap(bool enabled) {
+    QMutexLocker locker(&m_mutex);
+    m_autoWrap = enabled;
+}
+
+void TerminalScreen::setCursorVisible(bool visible) {
+    QMutexLocker locker(&m_mutex);
+    if (visible == m_cursorVisible)
+        return;
+    m_cursorVisible = visible;
+    markCursorChanged();
+}
+
+void TerminalScreen::swapBuffers() {
+    std::swap(m_cells, m_savedBuffer.cells);
+    std::swap(m_lineFlags, m_savedBuffer.lineFlags);
+    std::swap(m_capacity, m_savedBuffer.capacity);
+    std::swap(m_ringHead, m_savedBuffer.ringHead);
+    std::swap(m_lineCount, m_savedBuffer.lineCount);
+}
+
+void TerminalScreen::resetAlternateBuffer() {
+    m_cells     = QVector<TerminalCell>(static_cast<qsizetype>(m_rows) * m_cols);
+    m_lineFlags = QVector<uint8_t>(m_rows, 0);
+    m_capacity  = m_rows;
+    m_ringHead  = 0;
+    m_lineCount = m_rows;
+}
+
+void TerminalScreen::setAlternateScreen(bool enabled) {
+    QMutexLocker locker(&m_mutex);
+    if (enabled == m_altScreen)
+        return;
+
+    swapBuffers();
+    m_altScreen = enabled;
+    if (enabled) {
+        m_savedBuffer.cursorX = m_cursorX;
+        m_savedBuffer.cursorY = m_cursorY;
+        resetAlternateBuffer();
+    } else {
+        // Drop the alternate grid; it is blank on the next entry anyway
+        m_savedBuffer = Buffer();
     }
-    emit screenChanged();
+
+    m_hasSelection = false;
+    markAllDirty();
+    markScreenChanged();
+    markCursorChanged();
+}
+
+void TerminalScreen::saveCursor() {
+    QMutexLocker locker(&m_mutex);
+    m_savedCursor.x          = std::min(m_cursorX, m_cols - 1);
+    m_savedCursor.y          = m_cursorY;
+    m_savedCursor.fg         = m_currentFg;
+    m_savedCursor.bg         = m_currentBg;
+    m_savedCursor.attributes = m_currentAttributes;
+}
+
+void TerminalScreen::restoreCursor() {
+    QMutexLocker locker(&m_mutex);
+    m_cursorX           = std::min(m_savedCursor.x, m_cols - 1);
+    m_cursorY           = std::min(m_savedCursor.y, m_rows - 1);
+    m_currentFg         = m_savedCursor.fg;
+    m_currentBg         = m_savedCursor.bg;
+    m_currentAttributes = m_savedCursor.attributes;
+    markCursorChanged();
 }
 
-void TerminalScreen::setFgColor(uint32_t color) {
+void TerminalScreen::reset() {
+    setAlternateScreen(false);
+
+    QMutexLocker locker(&m_mutex);
+    resetStyle();
+    for (int y = 0; y < m_rows; ++y)
+        clearRow(y);
+    m_cursorX       = 0;
+    m_cursorY       = 0;
+    m_scrollTop     = 0;
+    m_scrollBottom  = m_rows - 1;
+    m_autoWrap      = true;
+    m_cursorVisible = true;
+    m_savedCursor   = SavedCursor();
+    // Colors only the cleared screen used are not referenced anymore
+    compactTrueColors();
+    markScreenChanged();
+    markCursorChanged();
+}
+
+void TerminalScreen::setFgColor(uint16_t color) {
     m_currentFg = color;
 }
 
-void TerminalScreen::setBgColor(uint32_t color) {
+void TerminalScreen::setBgColor(uint16_t color) {
     m_currentBg = color;
 }
 
+void TerminalScreen::setFgRgb(uint32_t rgb) {
+    m_currentFg = trueColorIndex(rgb);
+}
+
+void TerminalScreen::setBgRgb(uint32_t rgb) {
+    m_currentBg = trueColorIndex(rgb);
+}
+
+uint16_t TerminalScreen::trueColorIndex(uint32_t rgb) {
+    rgb &= 0xFFFFFF;
+    auto it = m_trueColorIndex.constFind(rgb);
+    if (it != m_trueColorIndex.constEnd())
+        return it.value();
+
+    // The renderer reads the table under the screen lock
+    QMutexLocker locker(&m_mutex);
+    if (m_trueColors.size() >= kMaxTrueColors && m_trueColorFallbacks == 0)
+        compactTrueColors();
+
+    if (m_trueColors.size() >= kMaxTrueColors) {
+        // Still exhausted: fall back to the nearest entry of the 6x6x6 color cube, and only
+        // try compacting again once a batch of colors has been approximated
+        m_trueColorFallbacks = (m_trueColorFallbacks + 1) % kCompactRetryInterval;
+        auto level = [](uint32_t v) { return v < 48 ? 0 : (v < 115 ? 1 : (v - 35) / 40); };
+        return static_cast<uint16_t>(16 + 36 * level((rgb >> 16) & 0xFF) +
+                                     6 * level((rgb >> 8) & 0xFF) + level(rgb & 0xFF));
+    }
+
+    const auto index = static_cast<uint16_t>(TerminalCell::FirstTrueColor + m_trueColors.size());
+    m_trueColors.append(rgb);
+    m_trueColorIndex.insert(rgb, index);
+    return index;
+}
+
+void TerminalScreen::compactTrueColors() {
+    // Caller holds m_mutex. Keeps the colors still used by a cell of either screen, the pen
+    // or the saved cursor, renumbered from FirstTrueColor; everything else is dropped.
+    if (m_trueColors.isEmpty())
+        return;
+
+    QVector<uint16_t> remap(m_trueColors.size(), 0); // Old slot -> new index, 0 = unused
+
+    auto use = [&remap](uint16_t color) {
+        if (color >= TerminalCell::FirstTrueColor)
+            remap[color - TerminalCell::FirstTrueColor] = 1;
+    };
+    for (const TerminalCell &cell : std::as_const(m_cells)) {
+        use(cell.fg);
+        use(cell.bg);
+    }
+    for (const TerminalCell &cell : std::as_const(m_savedBuffer.cells)) {
+        use(cell.fg);
+        use(cell.bg);
+    }
+    use(m_currentFg);
+    use(m_currentBg);
+    use(m_savedCursor.fg);
+    use(m_savedCursor.bg);
+
+    QVector<uint32_t>         colors;
+    QHash<uint32_t, uint16_t> colorIndex;
+    for (int i = 0; i < m_trueColors.size(); ++i) {
+        if (!remap[i])
+            continue;
+        remap[i] = static_cast<uint16_t>(TerminalCell::FirstTrueColor + colors.size());
+        colors.append(m_trueColors[i]);
+        colorIndex.insert(m_trueColors[i], remap[i]);
+    }
+    if (colors.size() == m_trueColors.size())
+        return;
+
+    auto renumber = [&remap](uint16_t &color) {
+        if (color >= TerminalCell::FirstTrueColor)
+            color = remap[color - TerminalCell::FirstTrueColor];
+    };
+    for (TerminalCell &cell : m_cells) {
+        renumber(cell.fg);
+        renumber(cell.bg);
+    }
+    for (TerminalCell &cell : m_savedBuffer.cells) {
+        renumber(cell.fg);
+        renumber(cell.bg);
+    }
+    renumber(m_currentFg);
+    renumber(m_currentBg);
+    renumber(m_savedCursor.fg);
+    renumber(m_savedCursor.bg);
+
+    m_trueColors         = std::move(colors);
+    m_trueColorIndex     = std::move(colorIndex);
+    m_trueColorFallbacks = 0;
+    // Rows the renderer already holds were resolved against the old numbering
+    markAllDirty();
+}
+
+uint32_t TerminalScreen::colorValue(uint16_t color) const {
+    if (color < 256)
+        return paletteColor(color);
+    if (color >= TerminalCell::FirstTrueColor)
+        return 0xFF000000 | m_trueColors.value(color - TerminalCell::FirstTrueColor);
+    return 0;
+}
+
+uint32_t TerminalScreen::paletteColor(int index) {
+    // xterm-256: 16 Tango colors, 6x6x6 cube, 24-step gray ramp
+    static const uint32_t basic[16] = {0xFF000000, 0xFFCC0000, 0xFF4E9A06, 0xFFC4A000,
+                                       0xFF3465A4, 0xFF75507B, 0xFF06989A, 0xFFD3D7CF,
+                                       0xFF555753, 0xFFEF2929, 0xFF8AE234, 0xFFFCE94F,
+                                       0xFF729FCF, 0xFFAD7FA8, 0xFF34E2E2, 0xFFEEEEEC};
+    if (index < 16)
+        return basic[std::max(0, index)];
+
+    if (index < 232) {
+        static const uint32_t levels[6] = {0, 95, 135, 175, 215, 255};
+        const int             i         = index - 16;
+        return 0xFF000000 | (levels[i / 36] << 16) | (levels[(i / 6) % 6] << 8) | levels[i % 6];
+    }
+
+    const uint32_t gray = 8 + 10 * (std::min(index, 255) - 232);
+    return 0xFF000000 | (gray << 16) | (gray << 8) | gray;
+}
+
+void TerminalScreen::setAttribute(TerminalCell::Attribute attribute, bool enabled) {
+    if (enabled)
+        m_currentAttributes |= attribute;
+    else
+        m_currentAttributes &= ~attribute;
+}
+
 void TerminalScreen::setBold(bool bold) {
-    m_currentBold = bold;
+    setAttribute(TerminalCell::Bold, bold);
+}
+
+void TerminalScreen::setItalic(bool italic) {
+    setAttribute(TerminalCell::Italic, italic);
+}
+
+void TerminalScreen::setUnderline(bool underline) {
+    setAttribute(TerminalCell::Underline, underline);
 }
 
 void TerminalScreen::setInverse(bool inverse) {
-    m_currentInverse = inverse;
+    setAttribute(TerminalCell::Inverse, inverse);
 }
 
 void TerminalScreen::resetStyle() {
-    m_currentFg      = 0xFFFFFFFF;
-    m_currentBg      = 0xFF000000;
-    m_currentBold    = false;
-    m_currentInverse = false;
+    m_currentFg         = TerminalCell::DefaultFg;
+    m_currentBg         = TerminalCell::DefaultBg;
+    m_currentAttributes = 0;
 }
 
 const TerminalCell &TerminalScreen::cell(int x, int y) const {
     static TerminalCell empty;
-    if (y >= 0 && y < m_rows && x >= 0 && x < m_cols) {
-        // Const cast to call helper, but we know we are reading
-        return const_cast<TerminalScreen *>(this)->cellAt(x, y);
+    if (y >= -historyLines() && y < m_rows && x >= 0 && x < m_cols) {
+        return row(y)[x];
     }
     return empty;
 }
 
-void TerminalScreen::scrollUp() {
-    // Ring buffer scroll: just increment top pointer
-    m_topRow = (m_topRow + 1) % m_historySize;
+void TerminalScreen::advanceRing() {
+    const int maxLines = m_rows + (m_altScreen ? 0 : m_scrollbackLimit);
+
+    if (m_lineCount < m_capacity) {
+        // Ring not full yet: the next ring row becomes the bottom line
+        m_lineCount++;
+    } else if (m_capacity < maxLines) {
+        // Grow geometrically up to the scrollback limit
+        reallocate(std::min(maxLines, std::max(m_capacity * 2, m_capacity + kMinRingGrowth)));
+        m_lineCount++;
+    } else {
+        // Full: the oldest line falls off, O(1)
+        m_ringHead = (m_ringHead + 1) % m_capacity;
+    }
 
-    // Clear the new bottom row (which was the old top row)
-    // The bottom row is at visual index m_rows - 1
-    int bottomRowIndex = (m_topRow + m_rows - 1) % m_historySize;
+    // Damage moves up with the content; the renderer shifts its rows by m_pendingScroll
+    std::rotate(m_dirtyRows.begin(), m_dirtyRows.begin() + 1, m_dirtyRows.end());
+    m_pendingScroll++;
+
+    // Clear the new bottom row (it may hold a recycled line)
+    clearRow(m_rows - 1);
+
+    markScreenChanged();
+}
 
-    for (int x = 0; x < m_cols; ++x) {
-        m_grid[bottomRowIndex][x]         = TerminalCell();
-        m_grid[bottomRowIndex][x].bgColor = m_currentBg;
+void TerminalScreen::takeSnapshot(TerminalSnapshot &snapshot, bool full) {
+    QMutexLocker locker(&m_mutex);
+
+    full = full || m_fullDamage || m_pendingScroll >= m_rows;
+
+    snapshot.cols          = m_cols;
+    snapshot.rows          = m_rows;
+    snapshot.cursorX       = m_cursorX;
+    snapshot.cursorY       = m_cursorY;
+    snapshot.cursorVisible = m_cursorVisible;
+    snapshot.scrolled      = full ? 0 : m_pendingScroll;
+    snapshot.full          = full;
+    snapshot.rowIndices.clear();
+    snapshot.cells.clear();
+    snapshot.trueColors = m_trueColors;
+
+    snapshot.hasSelection = m_hasSelection;
+    snapshot.selStartX    = m_selStartX;
+    snapshot.selStartY    = m_selStartY;
+    snapshot.selEndX      = m_selEndX;
+    snapshot.selEndY      = m_selEndY;
+
+    for (int y = 0; y < m_rows; ++y) {
+        if (full || m_dirtyRows[y]) {
+            snapshot.rowIndices.append(y);
+        }
     }
 
-    emit screenChanged();
+    snapshot.cells.resize(snapshot.rowIndices.size() * m_cols);
+    TerminalCell *dest = snapshot.cells.data();
+    for (int y : std::as_const(snapshot.rowIndices)) {
+        dest = std::copy_n(row(y), m_cols, dest);
+    }
+
+    m_dirtyRows.fill(0);
+    m_pendingScroll = 0;
+    m_fullDamage    = false;
+}
+
+uint32_t TerminalSnapshot::colorValue(uint16_t color) const {
+    if (color < 256)
+        return TerminalScreen::paletteColor(color);
+    if (color >= TerminalCell::FirstTrueColor)
+        return 0xFF000000 | trueColors.value(color - TerminalCell::FirstTrueColor);
+    return 0;
 }
 
 void TerminalScreen::setSelection(int startX, int startY, int endX, int endY) {
@@ -295,14 +993,14 @@ void TerminalScreen::setSelection(int startX, int startY, int endX, int endY) {
     m_selEndX   = std::clamp(endX, 0, m_cols - 1);
     m_selEndY   = std::clamp(endY, 0, m_rows - 1);
 
-    emit screenChanged();
+    markScreenChanged();
 }
 
 void TerminalScreen::clearSelection() {
     QMutexLocker locker(&m_mutex);
     if (m_hasSelection) {
         m_hasSelection = false;
-        emit screenChanged();
+        markScreenChanged();
     }
 }
 
@@ -339,11 +1037,10 @@ QString TerminalScreen::getSelectedText() const {
 
         for (int x = startX; x <= endX; ++x) {
             const TerminalCell &c = cell(x, y);
-            if (c.codePoint) {
-                text.append(QChar(c.codePoint));
-            } else {
-                text.append(' '); // Empty cells are spaces
+            if (c.isWideContinuation()) {
+                continue; // Already emitted with its left half
             }
+            appendCodePoint(text, c.codePoint);
         }
 
         if (y < m_selEndY) {
@@ -2,22 +2,53 @@
 
 #include <QObject>
 #include <QVector>
+#include <QHash>
 #include <QColor>
 #include <QMutex>
+#include <QString>
+#include <QTimer>
 
+// One grid cell, packed into 8 bytes.
+// Colors are indices: 0-255 is the xterm-256 palette, DefaultFg/DefaultBg defer to the
+// renderer's theme colors, and FirstTrueColor onwards index the screen's 24-bit color table.
 struct TerminalCell {
-    uint32_t codePoint = ' ';
-    uint32_t fgColor   = 0xFFFFFFFF; // ARGB
-    uint32_t bgColor   = 0xFF000000; // ARGB
-    bool     bold      = false;
-    bool     italic    = false;
-    bool     underline = false;
-    bool     inverse   = false;
+    enum Attribute : uint16_t {
+        Bold      = 0x01,
+        Italic    = 0x02,
+        Underline = 0x04,
+        Inverse   = 0x08,
+        Wide      = 0x10, // Left half of a double-width character
+    };
 
-    bool     operator==(const TerminalCell &other) const {
-        return codePoint == other.codePoint && fgColor == other.fgColor &&
-            bgColor == other.bgColor && bold == other.bold && italic == other.italic &&
-            underline == other.underline && inverse == other.inverse;
+    static constexpr uint16_t DefaultFg      = 256;
+    static constexpr uint16_t DefaultBg      = 257;
+    static constexpr uint16_t FirstTrueColor = 258;
+
+    uint32_t                  codePoint : 21; // 0 = right half of the preceding wide character
+    uint32_t                  attributes : 11;
+    uint16_t                  fg;
+    uint16_t                  bg;
+
+    TerminalCell()
+        : codePoint(' ')
+        , attributes(0)
+        , fg(DefaultFg)
+        , bg(DefaultBg) {}
+
+    bool has(Attribute attribute) const {
+        return attributes & attribute;
+    }
+    bool isWideContinuation() const {
+        return codePoint == 0;
+    }
+
+    // Same colors and attributes (code point ignored)
+    bool sameStyle(const TerminalCell &other) const {
+        return fg == other.fg && bg == other.bg && attributes == other.attributes;
+    }
+
+    bool operator==(const TerminalCell &other) const {
+        return codePoint == other.codePoint && sameStyle(other);
     }
 
     bool operator!=(const TerminalCell &other) const {
@@ -25,18 +56,64 @@ struct TerminalCell {
     }
 };
 
+static_assert(sizeof(TerminalCell) == 8, "TerminalCell should stay packed");
+
+// Appends a cell's code point to a QString (as a surrogate pair outside the BMP)
+inline void appendCodePoint(QString &text, uint32_t codePoint) {
+    if (QChar::requiresSurrogates(codePoint)) {
+        text.append(QChar(QChar::highSurrogate(codePoint)));
+        text.append(QChar(QChar::lowSurrogate(codePoint)));
+    } else {
+        text.append(QChar(static_cast<char16_t>(codePoint)));
+    }
+}
+
+// Copy of the damaged part of the screen, taken under the lock so the renderer can
+// rasterize without holding it
+struct TerminalSnapshot {
+    int                   cols          = 0;
+    int                   rows          = 0;
+    int                   cursorX       = 0;
+    int                   cursorY       = 0;
+    bool                  cursorVisible = true;
+    int                   scrolled      = 0;     // Whole-screen scrolls since the previous snapshot
+    bool                  full          = false; // Every row is included
+    QVector<int>          rowIndices;       // Visible rows present in `cells`, ascending
+    QVector<TerminalCell> cells;            // rowIndices.size() * cols cells
+    QVector<uint32_t>     trueColors;       // Shared copy of the screen's 24-bit color table
+
+    bool                  hasSelection = false;
+    int                   selStartX = 0, selStartY = 0;
+    int                   selEndX = 0, selEndY = 0;
+
+    uint32_t              colorValue(uint16_t color) const;
+};
+
 class TerminalScreen : public QObject {
     Q_OBJECT
 
   public:
     explicit TerminalScreen(QObject *parent = nullptr);
 
+    // Resizing reflows soft-wrapped lines (screen and scrollback) to the new width
     void resize(int cols, int rows);
     void clear();
 
+    // Scrollback
+    int  scrollbackLines() const {
+        return m_scrollbackLimit;
+    }
+    void setScrollbackLines(int lines);
+    int  historyLines() const {
+        return m_lineCount - m_rows;
+    }
+
     // Character manipulation
     void putChar(uint32_t codePoint);
-    void newLine();
+    // Bulk ingest of a run of printable code points under a single lock
+    void putChars(const uint32_t *codePoints, int count);
+    void newLine();        // Index: scrolls the region when the cursor is on its bottom row
+    void reverseIndex();   // Scrolls the region down when the cursor is on its top row
     void backspace();
 
     // Cursor movement
@@ -50,16 +127,52 @@ class TerminalScreen : public QObject {
     void clearScreen(int mode); // 0=end, 1=start, 2=all
     void deleteChars(int count);
     void insertChars(int count);
+    void eraseChars(int count);
+    void insertLines(int count); // Within the scroll region, from the cursor row down
+    void deleteLines(int count);
+    void scrollUp(int count);    // Scrolls the region's contents
+    void scrollDown(int count);
+    void fillWithAlignmentPattern(); // DECALN
+
+    // Scroll region (DECSTBM), rows [top, bottom] inclusive; homes the cursor
+    void setScrollRegion(int top, int bottom);
+
+    // Modes
+    void setAutoWrap(bool enabled);
+    void setCursorVisible(bool visible);
+    bool cursorVisible() const {
+        return m_cursorVisible;
+    }
+    // The alternate screen has no scrollback and is blank whenever it is entered
+    void setAlternateScreen(bool enabled);
+    bool alternateScreen() const {
+        return m_altScreen;
+    }
+
+    // DECSC / DECRC: cursor position and style
+    void saveCursor();
+    void restoreCursor();
+
+    // Full reset (RIS): primary screen, default modes and style, scrollback kept
+    void reset();
 
     // Style
-    void setFgColor(uint32_t color);
-    void setBgColor(uint32_t color);
-    void setBold(bool bold);
-    void setInverse(bool inverse);
-    void resetStyle();
+    void            setFgColor(uint16_t color); // Palette index or TerminalCell::DefaultFg
+    void            setBgColor(uint16_t color); // Palette index or TerminalCell::DefaultBg
+    void            setFgRgb(uint32_t rgb);
+    void            setBgRgb(uint32_t rgb);
+    void            setBold(bool bold);
+    void            setItalic(bool italic);
+    void            setUnderline(bool underline);
+    void            setInverse(bool inverse);
+    void            resetStyle();
+
+    // ARGB value of a palette or true-color index (not valid for the Default* indices)
+    uint32_t        colorValue(uint16_t color) const;
+    static uint32_t paletteColor(int index);
 
     // Accessors for Renderer
-    int cols() const {
+    int             cols() const {
         return m_cols;
     }
     int rows() const {
@@ -71,54 +184,135 @@ class TerminalScreen : public QObject {
     int cursorY() const {
         return m_cursorY;
     }
+    // y in [-historyLines(), rows()): negative rows address the scrollback
     const TerminalCell &cell(int x, int y) const;
 
     // Selection
-    void setSelection(int startX, int startY, int endX, int endY);
-    void clearSelection();
-    bool hasSelection() const {
+    void                setSelection(int startX, int startY, int endX, int endY);
+    void                clearSelection();
+    bool                hasSelection() const {
         return m_hasSelection;
     }
     bool    isSelected(int x, int y) const;
     QString getSelectedText() const;
 
+    // Damage tracking: copies the rows changed since the last snapshot (all rows if
+    // `full`) and resets the damage. Takes the lock only for the copy.
+    void    takeSnapshot(TerminalSnapshot &snapshot, bool full = false);
+
     // Thread safety
     QMutex *mutex() {
         return &m_mutex;
     }
 
   signals:
+    // Coalesced: emitted at most once per frame interval
     void screenChanged();
     void cursorChanged();
 
   private:
-    void          scrollUp();
+    enum LineFlag : uint8_t {
+        Wrapped = 0x01, // Line continues on the next row (soft wrap)
+    };
+
+    // Grid storage of one screen (the inactive one is parked in m_savedBuffer)
+    struct Buffer {
+        QVector<TerminalCell> cells;
+        QVector<uint8_t>      lineFlags;
+        int                   capacity  = 0;
+        int                   ringHead  = 0;
+        int                   lineCount = 0;
+        int                   cursorX   = 0; // Primary cursor while the alternate screen is up
+        int                   cursorY   = 0;
+    };
+
+    struct SavedCursor {
+        int      x          = 0;
+        int      y          = 0;
+        uint16_t fg         = TerminalCell::DefaultFg;
+        uint16_t bg         = TerminalCell::DefaultBg;
+        uint16_t attributes = 0;
+    };
+
+    void          advanceRing();
+    void          lineFeed();
+    void          scrollRegionUp(int count);
+    void          shiftRowsUp(int top, int bottom, int count);
+    void          shiftRowsDown(int top, int bottom, int count);
+    void          copyRow(int from, int to);
+    void          swapBuffers();
+    void          resetAlternateBuffer();
+    void          setAttribute(TerminalCell::Attribute attribute, bool enabled);
+    TerminalCell *row(int y);
+    const TerminalCell *row(int y) const;
+    int           ringIndex(int y) const;
     TerminalCell &cellAt(int x, int y);
+    void          clearRow(int y);
+    void          writeChar(uint32_t codePoint);
+    TerminalCell  blankCell() const;
+    uint16_t      trueColorIndex(uint32_t rgb);
+    void          compactTrueColors();
+    void          reallocate(int capacity);
+    void          reflow(int cols, int rows);
+    void          clearLineLocked(int mode);
+    void          markRowDirty(int y) {
+        m_dirtyRows[y] = 1;
+    }
+    void          markAllDirty();
+    void          markScreenChanged();
+    void          markCursorChanged();
+    void          flushUpdates();
 
     int           m_cols;
     int           m_rows;
     int           m_cursorX;
     int           m_cursorY;
 
-    // Ring Buffer State
-    int m_topRow;      // Index of the visual top row in the buffer
-    int m_historySize; // Total rows in buffer (screen + history)
+    // Modes
+    int           m_scrollTop;
+    int           m_scrollBottom;
+    bool          m_autoWrap;
+    bool          m_cursorVisible;
+    bool          m_altScreen;
+    SavedCursor   m_savedCursor;
+    Buffer        m_savedBuffer;
 
     // Style state
-    uint32_t m_currentFg;
-    uint32_t m_currentBg;
-    bool     m_currentBold;
-    bool     m_currentInverse;
+    uint16_t      m_currentFg;
+    uint16_t      m_currentBg;
+    uint16_t      m_currentAttributes;
 
     // Selection State
-    bool m_hasSelection;
-    int  m_selStartX, m_selStartY;
-    int  m_selEndX, m_selEndY;
+    bool          m_hasSelection;
+    int           m_selStartX, m_selStartY;
+    int           m_selEndX, m_selEndY;
+
+    // Grid: one contiguous ring of m_capacity rows * m_cols cells.
+    // Line 0 (oldest scrollback) lives at ring row m_ringHead; the visible screen is the last
+    // m_rows of the m_lineCount stored lines. The ring grows on demand up to
+    // m_rows + m_scrollbackLimit rows, after which scrolling just advances m_ringHead.
+    // On the alternate screen the ring is exactly m_rows rows (no history).
+    QVector<TerminalCell>  m_cells;
+    QVector<uint8_t>       m_lineFlags; // Per ring row
+    int                    m_capacity;
+    int                    m_ringHead;
+    int                    m_lineCount;
+    int                    m_scrollbackLimit;
+
+    // 24-bit colors referenced by cells (index - TerminalCell::FirstTrueColor)
+    QVector<uint32_t>      m_trueColors;
+    QHash<uint32_t, uint16_t> m_trueColorIndex;
+    int                    m_trueColorFallbacks; // Cube approximations since a failed compaction
+
+    // Damage since the last snapshot (visible rows)
+    QVector<uint8_t>       m_dirtyRows;
+    int                    m_pendingScroll;
+    bool                   m_fullDamage;
 
-    // Grid: [row][col]
-    // We use a flat vector for better cache locality? Or vector of vectors?
-    // Vector of vectors is easier for resizing.
-    QVector<QVector<TerminalCell>> m_grid;
+    QMutex                 m_mutex;
 
-    QMutex                         m_mutex;
+    // Change notification coalescing
+    QTimer                 m_updateTimer;
+    bool                   m_screenDirty;
+    bool                   m_cursorDirty;
 };
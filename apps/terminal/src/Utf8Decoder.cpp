@@ -0,0 +1,104 @@
+#include "Utf8Decoder.h"
+
+namespace {
+
+    // Byte classes:
+    //  0: 00..7F        ASCII
+    //  1: 80..8F        continuation
+    //  2: 90..9F        continuation
+    //  3: A0..BF        continuation
+    //  4: C0 C1 F5..FF  never valid
+    //  5: C2..DF        2-byte lead
+    //  6: E0            3-byte lead, next byte A0..BF
+    //  7: E1..EC EE EF  3-byte lead
+    //  8: ED            3-byte lead, next byte 80..9F (no surrogates)
+    //  9: F0            4-byte lead, next byte 90..BF
+    // 10: F1..F3        4-byte lead
+    // 11: F4            4-byte lead, next byte 80..8F (<= U+10FFFF)
+    // clang-format off
+    const uint8_t kByteClass[256] = {
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, // 00..1F
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, // 20..3F
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, // 40..5F
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, // 60..7F
+        1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1, 2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2, // 80..9F
+        3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3, 3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3, // A0..BF
+        4,4,5,5,5,5,5,5,5,5,5,5,5,5,5,5, 5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5, // C0..DF
+        6,7,7,7,7,7,7,7,7,7,7,7,7,8,7,7, 9,10,10,10,11,4,4,4,4,4,4,4,4,4,4,4, // E0..FF
+    };
+
+    // Payload bits carried by a lead byte of each class
+    const uint8_t kLeadMask[12] = {0x7F, 0, 0, 0, 0, 0x1F, 0x0F, 0x0F, 0x0F, 0x07, 0x07, 0x07};
+
+    // States: 0 accept, 1..3 need that many continuation bytes, 4 after E0, 5 after ED,
+    // 6 after F0, 7 after F4, 8 reject.
+    enum : uint8_t { Accept = 0, Reject = 8 };
+
+    const uint8_t kTransition[8][12] = {
+        // cls: 0  1  2  3  4  5  6  7  8  9 10 11
+        {0, 8, 8, 8, 8, 1, 4, 2, 5, 6, 3, 7}, // accept
+        {8, 0, 0, 0, 8, 8, 8, 8, 8, 8, 8, 8}, // 1 continuation left
+        {8, 1, 1, 1, 8, 8, 8, 8, 8, 8, 8, 8}, // 2 continuations left
+        {8, 2, 2, 2, 8, 8, 8, 8, 8, 8, 8, 8}, // 3 continuations left
+        {8, 8, 8, 1, 8, 8, 8, 8, 8, 8, 8, 8}, // E0: A0..BF
+        {8, 1, 1, 8, 8, 8, 8, 8, 8, 8, 8, 8}, // ED: 80..9F
+        {8, 8, 2, 2, 8, 8, 8, 8, 8, 8, 8, 8}, // F0: 90..BF
+        {8, 2, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8}, // F4: 80..8F
+    };
+    // clang-format on
+
+} // namespace
+
+int Utf8Decoder::decode(const char *data, int length, uint32_t *out) {
+    const auto *bytes = reinterpret_cast<const uint8_t *>(data);
+    uint32_t   *start = out;
+    int         i     = 0;
+
+    while (i < length) {
+        if (m_state == Accept) {
+            // ASCII fast path
+            while (i < length && bytes[i] < 0x80) {
+                *out++ = bytes[i++];
+            }
+            if (i == length)
+                break;
+
+            const uint8_t byte = bytes[i++];
+            const uint8_t cls  = kByteClass[byte];
+            const uint8_t next = kTransition[Accept][cls];
+            if (next == Reject) {
+                *out++ = ReplacementChar;
+            } else {
+                m_codePoint = byte & kLeadMask[cls];
+                m_state     = next;
+            }
+            continue;
+        }
+
+        const uint8_t byte = bytes[i];
+        const uint8_t next = kTransition[m_state][kByteClass[byte]];
+        if (next == Reject) {
+            // Truncated sequence: substitute it and reprocess this byte from scratch
+            *out++  = ReplacementChar;
+            m_state = Accept;
+            continue;
+        }
+
+        ++i;
+        m_codePoint = (m_codePoint << 6) | (byte & 0x3F);
+        m_state     = next;
+        if (m_state == Accept)
+            *out++ = m_codePoint;
+    }
+
+    return static_cast<int>(out - start);
+}
+
+int Utf8Decoder::flush(uint32_t *out) {
+    if (m_state == Accept)
+        return 0;
+
+    reset();
+    *out = ReplacementChar;
+    return 1;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+// Streaming, table-driven UTF-8 decoder.
+// State survives between decode() calls, so a multi-byte sequence split across two
+// PTY reads decodes correctly. Malformed input becomes U+FFFD, one per maximal
+// invalid subpart (same substitution policy as QString::fromUtf8 and browsers).
+class Utf8Decoder {
+  public:
+    static constexpr uint32_t ReplacementChar = 0xFFFD;
+
+    // Decodes `length` bytes into `out`, which must have room for length + 1 code points.
+    // Returns the number of code points written.
+    int decode(const char *data, int length, uint32_t *out);
+
+    // Terminates an incomplete sequence, e.g. when a C0 control interrupts it.
+    // Writes U+FFFD to `out` if a sequence was pending; returns 0 or 1.
+    int flush(uint32_t *out);
+
+    void reset() {
+        m_state     = 0;
+        m_codePoint = 0;
+    }
+    bool hasPending() const {
+        return m_state != 0;
+    }
+
+  private:
+    uint8_t  m_state     = 0;
+    uint32_t m_codePoint = 0;
+};
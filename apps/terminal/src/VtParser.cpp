@@ -0,0 +1,204 @@
+#include "VtParser.h"
+#include <algorithm>
+
+namespace {
+    enum Action : uint8_t {
+        None,
+        Execute,
+        Collect,
+        Marker,
+        Param,
+        EscDispatch,
+        CsiDispatch,
+        OscPut,
+    };
+
+    // Each entry packs (action << 4) | next state
+    struct TransitionTable {
+        uint8_t entries[VtParser::StateCount][256];
+
+        constexpr void set(int state, int first, int last, Action action, int next) {
+            for (int byte = first; byte <= last; ++byte)
+                entries[state][byte] = static_cast<uint8_t>((action << 4) | next);
+        }
+
+        // C0 controls other than CAN, SUB and ESC, which are handled from every state
+        constexpr void setC0(int state, Action action) {
+            set(state, 0x00, 0x17, action, state);
+            set(state, 0x19, 0x19, action, state);
+            set(state, 0x1C, 0x1F, action, state);
+        }
+    };
+
+    constexpr TransitionTable buildTable() {
+        TransitionTable t{};
+
+        for (int state = 0; state < VtParser::StateCount; ++state) {
+            t.set(state, 0x00, 0xFF, None, state);
+            t.set(state, 0x18, 0x18, Execute, VtParser::Ground);
+            t.set(state, 0x1A, 0x1A, Execute, VtParser::Ground);
+            t.set(state, 0x1B, 0x1B, None, VtParser::Escape);
+        }
+
+        // Printable bytes in the ground state never reach the table (see feed())
+        t.setC0(VtParser::Ground, Execute);
+
+        t.setC0(VtParser::Escape, Execute);
+        t.set(VtParser::Escape, 0x20, 0x2F, Collect, VtParser::EscapeIntermediate);
+        t.set(VtParser::Escape, 0x30, 0x7E, EscDispatch, VtParser::Ground);
+        t.set(VtParser::Escape, 0x5B, 0x5B, None, VtParser::CsiEntry);    // [
+        t.set(VtParser::Escape, 0x5D, 0x5D, None, VtParser::OscString);   // ]
+        t.set(VtParser::Escape, 0x50, 0x50, None, VtParser::IgnoreString); // P (DCS)
+        t.set(VtParser::Escape, 0x58, 0x58, None, VtParser::IgnoreString); // X (SOS)
+        t.set(VtParser::Escape, 0x5E, 0x5F, None, VtParser::IgnoreString); // ^ _ (PM, APC)
+
+        t.setC0(VtParser::EscapeIntermediate, Execute);
+        t.set(VtParser::EscapeIntermediate, 0x20, 0x2F, Collect, VtParser::EscapeIntermediate);
+        t.set(VtParser::EscapeIntermediate, 0x30, 0x7E, EscDispatch, VtParser::Ground);
+
+        t.setC0(VtParser::CsiEntry, Execute);
+        t.set(VtParser::CsiEntry, 0x20, 0x2F, Collect, VtParser::CsiIntermediate);
+        t.set(VtParser::CsiEntry, 0x30, 0x39, Param, VtParser::CsiParam);
+        t.set(VtParser::CsiEntry, 0x3A, 0x3A, None, VtParser::CsiIgnore);
+        t.set(VtParser::CsiEntry, 0x3B, 0x3B, Param, VtParser::CsiParam);
+        t.set(VtParser::CsiEntry, 0x3C, 0x3F, Marker, VtParser::CsiParam);
+        t.set(VtParser::CsiEntry, 0x40, 0x7E, CsiDispatch, VtParser::Ground);
+
+        t.setC0(VtParser::CsiParam, Execute);
+        t.set(VtParser::CsiParam, 0x20, 0x2F, Collect, VtParser::CsiIntermediate);
+        t.set(VtParser::CsiParam, 0x30, 0x39, Param, VtParser::CsiParam);
+        t.set(VtParser::CsiParam, 0x3A, 0x3A, None, VtParser::CsiIgnore);
+        t.set(VtParser::CsiParam, 0x3B, 0x3B, Param, VtParser::CsiParam);
+        t.set(VtParser::CsiParam, 0x3C, 0x3F, None, VtParser::CsiIgnore);
+        t.set(VtParser::CsiParam, 0x40, 0x7E, CsiDispatch, VtParser::Ground);
+
+        t.setC0(VtParser::CsiIntermediate, Execute);
+        t.set(VtParser::CsiIntermediate, 0x20, 0x2F, Collect, VtParser::CsiIntermediate);
+        t.set(VtParser::CsiIntermediate, 0x30, 0x3F, None, VtParser::CsiIgnore);
+        t.set(VtParser::CsiIntermediate, 0x40, 0x7E, CsiDispatch, VtParser::Ground);
+
+        t.setC0(VtParser::CsiIgnore, Execute);
+        t.set(VtParser::CsiIgnore, 0x40, 0x7E, None, VtParser::Ground);
+
+        // OSC payloads are UTF-8, so bytes >= 0x80 are data, not C1 controls
+        t.set(VtParser::OscString, 0x07, 0x07, None, VtParser::Ground); // BEL terminator
+        t.set(VtParser::OscString, 0x20, 0xFF, OscPut, VtParser::OscString);
+
+        return t;
+    }
+
+    constexpr TransitionTable kTable = buildTable();
+} // namespace
+
+VtParser::VtParser(Handler *handler)
+    : m_handler(handler)
+    , m_state(Ground)
+    , m_oscLength(0) {
+    clear();
+}
+
+void VtParser::reset() {
+    m_state = Ground;
+    m_utf8.reset();
+    m_oscLength = 0;
+    clear();
+}
+
+void VtParser::clear() {
+    m_paramCount           = 0;
+    m_params[0]            = 0;
+    m_intermediateCount    = 0;
+    m_privateMarker        = 0;
+    m_paramsFull           = false;
+    m_intermediateOverflow = false;
+}
+
+void VtParser::feed(const char *data, int length) {
+    const auto *bytes = reinterpret_cast<const uint8_t *>(data);
+    int         i     = 0;
+
+    while (i < length) {
+        if (m_state == Ground) {
+            // Fast path: hand printable runs (ASCII and UTF-8) straight to the decoder
+            const int start = i;
+            while (i < length && bytes[i] >= 0x20 && bytes[i] != 0x7F)
+                ++i;
+            if (i > start)
+                printRun(data + start, i - start);
+            if (i == length)
+                break;
+            flushPendingUtf8();
+        }
+        transition(bytes[i++]);
+    }
+}
+
+void VtParser::printRun(const char *data, int length) {
+    for (int offset = 0; offset < length; offset += PrintChunk) {
+        const int count = m_utf8.decode(data + offset, std::min(PrintChunk, length - offset),
+                                        m_decoded);
+        if (count > 0)
+            m_handler->print(m_decoded, count);
+    }
+}
+
+void VtParser::flushPendingUtf8() {
+    if (m_utf8.flush(m_decoded))
+        m_handler->print(m_decoded, 1);
+}
+
+void VtParser::transition(uint8_t byte) {
+    const uint8_t entry  = kTable.entries[m_state][byte];
+    const auto    action = static_cast<Action>(entry >> 4);
+    const auto    next   = static_cast<State>(entry & 0x0F);
+
+    // Exit action; CAN and SUB abort the string instead of terminating it
+    if (m_state == OscString && next != OscString && byte != 0x18 && byte != 0x1A)
+        m_handler->oscDispatch(m_osc, m_oscLength);
+
+    switch (action) {
+        case None: break;
+        case Execute: m_handler->execute(byte); break;
+        case Collect:
+            if (m_intermediateCount < MaxIntermediates)
+                m_intermediates[m_intermediateCount++] = static_cast<char>(byte);
+            else
+                m_intermediateOverflow = true;
+            break;
+        case Marker: m_privateMarker = static_cast<char>(byte); break;
+        case Param:
+            if (m_paramCount == 0)
+                m_paramCount = 1;
+            if (byte == ';') {
+                if (m_paramCount < MaxParams)
+                    m_params[m_paramCount++] = 0;
+                else
+                    m_paramsFull = true;
+            } else if (!m_paramsFull) {
+                int &value = m_params[m_paramCount - 1];
+                value      = std::min(value * 10 + (byte - '0'), 65535);
+            }
+            break;
+        case EscDispatch:
+            if (!m_intermediateOverflow)
+                m_handler->escDispatch(*this, byte);
+            break;
+        case CsiDispatch:
+            if (!m_intermediateOverflow)
+                m_handler->csiDispatch(*this, byte);
+            break;
+        case OscPut:
+            if (m_oscLength < MaxOscLength)
+                m_osc[m_oscLength++] = static_cast<char>(byte);
+            break;
+    }
+
+    // Entry actions (ESC restarts a sequence even from the Escape state itself)
+    if (next != m_state || byte == 0x1B) {
+        if (next == Escape || next == CsiEntry)
+            clear();
+        else if (next == OscString)
+            m_oscLength = 0;
+    }
+    m_state = next;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "Utf8Decoder.h"
+#include <cstdint>
+
+// Table-driven VT500-series escape sequence parser (after Paul Williams' DEC ANSI parser
+// state machine), with UTF-8 decoding in the ground state.
+// All state lives in fixed-size members: parsing never allocates, whatever the input.
+// DCS, SOS, PM and APC strings are recognized and skipped.
+class VtParser {
+  public:
+    static constexpr int MaxParams        = 16;
+    static constexpr int MaxIntermediates = 2;
+    static constexpr int MaxOscLength     = 512;
+
+    class Handler {
+      public:
+        virtual ~Handler() = default;
+
+        // Printable text (decoded code points), in runs
+        virtual void print(const uint32_t *codePoints, int count) = 0;
+        // C0 control character
+        virtual void execute(uint8_t control) = 0;
+        // ESC [intermediates] final
+        virtual void escDispatch(const VtParser &parser, uint8_t final) = 0;
+        // CSI [marker] [params] [intermediates] final
+        virtual void csiDispatch(const VtParser &parser, uint8_t final) = 0;
+        // OSC payload (raw bytes, UTF-8), terminated by BEL or ST
+        virtual void oscDispatch(const char *data, int length) = 0;
+    };
+
+    explicit VtParser(Handler *handler);
+
+    void feed(const char *data, int length);
+    void reset();
+
+    // Sequence accessors, valid during a dispatch callback
+    int paramCount() const {
+        return m_paramCount;
+    }
+    // Missing and zero parameters both yield `defaultValue`
+    int param(int index, int defaultValue) const {
+        return (index < m_paramCount && m_params[index] != 0) ? m_params[index] : defaultValue;
+    }
+    int rawParam(int index) const {
+        return index < m_paramCount ? m_params[index] : 0;
+    }
+    // Private parameter marker ('?', '>', '<', '=') or 0
+    char privateMarker() const {
+        return m_privateMarker;
+    }
+    int intermediateCount() const {
+        return m_intermediateCount;
+    }
+    char intermediate(int index) const {
+        return index < m_intermediateCount ? m_intermediates[index] : 0;
+    }
+
+    enum State : uint8_t {
+        Ground,
+        Escape,
+        EscapeIntermediate,
+        CsiEntry,
+        CsiParam,
+        CsiIntermediate,
+        CsiIgnore,
+        OscString,
+        IgnoreString, // DCS, SOS, PM, APC: consumed until ST
+        StateCount
+    };
+
+  private:
+    void        printRun(const char *data, int length);
+    void        flushPendingUtf8();
+    void        transition(uint8_t byte);
+    void        clear();
+
+    Handler    *m_handler;
+    State       m_state;
+    Utf8Decoder m_utf8;
+
+    int         m_params[MaxParams];
+    int         m_paramCount;
+    char        m_intermediates[MaxIntermediates];
+    int         m_intermediateCount;
+    char        m_privateMarker;
+    bool        m_paramsFull;          // Parameters past MaxParams are dropped
+    bool        m_intermediateOverflow; // Sequence is malformed and not dispatched
+
+    char        m_osc[MaxOscLength];
+    int         m_oscLength;
+
+    // Decoded print runs are handed over in chunks of this size
+    static constexpr int PrintChunk = 1024;
+    uint32_t    m_decoded[PrintChunk + 1];
+};
@@ -2,6 +2,7 @@
 #include "marathonkeyboardime.h"
 #include <QDebug>
 #include <QFile>
+#include <QLocale>
 #include <QTextStream>
 #include <QStandardPaths>
 #include <algorithm>
@@ -13,12 +14,16 @@ MarathonKeyboardIME::MarathonKeyboardIME(QObject *parent)
     , m_autoCorrectEnabled(true)
     , m_averageLatency(0)
     , m_predictionThread(new QThread(this))
-    , m_predictionEngine(new PredictionEngine())
-    , m_dictionaryLoader(new DictionaryLoader()) {
+    , m_dictionaryLoader(new DictionaryLoader())
+    , m_predictionEngine(new PredictionEngine(m_dictionaryLoader)) {
     // Move prediction engine to background thread
     m_predictionEngine->moveToThread(m_predictionThread);
     m_dictionaryLoader->moveToThread(m_predictionThread);
 
+    // Deleted in their thread, where the user dictionary writes its last batch
+    connect(m_predictionThread, &QThread::finished, m_predictionEngine, &QObject::deleteLater);
+    connect(m_predictionThread, &QThread::finished, m_dictionaryLoader, &QObject::deleteLater);
+
     // Connect signals
     connect(m_predictionEngine, &PredictionEngine::predictionsReady, this,
             &MarathonKeyboardIME::onPredictionsReady);
@@ -35,9 +40,6 @@ MarathonKeyboardIME::MarathonKeyboardIME(QObject *parent)
 MarathonKeyboardIME::~MarathonKeyboardIME() {
     m_predictionThread->quit();
     m_predictionThread->wait();
-
-    delete m_predictionEngine;
-    delete m_dictionaryLoader;
 }
 
 void MarathonKeyboardIME::setAutoCorrectEnabled(bool enabled) {
@@ -173,10 +175,9 @@ void MarathonKeyboardIME::learnWord(const QString &word) {
         return;
     }
 
-    // Update frequency asynchronously
-    QMetaObject::invokeMethod(
-        m_dictionaryLoader, [this, word]() { m_dictionaryLoader->updateFrequency(word, 10); },
-        Qt::QueuedConnection);
+    // Learn asynchronously
+    QMetaObject::invokeMethod(m_dictionaryLoader, "learnWord", Qt::QueuedConnection,
+                              Q_ARG(QString, word));
 }
 
 void MarathonKeyboardIME::clearCurrentWord() {
@@ -248,11 +249,22 @@ QString MarathonKeyboardIME::applyAutoCorrect(const QString &word) {
 
 // ========== PredictionEngine Implementation ==========
 
-PredictionEngine::PredictionEngine(QObject *parent)
+namespace {
+    // Keystroke-to-suggestion budget; same threshold updateLatencyMetrics() warns at
+    constexpr qint64 kPredictionBudgetMs = 10;
+
+    // Words the keyboard can still suggest when no compiled lexicon is installed
+    const char *const kFallbackWords[] = {
+        "the",  "be",  "to",   "of", "and",  "a",    "in",    "that",  "have",  "I",
+        "it",   "for", "not",  "on", "with", "he",   "as",    "you",   "do",    "at",
+        "this", "but", "his",  "by", "from", "they", "we",    "say",   "her",   "she",
+        "or",   "an",  "will", "my", "one",  "all",  "would", "there", "their", "what",
+    };
+} // namespace
+
+PredictionEngine::PredictionEngine(DictionaryLoader *dictionary, QObject *parent)
     : QObject(parent)
-    , m_root(new TrieNode()) {
-    buildTrie();
-}
+    , m_dictionary(dictionary) {}
 
 void PredictionEngine::generatePredictions(const QString &prefix) {
     if (prefix.isEmpty()) {
@@ -260,89 +272,71 @@ void PredictionEngine::generatePredictions(const QString &prefix) {
         return;
     }
 
-    // Search trie for predictions
-    QStringList predictions = searchTrie(prefix.toLower(), 3);
-
-    emit        predictionsReady(predictions);
-}
-
-void PredictionEngine::buildTrie() {
-    // Build trie from common words
-    // This is a placeholder - real implementation would load from file
-    QStringList commonWords = {"the", "be", "to",   "of",  "and", "a",    "in",   "that", "have",
-                               "I",   "it", "for",  "not", "on",  "with", "he",   "as",   "you",
-                               "do",  "at", "this", "but", "his", "by",   "from", "they"};
-
-    for (const QString &word : commonWords) {
-        TrieNode *current = m_root;
-        for (const QChar &ch : word) {
-            if (!current->children.contains(ch)) {
-                current->children[ch]            = new TrieNode();
-                current->children[ch]->character = ch;
-            }
-            current = current->children[ch];
-        }
-        current->isWord    = true;
-        current->frequency = 100; // Default frequency
-    }
-}
-
-QStringList PredictionEngine::searchTrie(const QString &prefix, int maxResults) {
-    QStringList results;
+    QElapsedTimer timer;
+    timer.start();
 
-    // Navigate to prefix node
-    TrieNode *current = m_root;
-    for (const QChar &ch : prefix) {
-        if (!current->children.contains(ch)) {
-            return results; // Prefix not found
-        }
-        current = current->children[ch];
-    }
+    QStringList predictions = m_dictionary->complete(prefix, 3);
 
-    // DFS to find words (simplified - real implementation would use priority queue)
-    // For now, just return if current is a word
-    if (current->isWord) {
-        results.append(prefix);
+    if (timer.elapsed() > kPredictionBudgetMs) {
+        qWarning() << "[PredictionEngine] Slow prediction for" << prefix << ":" << timer.elapsed()
+                   << "ms";
     }
 
-    return results;
+    emit predictionsReady(predictions);
 }
 
 // ========== DictionaryLoader Implementation ==========
 
 DictionaryLoader::DictionaryLoader(QObject *parent)
-    : QObject(parent) {}
+    : QObject(parent)
+    , m_userDictionary(new MarathonUserDictionary(MarathonUserDictionary::defaultPath(), this)) {}
 
 void DictionaryLoader::loadDictionary() {
     qDebug() << "[DictionaryLoader] Loading dictionary...";
 
-    // Load common words with frequencies
-    // This is a placeholder - real implementation would load from file
-    QStringList  commonWords = {"the", "be", "to",  "of",  "and", "a",    "in", "that", "have",
-                                "I",   "it", "for", "not", "on",  "with", "he", "as",   "you"};
+    QElapsedTimer timer;
+    timer.start();
+
+    QString path = MarathonLexicon::locate(QLocale::system().name());
+    if (path.isEmpty())
+        path = MarathonLexicon::locate("en_US");
 
     QMutexLocker locker(&m_mutex);
-    for (int i = 0; i < commonWords.size(); ++i) {
-        m_wordFrequencies[commonWords[i]] = 1000 - (i * 10);
-        emit loadProgress((i + 1) * 100 / commonWords.size());
+    if (path.isEmpty() || !m_lexicon.load(path)) {
+        qWarning() << "[DictionaryLoader] No compiled lexicon found, using built-in word list";
+
+        QList<MarathonLexicon::Entry> entries;
+        quint32                       frequency = 1000;
+        for (const char *word : kFallbackWords)
+            entries.append({QString::fromLatin1(word), frequency--});
+        m_lexicon.loadData(MarathonLexicon::build(entries));
     }
+    m_userDictionary->load();
+    locker.unlock();
 
-    qDebug() << "[DictionaryLoader] Loaded" << m_wordFrequencies.size() << "words";
+    emit loadProgress(100);
+    qDebug() << "[DictionaryLoader] Loaded" << m_lexicon.wordCount() << "words in"
+             << timer.elapsed() << "ms";
     emit dictionaryLoaded();
 }
 
+QStringList DictionaryLoader::complete(const QString &prefix, int maxResults) const {
+    QMutexLocker locker(&m_mutex);
+    return m_userDictionary->complete(m_lexicon, prefix, maxResults);
+}
+
 bool DictionaryLoader::hasWord(const QString &word) const {
     QMutexLocker locker(&m_mutex);
-    return m_wordFrequencies.contains(word.toLower());
+    return m_lexicon.contains(word) || m_userDictionary->contains(word);
 }
 
 int DictionaryLoader::getFrequency(const QString &word) const {
     QMutexLocker locker(&m_mutex);
-    return m_wordFrequencies.value(word.toLower(), 0);
+    return static_cast<int>(m_lexicon.frequency(word) +
+                            MarathonUserDictionary::LearnedWeight * m_userDictionary->score(word));
 }
 
-void DictionaryLoader::updateFrequency(const QString &word, int delta) {
+void DictionaryLoader::learnWord(const QString &word) {
     QMutexLocker locker(&m_mutex);
-    QString      lowerWord       = word.toLower();
-    m_wordFrequencies[lowerWord] = m_wordFrequencies.value(lowerWord, 0) + delta;
+    m_userDictionary->learn(word);
 }
@@ -14,6 +14,9 @@
 #include <QVariant>
 #include <QVariantMap>
 
+#include "marathonlexicon.h"
+#include "marathonuserdictionary.h"
+
 // Forward declarations
 class PredictionEngine;
 class DictionaryLoader;
@@ -159,8 +162,8 @@ class MarathonKeyboardIME : public QObject {
 
     // Background processing
     QThread          *m_predictionThread;
-    PredictionEngine *m_predictionEngine;
     DictionaryLoader *m_dictionaryLoader;
+    PredictionEngine *m_predictionEngine;
 
     // Thread safety
     mutable QMutex m_mutex;
@@ -179,7 +182,7 @@ class PredictionEngine : public QObject {
     Q_OBJECT
 
   public:
-    explicit PredictionEngine(QObject *parent = nullptr);
+    explicit PredictionEngine(DictionaryLoader *dictionary, QObject *parent = nullptr);
 
   public slots:
     void generatePredictions(const QString &prefix);
@@ -188,31 +191,14 @@ class PredictionEngine : public QObject {
     void predictionsReady(const QStringList &predictions);
 
   private:
-    // Trie or similar fast structure for predictions
-    struct TrieNode {
-        QChar                    character;
-        int                      frequency;
-        bool                     isWord;
-        QHash<QChar, TrieNode *> children;
-
-        TrieNode()
-            : frequency(0)
-            , isWord(false) {}
-        ~TrieNode() {
-            qDeleteAll(children);
-        }
-    };
-
-    TrieNode   *m_root;
-
-    void        buildTrie();
-    QStringList searchTrie(const QString &prefix, int maxResults = 3);
+    DictionaryLoader *m_dictionary;
 };
 
 /**
  * @brief Async dictionary loader
  * 
- * Loads and indexes dictionary in background
+ * Maps the compiled lexicon for the current locale in background and ranks
+ * it together with the words learned from the user
  */
 class DictionaryLoader : public QObject {
     Q_OBJECT
@@ -223,15 +209,19 @@ class DictionaryLoader : public QObject {
     Q_INVOKABLE void loadDictionary();
     Q_INVOKABLE bool hasWord(const QString &word) const;
     Q_INVOKABLE int  getFrequency(const QString &word) const;
-    Q_INVOKABLE void updateFrequency(const QString &word, int delta = 1);
+    Q_INVOKABLE void learnWord(const QString &word);
+
+    // Most frequent words for a prefix; called from the prediction thread
+    QStringList complete(const QString &prefix, int maxResults) const;
 
   signals:
     void dictionaryLoaded();
     void loadProgress(int percent);
 
   private:
-    QHash<QString, int> m_wordFrequencies;
-    mutable QMutex      m_mutex;
+    MarathonLexicon         m_lexicon;
+    MarathonUserDictionary *m_userDictionary;
+    mutable QMutex          m_mutex;
 };
 
 #endif // MARATHONKEYBOARDIME_H
@@ -0,0 +1,409 @@
+// Marathon Keyboard Lexicon - Implementation
+#include "marathonlexicon.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QIODevice>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <queue>
+#include <vector>
+
+struct MarathonLexicon::Header {
+    char    magic[4];
+    quint32 version;
+    quint32 nodeCount;
+    quint32 edgeCount;
+    quint32 wordCount;
+    quint32 reserved;
+};
+
+struct MarathonLexicon::Node {
+    quint32 firstEdge;
+    quint32 frequency;     // 0 if no word ends here
+    quint32 bestFrequency; // highest frequency in this subtree
+    quint16 edgeCount;
+    quint16 flags;
+};
+
+struct MarathonLexicon::Edge {
+    quint32  target;
+    char16_t label;
+    quint16  reserved;
+};
+
+namespace {
+    const char kMagic[4] = {'M', 'L', 'E', 'X'};
+
+    enum NodeFlag : quint16 {
+        Capitalized = 0x1, // "Monday", "I"
+        AllCaps     = 0x2, // "NASA"
+    };
+
+    quint16 caseFlags(const QString &word) {
+        if (word.isEmpty() || !word.at(0).isUpper())
+            return 0;
+        if (word.size() > 1 && word == word.toUpper())
+            return AllCaps;
+        return Capitalized;
+    }
+
+    QString applyCase(QString word, quint16 flags) {
+        if (flags & AllCaps)
+            return word.toUpper();
+        if ((flags & Capitalized) && !word.isEmpty())
+            word[0] = word.at(0).toUpper();
+        return word;
+    }
+} // namespace
+
+MarathonLexicon::MarathonLexicon()
+    : m_header(nullptr)
+    , m_nodes(nullptr)
+    , m_edges(nullptr) {}
+
+MarathonLexicon::~MarathonLexicon() {
+    clear();
+}
+
+bool MarathonLexicon::load(const QString &path) {
+    clear();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly))
+        return false;
+
+    const uchar *data = m_file.map(0, m_file.size());
+    if (!data || !attach(data, m_file.size())) {
+        qWarning() << "[MarathonLexicon] Not a valid lexicon:" << path;
+        clear();
+        return false;
+    }
+    return true;
+}
+
+bool MarathonLexicon::loadData(const QByteArray &data) {
+    clear();
+
+    m_data = data;
+    if (!attach(reinterpret_cast<const uchar *>(m_data.constData()), m_data.size())) {
+        clear();
+        return false;
+    }
+    return true;
+}
+
+void MarathonLexicon::clear() {
+    m_header = nullptr;
+    m_nodes  = nullptr;
+    m_edges  = nullptr;
+    m_data.clear();
+    if (m_file.isOpen())
+        m_file.close(); // also unmaps
+}
+
+bool MarathonLexicon::attach(const uchar *data, qint64 size) {
+    if (size < qint64(sizeof(Header)))
+        return false;
+
+    const auto *header = reinterpret_cast<const Header *>(data);
+    if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 || header->version != Version)
+        return false;
+    if (header->nodeCount == 0 ||
+        size != qint64(sizeof(Header)) + qint64(header->nodeCount) * qint64(sizeof(Node)) +
+                qint64(header->edgeCount) * qint64(sizeof(Edge)))
+        return false;
+
+    const auto *nodes = reinterpret_cast<const Node *>(data + sizeof(Header));
+    const auto *edges = reinterpret_cast<const Edge *>(nodes + header->nodeCount);
+
+    // One linear pass so that lookups never have to bounds-check
+    for (quint32 i = 0; i < header->nodeCount; ++i) {
+        if (quint64(nodes[i].firstEdge) + nodes[i].edgeCount > header->edgeCount)
+            return false;
+    }
+    for (quint32 i = 0; i < header->edgeCount; ++i) {
+        if (edges[i].target == 0 || edges[i].target >= header->nodeCount)
+            return false;
+    }
+
+    m_header = header;
+    m_nodes  = nodes;
+    m_edges  = edges;
+    return true;
+}
+
+int MarathonLexicon::wordCount() const {
+    return m_header ? static_cast<int>(m_header->wordCount) : 0;
+}
+
+int MarathonLexicon::findChild(int node, char16_t label) const {
+    const Edge *begin = m_edges + m_nodes[node].firstEdge;
+    const Edge *end   = begin + m_nodes[node].edgeCount;
+    const Edge *it    = std::lower_bound(
+        begin, end, label, [](const Edge &edge, char16_t value) { return edge.label < value; });
+    return (it != end && it->label == label) ? static_cast<int>(it->target) : -1;
+}
+
+int MarathonLexicon::findNode(const QString &key) const {
+    if (!isValid())
+        return -1;
+
+    int node = 0;
+    for (const QChar ch : key) {
+        node = findChild(node, ch.unicode());
+        if (node < 0)
+            return -1;
+    }
+    return node;
+}
+
+bool MarathonLexicon::contains(const QString &word) const {
+    return frequency(word) > 0;
+}
+
+quint32 MarathonLexicon::frequency(const QString &word) const {
+    if (word.isEmpty())
+        return 0;
+    const int node = findNode(word.toLower());
+    return node < 0 ? 0 : m_nodes[node].frequency;
+}
+
+QStringList MarathonLexicon::complete(const QString &prefix, int maxResults) const {
+    QStringList results;
+    const QString key  = prefix.toLower();
+    const int     root = findNode(key);
+    if (root < 0 || maxResults <= 0)
+        return results;
+
+    const bool capitalize = !prefix.isEmpty() && prefix.at(0).isUpper();
+
+    // Best-first search. A subtree is ranked by the best word inside it, so words
+    // come off the queue in frequency order and each result costs at most one
+    // expansion per level of the trie below the prefix.
+    struct Candidate {
+        quint32 score;
+        int     node;
+        int     path; // index into steps, -1 for the prefix itself
+        bool    word;
+
+        bool    operator<(const Candidate &other) const {
+            if (score != other.score)
+                return score < other.score;
+            if (word != other.word)
+                return !word; // emit a word before expanding an equal subtree
+            return node > other.node; // breadth-first ids: shorter words first
+        }
+    };
+    struct Step {
+        int      parent;
+        char16_t label;
+    };
+
+    std::vector<Step>              steps;
+    std::priority_queue<Candidate> queue;
+    queue.push({m_nodes[root].bestFrequency, root, -1, false});
+
+    while (!queue.empty() && results.size() < maxResults) {
+        const Candidate candidate = queue.top();
+        queue.pop();
+
+        const Node &node = m_nodes[candidate.node];
+        if (candidate.word) {
+            QString suffix;
+            for (int i = candidate.path; i >= 0; i = steps[i].parent)
+                suffix.prepend(QChar(steps[i].label));
+            results.append(applyCase(key + suffix, node.flags | (capitalize ? Capitalized : 0)));
+            continue;
+        }
+
+        if (node.frequency > 0)
+            queue.push({node.frequency, candidate.node, candidate.path, true});
+        for (quint32 i = node.firstEdge; i < node.firstEdge + node.edgeCount; ++i) {
+            const Edge &edge = m_edges[i];
+            steps.push_back({candidate.path, edge.label});
+            queue.push({m_nodes[edge.target].bestFrequency, static_cast<int>(edge.target),
+                        static_cast<int>(steps.size()) - 1, false});
+        }
+    }
+
+    return results;
+}
+
+QByteArray MarathonLexicon::build(const QList<Entry> &entries) {
+    struct BuildNode {
+        std::map<char16_t, int> children;
+        quint32                 frequency = 0;
+        quint16                 flags     = 0;
+    };
+
+    std::vector<BuildNode> trie(1);
+    quint32                wordCount = 0;
+
+    for (const Entry &entry : entries) {
+        const QString key = entry.word.trimmed().toLower();
+        if (key.isEmpty())
+            continue;
+
+        int node = 0;
+        for (const QChar ch : key) {
+            auto it = trie[node].children.find(ch.unicode());
+            if (it == trie[node].children.end()) {
+                trie.emplace_back();
+                it = trie[node].children.emplace(ch.unicode(), int(trie.size()) - 1).first;
+            }
+            node = it->second;
+        }
+
+        const quint32 frequency = std::max<quint32>(entry.frequency, 1);
+        if (trie[node].frequency == 0)
+            ++wordCount;
+        if (frequency > trie[node].frequency) {
+            trie[node].frequency = frequency;
+            trie[node].flags     = caseFlags(entry.word.trimmed());
+        }
+    }
+
+    // Lay nodes out breadth-first so every node's edges are contiguous
+    std::vector<int>  order{0};
+    std::vector<int>  newId(trie.size());
+    std::vector<Node> nodes;
+    std::vector<Edge> edges;
+    nodes.reserve(trie.size());
+    edges.reserve(trie.size() - 1);
+
+    for (size_t i = 0; i < order.size(); ++i) {
+        const BuildNode &source = trie[order[i]];
+        Node             node{};
+        node.firstEdge = static_cast<quint32>(edges.size());
+        node.edgeCount = static_cast<quint16>(source.children.size());
+        node.frequency = source.frequency;
+        node.flags     = source.flags;
+        for (const auto &[label, child] : source.children) {
+            newId[child] = static_cast<int>(order.size());
+            order.push_back(child);
+            edges.push_back({static_cast<quint32>(newId[child]), label, 0});
+        }
+        nodes.push_back(node);
+    }
+
+    // Children always come after their parent, so a reverse pass sees them first
+    for (size_t i = nodes.size(); i-- > 0;) {
+        quint32 best = nodes[i].frequency;
+        for (quint32 e = nodes[i].firstEdge; e < nodes[i].firstEdge + nodes[i].edgeCount; ++e)
+            best = std::max(best, nodes[edges[e].target].bestFrequency);
+        nodes[i].bestFrequency = best;
+    }
+
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version   = Version;
+    header.nodeCount = static_cast<quint32>(nodes.size());
+    header.edgeCount = static_cast<quint32>(edges.size());
+    header.wordCount = wordCount;
+
+    QByteArray image;
+    image.reserve(int(sizeof(Header) + nodes.size() * sizeof(Node) + edges.size() * sizeof(Edge)));
+    image.append(reinterpret_cast<const char *>(&header), sizeof(Header));
+    image.append(reinterpret_cast<const char *>(nodes.data()),
+                 qsizetype(nodes.size() * sizeof(Node)));
+    image.append(reinterpret_cast<const char *>(edges.data()),
+                 qsizetype(edges.size() * sizeof(Edge)));
+    return image;
+}
+
+QList<MarathonLexicon::Entry> MarathonLexicon::readWordList(QIODevice *device) {
+    QList<Entry> entries;
+
+    while (!device->atEnd()) {
+        QString   line    = QString::fromUtf8(device->readLine());
+        const int comment = line.indexOf('#');
+        if (comment >= 0)
+            line.truncate(comment);
+
+        const QStringList fields = line.simplified().split(' ', Qt::SkipEmptyParts);
+        if (fields.isEmpty())
+            continue;
+
+        QString   word    = fields.at(0);
+        const int affixes = word.indexOf('/');
+        if (affixes >= 0)
+            word.truncate(affixes);
+
+        bool isNumber = false;
+        word.toUInt(&isNumber);
+        if (word.isEmpty() || isNumber)
+            continue; // Hunspell word count, or not a word at all
+
+        bool    ok        = false;
+        quint32 frequency = fields.size() > 1 ? fields.at(1).toUInt(&ok) : 0;
+        entries.append({word, ok ? frequency : 1});
+    }
+
+    return entries;
+}
+
+QString MarathonLexicon::locate(const QString &language) {
+    const QString name = "marathon-keyboard/dictionaries/" + language;
+
+    // Newest installed lexicon; on a tie ~/.local/share wins over the system data dirs
+    QString   path;
+    QDateTime modified;
+    for (const QString &candidate :
+         QStandardPaths::locateAll(QStandardPaths::GenericDataLocation, name + ".lex")) {
+        const QDateTime candidateModified = QFileInfo(candidate).lastModified();
+        if (path.isEmpty() || candidateModified > modified) {
+            path     = candidate;
+            modified = candidateModified;
+        }
+    }
+
+    // A word list newer than that was installed for compiling on the device
+    const QString wordList =
+        QStandardPaths::locate(QStandardPaths::GenericDataLocation, name + ".txt");
+    if (!wordList.isEmpty() && (path.isEmpty() || QFileInfo(wordList).lastModified() > modified)) {
+        const QString compiled = compileWordList(wordList, language);
+        if (!compiled.isEmpty())
+            path = compiled;
+    }
+
+    if (path.isEmpty() && language.contains('_'))
+        path = locate(language.section('_', 0, 0));
+    return path;
+}
+
+QString MarathonLexicon::compileWordList(const QString &wordList, const QString &language) {
+    // The cached lexicon carries the word list's mtime, so an upgraded list is compiled again
+    const QString path = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) +
+                         "/marathon-keyboard/dictionaries/" + language + ".lex";
+    const QDateTime stamp = QFileInfo(wordList).lastModified();
+    if (QFileInfo(path).lastModified() == stamp)
+        return path;
+
+    QFile input(wordList);
+    if (!input.open(QIODevice::ReadOnly)) {
+        qWarning() << "[MarathonLexicon] Cannot read" << wordList << input.errorString();
+        return QString();
+    }
+    const QByteArray image = build(readWordList(&input));
+
+    // Written atomically, so the shell and the keyboard may race to compile it
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile output(path);
+    if (!output.open(QIODevice::WriteOnly) || output.write(image) != image.size() ||
+        !output.commit()) {
+        qWarning() << "[MarathonLexicon] Cannot write" << path << output.errorString();
+        return QString();
+    }
+    QFile stamped(path);
+    if (!stamped.open(QIODevice::ReadWrite) ||
+        !stamped.setFileTime(stamp, QFileDevice::FileModificationTime))
+        qWarning() << "[MarathonLexicon] Cannot stamp" << path << stamped.errorString();
+
+    qDebug() << "[MarathonLexicon] Compiled" << wordList << "to" << path;
+    return path;
+}
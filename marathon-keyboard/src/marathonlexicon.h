@@ -0,0 +1,125 @@
+// Marathon Keyboard Lexicon - Compact word list with frequencies
+// Memory-mapped trie used for spell lookups and ranked completions
+#ifndef MARATHONLEXICON_H
+#define MARATHONLEXICON_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+class QIODevice;
+
+/**
+ * @brief Read-only, frequency-ranked word list
+ *
+ * The lexicon is a trie serialized into a single flat image that is mapped
+ * straight from disk, so loading costs one mmap plus a validation pass.
+ * Every node stores the best frequency found in its subtree, which lets
+ * complete() walk the trie best-first and stop as soon as it has enough words.
+ *
+ * Image layout (native byte order, all records 4-byte aligned):
+ *   Header
+ *   Node[nodeCount]   node 0 is the root, children are stored breadth-first
+ *   Edge[edgeCount]   each node's edges are contiguous and sorted by label
+ *
+ * Keys are lower-case UTF-16; the original capitalisation of a word is kept
+ * as node flags and restored in results.
+ *
+ * Lexicons are compiled at build time by tools/marathon-lexicon and installed
+ * to <datadir>/marathon-keyboard/dictionaries/<language>.lex. The shell's
+ * WordEngine and the keyboard's DictionaryLoader map the same file, so the
+ * pages are shared between processes.
+ */
+class MarathonLexicon {
+  public:
+    struct Entry {
+        QString word;
+        quint32 frequency;
+    };
+
+    static constexpr quint32 Version = 1;
+
+    MarathonLexicon();
+    ~MarathonLexicon();
+
+    MarathonLexicon(const MarathonLexicon &)            = delete;
+    MarathonLexicon &operator=(const MarathonLexicon &) = delete;
+
+    /**
+     * @brief Map a compiled lexicon file
+     * @return false if the file is missing or not a valid lexicon image
+     */
+    bool load(const QString &path);
+
+    /**
+     * @brief Use an in-memory lexicon image (as produced by build())
+     */
+    bool loadData(const QByteArray &data);
+
+    void clear();
+    bool isValid() const {
+        return m_nodes != nullptr;
+    }
+    int     wordCount() const;
+
+    bool    contains(const QString &word) const;
+    quint32 frequency(const QString &word) const;
+
+    /**
+     * @brief Most frequent words starting with prefix, best first
+     *
+     * Matching is case-insensitive; results use the word's own capitalisation,
+     * and are capitalised as well if the prefix starts with a capital letter.
+     */
+    QStringList complete(const QString &prefix, int maxResults) const;
+
+    /**
+     * @brief Serialize a word list into a lexicon image
+     *
+     * Duplicate words (ignoring case) keep the highest frequency and the
+     * capitalisation of that spelling. A frequency of 0 is stored as 1.
+     */
+    static QByteArray build(const QList<Entry> &entries);
+
+    /**
+     * @brief Parse a plain-text word list
+     *
+     * One "word [frequency]" per line, '#' starts a comment. Hunspell .dic
+     * files are accepted too: the leading word count and "/FLAGS" suffixes
+     * are skipped, and words without a frequency get 1.
+     */
+    static QList<Entry> readWordList(QIODevice *device);
+
+    /**
+     * @brief Installed lexicon for a language ("en_US", falling back to "en")
+     *
+     * The newest installed .lex is used. Builds that could not compile the
+     * word lists (cross builds without a host marathon-lexicon) install the
+     * .txt lists instead; a list newer than any .lex is compiled into the
+     * cache directory, and again whenever the list changes.
+     *
+     * @return Path of the file, or an empty string if there is none
+     */
+    static QString locate(const QString &language);
+
+  private:
+    static QString compileWordList(const QString &wordList, const QString &language);
+
+    struct Header;
+    struct Node;
+    struct Edge;
+
+    bool            attach(const uchar *data, qint64 size);
+    int             findNode(const QString &key) const;
+    int             findChild(int node, char16_t label) const;
+
+    QFile           m_file;
+    QByteArray      m_data;
+    const Header   *m_header;
+    const Node     *m_nodes;
+    const Edge     *m_edges;
+};
+
+#endif // MARATHONLEXICON_H
@@ -0,0 +1,350 @@
+// Marathon Keyboard User Dictionary - Implementation
+#include "marathonuserdictionary.h"
+#include "marathonlexicon.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QLockFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTimer>
+#include <algorithm>
+#include <cmath>
+#include <sys/stat.h>
+
+namespace {
+    constexpr int    kFlushBatch   = 32;   // pending words that force a write
+    constexpr int    kFlushIdleMs  = 5000; // quiet time before a write
+    constexpr double kHalfLifeSecs = 30 * 24 * 3600.0;
+    constexpr int    kCompactSlack = 256; // journal lines tolerated beyond the word count
+
+    QByteArray journalLine(const QString &spelling, quint32 uses, qint64 lastUsed) {
+        return spelling.toUtf8() + '\t' + QByteArray::number(uses) + '\t' +
+            QByteArray::number(lastUsed) + '\n';
+    }
+
+    quint64 fileId(const QFile &file) {
+        struct stat info;
+        return ::fstat(file.handle(), &info) == 0 ? quint64(info.st_ino) : 0;
+    }
+} // namespace
+
+MarathonUserDictionary::MarathonUserDictionary(const QString &path, QObject *parent)
+    : QObject(parent)
+    , m_path(path)
+    , m_flushTimer(new QTimer(this))
+    , m_watcher(new QFileSystemWatcher(this))
+    , m_journalLines(0)
+    , m_readOffset(0)
+    , m_fileId(0)
+    , m_loaded(false)
+    , m_externalChanges(false) {
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(kFlushIdleMs);
+    connect(m_flushTimer, &QTimer::timeout, this, &MarathonUserDictionary::flush);
+
+    // The directory catches the file being created, or replaced by a compaction
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, this, &MarathonUserDictionary::sync);
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, &MarathonUserDictionary::sync);
+}
+
+MarathonUserDictionary::~MarathonUserDictionary() {
+    flush();
+}
+
+QString MarathonUserDictionary::defaultPath() {
+    return QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) +
+        "/marathon-os/keyboard_user_dictionary.txt";
+}
+
+void MarathonUserDictionary::load() {
+    QMutexLocker locker(&m_mutex);
+    loadLocked();
+}
+
+void MarathonUserDictionary::loadLocked() {
+    if (m_loaded)
+        return;
+    m_loaded = true;
+
+    QDir().mkpath(QFileInfo(m_path).absolutePath());
+    QLockFile lock(m_path + ".lock");
+    if (!lock.lock()) {
+        qWarning() << "[MarathonUserDictionary] Cannot lock" << m_path;
+        return;
+    }
+    readJournal();
+    m_externalChanges = false;
+    watch();
+
+    qDebug() << "[MarathonUserDictionary] Loaded" << m_words.size() << "words from" << m_path;
+}
+
+void MarathonUserDictionary::sync() {
+    bool changed = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_loaded)
+            return;
+
+        QLockFile lock(m_path + ".lock");
+        if (!lock.lock())
+            return;
+        changed           = readJournal() || m_externalChanges;
+        m_externalChanges = false;
+        watch();
+    }
+
+    if (changed)
+        emit changed();
+}
+
+bool MarathonUserDictionary::readJournal() {
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        // Gone: the next write starts a new journal with what is pending
+        m_fileId       = 0;
+        m_readOffset   = 0;
+        m_journalLines = 0;
+        return false;
+    }
+
+    bool          changed = false;
+    const quint64 id      = fileId(file);
+    if (id != m_fileId || file.size() < m_readOffset) {
+        // First read, or another instance compacted: start over from the new file, keeping
+        // only the uses learned here that are not in any file yet
+        QMap<QString, Word> unwritten;
+        for (auto it = m_pending.cbegin(); it != m_pending.cend(); ++it) {
+            Word word = m_words.value(it.key());
+            word.uses = it.value();
+            unwritten.insert(it.key(), word);
+        }
+        m_words        = unwritten;
+        m_fileId       = id;
+        m_readOffset   = 0;
+        m_journalLines = 0;
+        changed        = true;
+    }
+
+    // The old format has no timestamps; treat those words as last used when the file was written
+    const qint64 legacyTimestamp = QFileInfo(file).lastModified().toSecsSinceEpoch();
+
+    file.seek(m_readOffset);
+    while (!file.atEnd()) {
+        const QList<QByteArray> fields = file.readLine().trimmed().split('\t');
+        const QString           spelling = QString::fromUtf8(fields.at(0));
+        if (spelling.isEmpty())
+            continue;
+        ++m_journalLines;
+        changed = true;
+
+        // Old format: one bare word per line, appended on every use
+        if (fields.size() < 3) {
+            Word &word    = m_words[spelling.toLower()];
+            word.spelling = spelling;
+            word.lastUsed = legacyTimestamp;
+            ++word.uses;
+            continue;
+        }
+
+        applyRecord(spelling, fields.at(1).toUInt(), fields.at(2).toLongLong());
+    }
+    m_readOffset = file.pos();
+
+    return changed;
+}
+
+void MarathonUserDictionary::applyRecord(const QString &spelling, quint32 uses, qint64 lastUsed) {
+    // A journal line holds a word's total as of that write; uses learned here since are added
+    const QString key       = spelling.toLower();
+    const quint32 unwritten = m_pending.value(key);
+    Word         &word      = m_words[key];
+
+    if (unwritten == 0 || word.spelling.isEmpty())
+        word.spelling = spelling;
+    word.uses     = uses + unwritten;
+    word.lastUsed = unwritten ? std::max(word.lastUsed, lastUsed) : lastUsed;
+}
+
+void MarathonUserDictionary::watch() {
+    const QString directory = QFileInfo(m_path).absolutePath();
+    if (!m_watcher->directories().contains(directory))
+        m_watcher->addPath(directory);
+    // Dropped by the watcher whenever the file is replaced
+    if (!m_watcher->files().contains(m_path) && QFile::exists(m_path))
+        m_watcher->addPath(m_path);
+}
+
+void MarathonUserDictionary::learn(const QString &word, qint64 timestamp) {
+    const QString key = word.toLower();
+    if (key.isEmpty())
+        return;
+
+    QMutexLocker locker(&m_mutex);
+    // Never write before the journal has been read, or compaction would drop it
+    loadLocked();
+
+    auto it = m_words.find(key);
+    if (it == m_words.end()) {
+        it = m_words.insert(key, {word, 0, 0});
+    } else if (word == key) {
+        // A lower-case spelling wins over one capitalised at a sentence start
+        it->spelling = word;
+    }
+    ++it->uses;
+    it->lastUsed = timestamp ? timestamp : QDateTime::currentSecsSinceEpoch();
+
+    ++m_pending[key];
+    if (m_pending.size() >= kFlushBatch)
+        flushLocked();
+    else
+        QMetaObject::invokeMethod(m_flushTimer, qOverload<>(&QTimer::start));
+}
+
+bool MarathonUserDictionary::contains(const QString &word) const {
+    QMutexLocker locker(&m_mutex);
+    return m_words.contains(word.toLower());
+}
+
+int MarathonUserDictionary::size() const {
+    QMutexLocker locker(&m_mutex);
+    return static_cast<int>(m_words.size());
+}
+
+QStringList MarathonUserDictionary::words() const {
+    QMutexLocker locker(&m_mutex);
+    QStringList  result;
+    result.reserve(m_words.size());
+    for (const Word &word : m_words)
+        result.append(word.spelling);
+    return result;
+}
+
+double MarathonUserDictionary::decayedUses(const Word &word, qint64 now) const {
+    const qint64 age = std::max<qint64>(0, now - word.lastUsed);
+    return word.uses * std::exp2(-age / kHalfLifeSecs);
+}
+
+double MarathonUserDictionary::score(const QString &word) const {
+    QMutexLocker locker(&m_mutex);
+    const auto   it = m_words.constFind(word.toLower());
+    return it == m_words.constEnd() ? 0.0
+                                    : decayedUses(*it, QDateTime::currentSecsSinceEpoch());
+}
+
+QStringList MarathonUserDictionary::complete(const MarathonLexicon &lexicon, const QString &prefix,
+                                             int maxResults) const {
+    struct Candidate {
+        QString word;
+        double  rank;
+    };
+
+    QMutexLocker     locker(&m_mutex);
+    const qint64     now = QDateTime::currentSecsSinceEpoch();
+    const QString    key = prefix.toLower();
+    QList<Candidate> candidates;
+
+    for (const QString &word : lexicon.complete(prefix, maxResults)) {
+        double     rank    = lexicon.frequency(word);
+        const auto learned = m_words.constFind(word.toLower());
+        if (learned != m_words.constEnd())
+            rank += LearnedWeight * decayedUses(*learned, now);
+        candidates.append({word, rank});
+    }
+    const qsizetype fromLexicon = candidates.size();
+
+    // Learned words sharing the prefix are one contiguous range of the map
+    for (auto it = m_words.lowerBound(key); it != m_words.constEnd() && it.key().startsWith(key);
+         ++it) {
+        const auto inLexicon = std::find_if(
+            candidates.cbegin(), candidates.cbegin() + fromLexicon,
+            [&](const Candidate &c) { return c.word.compare(it.key(), Qt::CaseInsensitive) == 0; });
+        if (inLexicon != candidates.cbegin() + fromLexicon)
+            continue;
+
+        QString word = it->spelling;
+        if (!prefix.isEmpty() && prefix.at(0).isUpper())
+            word[0] = word.at(0).toUpper();
+        candidates.append({word, lexicon.frequency(word) + LearnedWeight * decayedUses(*it, now)});
+    }
+
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const Candidate &a, const Candidate &b) { return a.rank > b.rank; });
+
+    QStringList results;
+    for (int i = 0; i < candidates.size() && i < maxResults; ++i)
+        results.append(candidates.at(i).word);
+    return results;
+}
+
+void MarathonUserDictionary::flush() {
+    QMutexLocker locker(&m_mutex);
+    flushLocked();
+}
+
+void MarathonUserDictionary::flushLocked() {
+    QMetaObject::invokeMethod(m_flushTimer, &QTimer::stop);
+    if (m_pending.isEmpty())
+        return;
+
+    QDir().mkpath(QFileInfo(m_path).absolutePath());
+    QLockFile lock(m_path + ".lock");
+    if (!lock.lock()) {
+        qWarning() << "[MarathonUserDictionary] Cannot lock" << m_path;
+        return;
+    }
+
+    // Merge what the other instances wrote first, so the totals written here include it
+    m_externalChanges |= readJournal();
+
+    if (m_journalLines + m_pending.size() > 2 * m_words.size() + kCompactSlack) {
+        compact();
+        return;
+    }
+
+    QFile file(m_path);
+    if (!file.open(QIODevice::Append)) {
+        qWarning() << "[MarathonUserDictionary] Cannot write" << m_path << file.errorString();
+        return;
+    }
+
+    // One write for the whole batch
+    QByteArray batch;
+    for (auto it = m_pending.cbegin(); it != m_pending.cend(); ++it) {
+        const Word &word = m_words[it.key()];
+        batch += journalLine(word.spelling, word.uses, word.lastUsed);
+    }
+    file.write(batch);
+    file.flush();
+
+    // Everything before the batch was just read, so the journal is read up to its end
+    m_fileId        = fileId(file);
+    m_readOffset    = file.size();
+    m_journalLines += m_pending.size();
+    m_pending.clear();
+}
+
+void MarathonUserDictionary::compact() {
+    QSaveFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "[MarathonUserDictionary] Cannot write" << m_path << file.errorString();
+        return;
+    }
+
+    for (const Word &word : std::as_const(m_words))
+        file.write(journalLine(word.spelling, word.uses, word.lastUsed));
+
+    if (!file.commit())
+        return;
+
+    QFile written(m_path);
+    written.open(QIODevice::ReadOnly);
+    m_fileId       = fileId(written);
+    m_readOffset   = written.size();
+    m_journalLines = m_words.size();
+    m_pending.clear();
+}
@@ -0,0 +1,120 @@
+// Marathon Keyboard User Dictionary - Words learned from the user
+// Frequency and recency scored, persisted through an append-only journal
+#ifndef MARATHONUSERDICTIONARY_H
+#define MARATHONUSERDICTIONARY_H
+
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+class QFile;
+class QFileSystemWatcher;
+class QTimer;
+class MarathonLexicon;
+
+/**
+ * @brief Learned-word store shared by WordEngine and MarathonKeyboardIME
+ *
+ * Words are kept in memory, ordered by their lower-case form so a prefix is a
+ * single range scan. learn() never touches the disk: changed words are
+ * appended to the journal file in batches, when typing pauses, and on
+ * destruction. The journal is rewritten once it has grown well past the
+ * number of words it describes.
+ *
+ * A word's score is its use count, halved for every month since it was last
+ * used, so words the user stopped typing fade out of the predictions.
+ *
+ * Several instances (the shell's and the keyboard's, in two processes) may
+ * share one file. Writers take a lock file and first pick up the lines the
+ * others appended, adding the uses learned here on top, so no instance's
+ * words are lost to another's append or compaction. Changes made by other
+ * instances are read in when the file changes on disk.
+ *
+ * Thread-safe; the flush timer and the file watcher run on the thread the
+ * store lives on while owners may read it from another.
+ */
+class MarathonUserDictionary : public QObject {
+    Q_OBJECT
+
+  public:
+    explicit MarathonUserDictionary(const QString &path, QObject *parent = nullptr);
+    ~MarathonUserDictionary() override;
+
+    // ~/.config/marathon-os/keyboard_user_dictionary.txt
+    static QString defaultPath();
+
+    /**
+     * @brief Read the journal; later entries for a word replace earlier ones
+     *
+     * Only the first call reads the file; after that it is followed through
+     * sync(). The old one-word-per-line format is accepted.
+     */
+    void load();
+
+    /**
+     * @brief Record one use of a word (loads the journal first if needed)
+     * @param timestamp Seconds since the epoch, 0 for now
+     */
+    void learn(const QString &word, qint64 timestamp = 0);
+
+    bool        contains(const QString &word) const;
+    int         size() const;
+    QStringList words() const;
+
+    // Decayed use count, 0 for unknown words
+    double score(const QString &word) const;
+
+    /**
+     * @brief Lexicon completions re-ranked with learned words, best first
+     *
+     * Learned words are merged in and each candidate is ranked by its lexicon
+     * frequency plus its learned score scaled by LearnedWeight.
+     */
+    QStringList complete(const MarathonLexicon &lexicon, const QString &prefix,
+                         int maxResults) const;
+
+    // Lexicon frequency units a single recent use is worth
+    static constexpr double LearnedWeight = 1000.0;
+
+  public slots:
+    void flush();
+    // Reads what other instances wrote since the last read (called on file changes)
+    void sync();
+
+  signals:
+    // Words learned by another instance were read in; emitted from sync() only
+    void changed();
+
+  private:
+    struct Word {
+        QString spelling;
+        quint32 uses     = 0;
+        qint64  lastUsed = 0;
+    };
+
+    // Callers hold m_mutex (and the lock file for the journal functions)
+    void                    loadLocked();
+    void                    flushLocked();
+    bool                    readJournal();
+    void                    applyRecord(const QString &spelling, quint32 uses, qint64 lastUsed);
+    void                    compact();
+    void                    watch();
+    double                  decayedUses(const Word &word, qint64 now) const;
+
+    QString                 m_path;
+    QMap<QString, Word>     m_words;   // keyed by lower-case spelling
+    QHash<QString, quint32> m_pending; // uses learned here and not written yet
+    QTimer                 *m_flushTimer;
+    QFileSystemWatcher     *m_watcher;
+    int                     m_journalLines;
+    qint64                  m_readOffset; // journal read up to here
+    quint64                 m_fileId;     // inode, changes when another instance compacts
+    bool                    m_loaded;
+    bool                    m_externalChanges;
+    mutable QMutex          m_mutex;
+};
+
+#endif // MARATHONUSERDICTIONARY_H
@@ -1,6 +1,8 @@
 #include <QApplication>
 #include <QQmlApplicationEngine>
 #include <QQuickStyle>
+#include <QQuickWindow>
+#include <QIcon>
 #include <QDebug>
 #include <QQmlContext>
 #include <QDir>
@@ -21,7 +23,9 @@
 #include "src/desktopfileparser.h"
 #include "src/crashhandler.h"
 #include "src/appmodel.h"
+#include "src/appsearchindex.h"
 #include "src/taskmodel.h"
+#include "src/tasksnapshotprovider.h"
 #include "src/notificationmodel.h"
 #include "src/networkmanagercpp.h"
 #include "src/powermanagercpp.h"
@@ -34,7 +38,9 @@
 #include "src/marathonappregistry.h"
 #include "src/marathonappscanner.h"
 #include "src/marathonapploader.h"
+#include "src/marathonappcompiler.h"
 #include "src/marathonappinstaller.h"
+#include "src/launchhistory.h"
 #include "src/marathonpermissionmanager.h"
 #include "src/marathonappstoreservice.h"
 #include "src/contactsmanager.h"
@@ -47,6 +53,7 @@
 #include "src/marathoninputmethodengine.h"
 #include "src/storagemanager.h"
 #include "src/rtscheduler.h"
+#include "src/frametimingmonitor.h"
 
 #include "src/mpris2controller.h"
 #include "src/rotationmanager.h"
@@ -63,11 +70,13 @@
 #include "src/dbus/notificationdatabase.h"
 #include "src/dbus/marathonstorageservice.h"
 #include "src/dbus/marathonsettingsservice.h"
+#include "src/dbus/marathonperformanceservice.h"
 #include "src/dbus/marathonpermissionportal.h"
 #include <QDBusConnection>
 
 #ifdef HAVE_WAYLAND
 #include "src/waylandcompositor.h"
+#include "src/waylandsurfaceregistry.h"
 #include <QWaylandSurface>
 #include <QWaylandXdgShell>
 #endif
@@ -268,6 +277,8 @@ int main(int argc, char *argv[]) {
                                                    "WaylandXdgSurface cannot be created from QML");
     qmlRegisterUncreatableType<WaylandCompositor>("MarathonOS.Wayland", 1, 0, "WaylandCompositor",
                                                   "WaylandCompositor is created in C++");
+    qmlRegisterUncreatableType<WaylandSurfaceRegistry>(
+        "MarathonOS.Wayland", 1, 0, "WaylandSurfaceRegistry", "Use WaylandCompositor.surfaces");
 
     // CRITICAL: Register pointer types for signal/slot marshalling across C++/QML boundary
     qRegisterMetaType<QWaylandSurface *>("QWaylandSurface*");
@@ -297,6 +308,11 @@ int main(int argc, char *argv[]) {
         new WaylandCompositorManager(settingsManager, &app);
     engine.rootContext()->setContextProperty("WaylandCompositorManager", compositorManager);
 
+    // Frame deadline measurements, attached to the shell window once it is loaded
+    FrameTimingMonitor *frameTiming = new FrameTimingMonitor(&app);
+    compositorManager->setFrameTimingMonitor(frameTiming);
+    engine.rootContext()->setContextProperty("FrameTiming", frameTiming);
+
     // Set debug mode context property
     engine.rootContext()->setContextProperty("MARATHON_DEBUG_ENABLED", debugEnabled);
 
@@ -309,19 +325,30 @@ int main(int argc, char *argv[]) {
 
     // Register DesktopFileParser as a singleton accessible from QML
     DesktopFileParser *desktopFileParser = new DesktopFileParser(&app);
+    desktopFileParser->setIconTheme(QIcon::themeName());
     engine.rootContext()->setContextProperty("DesktopFileParserCpp", desktopFileParser);
 
     // Register Marathon App System
     MarathonAppRegistry  *appRegistry  = new MarathonAppRegistry(&app);
     MarathonAppScanner   *appScanner   = new MarathonAppScanner(appRegistry, &app);
     MarathonAppLoader    *appLoader    = new MarathonAppLoader(appRegistry, &engine, &app);
+    MarathonAppCompiler  *appCompiler  =
+        new MarathonAppCompiler(appRegistry, appLoader->importPaths(), &app);
     MarathonAppInstaller *appInstaller = new MarathonAppInstaller(appRegistry, appScanner, &app);
+    compositorManager->setAppRunnerPool(appLoader->runnerPool());
 
     engine.rootContext()->setContextProperty("MarathonAppRegistry", appRegistry);
     engine.rootContext()->setContextProperty("MarathonAppScanner", appScanner);
     engine.rootContext()->setContextProperty("MarathonAppLoader", appLoader);
     engine.rootContext()->setContextProperty("MarathonAppInstaller", appInstaller);
 
+    // Launch history: ranks apps for predictive preloading and the frequent apps row
+    LaunchHistory *launchHistory = new LaunchHistory(&app);
+    appLoader->setLaunchHistory(launchHistory);
+    QObject::connect(appRegistry, &MarathonAppRegistry::appUnregistered, launchHistory,
+                     &LaunchHistory::forget);
+    engine.rootContext()->setContextProperty("LaunchHistory", launchHistory);
+
     // Register Marathon Input Method Engine
     MarathonInputMethodEngine *inputMethodEngine = new MarathonInputMethodEngine(&app);
     engine.rootContext()->setContextProperty("InputMethodEngine", inputMethodEngine);
@@ -337,7 +364,18 @@ int main(int argc, char *argv[]) {
                                      "NotificationRoles", "Cannot create NotificationRoles enum");
 
     engine.rootContext()->setContextProperty("AppModel", appModel);
+
+    // Search-as-you-type over AppModel and the registry's deep links
+    AppSearchIndex *appSearchIndex = new AppSearchIndex(appModel, appRegistry, &app);
+    appSearchIndex->setIncludeNativeApps(settingsManager->searchNativeApps());
+    QObject::connect(settingsManager, &SettingsManager::searchNativeAppsChanged, appSearchIndex,
+                     [appSearchIndex, settingsManager]() {
+                         appSearchIndex->setIncludeNativeApps(settingsManager->searchNativeApps());
+                     });
+    engine.rootContext()->setContextProperty("AppSearchIndex", appSearchIndex);
     engine.rootContext()->setContextProperty("TaskModel", taskModel);
+    engine.addImageProvider(TaskSnapshotProvider::kProviderId,
+                            new TaskSnapshotProvider(taskModel->snapshotCache()));
     engine.rootContext()->setContextProperty("NotificationModel", notificationModel);
 
     // Register C++ services (SettingsManager already created above for compositor)
@@ -466,7 +504,14 @@ int main(int argc, char *argv[]) {
             qInfo() << "[MarathonShell]   ✓ SettingsService registered";
         }
 
-        qInfo() << "[MarathonShell] Service bus ready (6 services active)";
+        // Register PerformanceService
+        MarathonPerformanceService *performanceService =
+            new MarathonPerformanceService(frameTiming, &app);
+        if (performanceService->registerService()) {
+            qInfo() << "[MarathonShell]   ✓ PerformanceService registered";
+        }
+
+        qInfo() << "[MarathonShell] Service bus ready (7 services active)";
     }
 
     // Register Permission Manager
@@ -587,25 +632,50 @@ int main(int argc, char *argv[]) {
     bool filterMobile = settingsManager->filterMobileFriendlyApps();
     qDebug() << "[Marathon] Filter mobile-friendly apps:" << filterMobile;
 
-    QVariantList nativeApps = desktopFileParser->scanApplications(searchPaths, filterMobile);
-    qDebug() << "[Marathon] Found" << nativeApps.count() << "native apps";
-    for (const QVariant &appVariant : nativeApps) {
-        QVariantMap app = appVariant.toMap();
-        appModel->addApp(app["id"].toString(), app["name"].toString(), app["icon"].toString(),
-                         app["type"].toString(), app["exec"].toString());
-        qDebug() << "[Marathon] Added app:" << app["name"].toString() << "(" << app["id"].toString()
-                 << ") exec:" << app["exec"].toString();
-    }
-
-    // Scan for Marathon apps
+    // Parsed on worker threads: the launcher gets cached apps right away and the rest in
+    // batches as they are parsed, instead of main() blocking on every .desktop file
+    QObject::connect(desktopFileParser, &DesktopFileParser::applicationsFound, appModel,
+                     &AppModel::addApps);
+    QObject::connect(desktopFileParser, &DesktopFileParser::scanFinished, appModel,
+                     [appModel](int count) {
+                         qDebug() << "[Marathon] Found" << count << "native apps";
+                         appModel->sortAppsByName();
+                     });
+    desktopFileParser->scanApplicationsAsync(searchPaths, filterMobile);
+
+    // Packages installed or removed later only touch their own rows
+    QObject::connect(desktopFileParser, &DesktopFileParser::applicationsChanged, appModel,
+                     [appModel](const QVariantList &apps, const QStringList &removedIds) {
+                         appModel->updateApps(apps);
+                         for (const QString &id : removedIds)
+                             appModel->removeApp(id);
+                     });
+    desktopFileParser->watchDirectories(searchPaths, filterMobile);
+
+    // Scan for Marathon apps; manifests are read on a worker thread and the registry is
+    // swapped in on this one, then the apps are loaded into AppModel
+    QObject::connect(appScanner, &MarathonAppScanner::scanComplete, appModel,
+                     [appModel, appRegistry]() {
+                         appModel->loadFromRegistry(appRegistry);
+                         appModel->sortAppsByName();
+                     });
+    // Installs, updates and removals after that are applied one app at a time
+    QObject::connect(appScanner, &MarathonAppScanner::appChanged, appModel,
+                     [appModel, appRegistry](const QString &appId) {
+                         appModel->loadAppFromRegistry(appRegistry, appId);
+                     });
+    QObject::connect(appScanner, &MarathonAppScanner::appRemoved, appModel,
+                     [appModel, appRegistry](const QString &appId) {
+                         appModel->loadAppFromRegistry(appRegistry, appId);
+                     });
+    // Fill the QML disk cache for new and updated apps before they are first launched
+    QObject::connect(appScanner, &MarathonAppScanner::scanComplete, appCompiler,
+                     &MarathonAppCompiler::compileAll);
+    QObject::connect(appScanner, &MarathonAppScanner::appChanged, appCompiler,
+                     &MarathonAppCompiler::compileApp);
     qDebug() << "Scanning for Marathon apps...";
-    appScanner->scanApplications();
-
-    // Load apps from registry into AppModel
-    appModel->loadFromRegistry(appRegistry);
-
-    // Sort all apps alphabetically after loading both native and Marathon apps
-    appModel->sortAppsByName();
+    appScanner->startWatching();
+    appScanner->scanApplicationsAsync();
 
     // Add QML import paths for modules
     engine.addImportPath("qrc:/");
@@ -725,6 +795,8 @@ int main(int argc, char *argv[]) {
         return -1;
     }
 
+    frameTiming->attach(qobject_cast<QQuickWindow *>(engine.rootObjects().first()));
+
     qDebug() << "Marathon OS Shell started";
     return app.exec();
 }
@@ -1332,6 +1332,10 @@ Item {
         }
     }
 
+    FrameTimingOverlay {
+        id: frameTimingOverlay
+    }
+
     ConfirmDialog {
         id: confirmDialog
 
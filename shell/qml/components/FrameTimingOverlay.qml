@@ -0,0 +1,122 @@
+import QtQuick
+import MarathonOS.Shell
+import MarathonUI.Core
+import MarathonUI.Theme
+
+/**
+ * Frame timing readout for measuring the shell on real devices
+ *
+ * Shows FrameTimingMonitor's last-second summary and a bar per recent frame
+ * (frame time against the refresh budget). Only visible while frame timing
+ * is enabled, via MARATHON_FRAME_TIMING=1 or org.marathon.PerformanceService.
+ * Takes no input, so it can stay up while using the shell.
+ */
+Item {
+    id: overlay
+    anchors.fill: parent
+    z: 3000
+    enabled: false
+    visible: typeof FrameTiming !== 'undefined' && FrameTiming !== null && FrameTiming.enabled
+
+    readonly property int graphFrames: 60
+    readonly property real budgetMs: FrameTiming.refreshIntervalMs > 0 ? FrameTiming.refreshIntervalMs : 1000 / 60
+    property var frameTimes: []
+
+    Connections {
+        target: overlay.visible ? FrameTiming : null
+        function onStatsChanged() {
+            overlay.frameTimes = FrameTiming.frameTimes(overlay.graphFrames);
+        }
+    }
+
+    function latencyText(ms) {
+        return ms > 0 ? ms.toFixed(1) + " ms" : "–";
+    }
+
+    Rectangle {
+        id: panel
+        anchors.top: parent.top
+        anchors.right: parent.right
+        anchors.topMargin: Constants.statusBarHeight + Constants.spacingSmall
+        anchors.rightMargin: Constants.spacingSmall
+        width: 220
+        height: content.height + Constants.spacingSmall * 2
+        radius: Constants.borderRadiusSharp
+        color: Qt.rgba(0, 0, 0, 0.7)
+
+        Column {
+            id: content
+            anchors.left: parent.left
+            anchors.right: parent.right
+            anchors.top: parent.top
+            anchors.margins: Constants.spacingSmall
+            spacing: 2
+
+            Text {
+                text: FrameTiming.fps.toFixed(0) + " fps  " + FrameTiming.frameTimeMs.toFixed(1) + " / " + FrameTiming.frameTimeP95Ms.toFixed(1) + " ms (p95)"
+                color: FrameTiming.droppedFrames > 0 ? MColors.warning : MColors.textPrimary
+                font.pixelSize: MTypography.sizeXSmall
+                font.family: MTypography.fontFamilyMono
+            }
+
+            Text {
+                text: "dropped " + FrameTiming.droppedFrames + "/s"
+                color: FrameTiming.droppedFrames > 0 ? MColors.error : MColors.textSecondary
+                font.pixelSize: MTypography.sizeXSmall
+                font.family: MTypography.fontFamilyMono
+            }
+
+            Text {
+                text: "commit→present " + overlay.latencyText(FrameTiming.commitLatencyMs)
+                color: MColors.textSecondary
+                font.pixelSize: MTypography.sizeXSmall
+                font.family: MTypography.fontFamilyMono
+            }
+
+            Text {
+                text: "callback→present " + overlay.latencyText(FrameTiming.callbackLatencyMs)
+                color: MColors.textSecondary
+                font.pixelSize: MTypography.sizeXSmall
+                font.family: MTypography.fontFamilyMono
+            }
+
+            Text {
+                text: "input→present " + overlay.latencyText(FrameTiming.inputLatencyMs)
+                color: MColors.textSecondary
+                font.pixelSize: MTypography.sizeXSmall
+                font.family: MTypography.fontFamilyMono
+            }
+
+            // One bar per frame, full height at twice the budget; the line marks the budget
+            Item {
+                width: parent.width
+                height: 40
+
+                Row {
+                    anchors.bottom: parent.bottom
+                    height: parent.height
+                    spacing: 1
+
+                    Repeater {
+                        model: overlay.frameTimes
+
+                        Rectangle {
+                            anchors.bottom: parent.bottom
+                            width: Math.max(1, (content.width - overlay.graphFrames) / overlay.graphFrames)
+                            height: Math.min(1, modelData / (overlay.budgetMs * 2)) * parent.height
+                            color: modelData > overlay.budgetMs * 1.5 ? MColors.error : modelData > overlay.budgetMs ? MColors.warning : MColors.success
+                        }
+                    }
+                }
+
+                Rectangle {
+                    anchors.left: parent.left
+                    anchors.right: parent.right
+                    y: parent.height / 2
+                    height: 1
+                    color: Qt.rgba(1, 1, 1, 0.3)
+                }
+            }
+        }
+    }
+}
@@ -226,6 +226,11 @@ Rectangle {
                         AppLifecycleManager.registerApp(id, existingInstance);
                     }
 
+                    // Suspended while in the background; restarts its timers and animations
+                    if (typeof MarathonAppLoader !== 'undefined' && MarathonAppLoader !== null) {
+                        MarathonAppLoader.resumeApp(id);
+                    }
+
                     existingInstance.visible = true;
                     appWindow.pendingAppInstance = existingInstance;
                     // FORCE reload by clearing first
@@ -450,6 +455,15 @@ Rectangle {
             }
         }
 
+        function onAppProcessStarted(appId) {
+            if (appId === appWindow.appId) {
+                // Runs in its own process; its window arrives through the compositor
+                Logger.info("AppWindow", "App started in its own process: " + appId);
+                appWindow.isLoadingComponent = false;
+                appWindow.hide();
+            }
+        }
+
         function onLoadError(appId, error) {
             if (appId === appWindow.appId) {
                 Logger.error("AppWindow", "Received loadError signal for: " + appId + " - " + error);
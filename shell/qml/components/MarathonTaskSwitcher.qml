@@ -680,6 +680,22 @@ Item {
                                             }
                                         }
 
+                                        // Last snapshot taken when the app went to the background,
+                                        // already downscaled and cached by TaskModel's image provider.
+                                        // Shows until (and underneath) the live preview.
+                                        Image {
+                                            id: cachedSnapshot
+                                            anchors.top: parent.top
+                                            anchors.horizontalCenter: parent.horizontalCenter
+                                            width: parent.width
+                                            height: (Constants.screenHeight / Constants.screenWidth) * width
+                                            source: model.snapshot || ""
+                                            visible: model.type !== "native" && status === Image.Ready
+                                            asynchronous: true
+                                            fillMode: Image.PreserveAspectCrop
+                                            sourceSize.width: width
+                                        }
+
                                         // Live preview using ShaderEffectSource with forced updates
                                         ShaderEffectSource {
                                             id: liveSnapshot
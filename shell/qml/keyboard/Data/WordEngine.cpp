@@ -36,10 +36,9 @@ class Hunspell {
 
 #include <QDebug>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFile>
-#include <QTextStream>
 #include <QStringConverter>
-#include <QStandardPaths>
 #include <QMutexLocker>
 
 // ======================
@@ -83,6 +82,9 @@ void WordEngine::initializeWorker() {
     m_worker = new WordEngineWorker();
     m_worker->moveToThread(m_workerThread);
 
+    // Delete the worker in its own thread so the user dictionary flushes there
+    connect(m_workerThread, &QThread::finished, m_worker, &QObject::deleteLater);
+
     // Connect signals
     connect(m_worker, &WordEngineWorker::predictionsReady, this, &WordEngine::predictionsReady);
     connect(m_worker, &WordEngineWorker::errorOccurred, this, &WordEngine::errorOccurred);
@@ -148,6 +150,9 @@ bool WordEngine::spell(const QString &word) {
 }
 
 void WordEngine::requestPredictions(const QString &prefix, int maxResults) {
+    // Supersedes anything still queued on the worker
+    const quint64 generation = m_worker->beginRequest();
+
     if (!d->enabled || prefix.isEmpty()) {
         emit predictionsReady(prefix, QStringList());
         return;
@@ -155,7 +160,8 @@ void WordEngine::requestPredictions(const QString &prefix, int maxResults) {
 
     // Invoke worker asynchronously
     QMetaObject::invokeMethod(m_worker, "computePredictions", Qt::QueuedConnection,
-                              Q_ARG(QString, prefix), Q_ARG(int, maxResults));
+                              Q_ARG(QString, prefix), Q_ARG(int, maxResults),
+                              Q_ARG(quint64, generation));
 }
 
 void WordEngine::learnWord(const QString &word) {
@@ -194,14 +200,28 @@ QString WordEngine::dictionaryPath() {
 // WordEngineWorker
 // ======================
 
+namespace {
+    // Candidates kept per cached prefix. Larger than any prediction bar, so the
+    // next few keystrokes can usually be answered by narrowing this set.
+    constexpr int kCandidateSetSize = 16;
+    constexpr int kCachedPrefixes   = 64;
+} // namespace
+
 WordEngineWorker::WordEngineWorker(QObject *parent)
     : QObject(parent)
     , m_hunspell(nullptr)
     , m_encoding("UTF-8")
-    , m_language("en_US") {
-    m_userDictionaryPath = QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) +
-        "/marathon-os/keyboard_user_dictionary.txt";
-    qDebug() << "[WordEngineWorker] User dictionary:" << m_userDictionaryPath;
+    , m_userDictionary(new MarathonUserDictionary(MarathonUserDictionary::defaultPath(), this))
+    , m_language("en_US")
+    , m_latestRequest(0)
+    , m_candidateCache(kCachedPrefixes) {
+    qDebug() << "[WordEngineWorker] User dictionary:" << MarathonUserDictionary::defaultPath();
+
+    // The keyboard process learns into the same file; cached candidates may now rank differently
+    connect(m_userDictionary, &MarathonUserDictionary::changed, this, [this]() {
+        QMutexLocker locker(&m_mutex);
+        m_candidateCache.clear();
+    });
 }
 
 WordEngineWorker::~WordEngineWorker() {
@@ -210,12 +230,32 @@ WordEngineWorker::~WordEngineWorker() {
     m_hunspell = nullptr;
 }
 
+quint64 WordEngineWorker::beginRequest() {
+    return m_latestRequest.fetchAndAddOrdered(1) + 1;
+}
+
 void WordEngineWorker::setLanguage(const QString &language) {
     QMutexLocker locker(&m_mutex);
+    m_candidateCache.clear();
 
     qDebug() << "[WordEngineWorker] Setting language to:" << language;
     m_language = language;
 
+    // Prefer the prebuilt lexicon: mapping it is near-instant and the pages are
+    // shared with the keyboard process, unlike a Hunspell instance
+    QElapsedTimer timer;
+    timer.start();
+    m_userDictionary->load();
+    const QString lexiconPath = MarathonLexicon::locate(language);
+    if (!lexiconPath.isEmpty() && m_lexicon.load(lexiconPath)) {
+        delete m_hunspell;
+        m_hunspell = nullptr;
+        qDebug() << "[WordEngineWorker] Mapped lexicon" << lexiconPath << "("
+                 << m_lexicon.wordCount() << "words) in" << timer.elapsed() << "ms";
+        return;
+    }
+    m_lexicon.clear();
+
     if (!loadDictionary(language)) {
         emit errorOccurred(QString("Failed to load dictionary for %1").arg(language));
     } else {
@@ -289,74 +329,91 @@ void WordEngineWorker::loadUserDictionary() {
     if (!m_hunspell)
         return;
 
-    QFile file(m_userDictionaryPath);
-    if (!file.exists() || !file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        return;
-    }
-
-    QTextStream stream(&file);
-    int         count = 0;
-    while (!stream.atEnd()) {
-        QString word = stream.readLine().trimmed();
-        if (!word.isEmpty()) {
-            m_hunspell->add(word.toStdString());
-            count++;
-        }
-    }
+    const QStringList words = m_userDictionary->words();
+    for (const QString &word : words)
+        m_hunspell->add(word.toStdString());
 
-    qDebug() << "[WordEngineWorker] Loaded" << count << "words from user dictionary";
+    qDebug() << "[WordEngineWorker] Loaded" << words.size() << "words from user dictionary";
 }
 
-void WordEngineWorker::computePredictions(const QString &prefix, int maxResults) {
+void WordEngineWorker::computePredictions(const QString &prefix, int maxResults,
+                                          quint64 generation) {
+    // A newer request was made while this one sat in the queue; its result
+    // would be out of date by the time it arrived
+    if (generation != m_latestRequest.loadAcquire())
+        return;
+
     QMutexLocker locker(&m_mutex);
 
-    if (!m_hunspell || prefix.isEmpty()) {
+    if (prefix.isEmpty()) {
         emit predictionsReady(prefix, QStringList());
         return;
     }
 
-    // Get suggestions from Hunspell
-    auto suggestions = m_hunspell->suggest(prefix.toStdString());
+    QStringList results = candidates(prefix.toLower(), maxResults).mid(0, maxResults);
+
+    // Normalize case to match user input (Maliit behavior)
+    if (prefix[0].isUpper()) {
+        for (QString &word : results)
+            word[0] = word[0].toUpper();
+    }
+
+    emit predictionsReady(prefix, results);
+}
 
-    // Determine if prefix is lowercase for case normalization
-    bool        isLowercase = prefix[0].isLower();
+QStringList WordEngineWorker::candidates(const QString &key, int maxResults) {
+    // Narrow the longest cached prefix of key. Sets are ranked, so the words of
+    // a set that still match are also the best matches for the longer key.
+    for (qsizetype length = key.size(); length > 0; --length) {
+        const CandidateSet *cached = m_candidateCache.object(key.left(length));
+        if (!cached)
+            continue;
+
+        QStringList words;
+        for (const QString &word : cached->words) {
+            if (word.startsWith(key, Qt::CaseInsensitive))
+                words.append(word);
+        }
 
-    QStringList results;
-    for (const auto &s : suggestions) {
-        if (results.size() >= maxResults)
+        // Too few left to fill the bar, and there may be more words we never kept
+        if (!cached->complete && words.size() < maxResults)
             break;
 
-        QString word = QString::fromStdString(s);
-        // Only include words that start with the prefix
-        if (word.toLower().startsWith(prefix.toLower())) {
-            // Normalize case to match user input (Maliit behavior)
-            if (isLowercase) {
-                word = word.toLower();
-            }
-            results.append(word);
+        if (length < key.size())
+            m_candidateCache.insert(key, new CandidateSet{words, cached->complete});
+        return words;
+    }
+
+    CandidateSet *set = new CandidateSet{QStringList(), false};
+    if (m_hunspell) {
+        // Get suggestions from Hunspell (learned words were added to it)
+        for (const auto &s : m_hunspell->suggest(key.toStdString())) {
+            QString word = QString::fromStdString(s).toLower();
+            // Only include words that start with the prefix
+            if (word.startsWith(key) && !set->words.contains(word))
+                set->words.append(word);
         }
+    } else {
+        // Lexicon ranked together with the words the user has taught us
+        set->words    = m_userDictionary->complete(m_lexicon, key, kCandidateSetSize);
+        set->complete = set->words.size() < kCandidateSetSize;
     }
 
-    emit predictionsReady(prefix, results);
+    const QStringList words = set->words;
+    m_candidateCache.insert(key, set);
+    return words;
 }
 
 void WordEngineWorker::addWord(const QString &word) {
     QMutexLocker locker(&m_mutex);
 
-    if (!m_hunspell || word.length() < 2)
+    if (word.length() < 2)
         return;
 
-    // Add to Hunspell
-    m_hunspell->add(word.toStdString());
-
-    // Save to user dictionary
-    QFile file(m_userDictionaryPath);
-    QDir().mkpath(QFileInfo(file).absolutePath());
+    // In memory only; the store writes its journal in batches
+    m_userDictionary->learn(word);
 
-    if (file.open(QIODevice::Append | QIODevice::Text)) {
-        QTextStream stream(&file);
-        stream << word << '\n';
-        stream.flush();
-        qDebug() << "[WordEngineWorker] Added word to user dictionary:" << word;
-    }
+    if (m_hunspell)
+        m_hunspell->add(word.toStdString());
+    m_candidateCache.clear();
 }
@@ -9,12 +9,17 @@
 #ifndef MARATHON_WORDENGINE_H
 #define MARATHON_WORDENGINE_H
 
+#include <QAtomicInteger>
+#include <QCache>
 #include <QObject>
 #include <QString>
 #include <QStringList>
 #include <QThread>
 #include <QMutex>
 
+#include "marathonlexicon.h"
+#include "marathonuserdictionary.h"
+
 class Hunspell;
 class QTextCodec;
 class WordEngineWorker;
@@ -22,7 +27,9 @@ class WordEngineWorker;
 /**
  * @brief Main word engine for spell-checking and predictions
  * 
- * Thread-safe wrapper around Hunspell for the Marathon keyboard.
+ * Predictions come from the compiled keyboard lexicon (see MarathonLexicon),
+ * which is memory-mapped, so switching languages costs a single mmap. Hunspell
+ * is only loaded for languages without a lexicon.
  * Predictions run on a background thread to avoid blocking the UI.
  */
 class WordEngine : public QObject {
@@ -70,6 +77,11 @@ class WordEngine : public QObject {
 
 /**
  * @brief Background worker for async predictions
+ *
+ * Every request carries a generation number. Requests that were superseded
+ * while waiting in the queue are dropped without running, so fast typing
+ * never builds a backlog. Candidate sets are cached per prefix; typing
+ * forward narrows a cached set instead of searching again.
  */
 class WordEngineWorker : public QObject {
     Q_OBJECT
@@ -78,9 +90,12 @@ class WordEngineWorker : public QObject {
     explicit WordEngineWorker(QObject *parent = nullptr);
     ~WordEngineWorker() override;
 
+    // Called from the GUI thread; returns the generation for a new request
+    quint64 beginRequest();
+
   public slots:
     void setLanguage(const QString &language);
-    void computePredictions(const QString &prefix, int maxResults);
+    void computePredictions(const QString &prefix, int maxResults, quint64 generation);
     void addWord(const QString &word);
 
   signals:
@@ -88,15 +103,24 @@ class WordEngineWorker : public QObject {
     void errorOccurred(QString message);
 
   private:
-    Hunspell *m_hunspell;
-    QString   m_encoding; // Dictionary encoding (usually "UTF-8")
-    QString   m_userDictionaryPath;
-    QString   m_language;
-    QMutex    m_mutex;
-
-    bool      loadDictionary(const QString &language);
-    void      loadUserDictionary();
-    QString   findDictionaryPath(const QString &language);
+    struct CandidateSet {
+        QStringList words;    // best first
+        bool        complete; // holds every known word with this prefix
+    };
+
+    MarathonLexicon               m_lexicon;
+    Hunspell                     *m_hunspell;
+    QString                       m_encoding; // Dictionary encoding (usually "UTF-8")
+    MarathonUserDictionary       *m_userDictionary;
+    QString                       m_language;
+    QMutex                        m_mutex;
+    QAtomicInteger<quint64>       m_latestRequest;
+    QCache<QString, CandidateSet> m_candidateCache;
+
+    bool                          loadDictionary(const QString &language);
+    void                          loadUserDictionary();
+    QString                       findDictionaryPath(const QString &language);
+    QStringList                   candidates(const QString &key, int maxResults);
 };
 
 #endif // MARATHON_WORDENGINE_H
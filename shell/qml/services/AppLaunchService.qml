@@ -87,6 +87,11 @@ QtObject {
         launchingApps[app.id] = true;
         root.appLaunchStarted(app.id, app.name);
 
+        // Feeds the frequent apps ranking and predictive preloading
+        if (typeof LaunchHistory !== 'undefined') {
+            LaunchHistory.recordLaunch(app.id);
+        }
+
         if (app.type === "native") {
             return launchNativeApp(app, comp, win);
         } else {
@@ -50,6 +50,12 @@ QtObject {
      */
     property var appStates: ({})
 
+    /**
+     * @brief Width task switcher snapshots are grabbed at, in pixels
+     * @type {int}
+     */
+    property int snapshotWidth: 360
+
     /**
      * @brief Registers an app instance with the lifecycle manager
      *
@@ -160,12 +166,14 @@ QtObject {
                 var previousApp = appRegistry[foregroundApp.appId];
                 previousApp.pause();
                 previousApp.stop();  // No longer visible
+                suspendInBackground(foregroundApp.appId);
             }
         }
 
         // Resume/start new foreground app
         if (appRegistry[appId]) {
             var app = appRegistry[appId];
+            resumeInstance(appId);
             app.start();   // Becomes visible
             app.resume();  // Becomes active
 
@@ -294,6 +302,7 @@ QtObject {
         if (appRegistry[appId]) {
             appRegistry[appId].minimize();
             appRegistry[appId].stop();
+            suspendInBackground(appId);
 
             if (appStates[appId]) {
                 appStates[appId].isMinimized = true;
@@ -358,6 +367,69 @@ QtObject {
         }
     }
 
+    /**
+     * Freeze a backgrounded Marathon app's timers and animations
+     * Native apps and apps in their own process are not in the loader's pool
+     */
+    function suspendInstance(appId) {
+        if (typeof MarathonAppLoader !== 'undefined' && MarathonAppLoader !== null) {
+            MarathonAppLoader.suspendApp(appId);
+        }
+    }
+
+    /**
+     * Snapshot a backgrounded app for the task switcher, then suspend it
+     * The grab is rendered at card size on the GPU and has to happen before the
+     * instance is hidden; if the app came back meanwhile it is left running
+     */
+    function suspendInBackground(appId) {
+        var app = appRegistry[appId];
+        var suspendUnlessForeground = function () {
+            if (!foregroundApp || foregroundApp.appId !== appId) {
+                suspendInstance(appId);
+            }
+        };
+
+        if (!app || typeof TaskModel === 'undefined' || !app.grabToImage || app.width <= 0 || app.height <= 0) {
+            suspendInstance(appId);
+            return;
+        }
+
+        var scale = Math.min(1, snapshotWidth / app.width);
+        var grabbing = app.grabToImage(function (result) {
+            TaskModel.updateTaskSnapshot(appId, result.image);
+            suspendUnlessForeground();
+        }, Qt.size(Math.round(app.width * scale), Math.round(app.height * scale)));
+
+        if (!grabbing) {
+            Logger.warn("AppLifecycle", "Snapshot grab failed for: " + appId);
+            suspendInstance(appId);
+        }
+    }
+
+    /**
+     * Undo suspendInstance() before the app is shown again
+     */
+    function resumeInstance(appId) {
+        if (typeof MarathonAppLoader !== 'undefined' && MarathonAppLoader !== null) {
+            MarathonAppLoader.resumeApp(appId);
+        }
+    }
+
+    /**
+     * A suspended app was dropped to stay within the pool's size or free memory;
+     * close it like the user would, so its task goes away too
+     */
+    property Connections loaderConnections: Connections {
+        target: typeof MarathonAppLoader !== 'undefined' ? MarathonAppLoader : null
+        ignoreUnknownSignals: true
+
+        function onAppEvicted(appId) {
+            Logger.info("AppLifecycle", "Suspended app evicted: " + appId);
+            lifecycleManager.closeApp(appId);
+        }
+    }
+
     /**
      * Get app state
      */
@@ -1,6 +1,7 @@
 #include "appmodel.h"
 #include "marathonappregistry.h"
 #include <QDebug>
+#include <QSet>
 #include <algorithm>
 
 AppModel::AppModel(QObject *parent)
@@ -52,30 +53,36 @@ App *AppModel::getAppAtIndex(int index) {
     return m_apps.at(index);
 }
 
-void AppModel::addApp(const QString &id, const QString &name, const QString &icon,
-                      const QString &type, const QString &exec) {
-    // Check if app already exists
-    if (m_appIndex.contains(id)) {
-        qDebug() << "[AppModel] App already exists:" << id;
-        return;
-    }
-
+bool AppModel::isValidApp(const QString &id, const QString &name, const QString &icon,
+                          const QString &type) const {
     // Validate inputs
     if (name.isEmpty()) {
         qWarning() << "[AppModel] Invalid app: empty name for ID:" << id;
-        return;
+        return false;
     }
 
     if (icon.isEmpty()) {
         qWarning() << "[AppModel] Invalid app: empty icon for ID:" << id;
-        return;
+        return false;
     }
 
     // Validate type is one of: "native", "marathon", "system"
     if (type != "native" && type != "marathon" && type != "system") {
         qWarning() << "[AppModel] Invalid app type:" << type << "for ID:" << id;
+        return false;
+    }
+
+    return true;
+}
+
+void AppModel::addApp(const QString &id, const QString &name, const QString &icon,
+                      const QString &type, const QString &exec) {
+    if (m_appIndex.contains(id)) {
+        qDebug() << "[AppModel] App already exists:" << id;
         return;
     }
+    if (!isValidApp(id, name, icon, type))
+        return;
 
     beginInsertRows(QModelIndex(), m_apps.count(), m_apps.count());
     App *app = new App(id, name, icon, type, exec, this);
@@ -87,6 +94,92 @@ void AppModel::addApp(const QString &id, const QString &name, const QString &ico
     qDebug() << "[AppModel] Added app:" << name << "(" << type << ")";
 }
 
+// Batch of {id, name, icon, type, exec} maps, e.g. from DesktopFileParser::applicationsFound
+void AppModel::addApps(const QVariantList &apps) {
+    QVector<App *> added;
+    QSet<QString>  addedIds;
+    for (const QVariant &entry : apps) {
+        const QVariantMap app  = entry.toMap();
+        const QString     id   = app.value("id").toString();
+        const QString     name = app.value("name").toString();
+        const QString     icon = app.value("icon").toString();
+        const QString     type = app.value("type").toString();
+        if (addedIds.contains(id) || m_appIndex.contains(id) || !isValidApp(id, name, icon, type))
+            continue;
+
+        added.append(new App(id, name, icon, type, app.value("exec").toString(), this));
+        addedIds.insert(id);
+    }
+
+    if (added.isEmpty())
+        return;
+
+    // One insertion and one countChanged for the whole batch
+    beginInsertRows(QModelIndex(), m_apps.count(), m_apps.count() + added.count() - 1);
+    for (App *app : std::as_const(added)) {
+        m_apps.append(app);
+        m_appIndex.insert(app->id(), app);
+    }
+    endInsertRows();
+
+    emit countChanged();
+    qDebug() << "[AppModel] Added" << added.count() << "apps";
+}
+
+int AppModel::sortedRow(const QString &name) const {
+    const QString key = name.toLower();
+    const auto    it  = std::lower_bound(
+        m_apps.cbegin(), m_apps.cend(), key,
+        [](const App *app, const QString &value) { return app->name().toLower() < value; });
+    return static_cast<int>(it - m_apps.cbegin());
+}
+
+void AppModel::updateApp(const QString &id, const QString &name, const QString &icon,
+                         const QString &type, const QString &exec) {
+    if (!isValidApp(id, name, icon, type))
+        return;
+
+    App *current = m_appIndex.value(id, nullptr);
+    if (!current) {
+        // Keep the name order sortAppsByName() established, without sorting again
+        const int row = sortedRow(name);
+        beginInsertRows(QModelIndex(), row, row);
+        App *app = new App(id, name, icon, type, exec, this);
+        m_apps.insert(row, app);
+        m_appIndex.insert(id, app);
+        endInsertRows();
+
+        emit countChanged();
+        qDebug() << "[AppModel] Added app:" << name << "(" << type << ")";
+        return;
+    }
+
+    if (current->name() == name && current->icon() == icon && current->type() == type &&
+        current->exec() == exec)
+        return;
+
+    // App's properties are constant, so the row gets a new object and keeps its place
+    const int row = static_cast<int>(m_apps.indexOf(current));
+    App      *app = new App(id, name, icon, type, exec, this);
+    m_apps[row]   = app;
+    m_appIndex.insert(id, app);
+    emit dataChanged(index(row), index(row));
+
+    // QML may still hold the old object from getApp()
+    current->deleteLater();
+    qDebug() << "[AppModel] Updated app:" << id;
+}
+
+// Batch of {id, name, icon, type, exec} maps; only new or changed apps touch the model
+void AppModel::updateApps(const QVariantList &apps) {
+    for (const QVariant &entry : apps) {
+        const QVariantMap app = entry.toMap();
+        updateApp(app.value("id").toString(), app.value("name").toString(),
+                  app.value("icon").toString(), app.value("type").toString(),
+                  app.value("exec").toString());
+    }
+}
+
 void AppModel::removeApp(const QString &appId) {
     App *app = m_appIndex.value(appId, nullptr);
     if (!app) {
@@ -133,6 +226,34 @@ bool AppModel::isNativeApp(const QString &appId) {
     return app ? (app->type() == "native") : false;
 }
 
+QVariantMap AppModel::fromRegistry(const QVariantMap &appInfo) {
+    QString icon    = appInfo.value("icon").toString();
+    int     typeInt = appInfo.value("type").toInt();
+
+    // Convert type enum to string
+    QString type = "marathon";
+    if (typeInt == MarathonAppRegistry::Native) {
+        type = "native";
+    } else if (typeInt == MarathonAppRegistry::System) {
+        type = "marathon";
+    }
+
+    // Convert relative icon path to absolute if needed
+    QString absolutePath = appInfo.value("absolutePath").toString();
+    if (!icon.isEmpty() && !icon.startsWith("qrc:") && !icon.startsWith("file://")) {
+        if (!icon.startsWith("/")) {
+            icon = absolutePath + "/" + icon;
+        }
+        // Add file:// prefix for filesystem paths
+        icon = "file://" + icon;
+    }
+
+    return {{"id", appInfo.value("id")},
+            {"name", appInfo.value("name")},
+            {"icon", icon},
+            {"type", type}};
+}
+
 void AppModel::loadFromRegistry(QObject *registryObj) {
     MarathonAppRegistry *registry = qobject_cast<MarathonAppRegistry *>(registryObj);
     if (!registry) {
@@ -142,45 +263,13 @@ void AppModel::loadFromRegistry(QObject *registryObj) {
 
     qDebug() << "[AppModel] Loading apps from registry...";
 
-    QStringList appIds = registry->getAllAppIds();
+    // Apps that did not change keep their rows; hardcoded placeholders are replaced in place
+    QStringList  appIds = registry->getAllAppIds();
+    QVariantList apps;
     appIds.sort(); // Sort alphabetically for consistent ordering
-    for (const QString &appId : appIds) {
-        QVariantMap appInfo = registry->getApp(appId);
-
-        QString     id      = appInfo.value("id").toString();
-        QString     name    = appInfo.value("name").toString();
-        QString     icon    = appInfo.value("icon").toString();
-        int         typeInt = appInfo.value("type").toInt();
-
-        // Convert type enum to string
-        QString type = "marathon";
-        if (typeInt == MarathonAppRegistry::Native) {
-            type = "native";
-        } else if (typeInt == MarathonAppRegistry::System) {
-            type = "marathon";
-        }
-
-        // Convert relative icon path to absolute if needed
-        QString absolutePath = appInfo.value("absolutePath").toString();
-        if (!icon.isEmpty() && !icon.startsWith("qrc:") && !icon.startsWith("file://")) {
-            if (!icon.startsWith("/")) {
-                icon = absolutePath + "/" + icon;
-            }
-            // Add file:// prefix for filesystem paths
-            icon = "file://" + icon;
-        }
-
-        // Add or update app
-        if (m_appIndex.contains(id)) {
-            qDebug() << "[AppModel] Updating app from registry:" << id;
-            // Replace hardcoded placeholder with real app from filesystem
-            removeApp(id);
-            addApp(id, name, icon, type);
-        } else {
-            addApp(id, name, icon, type);
-            qDebug() << "[AppModel] Added app from registry:" << id;
-        }
-    }
+    for (const QString &appId : appIds)
+        apps.append(fromRegistry(registry->getApp(appId)));
+    updateApps(apps);
 
     qDebug() << "[AppModel] Loaded" << appIds.count() << "apps from registry";
 
@@ -188,6 +277,20 @@ void AppModel::loadFromRegistry(QObject *registryObj) {
     cleanupMissingApps(appIds);
 }
 
+// Add, update or remove a single app to match the registry
+void AppModel::loadAppFromRegistry(QObject *registryObj, const QString &appId) {
+    MarathonAppRegistry *registry = qobject_cast<MarathonAppRegistry *>(registryObj);
+    if (!registry) {
+        qWarning() << "[AppModel] Invalid registry object";
+        return;
+    }
+
+    if (registry->hasApp(appId))
+        updateApps({fromRegistry(registry->getApp(appId))});
+    else if (m_appIndex.contains(appId))
+        removeApp(appId);
+}
+
 void AppModel::cleanupMissingApps(const QStringList &registryAppIds) {
     // List of hardcoded app IDs that should be removed if not found in registry
     QStringList hardcodedAppIds = {"phone", "messages", "browser", "camera", "gallery",
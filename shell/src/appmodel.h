@@ -76,6 +76,10 @@ class AppModel : public QAbstractListModel {
     Q_INVOKABLE App    *getAppAtIndex(int index);
     Q_INVOKABLE void    addApp(const QString &id, const QString &name, const QString &icon,
                                const QString &type, const QString &exec = QString());
+    Q_INVOKABLE void    addApps(const QVariantList &apps);
+    Q_INVOKABLE void    updateApp(const QString &id, const QString &name, const QString &icon,
+                                  const QString &type, const QString &exec = QString());
+    Q_INVOKABLE void    updateApps(const QVariantList &apps);
     Q_INVOKABLE void    removeApp(const QString &appId);
     Q_INVOKABLE void    clear();
     Q_INVOKABLE QString getAppName(const QString &appId);
@@ -84,6 +88,7 @@ class AppModel : public QAbstractListModel {
     Q_INVOKABLE void    sortAppsByName();
 
     Q_INVOKABLE void    loadFromRegistry(QObject *registryObj);
+    Q_INVOKABLE void    loadAppFromRegistry(QObject *registryObj, const QString &appId);
 
   signals:
     void countChanged();
@@ -92,7 +97,11 @@ class AppModel : public QAbstractListModel {
     QVector<App *>        m_apps;
     QHash<QString, App *> m_appIndex; // O(1) lookup
 
+    bool                  isValidApp(const QString &id, const QString &name, const QString &icon,
+                                     const QString &type) const;
+    int                   sortedRow(const QString &name) const;
     void                  cleanupMissingApps(const QStringList &registryAppIds);
+    static QVariantMap    fromRegistry(const QVariantMap &appInfo);
 };
 
 #endif // APPMODEL_H
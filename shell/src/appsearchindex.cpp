@@ -0,0 +1,284 @@
+#include "appsearchindex.h"
+#include "appmodel.h"
+#include "marathonappregistry.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QRegularExpression>
+#include <algorithm>
+
+namespace {
+    constexpr int kExactTitle    = 10000;
+    constexpr int kTitlePrefix   = 5000;
+    constexpr int kExactKeyword  = 3000;
+    constexpr int kKeywordPrefix = 2000;
+    constexpr int kTitleContains = 1000;
+    constexpr int kKeywordMatch  = 500;
+    constexpr int kAppBoost      = 100;
+
+    struct Hit {
+        int item;
+        int score;
+    };
+} // namespace
+
+AppSearchIndex::AppSearchIndex(AppModel *apps, MarathonAppRegistry *registry, QObject *parent)
+    : QObject(parent)
+    , m_apps(apps)
+    , m_registry(registry)
+    , m_includeNativeApps(true)
+    , m_dirty(true) {
+    // Any change to either model only marks the index; it is rebuilt when next searched
+    for (QAbstractItemModel *model : {static_cast<QAbstractItemModel *>(apps),
+                                      static_cast<QAbstractItemModel *>(registry)}) {
+        if (!model)
+            continue;
+        connect(model, &QAbstractItemModel::rowsInserted, this, &AppSearchIndex::invalidate);
+        connect(model, &QAbstractItemModel::rowsRemoved, this, &AppSearchIndex::invalidate);
+        connect(model, &QAbstractItemModel::dataChanged, this, &AppSearchIndex::invalidate);
+        connect(model, &QAbstractItemModel::modelReset, this, &AppSearchIndex::invalidate);
+    }
+}
+
+void AppSearchIndex::setIncludeNativeApps(bool include) {
+    if (include == m_includeNativeApps)
+        return;
+    m_includeNativeApps = include;
+    invalidate();
+    emit includeNativeAppsChanged();
+}
+
+void AppSearchIndex::invalidate() {
+    if (m_dirty)
+        return;
+    m_dirty = true;
+    emit indexChanged();
+}
+
+int AppSearchIndex::count() {
+    ensureBuilt();
+    return static_cast<int>(m_items.size());
+}
+
+QString AppSearchIndex::fold(const QString &text) {
+    const QString decomposed = text.normalized(QString::NormalizationForm_D);
+    QString       folded;
+    folded.reserve(decomposed.size());
+    for (const QChar c : decomposed) {
+        if (c.category() != QChar::Mark_NonSpacing)
+            folded.append(c.toCaseFolded());
+    }
+    return folded;
+}
+
+quint64 AppSearchIndex::charMask(const QString &folded) {
+    // One bit per letter and digit, the rest of the alphabet shares the upper bits
+    quint64 mask = 0;
+    for (const QChar c : folded) {
+        const char16_t u = c.unicode();
+        if (u >= 'a' && u <= 'z')
+            mask |= quint64(1) << (u - 'a');
+        else if (u >= '0' && u <= '9')
+            mask |= quint64(1) << (26 + u - '0');
+        else if (!c.isSpace())
+            mask |= quint64(1) << (36 + u % 28);
+    }
+    return mask;
+}
+
+int AppSearchIndex::fuzzyScore(const QString &text, const QString &pattern) {
+    // Every pattern character in order; runs of consecutive characters score more
+    int             score       = 0;
+    int             consecutive = 0;
+    qsizetype       p           = 0;
+    const QChar    *t           = text.constData();
+    const qsizetype length      = text.size();
+    const qsizetype patternSize = pattern.size();
+    for (qsizetype i = 0; i < length && p < patternSize; ++i) {
+        if (t[i] == pattern.at(p)) {
+            score += 1 + consecutive * 2;
+            ++consecutive;
+            ++p;
+        } else {
+            consecutive = 0;
+        }
+    }
+    return p == patternSize ? score * 100 / static_cast<int>(patternSize) : 0;
+}
+
+void AppSearchIndex::ensureBuilt() {
+    if (m_dirty)
+        build();
+}
+
+void AppSearchIndex::addItem(Item item) {
+    item.foldedTitle = fold(item.title);
+    for (const QString &keyword : std::as_const(item.keywords))
+        item.foldedKeywords.append(fold(keyword));
+    item.foldedText = fold(item.searchText);
+    item.charMask   = charMask(item.foldedText + item.foldedKeywords.join(' '));
+
+    const int index = static_cast<int>(m_items.size());
+    m_tokens.append({item.foldedTitle, index, TitleToken});
+    for (const QString &keyword : std::as_const(item.foldedKeywords)) {
+        if (!keyword.isEmpty())
+            m_tokens.append({keyword, index, KeywordToken});
+    }
+    m_items.append(std::move(item));
+}
+
+void AppSearchIndex::build() {
+    QElapsedTimer timer;
+    timer.start();
+
+    m_items.clear();
+    m_tokens.clear();
+    m_dirty = false;
+
+    static const QRegularExpression whitespace("\\s+");
+    const MarathonAppRegistry::SnapshotPtr registry =
+        m_registry ? m_registry->snapshot() : MarathonAppRegistry::createSnapshot({});
+
+    for (int i = 0; m_apps && i < m_apps->count(); ++i) {
+        const App *app = m_apps->getAppAtIndex(i);
+        if (!app || app->id().isEmpty() || app->name().isEmpty())
+            continue;
+        if (app->type() == "native" && !m_includeNativeApps)
+            continue;
+
+        Item item;
+        item.type       = "app";
+        item.id         = app->id();
+        item.title      = app->name();
+        item.subtitle   = app->type() == "native" ? "Native App" : "Marathon App";
+        item.icon       = app->icon();
+        item.searchText = app->name().toLower() + " " + app->id().toLower();
+        item.keywords   = {app->name().toLower(), app->id().toLower()};
+        for (const QString &part : app->name().toLower().split(whitespace, Qt::SkipEmptyParts))
+            item.keywords.append(part);
+        if (const MarathonAppRegistry::AppInfo *info = registry->find(app->id())) {
+            for (const QString &keyword : info->searchKeywords)
+                item.keywords.append(keyword.toLower());
+        }
+        item.data = {{"id", app->id()},
+                     {"name", app->name()},
+                     {"icon", app->icon()},
+                     {"type", app->type()}};
+        addItem(std::move(item));
+    }
+    const qsizetype appCount = m_items.size();
+
+    for (const MarathonAppRegistry::AppPtr &entry : registry->apps) {
+        const MarathonAppRegistry::AppInfo &app = *entry;
+
+        const QJsonObject deepLinks = QJsonDocument::fromJson(app.deepLinksJson.toUtf8()).object();
+        for (auto it = deepLinks.constBegin(); it != deepLinks.constEnd(); ++it) {
+            const QString     route       = it.key();
+            const QJsonObject link        = it.value().toObject();
+            const QString     title       = link.value("title").toString();
+            const QString     description = link.value("description").toString();
+
+            Item              item;
+            item.type     = "deeplink";
+            item.id       = route;
+            item.title    = title.isEmpty() ? route : title;
+            item.subtitle = description.isEmpty() ? app.name : description;
+            item.icon     = app.icon.isEmpty() ? "qrc:/images/app-icon-placeholder.svg" : app.icon;
+            for (const QJsonValue &keyword : link.value("keywords").toArray())
+                item.keywords.append(keyword.toString());
+            // App name and route as extra context
+            item.keywords.append(app.name.toLower());
+            item.keywords.append(route.toLower());
+            item.searchText = item.title.toLower() + " " + item.keywords.join(" ");
+            item.data       = {{"appId", app.id}, {"route", route}, {"appName", app.name}};
+            addItem(std::move(item));
+        }
+    }
+
+    std::sort(m_tokens.begin(), m_tokens.end(),
+              [](const Token &a, const Token &b) { return a.text < b.text; });
+
+    qDebug() << "[AppSearchIndex] Indexed" << appCount << "apps and" << m_items.size() - appCount
+             << "deep links," << m_tokens.size() << "tokens in" << timer.elapsed() << "ms";
+}
+
+QVariantList AppSearchIndex::search(const QString &query, int limit) {
+    const QString q = fold(query.trimmed());
+    if (q.isEmpty())
+        return QVariantList();
+    ensureBuilt();
+
+    QVector<int> scores(m_items.size(), 0);
+
+    // Title and keyword prefixes, exact matches included: one contiguous range of tokens
+    auto it = std::lower_bound(
+        m_tokens.cbegin(), m_tokens.cend(), q,
+        [](const Token &token, const QString &text) { return token.text < text; });
+    for (; it != m_tokens.cend() && it->text.startsWith(q); ++it) {
+        const bool exact = it->text.size() == q.size();
+        const int  score = it->kind == TitleToken ? (exact ? kExactTitle : kTitlePrefix)
+                                                  : (exact ? kExactKeyword : kKeywordPrefix);
+        scores[it->item] = std::max(scores[it->item], score);
+    }
+
+    // Substring and fuzzy matches, only for items holding every character of the query
+    const quint64 queryMask = charMask(q);
+    for (qsizetype i = 0; i < m_items.size(); ++i) {
+        const Item &item = m_items.at(i);
+        if (scores[i] > 0 || (item.charMask & queryMask) != queryMask)
+            continue;
+
+        if (item.foldedTitle.contains(q)) {
+            scores[i] = kTitleContains;
+            continue;
+        }
+        const bool inKeyword =
+            std::any_of(item.foldedKeywords.cbegin(), item.foldedKeywords.cend(),
+                        [&q](const QString &keyword) { return keyword.contains(q); });
+        scores[i] = inKeyword ? kKeywordMatch : fuzzyScore(item.foldedText, q);
+    }
+
+    QVector<Hit> hits;
+    for (qsizetype i = 0; i < m_items.size(); ++i) {
+        if (scores[i] > 0) {
+            hits.append({static_cast<int>(i),
+                         scores[i] + (m_items.at(i).type == "app" ? kAppBoost : 0)});
+        }
+    }
+
+    const auto byRank = [this](const Hit &a, const Hit &b) {
+        if (a.score != b.score)
+            return a.score > b.score;
+        return QString::localeAwareCompare(m_items.at(a.item).title, m_items.at(b.item).title) < 0;
+    };
+    if (limit > 0 && limit < hits.size()) {
+        std::partial_sort(hits.begin(), hits.begin() + limit, hits.end(), byRank);
+        hits.resize(limit);
+    } else {
+        std::sort(hits.begin(), hits.end(), byRank);
+    }
+
+    QVariantList results;
+    results.reserve(hits.size());
+    for (const Hit &hit : std::as_const(hits))
+        results.append(toVariant(m_items.at(hit.item), hit.score));
+    return results;
+}
+
+QVariantMap AppSearchIndex::toVariant(const Item &item, int score) const {
+    QVariantMap result;
+    result["type"]       = item.type;
+    result["id"]         = item.id;
+    result["title"]      = item.title;
+    result["subtitle"]   = item.subtitle;
+    result["icon"]       = item.icon;
+    result["keywords"]   = item.keywords;
+    result["searchText"] = item.searchText;
+    result["data"]       = item.data;
+    result["score"]      = score;
+    if (item.type == "deeplink")
+        result["appId"] = item.data.value("appId");
+    return result;
+}
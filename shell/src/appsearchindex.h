@@ -0,0 +1,110 @@
+#ifndef APPSEARCHINDEX_H
+#define APPSEARCHINDEX_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+#include <QVariantMap>
+#include <QVector>
+
+class AppModel;
+class MarathonAppRegistry;
+
+/**
+ * @brief Search-as-you-type index over apps and Marathon app deep links
+ *
+ * Apps come from AppModel, deep links (and extra app keywords) from
+ * MarathonAppRegistry. Titles and keywords are lower-cased and stripped of
+ * accents once, when the index is built; every searchable token also goes
+ * into a sorted array, so the prefix tiers of a query are one binary search.
+ * The remaining items are first screened with a per-item character bitmask,
+ * and only those that contain every character of the query are scanned for
+ * substring and fuzzy matches.
+ *
+ * Scores follow the tiers UnifiedSearchService used: exact title (10000),
+ * title prefix (5000), exact keyword (3000), keyword prefix (2000), title
+ * substring (1000), keyword substring (500), then an in-order fuzzy match;
+ * apps get +100 over deep links.
+ *
+ * The index is rebuilt lazily on the first search after either model changed.
+ */
+class AppSearchIndex : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(bool includeNativeApps READ includeNativeApps WRITE setIncludeNativeApps NOTIFY
+                   includeNativeAppsChanged)
+    Q_PROPERTY(int count READ count NOTIFY indexChanged)
+
+  public:
+    explicit AppSearchIndex(AppModel *apps, MarathonAppRegistry *registry,
+                            QObject *parent = nullptr);
+
+    bool includeNativeApps() const {
+        return m_includeNativeApps;
+    }
+    void setIncludeNativeApps(bool include);
+
+    // Number of indexed items (builds the index if needed)
+    int count();
+
+    /**
+     * @brief Items matching the query, best first, ties in title order
+     *
+     * Each result is a map with type ("app" or "deeplink"), id, title,
+     * subtitle, icon, keywords, data and score, as UnifiedSearchService
+     * results always were.
+     * @param limit Maximum number of results, 0 for all
+     */
+    Q_INVOKABLE QVariantList search(const QString &query, int limit = 0);
+
+    // Rebuild on the next search
+    Q_INVOKABLE void invalidate();
+
+    // Lower case without accents, as titles and keywords are indexed
+    static QString fold(const QString &text);
+
+  signals:
+    void includeNativeAppsChanged();
+    void indexChanged();
+
+  private:
+    struct Item {
+        QString     type; // "app" or "deeplink"
+        QString     id;
+        QString     title;
+        QString     subtitle;
+        QString     icon;
+        QStringList keywords;
+        QString     searchText;
+        QVariantMap data;
+
+        QString     foldedTitle;
+        QStringList foldedKeywords;
+        QString     foldedText; // fuzzy matched
+        quint64     charMask = 0;
+    };
+
+    enum TokenKind { TitleToken, KeywordToken };
+
+    struct Token {
+        QString   text;
+        int       item;
+        TokenKind kind;
+    };
+
+    void                 ensureBuilt();
+    void                 build();
+    void                 addItem(Item item);
+    QVariantMap          toVariant(const Item &item, int score) const;
+    static quint64       charMask(const QString &folded);
+    static int           fuzzyScore(const QString &text, const QString &pattern);
+
+    AppModel            *m_apps;
+    MarathonAppRegistry *m_registry;
+    QVector<Item>        m_items;
+    QVector<Token>       m_tokens; // sorted by text
+    bool                 m_includeNativeApps;
+    bool                 m_dirty;
+};
+
+#endif // APPSEARCHINDEX_H
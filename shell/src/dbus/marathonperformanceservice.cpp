@@ -0,0 +1,78 @@
+#include "marathonperformanceservice.h"
+#include "../frametimingmonitor.h"
+#include <QDBusConnection>
+#include <QDebug>
+
+MarathonPerformanceService::MarathonPerformanceService(FrameTimingMonitor *frameTiming,
+                                                       QObject            *parent)
+    : QObject(parent)
+    , m_frameTiming(frameTiming) {
+    connect(m_frameTiming, &FrameTimingMonitor::enabledChanged, this,
+            [this]() { emit FrameTimingEnabledChanged(frameTimingEnabled()); });
+}
+
+MarathonPerformanceService::~MarathonPerformanceService() {}
+
+bool MarathonPerformanceService::registerService() {
+    QDBusConnection bus = QDBusConnection::sessionBus();
+
+    if (!bus.registerService("org.marathon.PerformanceService")) {
+        qWarning() << "[PerformanceService] Failed to register service:"
+                   << bus.lastError().message();
+        return false;
+    }
+
+    if (!bus.registerObject("/org/marathon/PerformanceService", this,
+                            QDBusConnection::ExportAllSlots | QDBusConnection::ExportAllSignals |
+                                QDBusConnection::ExportAllProperties)) {
+        qWarning() << "[PerformanceService] Failed to register object:"
+                   << bus.lastError().message();
+        return false;
+    }
+
+    qInfo() << "[PerformanceService] ✓ Registered on D-Bus";
+    return true;
+}
+
+bool MarathonPerformanceService::frameTimingEnabled() const {
+    return m_frameTiming ? m_frameTiming->enabled() : false;
+}
+
+void MarathonPerformanceService::setFrameTimingEnabled(bool enabled) {
+    if (m_frameTiming)
+        m_frameTiming->setEnabled(enabled);
+}
+
+QVariantMap MarathonPerformanceService::GetFrameStats(int windowMs) {
+    if (!m_frameTiming)
+        return QVariantMap();
+    return m_frameTiming->summarize(windowMs > 0 ? windowMs : FrameTimingMonitor::kStatsWindowMs);
+}
+
+QVariantMap MarathonPerformanceService::GetRecentFrames(int count) {
+    QVariantMap frames;
+    if (!m_frameTiming)
+        return frames;
+
+    // One array per field, all in the same frame order (oldest first); -1 means not measured
+    QList<qlonglong> presented;
+    QList<int>       interval, frameTime, dropped, commit, callback, input;
+    for (const FrameTiming &timing : m_frameTiming->ring().latest(count)) {
+        presented.append(timing.presentedNs);
+        interval.append(timing.intervalUs);
+        frameTime.append(timing.frameTimeUs);
+        dropped.append(timing.droppedFrames);
+        commit.append(timing.commitToPresentUs);
+        callback.append(timing.callbackToPresentUs);
+        input.append(timing.inputToPresentUs);
+    }
+
+    frames["presentedNs"]         = QVariant::fromValue(presented);
+    frames["intervalUs"]          = QVariant::fromValue(interval);
+    frames["frameTimeUs"]         = QVariant::fromValue(frameTime);
+    frames["droppedFrames"]       = QVariant::fromValue(dropped);
+    frames["commitToPresentUs"]   = QVariant::fromValue(commit);
+    frames["callbackToPresentUs"] = QVariant::fromValue(callback);
+    frames["inputToPresentUs"]    = QVariant::fromValue(input);
+    return frames;
+}
@@ -0,0 +1,38 @@
+#ifndef MARATHONPERFORMANCESERVICE_H
+#define MARATHONPERFORMANCESERVICE_H
+
+#include <QObject>
+#include <QDBusContext>
+#include <QDBusConnection>
+#include <QVariantMap>
+
+class FrameTimingMonitor;
+
+class MarathonPerformanceService : public QObject, protected QDBusContext {
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.marathon.PerformanceService")
+
+    Q_PROPERTY(bool FrameTimingEnabled READ frameTimingEnabled WRITE setFrameTimingEnabled NOTIFY
+                   FrameTimingEnabledChanged)
+
+  public:
+    explicit MarathonPerformanceService(FrameTimingMonitor *frameTiming, QObject *parent = nullptr);
+    ~MarathonPerformanceService();
+
+    bool registerService();
+
+    bool frameTimingEnabled() const;
+    void setFrameTimingEnabled(bool enabled);
+
+  public slots:
+    QVariantMap GetFrameStats(int windowMs);
+    QVariantMap GetRecentFrames(int count);
+
+  signals:
+    void FrameTimingEnabledChanged(bool enabled);
+
+  private:
+    FrameTimingMonitor *m_frameTiming;
+};
+
+#endif // MARATHONPERFORMANCESERVICE_H
@@ -1,13 +1,74 @@
 #include "desktopfileparser.h"
 #include <QFile>
+#include <QFileSystemWatcher>
 #include <QTextStream>
+#include <QDataStream>
+#include <QDateTime>
 #include <QDir>
 #include <QFileInfo>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QRegularExpression>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTimer>
+#include <algorithm>
+#include <sys/stat.h>
+
+namespace {
+    constexpr quint32 kCacheMagic    = 0x4d444543; // "MDEC"
+    constexpr quint32 kCacheVersion  = 1;
+    constexpr int     kIconSize      = 128; // launcher grid icons, in pixels
+    constexpr int     kParseChunk    = 16;  // desktop files per worker task and delivered batch
+    constexpr int     kChangeDelayMs = 500; // package managers touch many files at once
+
+    // A file changed within the same timestamp tick as our scan could change
+    // again without its mtime moving; such entries are not trusted next time
+    constexpr qint64  kRacyWindowNs = 2'000'000'000;
+
+    qint64            mtimeNs(const struct stat &st) {
+        return qint64(st.st_mtim.tv_sec) * 1'000'000'000 + st.st_mtim.tv_nsec;
+    }
+
+    bool statPath(const QString &path, struct stat *st) {
+        return ::stat(QFile::encodeName(path).constData(), st) == 0;
+    }
+} // namespace
 
 DesktopFileParser::DesktopFileParser(QObject *parent)
-    : QObject(parent) {}
+    : DesktopFileParser(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+                            "/marathon/desktop-entries.cache",
+                        parent) {}
+
+DesktopFileParser::DesktopFileParser(const QString &cachePath, QObject *parent)
+    : QObject(parent)
+    , m_cachePath(cachePath)
+    , m_cacheLoaded(false)
+    , m_cacheDirty(false)
+    , m_watcher(new QFileSystemWatcher(this))
+    , m_changeTimer(new QTimer(this))
+    , m_watchFilter(false) {
+    m_scanPool.setMaxThreadCount(1);
+
+    m_changeTimer->setSingleShot(true);
+    m_changeTimer->setInterval(kChangeDelayMs);
+    connect(m_changeTimer, &QTimer::timeout, this, [this]() {
+        const QStringList paths  = m_changedDirectories.values();
+        const bool        filter = m_watchFilter;
+        m_changedDirectories.clear();
+        // Serialized with full scans, which share the cache
+        m_scanPool.start([this, paths, filter]() { rescanDirectories(paths, filter); });
+    });
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, [this](const QString &path) {
+        m_changedDirectories.insert(path);
+        m_changeTimer->start();
+    });
+}
+
+DesktopFileParser::~DesktopFileParser() {
+    // Workers emit on this object and use its cache
+    m_scanPool.waitForDone();
+}
 
 QVariantList DesktopFileParser::scanApplications(const QStringList &searchPaths) {
     // Default: don't filter (for backwards compatibility)
@@ -16,49 +77,335 @@ QVariantList DesktopFileParser::scanApplications(const QStringList &searchPaths)
 
 QVariantList DesktopFileParser::scanApplications(const QStringList &searchPaths,
                                                  bool               filterMobileFriendly) {
-    QVariantList apps;
-
     qDebug() << "[DesktopFileParser] Scanning with mobile filter:" << filterMobileFriendly;
 
+    // The cache and the icon index belong to whichever scan is running
+    m_scanPool.waitForDone();
+
+    QElapsedTimer timer;
+    timer.start();
+    loadCache();
+    {
+        QMutexLocker locker(&m_iconMutex);
+        m_iconIndex.refresh();
+    }
+
+    QVariantList       apps;
+    QList<PendingFile> pending;
+    for (const QString &path : searchPaths) {
+        const QString dirPath = QDir(path).absolutePath();
+        apps += collectDirectory(dirPath, m_cache[dirPath], pending);
+    }
+
+    for (PendingFile &file : pending) {
+        file.entry.app = parseDesktopFile(file.directory + '/' + file.name);
+        if (!file.entry.app.isEmpty())
+            apps.append(file.entry.app);
+        m_cache[file.directory].files.insert(file.name, file.entry);
+    }
+
+    saveCache();
+
+    apps = filterApps(apps, filterMobileFriendly);
+    qDebug() << "[DesktopFileParser] Total apps found:" << apps.count()
+             << "(filtered:" << filterMobileFriendly << ") in" << timer.elapsed() << "ms";
+    return apps;
+}
+
+void DesktopFileParser::scanApplicationsAsync(const QStringList &searchPaths,
+                                              bool               filterMobileFriendly) {
+    if (!m_scanning.testAndSetAcquire(0, 1)) {
+        qDebug() << "[DesktopFileParser] Scan already in progress";
+        return;
+    }
+
+    qDebug() << "[DesktopFileParser] Starting async scan with mobile filter:"
+             << filterMobileFriendly;
+    m_scanPool.start([this, searchPaths, filterMobileFriendly]() {
+        runScan(searchPaths, filterMobileFriendly);
+        m_scanning.storeRelease(0);
+    });
+}
+
+void DesktopFileParser::watchDirectories(const QStringList &searchPaths,
+                                         bool               filterMobileFriendly) {
+    m_watchFilter = filterMobileFriendly;
     for (const QString &path : searchPaths) {
-        QDir dir(path);
-        if (!dir.exists()) {
-            qDebug() << "[DesktopFileParser] Directory does not exist:" << path;
+        const QString dirPath = QDir(path).absolutePath();
+        if (QFileInfo(dirPath).isDir() && !m_watcher->directories().contains(dirPath))
+            m_watcher->addPath(dirPath);
+    }
+    qDebug() << "[DesktopFileParser] Watching" << m_watcher->directories();
+}
+
+void DesktopFileParser::rescanDirectories(const QStringList &paths, bool filterMobileFriendly) {
+    loadCache();
+    {
+        QMutexLocker locker(&m_iconMutex);
+        m_iconIndex.refresh();
+    }
+
+    const auto   visible = [this, filterMobileFriendly](const QVariantMap &app) {
+        return !app.isEmpty() && (!filterMobileFriendly || isMobileFriendly(app));
+    };
+
+    QVariantList changed;
+    QStringList  removedIds;
+    for (const QString &path : paths) {
+        CachedDirectory &cached = m_cache[path];
+
+        // What the launcher has from this directory, by file name
+        QHash<QString, QVariantMap> before;
+        for (auto it = cached.files.cbegin(); it != cached.files.cend(); ++it) {
+            if (visible(it->app))
+                before.insert(it.key(), it->app);
+        }
+
+        // Only new and modified files are parsed, as in a full scan
+        QList<PendingFile> pending;
+        collectDirectory(path, cached, pending);
+        for (PendingFile &file : pending) {
+            file.entry.app = parseDesktopFile(file.directory + '/' + file.name);
+            cached.files.insert(file.name, file.entry);
+        }
+
+        QSet<QString> ids;
+        for (auto it = cached.files.cbegin(); it != cached.files.cend(); ++it) {
+            if (!visible(it->app))
+                continue;
+            ids.insert(it->app.value("id").toString());
+            if (before.value(it.key()) != it->app)
+                changed.append(it->app);
+        }
+        for (const QVariantMap &app : std::as_const(before)) {
+            const QString id = app.value("id").toString();
+            if (!ids.contains(id))
+                removedIds.append(id);
+        }
+    }
+    saveCache();
+
+    qDebug() << "[DesktopFileParser]" << changed.size() << "apps added or changed,"
+             << removedIds.size() << "removed in" << paths;
+    if (!changed.isEmpty() || !removedIds.isEmpty())
+        emit applicationsChanged(changed, removedIds);
+}
+
+void DesktopFileParser::runScan(const QStringList &searchPaths, bool filterMobileFriendly) {
+    QElapsedTimer timer;
+    timer.start();
+    loadCache();
+    {
+        QMutexLocker locker(&m_iconMutex);
+        m_iconIndex.refresh();
+    }
+
+    // Everything the cache still vouches for goes out first, after nothing but stat() calls
+    QList<PendingFile> pending;
+    QVariantList       cached;
+    for (const QString &path : searchPaths) {
+        const QString dirPath = QDir(path).absolutePath();
+        cached += collectDirectory(dirPath, m_cache[dirPath], pending);
+    }
+
+    QAtomicInt   total = 0;
+    QVariantList batch = filterApps(cached, filterMobileFriendly);
+    if (!batch.isEmpty()) {
+        total.fetchAndAddRelaxed(batch.size());
+        emit applicationsFound(batch);
+    }
+    qDebug() << "[DesktopFileParser]" << batch.size() << "cached apps ready in" << timer.elapsed()
+             << "ms," << pending.size() << "files to parse";
+
+    // Parse the rest in parallel; each chunk is delivered as soon as it is done.
+    // Tasks write disjoint elements, through a pointer taken before any of them runs.
+    PendingFile *files = pending.data();
+    for (qsizetype first = 0; first < pending.size(); first += kParseChunk) {
+        const qsizetype count = std::min<qsizetype>(kParseChunk, pending.size() - first);
+        m_parsePool.start([this, files, &total, first, count, filterMobileFriendly]() {
+            QVariantList apps;
+            for (qsizetype i = first; i < first + count; ++i) {
+                PendingFile &file = files[i];
+                file.entry.app    = parseDesktopFile(file.directory + '/' + file.name);
+                if (!file.entry.app.isEmpty())
+                    apps.append(file.entry.app);
+            }
+
+            apps = filterApps(apps, filterMobileFriendly);
+            if (!apps.isEmpty()) {
+                total.fetchAndAddRelaxed(apps.size());
+                emit applicationsFound(apps);
+            }
+        });
+    }
+    m_parsePool.waitForDone();
+
+    for (const PendingFile &file : std::as_const(pending))
+        m_cache[file.directory].files.insert(file.name, file.entry);
+    saveCache();
+
+    qDebug() << "[DesktopFileParser] Async scan found" << total.loadRelaxed() << "apps in"
+             << timer.elapsed() << "ms";
+    emit scanFinished(total.loadRelaxed());
+}
+
+QVariantList DesktopFileParser::filterApps(const QVariantList &apps, bool filterMobileFriendly) {
+    if (!filterMobileFriendly)
+        return apps;
+
+    QVariantList filtered;
+    for (const QVariant &entry : apps) {
+        const QVariantMap app = entry.toMap();
+        if (isMobileFriendly(app)) {
+            filtered.append(app);
+            qDebug() << "[DesktopFileParser] ✓ Mobile-friendly:" << app["name"].toString();
+        } else {
+            qDebug() << "[DesktopFileParser] ✗ Not mobile-friendly (filtered):"
+                     << app["name"].toString();
+        }
+    }
+    return filtered;
+}
+
+QVariantList DesktopFileParser::collectDirectory(const QString &path, CachedDirectory &cached,
+                                                 QList<PendingFile> &pending) {
+    QVariantList apps;
+
+    struct stat  dirStat;
+    if (!statPath(path, &dirStat) || !S_ISDIR(dirStat.st_mode)) {
+        qDebug() << "[DesktopFileParser] Directory does not exist:" << path;
+        if (!cached.files.isEmpty())
+            m_cacheDirty = true;
+        cached = CachedDirectory();
+        return apps;
+    }
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch() * 1'000'000;
+
+    // Files can only have been added or removed if the directory itself changed
+    QStringList  names;
+    const qint64 dirMtime = mtimeNs(dirStat);
+    if (cached.mtime >= 0 && cached.mtime == dirMtime) {
+        names = cached.files.keys();
+    } else {
+        names        = QDir(path).entryList({"*.desktop"}, QDir::Files);
+        cached.mtime = now - dirMtime > kRacyWindowNs ? dirMtime : -1;
+        m_cacheDirty = true;
+    }
+
+    // Files still to be parsed are added back to cached.files once they are
+    QMap<QString, CachedEntry> files;
+    const qsizetype            firstPending = pending.size();
+
+    for (const QString &name : std::as_const(names)) {
+        const QString filePath = path + '/' + name;
+        struct stat   st;
+        if (!statPath(filePath, &st) || !S_ISREG(st.st_mode)) {
+            m_cacheDirty = true; // removed, or a dangling Flatpak export link
             continue;
         }
 
-        QStringList filters;
-        filters << "*.desktop";
-        QFileInfoList desktopFiles = dir.entryInfoList(filters, QDir::Files);
-
-        qDebug() << "[DesktopFileParser] Found" << desktopFiles.count() << "desktop files in"
-                 << path;
-
-        for (const QFileInfo &fileInfo : desktopFiles) {
-            QVariantMap app = parseDesktopFile(fileInfo.absoluteFilePath());
-            if (!app.isEmpty()) {
-                // Apply mobile-friendly filter if requested
-                if (filterMobileFriendly) {
-                    if (isMobileFriendly(app)) {
-                        apps.append(app);
-                        qDebug() << "[DesktopFileParser] ✓ Mobile-friendly:"
-                                 << app["name"].toString();
-                    } else {
-                        qDebug() << "[DesktopFileParser] ✗ Not mobile-friendly (filtered):"
-                                 << app["name"].toString();
-                    }
-                } else {
-                    apps.append(app);
+        const qint64 mtime = mtimeNs(st);
+        auto         it    = cached.files.find(name);
+        if (it != cached.files.end() && it->mtime >= 0 && it->mtime == mtime &&
+            it->inode == quint64(st.st_ino) && it->size == qint64(st.st_size)) {
+            // Icon themes change independently of the entry; the index makes this a hash lookup
+            if (!it->app.isEmpty()) {
+                const QString icon = resolveIconPath(it->app.value("iconName").toString());
+                if (icon != it->app.value("icon").toString()) {
+                    it->app["icon"] = icon;
+                    m_cacheDirty    = true;
                 }
+                apps.append(it->app);
             }
+            files.insert(name, *it);
+        } else {
+            PendingFile file;
+            file.directory   = path;
+            file.name        = name;
+            file.entry.mtime = now - mtime > kRacyWindowNs ? mtime : -1;
+            file.entry.inode = st.st_ino;
+            file.entry.size  = st.st_size;
+            pending.append(file);
+            m_cacheDirty = true;
         }
     }
 
-    qDebug() << "[DesktopFileParser] Total apps found:" << apps.count()
-             << "(filtered:" << filterMobileFriendly << ")";
+    if (files.size() != cached.files.size())
+        m_cacheDirty = true;
+    cached.files = files;
+
+    qDebug() << "[DesktopFileParser] Found" << names.size() << "desktop files in" << path
+             << "(" << pending.size() - firstPending << "to parse)";
     return apps;
 }
 
+void DesktopFileParser::loadCache() {
+    if (m_cacheLoaded)
+        return;
+    m_cacheLoaded = true;
+
+    QFile file(m_cachePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic   = 0;
+    quint32 version = 0;
+    in >> magic >> version;
+    if (magic != kCacheMagic || version != kCacheVersion) {
+        qDebug() << "[DesktopFileParser] Ignoring outdated desktop entry cache";
+        return;
+    }
+
+    quint32 dirCount = 0;
+    in >> dirCount;
+    for (quint32 i = 0; i < dirCount && in.status() == QDataStream::Ok; ++i) {
+        QString         path;
+        CachedDirectory dir;
+        quint32         fileCount = 0;
+        in >> path >> dir.mtime >> fileCount;
+        for (quint32 j = 0; j < fileCount && in.status() == QDataStream::Ok; ++j) {
+            QString     name;
+            CachedEntry entry;
+            in >> name >> entry.mtime >> entry.inode >> entry.size >> entry.app;
+            dir.files.insert(name, entry);
+        }
+        m_cache.insert(path, dir);
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        qWarning() << "[DesktopFileParser] Desktop entry cache is corrupt, rescanning";
+        m_cache.clear();
+    }
+}
+
+void DesktopFileParser::saveCache() {
+    if (!m_cacheDirty)
+        return;
+
+    QDir().mkpath(QFileInfo(m_cachePath).absolutePath());
+    QSaveFile file(m_cachePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "[DesktopFileParser] Cannot write desktop entry cache:" << m_cachePath;
+        return;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << kCacheMagic << kCacheVersion << quint32(m_cache.size());
+    for (auto dir = m_cache.cbegin(); dir != m_cache.cend(); ++dir) {
+        out << dir.key() << dir->mtime << quint32(dir->files.size());
+        for (auto it = dir->files.cbegin(); it != dir->files.cend(); ++it)
+            out << it.key() << it->mtime << it->inode << it->size << it->app;
+    }
+
+    if (file.commit())
+        m_cacheDirty = false;
+}
+
 QVariantMap DesktopFileParser::parseDesktopFile(const QString &filePath) {
     QFile file(filePath);
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
@@ -105,7 +452,8 @@ QVariantMap DesktopFileParser::parseDesktopFile(const QString &filePath) {
         } else if (key == "Comment" || (key == "GenericName" && !app.contains("comment"))) {
             app["comment"] = value;
         } else if (key == "Icon") {
-            app["icon"] = resolveIconPath(value);
+            app["icon"]     = resolveIconPath(value);
+            app["iconName"] = value;
         } else if (key == "Exec") {
             app["exec"] = cleanExecLine(value);
         } else if (key == "Terminal") {
@@ -158,44 +506,31 @@ QString DesktopFileParser::resolveIconPath(const QString &iconName) {
     }
 
     // If it already has an extension, check if it exists
+    QString name = iconName;
     if (iconName.endsWith(".svg") || iconName.endsWith(".png") || iconName.endsWith(".xpm") ||
         iconName.endsWith(".jpg")) {
         if (QFile::exists(iconName)) {
             return "file://" + iconName;
         }
+        name.chop(4); // "firefox.png" is still worth a theme lookup
     }
 
-    // Search common icon paths
-    QStringList searchPaths = {"/usr/share/pixmaps/",
-                               "/usr/share/icons/hicolor/scalable/apps/",
-                               "/usr/share/icons/hicolor/48x48/apps/",
-                               "/usr/share/icons/hicolor/64x64/apps/",
-                               "/usr/share/icons/hicolor/128x128/apps/",
-                               "/usr/share/icons/hicolor/256x256/apps/",
-                               "~/.local/share/icons/hicolor/scalable/apps/",
-                               "~/.local/share/icons/hicolor/48x48/apps/"};
-
-    QStringList extensions = {".svg", ".png", ".xpm", ""};
-
-    for (const QString &basePath : searchPaths) {
-        QString expandedPath = basePath;
-        if (expandedPath.startsWith('~')) {
-            expandedPath.replace(0, 1, QDir::homePath());
-        }
-
-        for (const QString &ext : extensions) {
-            QString fullPath = expandedPath + iconName + ext;
-            if (QFile::exists(fullPath)) {
-                qDebug() << "[DesktopFileParser] Found icon:" << fullPath;
-                return "file://" + fullPath;
-            }
-        }
+    QMutexLocker  locker(&m_iconMutex);
+    const QString path = m_iconIndex.lookup(name, kIconSize);
+    locker.unlock();
+    if (!path.isEmpty()) {
+        return "file://" + path;
     }
 
     qDebug() << "[DesktopFileParser] Icon not found:" << iconName << ", using fallback";
     return "qrc:/images/icons/lucide/grid.svg";
 }
 
+void DesktopFileParser::setIconTheme(const QString &theme) {
+    QMutexLocker locker(&m_iconMutex);
+    m_iconIndex.setTheme(theme);
+}
+
 QString DesktopFileParser::cleanExecLine(const QString &exec) {
     // Remove field codes like %f, %F, %u, %U, etc.
     QString            cleaned = exec;
@@ -1,27 +1,128 @@
 #ifndef DESKTOPFILEPARSER_H
 #define DESKTOPFILEPARSER_H
 
+#include <QAtomicInt>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
 #include <QObject>
+#include <QSet>
 #include <QString>
 #include <QVariantMap>
 #include <QVariantList>
+#include <QThreadPool>
 
+#include "iconthemeindex.h"
+
+class QFileSystemWatcher;
+class QTimer;
+
+/**
+ * @brief Reads the .desktop files of installed native applications
+ *
+ * scanApplications() keeps every parsed entry in a binary cache
+ * (~/.cache/marathon/desktop-entries.cache), keyed by directory and by each
+ * file's mtime, inode and size. On the next scan unchanged files are taken
+ * from the cache and only new or modified ones are parsed; a directory whose
+ * mtime has not changed is not even listed again.
+ *
+ * Icons are resolved through an IconThemeIndex, which is refreshed at the
+ * start of every scan.
+ *
+ * After watchDirectories() a directory that changes is re-collected against
+ * the cache, and only the entries that were added, changed or removed are
+ * reported through applicationsChanged().
+ */
 class DesktopFileParser : public QObject {
     Q_OBJECT
 
   public:
     explicit DesktopFileParser(QObject *parent = nullptr);
+    explicit DesktopFileParser(const QString &cachePath, QObject *parent = nullptr);
+    ~DesktopFileParser() override;
 
     Q_INVOKABLE QVariantList scanApplications(const QStringList &searchPaths);
     Q_INVOKABLE QVariantList scanApplications(const QStringList &searchPaths,
                                               bool               filterMobileFriendly);
+
+    /**
+     * @brief scanApplications() on worker threads, delivering apps in batches
+     *
+     * Entries the cache still vouches for are delivered first, as one batch,
+     * once the directories have been stat()ed. Files that need parsing are
+     * split over a thread pool and each chunk is delivered as soon as it is
+     * parsed. Signals are emitted from the workers. Ignored while a scan runs.
+     */
+    Q_INVOKABLE void         scanApplicationsAsync(const QStringList &searchPaths,
+                                                   bool               filterMobileFriendly);
     Q_INVOKABLE QVariantMap  parseDesktopFile(const QString &filePath);
     Q_INVOKABLE QString      resolveIconPath(const QString &iconName);
 
+    /**
+     * @brief Report later changes to these directories through applicationsChanged()
+     *
+     * Directories are re-read on the scan thread once a burst of changes has
+     * settled, with the same filter as the initial scan.
+     */
+    Q_INVOKABLE void         watchDirectories(const QStringList &searchPaths,
+                                              bool               filterMobileFriendly);
+
+    // Icon theme used by resolveIconPath(); hicolor and pixmaps are always searched too
+    void setIconTheme(const QString &theme);
+
+  signals:
+    void applicationsFound(const QVariantList &apps);
+    void scanFinished(int count);
+    // Entries added or changed since the last scan, and ids of the apps that went away
+    void applicationsChanged(const QVariantList &apps, const QStringList &removedIds);
+
   private:
-    QString     cleanExecLine(const QString &exec);
-    QStringList findIconPaths(const QString &iconName);
-    bool        isMobileFriendly(const QVariantMap &app);
+    struct CachedEntry {
+        qint64      mtime = -1; // nanoseconds, -1 to parse again next time
+        quint64     inode = 0;
+        qint64      size  = 0;
+        QVariantMap app; // empty if the file is not a launchable application
+    };
+    struct CachedDirectory {
+        qint64                     mtime = -1; // nanoseconds, -1 to list again next time
+        QMap<QString, CachedEntry> files;      // keyed by file name
+    };
+    struct PendingFile {
+        QString     directory;
+        QString     name;
+        CachedEntry entry; // app is filled in once the file is parsed
+    };
+
+    QString                         cleanExecLine(const QString &exec);
+    QStringList                     findIconPaths(const QString &iconName);
+    bool                            isMobileFriendly(const QVariantMap &app);
+
+    QVariantList                    collectDirectory(const QString &path, CachedDirectory &cached,
+                                                     QList<PendingFile> &pending);
+    QVariantList                    filterApps(const QVariantList &apps, bool filterMobileFriendly);
+    void                            runScan(const QStringList &searchPaths,
+                                            bool               filterMobileFriendly);
+    void                            rescanDirectories(const QStringList &paths,
+                                                      bool               filterMobileFriendly);
+    void                            loadCache();
+    void                            saveCache();
+
+    QString                         m_cachePath;
+    QHash<QString, CachedDirectory> m_cache; // keyed by absolute directory path
+    IconThemeIndex                  m_iconIndex;
+    QMutex                          m_iconMutex; // parse workers share the index
+    QAtomicInt                      m_scanning;
+    bool                            m_cacheLoaded;
+    bool                            m_cacheDirty;
+
+    QFileSystemWatcher             *m_watcher;
+    QTimer                         *m_changeTimer;
+    QSet<QString>                   m_changedDirectories;
+    bool                            m_watchFilter; // filterMobileFriendly of watchDirectories()
+
+    // Declared last so they are drained before anything they use is destroyed
+    QThreadPool                     m_scanPool; // one scan at a time
+    QThreadPool                     m_parsePool;
 };
 
 #endif // DESKTOPFILEPARSER_H
@@ -0,0 +1,217 @@
+#include "frametimingmonitor.h"
+#include <QDebug>
+#include <QEvent>
+#include <QQuickWindow>
+#include <QScreen>
+#include <algorithm>
+#include <limits>
+
+namespace {
+    qint32 toMicroseconds(qint64 ns) {
+        return qint32(qMin<qint64>(ns / 1000, std::numeric_limits<qint32>::max()));
+    }
+
+    qreal mean(const QVector<qint32> &values) {
+        if (values.isEmpty())
+            return 0.0;
+        qint64 sum = 0;
+        for (qint32 value : values)
+            sum += value;
+        return qreal(sum) / values.count();
+    }
+
+    qreal percentile(QVector<qint32> values, qreal fraction) {
+        if (values.isEmpty())
+            return 0.0;
+        int rank = qBound(0, int(fraction * values.count()), int(values.count()) - 1);
+        std::nth_element(values.begin(), values.begin() + rank, values.end());
+        return values.at(rank);
+    }
+} // namespace
+
+FrameTimingMonitor::FrameTimingMonitor(QObject *parent)
+    : QObject(parent) {
+    m_clock.start();
+
+    m_statsTimer.setInterval(kStatsIntervalMs);
+    connect(&m_statsTimer, &QTimer::timeout, this, &FrameTimingMonitor::updateStats);
+
+    QByteArray env = qgetenv("MARATHON_FRAME_TIMING");
+    if (env == "1" || env.toLower() == "true")
+        setEnabled(true);
+}
+
+void FrameTimingMonitor::attach(QQuickWindow *window) {
+    if (m_window == window)
+        return;
+    if (m_window) {
+        m_window->removeEventFilter(this);
+        disconnect(m_window, nullptr, this, nullptr);
+    }
+
+    m_window = window;
+    if (!window)
+        return;
+
+    // Render loop signals come from the render thread; handle them there
+    connect(window, &QQuickWindow::beforeFrameBegin, this, &FrameTimingMonitor::handleFrameBegin,
+            Qt::DirectConnection);
+    connect(window, &QQuickWindow::afterRendering, this,
+            &FrameTimingMonitor::handleAfterRendering, Qt::DirectConnection);
+    connect(window, &QQuickWindow::frameSwapped, this, &FrameTimingMonitor::handleFrameSwapped,
+            Qt::DirectConnection);
+    connect(window, &QWindow::screenChanged, this, &FrameTimingMonitor::updateRefreshInterval);
+    window->installEventFilter(this);
+    updateRefreshInterval();
+
+    qDebug() << "[FrameTimingMonitor] Attached to" << window
+             << "- refresh interval:" << m_refreshIntervalNs.load() / 1000 << "us";
+}
+
+void FrameTimingMonitor::setEnabled(bool enabled) {
+    if (m_enabled.exchange(enabled) == enabled)
+        return;
+
+    m_pendingCommitNs.store(0);
+    m_pendingInputNs.store(0);
+    if (enabled) {
+        m_statsTimer.start();
+    } else {
+        m_statsTimer.stop();
+        m_stats.clear();
+        emit statsChanged();
+    }
+
+    qInfo() << "[FrameTimingMonitor] Frame timing" << (enabled ? "enabled" : "disabled");
+    emit enabledChanged();
+}
+
+void FrameTimingMonitor::recordCommit() {
+    qint64 none = 0;
+    if (enabled())
+        m_pendingCommitNs.compare_exchange_strong(none, now());
+}
+
+void FrameTimingMonitor::recordInput() {
+    qint64 none = 0;
+    if (enabled())
+        m_pendingInputNs.compare_exchange_strong(none, now());
+}
+
+bool FrameTimingMonitor::eventFilter(QObject *watched, QEvent *event) {
+    switch (event->type()) {
+        case QEvent::TouchBegin:
+        case QEvent::TouchUpdate:
+        case QEvent::MouseButtonPress:
+        case QEvent::KeyPress: recordInput(); break;
+        default: break;
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void FrameTimingMonitor::handleFrameBegin() {
+    m_frameBeginNs = now();
+}
+
+void FrameTimingMonitor::handleAfterRendering() {
+    // QWaylandQuickOutput sends the clients' frame callbacks once the scene is rendered
+    m_previousCallbacksNs = m_callbacksSentNs;
+    m_callbacksSentNs     = now();
+}
+
+void FrameTimingMonitor::handleFrameSwapped() {
+    qint64 swapNs     = now();
+    qint64 previousNs = m_lastSwapNs;
+    m_lastSwapNs      = swapNs;
+    if (!enabled())
+        return;
+
+    FrameTiming timing;
+    timing.presentedNs = swapNs;
+    timing.intervalUs  = previousNs > 0 ? toMicroseconds(swapNs - previousNs) : 0;
+
+    // Measured from the start of this frame, so idle time between frames is not a drop
+    if (m_frameBeginNs > 0 && m_frameBeginNs <= swapNs) {
+        qint64 frameTimeNs   = swapNs - m_frameBeginNs;
+        qint64 refreshNs     = qMax<qint64>(1, m_refreshIntervalNs.load(std::memory_order_relaxed));
+        timing.frameTimeUs   = toMicroseconds(frameTimeNs);
+        timing.droppedFrames = qMax(0, qRound(qreal(frameTimeNs) / refreshNs) - 1);
+    }
+
+    qint64 commitNs = m_pendingCommitNs.exchange(0);
+    if (commitNs > 0 && commitNs <= swapNs) {
+        timing.commitToPresentUs = toMicroseconds(swapNs - commitNs);
+        if (m_previousCallbacksNs > 0 && m_previousCallbacksNs <= commitNs)
+            timing.callbackToPresentUs = toMicroseconds(swapNs - m_previousCallbacksNs);
+    }
+
+    qint64 inputNs = m_pendingInputNs.exchange(0);
+    if (inputNs > 0 && inputNs <= swapNs)
+        timing.inputToPresentUs = toMicroseconds(swapNs - inputNs);
+
+    m_ring.push(timing);
+}
+
+QVariantMap FrameTimingMonitor::summarize(int windowMs) const {
+    qint64 sinceNs = now() - qint64(qMax(1, windowMs)) * 1000000;
+
+    QVector<qint32> frameTimes, commits, callbacks, inputs;
+    int             frames  = 0;
+    int             dropped = 0;
+    for (const FrameTiming &timing : m_ring.latest(FrameTimingRing::kCapacity)) {
+        if (timing.presentedNs < sinceNs)
+            continue;
+        ++frames;
+        dropped += timing.droppedFrames;
+        frameTimes.append(timing.frameTimeUs);
+        if (timing.commitToPresentUs >= 0)
+            commits.append(timing.commitToPresentUs);
+        if (timing.callbackToPresentUs >= 0)
+            callbacks.append(timing.callbackToPresentUs);
+        if (timing.inputToPresentUs >= 0)
+            inputs.append(timing.inputToPresentUs);
+    }
+
+    QVariantMap summary;
+    summary["windowMs"]          = windowMs;
+    summary["frames"]            = frames;
+    summary["fps"]               = frames * 1000.0 / qMax(1, windowMs);
+    summary["frameTimeMs"]       = mean(frameTimes) / 1000.0;
+    summary["frameTimeP95Ms"]    = percentile(frameTimes, 0.95) / 1000.0;
+    summary["droppedFrames"]     = dropped;
+    summary["commitLatencyMs"]   = mean(commits) / 1000.0;
+    summary["callbackLatencyMs"] = mean(callbacks) / 1000.0;
+    summary["inputLatencyMs"]    = mean(inputs) / 1000.0;
+    summary["inputLatencyMaxMs"] =
+        inputs.isEmpty() ? 0.0 : *std::max_element(inputs.begin(), inputs.end()) / 1000.0;
+    summary["refreshIntervalMs"] = m_refreshIntervalNs.load() / 1000000.0;
+    summary["totalFrames"]       = m_ring.pushed();
+    return summary;
+}
+
+QVariantList FrameTimingMonitor::frameTimes(int count) const {
+    QVariantList result;
+    for (const FrameTiming &timing : m_ring.latest(count))
+        result.append(timing.frameTimeUs / 1000.0);
+    return result;
+}
+
+void FrameTimingMonitor::updateStats() {
+    QVariantMap stats = summarize(kStatsWindowMs);
+    if (stats == m_stats)
+        return;
+    m_stats = stats;
+    emit statsChanged();
+}
+
+void FrameTimingMonitor::updateRefreshInterval() {
+    qreal rate = m_window && m_window->screen() ? m_window->screen()->refreshRate() : 0.0;
+    if (rate <= 0.0)
+        rate = 60.0;
+    m_refreshIntervalNs.store(qint64(1e9 / rate));
+}
+
+qint64 FrameTimingMonitor::now() const {
+    // Never 0, which marks "nothing pending"
+    return m_clock.nsecsElapsed() + 1;
+}
@@ -0,0 +1,127 @@
+#ifndef FRAMETIMINGMONITOR_H
+#define FRAMETIMINGMONITOR_H
+
+#include "frametimingring.h"
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QVariantList>
+#include <QVariantMap>
+#include <atomic>
+
+class QQuickWindow;
+
+/**
+ * @brief Measures whether the shell makes its frame deadlines
+ *
+ * Hooks the shell window's render loop (frame start, after rendering, swap)
+ * on the render thread, input events on the GUI thread and client commits
+ * reported by the compositor. Every swap becomes one FrameTiming in a
+ * lock-free ring, so the render thread never blocks on a reader; the GUI
+ * thread summarizes the ring twice a second for QML and D-Bus.
+ *
+ * Off unless enabled (MARATHON_FRAME_TIMING=1, the overlay or D-Bus); when
+ * off the hooks return right away.
+ */
+class FrameTimingMonitor : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(bool enabled READ enabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(qreal fps READ fps NOTIFY statsChanged)
+    Q_PROPERTY(qreal frameTimeMs READ frameTimeMs NOTIFY statsChanged)
+    Q_PROPERTY(qreal frameTimeP95Ms READ frameTimeP95Ms NOTIFY statsChanged)
+    Q_PROPERTY(int droppedFrames READ droppedFrames NOTIFY statsChanged)
+    Q_PROPERTY(qreal commitLatencyMs READ commitLatencyMs NOTIFY statsChanged)
+    Q_PROPERTY(qreal callbackLatencyMs READ callbackLatencyMs NOTIFY statsChanged)
+    Q_PROPERTY(qreal inputLatencyMs READ inputLatencyMs NOTIFY statsChanged)
+    Q_PROPERTY(qreal refreshIntervalMs READ refreshIntervalMs NOTIFY statsChanged)
+
+  public:
+    static constexpr int kStatsIntervalMs = 500;
+    static constexpr int kStatsWindowMs   = 1000;
+
+    explicit FrameTimingMonitor(QObject *parent = nullptr);
+
+    // Starts measuring window's frames, replacing any window attached before
+    void attach(QQuickWindow *window);
+
+    bool enabled() const {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+    void setEnabled(bool enabled);
+
+    // Over the last kStatsWindowMs, refreshed every kStatsIntervalMs
+    qreal fps() const {
+        return m_stats.value("fps").toReal();
+    }
+    qreal frameTimeMs() const {
+        return m_stats.value("frameTimeMs").toReal();
+    }
+    qreal frameTimeP95Ms() const {
+        return m_stats.value("frameTimeP95Ms").toReal();
+    }
+    int droppedFrames() const {
+        return m_stats.value("droppedFrames").toInt();
+    }
+    qreal commitLatencyMs() const {
+        return m_stats.value("commitLatencyMs").toReal();
+    }
+    qreal callbackLatencyMs() const {
+        return m_stats.value("callbackLatencyMs").toReal();
+    }
+    qreal inputLatencyMs() const {
+        return m_stats.value("inputLatencyMs").toReal();
+    }
+    qreal refreshIntervalMs() const {
+        return m_refreshIntervalNs.load(std::memory_order_relaxed) / 1000000.0;
+    }
+
+    // Summary of the frames presented in the last windowMs
+    Q_INVOKABLE QVariantMap  summarize(int windowMs) const;
+    // Frame times in ms of the newest count frames, oldest first, for a graph
+    Q_INVOKABLE QVariantList frameTimes(int count) const;
+
+    const FrameTimingRing   &ring() const {
+        return m_ring;
+    }
+
+  public slots:
+    // A client committed new content (any thread)
+    void recordCommit();
+    // An input event reached the shell (any thread)
+    void recordInput();
+
+  signals:
+    void enabledChanged();
+    void statsChanged();
+
+  protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+  private:
+    void                   handleFrameBegin();
+    void                   handleAfterRendering();
+    void                   handleFrameSwapped();
+    void                   updateStats();
+    void                   updateRefreshInterval();
+    qint64                 now() const;
+
+    QPointer<QQuickWindow> m_window;
+    QElapsedTimer          m_clock;
+    FrameTimingRing        m_ring;
+    QTimer                 m_statsTimer;
+    QVariantMap            m_stats;
+
+    std::atomic<bool>      m_enabled{false};
+    std::atomic<qint64>    m_refreshIntervalNs{16666667};
+    std::atomic<qint64>    m_pendingCommitNs{0};
+    std::atomic<qint64>    m_pendingInputNs{0};
+
+    // Render thread only
+    qint64 m_frameBeginNs        = 0;
+    qint64 m_lastSwapNs          = 0;
+    qint64 m_callbacksSentNs     = 0; // frame callbacks went out with this frame
+    qint64 m_previousCallbacksNs = 0; // ... and with the one before, which commits answer
+};
+
+#endif // FRAMETIMINGMONITOR_H
@@ -0,0 +1,87 @@
+#ifndef FRAMETIMINGRING_H
+#define FRAMETIMINGRING_H
+
+#include <QVector>
+#include <QtGlobal>
+#include <array>
+#include <atomic>
+
+/**
+ * @brief Timing of one presented shell frame
+ *
+ * Latencies are -1 when nothing of that kind happened since the previous
+ * frame (no client commit, no input event).
+ */
+struct FrameTiming {
+    qint64 presentedNs         = 0;  // monotonic clock, when the frame was swapped
+    qint32 intervalUs          = 0;  // since the previous swap
+    qint32 frameTimeUs         = 0;  // render loop start of this frame -> swap
+    qint32 droppedFrames       = 0;  // refresh periods this frame was late by
+    qint32 callbackToPresentUs = -1; // frame callbacks sent -> swap showing the client's answer
+    qint32 commitToPresentUs   = -1; // first client commit since the last swap -> swap
+    qint32 inputToPresentUs    = -1; // first input event since the last swap -> swap
+};
+
+/**
+ * @brief Fixed-size ring of the latest frame timings, lock-free
+ *
+ * The render thread pushes one sample per frame and never waits; any thread
+ * may read at the same time. Each slot carries a sequence number that is odd
+ * while the slot is being written, so a reader that raced with the writer
+ * notices and skips the sample instead of returning a torn one.
+ */
+class FrameTimingRing {
+  public:
+    static constexpr int kCapacity = 1024; // power of two, ~17 s at 60 Hz
+
+    // Single producer
+    void push(const FrameTiming &timing) {
+        quint64 index = m_head.load(std::memory_order_relaxed);
+        Slot   &slot  = m_slots[index & kMask];
+        slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.timing = timing;
+        slot.sequence.store(2 * index + 2, std::memory_order_release);
+        m_head.store(index + 1, std::memory_order_release);
+    }
+
+    // Samples pushed since construction
+    quint64 pushed() const {
+        return m_head.load(std::memory_order_acquire);
+    }
+
+    // Up to maxCount of the newest samples, oldest first
+    QVector<FrameTiming> latest(int maxCount) const {
+        quint64 head  = m_head.load(std::memory_order_acquire);
+        quint64 count = qMin<quint64>(head, quint64(qBound(0, maxCount, kCapacity)));
+
+        QVector<FrameTiming> result;
+        result.reserve(int(count));
+        for (quint64 index = head - count; index < head; ++index) {
+            const Slot &slot   = m_slots[index & kMask];
+            quint64     before = slot.sequence.load(std::memory_order_acquire);
+            if (before != 2 * index + 2)
+                continue; // being written or already overwritten
+
+            FrameTiming timing = slot.timing;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != before)
+                continue;
+            result.append(timing);
+        }
+        return result;
+    }
+
+  private:
+    static constexpr quint64 kMask = kCapacity - 1;
+
+    struct Slot {
+        std::atomic<quint64> sequence{0};
+        FrameTiming          timing;
+    };
+
+    std::array<Slot, kCapacity> m_slots;
+    std::atomic<quint64>        m_head{0};
+};
+
+#endif // FRAMETIMINGRING_H
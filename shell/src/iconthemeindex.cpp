@@ -0,0 +1,292 @@
+#include "iconthemeindex.h"
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <climits>
+#include <cstdlib>
+#include <iterator>
+#include <sys/stat.h>
+
+namespace {
+    // Preference order inside one directory, as in the Icon Theme Specification
+    const char *const kExtensions[] = {".png", ".svg", ".xpm"};
+
+    qint64            directoryMtime(const QString &path) {
+        struct stat st;
+        if (::stat(QFile::encodeName(path).constData(), &st) != 0 || !S_ISDIR(st.st_mode))
+            return -1;
+        return qint64(st.st_mtim.tv_sec) * 1'000'000'000 + st.st_mtim.tv_nsec;
+    }
+} // namespace
+
+IconThemeIndex::IconThemeIndex(const QString &theme)
+    : m_theme(theme.isEmpty() ? QStringLiteral("hicolor") : theme)
+    , m_built(false) {
+    setDataDirectories(QStandardPaths::standardLocations(QStandardPaths::GenericDataLocation));
+    m_iconRoots.prepend(QDir::homePath() + "/.icons");
+}
+
+void IconThemeIndex::setTheme(const QString &theme) {
+    const QString name = theme.isEmpty() ? QStringLiteral("hicolor") : theme;
+    if (name != m_theme) {
+        m_theme = name;
+        m_built = false;
+    }
+}
+
+void IconThemeIndex::setDataDirectories(const QStringList &dirs) {
+    m_iconRoots.clear();
+    m_pixmapDirs.clear();
+    for (const QString &dir : dirs) {
+        m_iconRoots.append(dir + "/icons");
+        m_pixmapDirs.append(dir + "/pixmaps");
+    }
+    m_built = false;
+}
+
+void IconThemeIndex::refresh() {
+    if (!m_built || isStale())
+        build();
+}
+
+bool IconThemeIndex::isStale() const {
+    for (auto it = m_watched.cbegin(); it != m_watched.cend(); ++it) {
+        if (directoryMtime(it.key()) != it.value())
+            return true;
+    }
+    return false;
+}
+
+void IconThemeIndex::watch(const QString &path) {
+    m_watched.insert(path, directoryMtime(path));
+}
+
+QString IconThemeIndex::themeIndexPath(const QString &theme) const {
+    for (const QString &root : m_iconRoots) {
+        const QString path = root + '/' + theme + "/index.theme";
+        if (QFile::exists(path))
+            return path;
+    }
+    return QString();
+}
+
+IconThemeIndex::IniGroups IconThemeIndex::readIni(const QString &path) {
+    IniGroups groups;
+    QFile     file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return groups;
+
+    QTextStream in(&file);
+    QString     group;
+    while (!in.atEnd()) {
+        const QString line = in.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith('#'))
+            continue;
+
+        if (line.startsWith('[') && line.endsWith(']')) {
+            group = line.mid(1, line.size() - 2);
+            continue;
+        }
+
+        const int eqPos = line.indexOf('=');
+        if (eqPos > 0)
+            groups[group].insert(line.left(eqPos).trimmed(), line.mid(eqPos + 1).trimmed());
+    }
+    return groups;
+}
+
+QStringList IconThemeIndex::themeDirectories(const QString   &theme,
+                                             const IniGroups &index) const {
+    QStringList dirs =
+        index.value("Icon Theme").value("Directories").split(',', Qt::SkipEmptyParts);
+    for (QString &dir : dirs)
+        dir = dir.trimmed();
+    if (!dirs.isEmpty())
+        return dirs;
+
+    // No index.theme (a bare hicolor tree): take "<size>/<context>" as it is on disk
+    for (const QString &root : m_iconRoots) {
+        const QDir themeDir(root + '/' + theme);
+        for (const QString &size : themeDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+            for (const QString &context :
+                 QDir(themeDir.filePath(size)).entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+                const QString dir = size + '/' + context;
+                if (!dirs.contains(dir))
+                    dirs.append(dir);
+            }
+        }
+    }
+    return dirs;
+}
+
+void IconThemeIndex::build() {
+    QElapsedTimer timer;
+    timer.start();
+
+    m_chain.clear();
+    m_directories.clear();
+    m_icons.clear();
+    m_watched.clear();
+
+    // Depth-first through Inherits=, each theme once, hicolor always last
+    QHash<QString, IniGroups> indexes;
+    QStringList               pending{m_theme};
+    while (!pending.isEmpty()) {
+        const QString theme = pending.takeFirst();
+        if (m_chain.contains(theme) || theme == "hicolor")
+            continue;
+
+        const QString indexPath = themeIndexPath(theme);
+        if (indexPath.isEmpty()) {
+            qDebug() << "[IconThemeIndex] Icon theme not installed:" << theme;
+            continue;
+        }
+
+        m_chain.append(theme);
+        indexes.insert(theme, readIni(indexPath));
+        const QStringList parents =
+            indexes[theme].value("Icon Theme").value("Inherits").split(',', Qt::SkipEmptyParts);
+        for (qsizetype i = parents.size(); i-- > 0;)
+            pending.prepend(parents.at(i).trimmed());
+    }
+    m_chain.append("hicolor");
+    indexes.insert("hicolor", readIni(themeIndexPath("hicolor")));
+
+    for (int rank = 0; rank < m_chain.size(); ++rank) {
+        const QString   &theme = m_chain.at(rank);
+        const IniGroups &index = indexes[theme];
+
+        // Picks up a theme directory that appears later, e.g. in ~/.local/share/icons
+        for (const QString &root : std::as_const(m_iconRoots))
+            watch(root + '/' + theme);
+
+        for (const QString &subdir : themeDirectories(theme, index)) {
+            const QHash<QString, QString> group = index.value(subdir);
+            if (group.value("Scale", "1").toInt() != 1)
+                continue;
+
+            Directory dir;
+            dir.theme = rank;
+            dir.size  = group.value("Size", subdir.section('x', 0, 0)).toInt();
+            if (dir.size <= 0 && !subdir.startsWith("scalable"))
+                continue;
+
+            const QString type = group.value("Type");
+            if (type == "Fixed")
+                dir.type = SizeType::Fixed;
+            else if (type == "Scalable" || (group.isEmpty() && subdir.startsWith("scalable")))
+                dir.type = SizeType::Scalable;
+            else
+                dir.type = SizeType::Threshold;
+
+            dir.minSize   = group.value("MinSize", QString::number(dir.size)).toInt();
+            dir.maxSize   = group.value("MaxSize", QString::number(dir.size)).toInt();
+            dir.threshold = group.value("Threshold", "2").toInt();
+            if (group.isEmpty() && dir.type == SizeType::Scalable)
+                dir.maxSize = INT_MAX; // guessed from the tree: any size will do
+
+            // Same sub-directory in every root before the next one, so earlier roots win ties
+            for (const QString &root : std::as_const(m_iconRoots)) {
+                dir.path = root + '/' + theme + '/' + subdir;
+                if (directoryMtime(dir.path) >= 0)
+                    indexDirectory(dir);
+            }
+        }
+    }
+
+    // Unthemed icons are the last resort
+    Directory fallback;
+    fallback.theme = static_cast<int>(m_chain.size());
+    fallback.type  = SizeType::Fallback;
+    for (const QString &path : std::as_const(m_pixmapDirs)) {
+        fallback.path = path;
+        watch(path);
+        if (m_watched.value(path) >= 0)
+            indexDirectory(fallback);
+    }
+
+    m_built = true;
+    qDebug() << "[IconThemeIndex] Indexed" << m_icons.size() << "icons from" << m_chain << "in"
+             << m_directories.size() << "directories," << timer.elapsed() << "ms";
+}
+
+void IconThemeIndex::indexDirectory(const Directory &dir) {
+    const int index = static_cast<int>(m_directories.size());
+    m_directories.append(dir);
+    watch(dir.path);
+
+    const QStringList files = QDir(dir.path).entryList(QDir::Files);
+    for (const QString &file : files) {
+        int extension = -1;
+        for (int i = 0; i < int(std::size(kExtensions)); ++i) {
+            if (file.endsWith(QLatin1String(kExtensions[i]))) {
+                extension = i;
+                break;
+            }
+        }
+        if (extension < 0)
+            continue;
+
+        QList<Icon> &icons = m_icons[file.chopped(qstrlen(kExtensions[extension]))];
+        if (!icons.isEmpty() && icons.last().directory == index) {
+            // Same icon in another format; keep the preferred one
+            if (extension < icons.last().extension)
+                icons.last().extension = extension;
+            continue;
+        }
+        icons.append({index, extension});
+    }
+}
+
+int IconThemeIndex::sizeDistance(const Directory &dir, int size) {
+    switch (dir.type) {
+    case SizeType::Fixed:
+        return std::abs(dir.size - size);
+    case SizeType::Scalable:
+        if (size < dir.minSize)
+            return dir.minSize - size;
+        if (size > dir.maxSize)
+            return size - dir.maxSize;
+        return 0;
+    case SizeType::Threshold:
+        if (size < dir.size - dir.threshold)
+            return dir.minSize - size;
+        if (size > dir.size + dir.threshold)
+            return size - dir.maxSize;
+        return 0;
+    case SizeType::Fallback:
+        break;
+    }
+    return INT_MAX;
+}
+
+QString IconThemeIndex::lookup(const QString &name, int size) {
+    if (!m_built)
+        build();
+
+    const auto it = m_icons.constFind(name);
+    if (it == m_icons.constEnd())
+        return QString();
+
+    // Lower theme rank first, then the closest size; the first directory wins ties
+    const Icon *best         = nullptr;
+    int         bestTheme    = INT_MAX;
+    int         bestDistance = INT_MAX;
+    for (const Icon &icon : *it) {
+        const Directory &dir = m_directories.at(icon.directory);
+        if (dir.theme > bestTheme)
+            continue;
+        const int distance = sizeDistance(dir, size);
+        if (!best || dir.theme < bestTheme || distance < bestDistance) {
+            best         = &icon;
+            bestTheme    = dir.theme;
+            bestDistance = distance;
+        }
+    }
+
+    return m_directories.at(best->directory).path + '/' + name +
+        QLatin1String(kExtensions[best->extension]);
+}
@@ -0,0 +1,97 @@
+#ifndef ICONTHEMEINDEX_H
+#define ICONTHEMEINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief Name-to-file index of the installed freedesktop icon themes
+ *
+ * Every directory of the current theme, the themes it inherits from,
+ * hicolor and the pixmaps directory is listed once; after that an icon
+ * lookup is a hash lookup instead of a stat() per candidate path.
+ *
+ * Lookups follow the Icon Theme Specification: the first theme in the
+ * inheritance chain that has the icon wins, and within it the directory
+ * whose size matches best (exact, then within MinSize/MaxSize or Threshold,
+ * then the closest size). Inside one directory .png beats .svg beats .xpm.
+ *
+ * The index remembers the mtime of every directory it read. refresh() stats
+ * only those directories and rebuilds if an icon was installed or removed.
+ */
+class IconThemeIndex {
+  public:
+    explicit IconThemeIndex(const QString &theme = QStringLiteral("hicolor"));
+
+    QString theme() const {
+        return m_theme;
+    }
+    void setTheme(const QString &theme);
+
+    /**
+     * @brief XDG data directories to search, most important first
+     *
+     * Themes are looked up in <dir>/icons and fallback icons in <dir>/pixmaps.
+     * Defaults to ~/.icons plus the GenericDataLocation directories.
+     */
+    void setDataDirectories(const QStringList &dirs);
+
+    /**
+     * @brief Path of the best icon for name at the requested pixel size
+     *
+     * Builds the index on first use; later calls never touch the disk.
+     * @return Absolute file path, or an empty string if no theme has the icon
+     */
+    QString lookup(const QString &name, int size);
+
+    // Rebuild if any indexed directory changed since the index was built
+    void refresh();
+
+    // Themes searched, in order: the theme, its parents depth-first, then hicolor
+    QStringList themeChain() const {
+        return m_chain;
+    }
+
+  private:
+    enum class SizeType { Fixed, Scalable, Threshold, Fallback };
+
+    struct Directory {
+        QString  path;
+        int      theme     = 0; // position in the theme chain, lower wins
+        SizeType type      = SizeType::Threshold;
+        int      size      = 0;
+        int      minSize   = 0;
+        int      maxSize   = 0;
+        int      threshold = 2;
+    };
+
+    struct Icon {
+        int directory; // index into m_directories
+        int extension; // index into the extension list, lower wins
+    };
+
+    using IniGroups = QHash<QString, QHash<QString, QString>>;
+
+    void                        build();
+    bool                        isStale() const;
+    void                        watch(const QString &path);
+    void                        indexDirectory(const Directory &dir);
+    QString                     themeIndexPath(const QString &theme) const;
+    QStringList                 themeDirectories(const QString   &theme,
+                                                 const IniGroups &index) const;
+    static IniGroups            readIni(const QString &path);
+    static int                  sizeDistance(const Directory &dir, int size);
+
+    QString                     m_theme;
+    QStringList                 m_iconRoots;
+    QStringList                 m_pixmapDirs;
+    QStringList                 m_chain;
+    QList<Directory>            m_directories;
+    QHash<QString, QList<Icon>> m_icons;   // keyed by icon name
+    QHash<QString, qint64>      m_watched; // directory -> mtime (ns), -1 if it did not exist
+    bool                        m_built;
+};
+
+#endif // ICONTHEMEINDEX_H
@@ -0,0 +1,211 @@
+#include "launchhistory.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTimer>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr int kFileVersion = 1;
+    constexpr int kSaveDelayMs = 5000;
+
+    // Launch counts halve every week, the recency bonus every hour
+    constexpr double kCountHalfLifeMs   = 7.0 * 24 * 60 * 60 * 1000;
+    constexpr double kRecencyHalfLifeMs = 60.0 * 60 * 1000;
+
+    // About one launch a month ago; anything less is dropped when the history is loaded
+    constexpr double kMinWeight = 0.05;
+} // namespace
+
+LaunchHistory::LaunchHistory(QObject *parent)
+    : LaunchHistory(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) +
+                        "/launch-history.json",
+                    parent) {}
+
+LaunchHistory::LaunchHistory(const QString &filePath, QObject *parent)
+    : QObject(parent)
+    , m_filePath(filePath)
+    , m_saveTimer(new QTimer(this))
+    , m_dirty(false) {
+    m_saveTimer->setSingleShot(true);
+    m_saveTimer->setInterval(kSaveDelayMs);
+    connect(m_saveTimer, &QTimer::timeout, this, &LaunchHistory::save);
+
+    load();
+}
+
+LaunchHistory::~LaunchHistory() {
+    save();
+}
+
+double LaunchHistory::decay(qint64 fromMs, qint64 toMs, double halfLifeMs) {
+    if (toMs <= fromMs)
+        return 1.0;
+    return std::exp2(-double(toMs - fromMs) / halfLifeMs);
+}
+
+void LaunchHistory::recordLaunch(const QString &appId) {
+    recordLaunch(appId, QDateTime::currentDateTime());
+}
+
+void LaunchHistory::recordLaunch(const QString &appId, const QDateTime &when) {
+    if (appId.isEmpty())
+        return;
+
+    const qint64 now   = when.toMSecsSinceEpoch();
+    const int    hour  = when.time().hour();
+    Entry       &entry = m_entries[appId];
+
+    // Bring the count and the histogram up to now, then add this launch
+    const double factor = decay(entry.updated, now, kCountHalfLifeMs);
+    for (int h = 0; h < 24; ++h)
+        entry.hours[h] = entry.hours[h] * factor + (h == hour ? 1.0 : 0.0);
+    entry.weight       = entry.weight * factor + 1.0;
+    entry.updated      = std::max(entry.updated, now);
+    entry.lastLaunched = std::max(entry.lastLaunched, now);
+
+    scheduleSave();
+    emit launchRecorded(appId);
+    emit historyChanged();
+}
+
+double LaunchHistory::score(const QString &appId) const {
+    return score(appId, QDateTime::currentDateTime());
+}
+
+double LaunchHistory::score(const QString &appId, const QDateTime &at) const {
+    const auto it = m_entries.constFind(appId);
+    if (it == m_entries.constEnd() || it->weight <= 0)
+        return 0;
+
+    const qint64 now    = at.toMSecsSinceEpoch();
+    const double weight = it->weight * decay(it->updated, now, kCountHalfLifeMs);
+
+    // Launches around this hour of day, the neighbouring hours counting half
+    const int    hour   = at.time().hour();
+    const double around = it->hours[hour] +
+        0.5 * (it->hours[(hour + 23) % 24] + it->hours[(hour + 1) % 24]);
+
+    return weight * (1.0 + around / it->weight) +
+        decay(it->lastLaunched, now, kRecencyHalfLifeMs);
+}
+
+QStringList LaunchHistory::topApps(int count) const {
+    return topApps(count, QDateTime::currentDateTime());
+}
+
+QStringList LaunchHistory::topApps(int count, const QDateTime &at) const {
+    QVector<QPair<double, QString>> ranked;
+    ranked.reserve(m_entries.size());
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it)
+        ranked.append({score(it.key(), at), it.key()});
+
+    // Highest score first, ties by id so the order is stable
+    const auto byScore = [](const QPair<double, QString> &a, const QPair<double, QString> &b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    };
+    if (count > 0 && count < ranked.size()) {
+        std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(), byScore);
+        ranked.resize(count);
+    } else {
+        std::sort(ranked.begin(), ranked.end(), byScore);
+    }
+
+    QStringList apps;
+    apps.reserve(ranked.size());
+    for (const auto &entry : std::as_const(ranked))
+        apps.append(entry.second);
+    return apps;
+}
+
+void LaunchHistory::forget(const QString &appId) {
+    if (m_entries.remove(appId) > 0) {
+        scheduleSave();
+        emit historyChanged();
+    }
+}
+
+void LaunchHistory::clear() {
+    if (m_entries.isEmpty())
+        return;
+    m_entries.clear();
+    scheduleSave();
+    emit historyChanged();
+}
+
+void LaunchHistory::scheduleSave() {
+    m_dirty = true;
+    m_saveTimer->start();
+}
+
+void LaunchHistory::load() {
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value("version").toInt() != kFileVersion) {
+        qWarning() << "[LaunchHistory] Ignoring unreadable launch history:" << m_filePath;
+        return;
+    }
+
+    const qint64      now  = QDateTime::currentMSecsSinceEpoch();
+    const QJsonObject apps = root.value("apps").toObject();
+    for (auto it = apps.constBegin(); it != apps.constEnd(); ++it) {
+        const QJsonObject app   = it.value().toObject();
+        const QJsonArray  hours = app.value("hours").toArray();
+        Entry             entry;
+        entry.weight       = app.value("weight").toDouble();
+        entry.updated      = app.value("updated").toInteger();
+        entry.lastLaunched = app.value("lastLaunched").toInteger();
+        for (int h = 0; h < 24 && h < hours.size(); ++h)
+            entry.hours[h] = hours.at(h).toDouble();
+
+        if (entry.weight * decay(entry.updated, now, kCountHalfLifeMs) >= kMinWeight)
+            m_entries.insert(it.key(), entry);
+        else
+            m_dirty = true;
+    }
+
+    qDebug() << "[LaunchHistory] Loaded launch history for" << m_entries.size() << "apps";
+}
+
+void LaunchHistory::save() {
+    m_saveTimer->stop();
+    if (!m_dirty)
+        return;
+
+    QJsonObject apps;
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        QJsonArray hours;
+        for (double hour : it->hours)
+            hours.append(hour);
+
+        QJsonObject app;
+        app["weight"]       = it->weight;
+        app["updated"]      = it->updated;
+        app["lastLaunched"] = it->lastLaunched;
+        app["hours"]        = hours;
+        apps[it.key()]      = app;
+    }
+    QJsonObject root;
+    root["version"] = kFileVersion;
+    root["apps"]    = apps;
+
+    QDir().mkpath(QFileInfo(m_filePath).absolutePath());
+    QSaveFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "[LaunchHistory] Cannot write launch history:" << m_filePath;
+        return;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    if (file.commit())
+        m_dirty = false;
+}
@@ -0,0 +1,86 @@
+#ifndef LAUNCHHISTORY_H
+#define LAUNCHHISTORY_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <array>
+
+class QTimer;
+
+/**
+ * @brief Persistent record of which apps are launched, how often and when
+ *
+ * Every launch adds one to an app's count, and counts decay with a half-life
+ * of a week, so an app used daily this month outranks one used daily last
+ * year. Launches are also binned by hour of day (decaying the same way), and
+ * the time since the last launch gives a short-lived recency bonus.
+ *
+ * score() combines the three for a given moment; topApps() ranks by it. The
+ * loader uses the ranking to preload likely apps and QML can use it for the
+ * "frequent apps" row.
+ *
+ * The history is a small JSON file, written a few seconds after the last
+ * change and when the object is destroyed.
+ */
+class LaunchHistory : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY historyChanged)
+
+  public:
+    // Stored in AppDataLocation
+    explicit LaunchHistory(QObject *parent = nullptr);
+    explicit LaunchHistory(const QString &filePath, QObject *parent = nullptr);
+    ~LaunchHistory() override;
+
+    // Number of apps with any launches left
+    int count() const {
+        return static_cast<int>(m_entries.size());
+    }
+
+    Q_INVOKABLE void recordLaunch(const QString &appId);
+    void             recordLaunch(const QString &appId, const QDateTime &when);
+
+    // Likelihood that the app is launched next; 0 for apps never launched
+    Q_INVOKABLE double score(const QString &appId) const;
+    double             score(const QString &appId, const QDateTime &at) const;
+
+    /**
+     * @brief App ids ordered by score, most likely first
+     * @param count Maximum number of ids, 0 for all
+     */
+    Q_INVOKABLE QStringList topApps(int count) const;
+    QStringList             topApps(int count, const QDateTime &at) const;
+
+    // Drop an app, e.g. when it is uninstalled
+    Q_INVOKABLE void forget(const QString &appId);
+    Q_INVOKABLE void clear();
+
+    // Write pending changes now
+    void save();
+
+  signals:
+    void launchRecorded(const QString &appId);
+    void historyChanged();
+
+  private:
+    struct Entry {
+        double                 weight       = 0; // decayed launch count as of `updated`
+        qint64                 updated      = 0; // ms since epoch
+        qint64                 lastLaunched = 0; // ms since epoch
+        std::array<double, 24> hours{};          // weight per hour of day, sums to `weight`
+    };
+
+    static double         decay(qint64 fromMs, qint64 toMs, double halfLifeMs);
+    void                  load();
+    void                  scheduleSave();
+
+    QString               m_filePath;
+    QHash<QString, Entry> m_entries;
+    QTimer               *m_saveTimer;
+    bool                  m_dirty;
+};
+
+#endif // LAUNCHHISTORY_H
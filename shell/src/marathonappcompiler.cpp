@@ -0,0 +1,286 @@
+#include "marathonappcompiler.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QUrl>
+#include <algorithm>
+
+namespace {
+    constexpr int kStampVersion = 1;
+
+    bool          isSource(const QFileInfo &file) {
+        const QString suffix = file.suffix();
+        return suffix == "qml" || suffix == "js" || suffix == "mjs" || file.fileName() == "qmldir";
+    }
+
+    bool isNativeCode(const QFileInfo &file) {
+        const QString suffix = file.suffix();
+        return suffix == "so" || suffix == "dylib" || suffix == "dll";
+    }
+} // namespace
+
+MarathonAppCompiler::MarathonAppCompiler(MarathonAppRegistry *registry,
+                                         MarathonImportPaths *importPaths, QObject *parent)
+    : QObject(parent)
+    , m_registry(registry)
+    , m_importPaths(importPaths)
+    , m_engine(importPaths->engine())
+    , m_stampDirectory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+                       "/marathon-apps")
+    , m_busy(false)
+    , m_pending(0)
+    , m_errors(0) {
+    m_hashPool.setMaxThreadCount(1);
+}
+
+MarathonAppCompiler::~MarathonAppCompiler() {
+    m_queue.clear();
+    m_hashPool.waitForDone();
+}
+
+void MarathonAppCompiler::setStampDirectory(const QString &path) {
+    m_stampDirectory = path;
+    m_compiled.clear();
+}
+
+void MarathonAppCompiler::compileApp(const QString &appId) {
+    m_compiled.remove(appId);
+    if (!m_queue.contains(appId))
+        m_queue.append(appId);
+    startNext();
+}
+
+void MarathonAppCompiler::compileAll() {
+    const MarathonAppRegistry::SnapshotPtr snapshot = m_registry->snapshot();
+    for (const MarathonAppRegistry::AppPtr &app : snapshot->apps) {
+        if (!m_compiled.contains(app->id) && !m_queue.contains(app->id))
+            m_queue.append(app->id);
+    }
+    startNext();
+}
+
+bool MarathonAppCompiler::isCompiled(const QString &appId) const {
+    return m_compiled.contains(appId);
+}
+
+QString MarathonAppCompiler::stampPath(const QString &appId) const {
+    return m_stampDirectory + "/" + appId + ".json";
+}
+
+void MarathonAppCompiler::startNext() {
+    while (!m_busy && !m_queue.isEmpty()) {
+        const QString                       appId   = m_queue.takeFirst();
+        const MarathonAppRegistry::AppInfo *appInfo = m_registry->getAppInfo(appId);
+        if (!appInfo || appInfo->absolutePath.isEmpty())
+            continue;
+
+        // Hashing reads every source file; keep it off the GUI thread
+        const QString appPath = appInfo->absolutePath;
+        m_busy                = true;
+        m_hashPool.start([this, appId, appPath]() {
+            const Job job = hashSources(appId, appPath);
+            QMetaObject::invokeMethod(
+                this, [this, job]() { compile(job); }, Qt::QueuedConnection);
+        });
+    }
+}
+
+MarathonAppCompiler::Job MarathonAppCompiler::hashSources(const QString &appId,
+                                                          const QString &appPath) {
+    Job job;
+    job.appId   = appId;
+    job.appPath = appPath;
+
+    const QDir   appDir(appPath);
+    QDirIterator it(appPath, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        const QFileInfo info = it.fileInfo();
+        if (isNativeCode(info)) {
+            job.hasNativeCode = true;
+            continue;
+        }
+        if (!isSource(info))
+            continue;
+
+        QFile file(info.filePath());
+        if (!file.open(QIODevice::ReadOnly))
+            continue;
+        QCryptographicHash hash(QCryptographicHash::Sha256);
+        hash.addData(&file);
+
+        SourceFile source;
+        source.sha256 = hash.result().toHex();
+        source.mtime  = info.lastModified().toMSecsSinceEpoch();
+        job.sources.insert(appDir.relativeFilePath(info.filePath()), source);
+    }
+    return job;
+}
+
+bool MarathonAppCompiler::sameSources(const Sources &a, const Sources &b) {
+    if (a.size() != b.size())
+        return false;
+    for (auto it = a.cbegin(); it != a.cend(); ++it) {
+        const auto other = b.constFind(it.key());
+        if (other == b.cend() || other->sha256 != it->sha256 || other->mtime != it->mtime)
+            return false;
+    }
+    return true;
+}
+
+void MarathonAppCompiler::compile(Job job) {
+    if (job.hasNativeCode) {
+        qDebug() << "[MarathonAppCompiler] Skipping app with native code:" << job.appId;
+        m_busy = false;
+        startNext();
+        return;
+    }
+
+    const Sources stamp = readStamp(job.appId);
+    if (!job.sources.isEmpty() && sameSources(job.sources, stamp)) {
+        qDebug() << "[MarathonAppCompiler] Compiled units up to date:" << job.appId;
+        m_compiled.insert(job.appId);
+        m_busy = false;
+        emit appCompiled(job.appId, 0, 0);
+        startNext();
+        return;
+    }
+
+    // The engine validates its units by mtime only; make it notice content changes
+    for (auto it = job.sources.begin(); it != job.sources.end(); ++it) {
+        const auto old = stamp.constFind(it.key());
+        if (old == stamp.cend() || old->sha256 == it->sha256 || old->mtime != it->mtime)
+            continue;
+
+        QFile file(job.appPath + "/" + it.key());
+        if (file.open(QIODevice::ReadWrite) &&
+            file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime)) {
+            it->mtime = QFileInfo(file.fileName()).lastModified().toMSecsSinceEpoch();
+        } else {
+            qWarning() << "[MarathonAppCompiler] Changed file keeps its old timestamp, a stale"
+                       << "compiled unit may be used:" << file.fileName();
+        }
+    }
+
+    // Same import paths the loader gives apps
+    m_importPaths->addSharedPaths();
+    m_importPaths->acquireAppPath(job.appPath);
+
+    qDebug() << "[MarathonAppCompiler] Compiling" << job.appId;
+    m_job    = std::move(job);
+    m_errors = 0;
+
+    // Loading a component compiles it and every type it uses, and writes the units to the
+    // engine's disk cache; nothing is instantiated
+    QList<QQmlComponent *> components;
+    for (auto it = m_job.sources.cbegin(); it != m_job.sources.cend(); ++it) {
+        if (!it.key().endsWith(".qml"))
+            continue;
+        const QUrl url = QUrl::fromLocalFile(m_job.appPath + "/" + it.key());
+        components.append(new QQmlComponent(m_engine, url, QQmlComponent::Asynchronous, this));
+    }
+
+    m_pending = static_cast<int>(components.size());
+    if (components.isEmpty()) {
+        finishApp();
+        return;
+    }
+    for (QQmlComponent *component : std::as_const(components)) {
+        if (component->isLoading()) {
+            connect(component, &QQmlComponent::statusChanged, this,
+                    [this, component]() { componentFinished(component); });
+        } else {
+            componentFinished(component);
+        }
+    }
+}
+
+void MarathonAppCompiler::componentFinished(QQmlComponent *component) {
+    if (component->isLoading())
+        return;
+
+    if (component->isError()) {
+        // Not fatal: a file may only be meant to be used from another one
+        ++m_errors;
+        qDebug() << "[MarathonAppCompiler]" << m_job.appId << component->url().fileName()
+                 << "did not compile:" << component->errorString();
+    }
+    disconnect(component, nullptr, this, nullptr);
+    component->deleteLater();
+
+    if (--m_pending == 0)
+        finishApp();
+}
+
+void MarathonAppCompiler::finishApp() {
+    const int files = static_cast<int>(
+        std::count_if(m_job.sources.keyBegin(), m_job.sources.keyEnd(),
+                      [](const QString &path) { return path.endsWith(".qml"); }));
+    qDebug() << "[MarathonAppCompiler] Compiled" << m_job.appId << ":" << files << "files,"
+             << m_errors << "errors";
+
+    // Errors are in the sources, compiling again would not help
+    writeStamp(m_job);
+    m_importPaths->releaseAppPath(m_job.appPath);
+    m_compiled.insert(m_job.appId);
+    m_busy = false;
+    emit appCompiled(m_job.appId, files, m_errors);
+
+    // The units are on disk now; the in-memory copies can go until the app is launched
+    m_engine->trimComponentCache();
+
+    QMetaObject::invokeMethod(this, [this]() { startNext(); }, Qt::QueuedConnection);
+}
+
+MarathonAppCompiler::Sources MarathonAppCompiler::readStamp(const QString &appId) const {
+    Sources sources;
+    QFile   file(stampPath(appId));
+    if (!file.open(QIODevice::ReadOnly))
+        return sources;
+
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value("version").toInt() != kStampVersion ||
+        root.value("qt").toString() != QLatin1String(qVersion()))
+        return sources;
+
+    const QJsonObject files = root.value("files").toObject();
+    for (auto it = files.constBegin(); it != files.constEnd(); ++it) {
+        const QJsonObject entry = it.value().toObject();
+        SourceFile        source;
+        source.sha256 = entry.value("sha256").toString().toLatin1();
+        source.mtime  = entry.value("mtime").toInteger();
+        sources.insert(it.key(), source);
+    }
+    return sources;
+}
+
+void MarathonAppCompiler::writeStamp(const Job &job) const {
+    QJsonObject files;
+    for (auto it = job.sources.cbegin(); it != job.sources.cend(); ++it) {
+        QJsonObject entry;
+        entry["sha256"] = QString::fromLatin1(it->sha256);
+        entry["mtime"]  = it->mtime;
+        files[it.key()] = entry;
+    }
+    QJsonObject root;
+    root["version"] = kStampVersion;
+    root["qt"]      = QString::fromLatin1(qVersion());
+    root["files"]   = files;
+
+    QDir().mkpath(m_stampDirectory);
+    QSaveFile file(stampPath(job.appId));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "[MarathonAppCompiler] Cannot write stamp:" << file.fileName();
+        return;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    file.commit();
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QQmlComponent>
+#include <QQmlEngine>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include "marathonappregistry.h"
+#include "marathonimportpaths.h"
+
+/**
+ * @brief Compiles Marathon apps' QML before they are first launched
+ *
+ * The QML engine keeps compiled units (.qmlc) in its disk cache. When a
+ * file's modification time still matches its unit, the engine maps the unit
+ * instead of parsing and compiling the file again. This class fills that
+ * cache when an app is installed, updated or first discovered. It loads
+ * every QML file of the app once through the shell's engine but never
+ * instantiates it.
+ *
+ * Each compiled app gets a stamp file. The stamp records the Qt version
+ * and the SHA-256 and mtime of every QML, JavaScript and qmldir file. An
+ * app whose stamp still matches is not compiled again. If a file's contents
+ * changed but its mtime did not (e.g. a copy that kept the old timestamp),
+ * the file is touched first. Otherwise the engine would keep using the
+ * stale unit.
+ *
+ * Apps that ship native plugins are skipped: they run in their own process,
+ * and loading them here would load their plugins into the shell.
+ */
+class MarathonAppCompiler : public QObject {
+    Q_OBJECT
+
+  public:
+    // Compiles with importPaths' engine, holding the app's directory as an import path meanwhile
+    explicit MarathonAppCompiler(MarathonAppRegistry *registry, MarathonImportPaths *importPaths,
+                                 QObject *parent = nullptr);
+    ~MarathonAppCompiler() override;
+
+    // Queue one app; sources are hashed on a worker thread, apps are compiled one at a time
+    Q_INVOKABLE void compileApp(const QString &appId);
+
+    // Queue every registered app; the ones whose stamp matches are skipped
+    Q_INVOKABLE void compileAll();
+
+    // True once the app's compiled units are known to match its sources
+    Q_INVOKABLE bool isCompiled(const QString &appId) const;
+
+    // Where the stamps are kept (defaults to <CacheLocation>/marathon-apps)
+    QString stampDirectory() const {
+        return m_stampDirectory;
+    }
+    void    setStampDirectory(const QString &path);
+
+  signals:
+    // compiledFiles is 0 if the stamp matched and nothing had to be compiled
+    void appCompiled(const QString &appId, int compiledFiles, int errors);
+
+  private:
+    struct SourceFile {
+        QByteArray sha256;
+        qint64     mtime = 0; // ms since epoch
+    };
+    using Sources = QHash<QString, SourceFile>; // keyed by path relative to the app
+
+    struct Job {
+        QString appId;
+        QString appPath;
+        Sources sources;
+        bool    hasNativeCode = false;
+    };
+
+    // Reads the app directory; runs on the worker thread
+    static Job           hashSources(const QString &appId, const QString &appPath);
+    static bool          sameSources(const Sources &a, const Sources &b);
+
+    void                 startNext();
+    void                 compile(Job job);
+    void                 componentFinished(QQmlComponent *component);
+    void                 finishApp();
+    Sources              readStamp(const QString &appId) const;
+    void                 writeStamp(const Job &job) const;
+    QString              stampPath(const QString &appId) const;
+
+    MarathonAppRegistry *m_registry;
+    MarathonImportPaths *m_importPaths;
+    QQmlEngine          *m_engine;
+    QString              m_stampDirectory;
+    QStringList          m_queue;
+    QSet<QString>        m_compiled;
+    bool                 m_busy;
+    Job                  m_job;     // app being compiled
+    int                  m_pending; // components of m_job still loading
+    int                  m_errors;
+    QThreadPool          m_hashPool;
+};
@@ -173,8 +173,8 @@ bool MarathonAppInstaller::installFromDirectory(const QString &sourcePath) {
 
     emit installProgress(appId, 90);
 
-    // Rescan applications
-    m_scanner->scanApplications();
+    // Register just this app; the rest of the registry is untouched
+    m_scanner->rescanApp(destPath);
 
     emit installProgress(appId, 100);
     emit installComplete(appId);
@@ -284,8 +284,8 @@ bool MarathonAppInstaller::installFromPackage(const QString &packagePath) {
 
     emit installProgress(appId, 90);
 
-    // Rescan applications
-    m_scanner->scanApplications();
+    // Register just this app; the rest of the registry is untouched
+    m_scanner->rescanApp(destPath);
 
     emit installProgress(appId, 100);
     emit installComplete(appId);
@@ -330,8 +330,8 @@ bool MarathonAppInstaller::uninstallApp(const QString &appId) {
         return false;
     }
 
-    // Rescan to update registry
-    m_scanner->scanApplications();
+    // Unregister just this app
+    m_scanner->rescanApp(appPath);
 
     emit uninstallComplete(appId);
 
@@ -0,0 +1,144 @@
+#include "marathonappinstancepool.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QQmlEngine>
+#include <QVariant>
+#include <utility>
+
+MarathonAppInstancePool::MarathonAppInstancePool(QObject *parent)
+    : QObject(parent)
+    , m_capacity(kDefaultCapacity) {
+    // The engine goes before the objects owning the pool; instances must not outlive it
+    if (QCoreApplication *app = QCoreApplication::instance())
+        connect(app, &QCoreApplication::aboutToQuit, this, &MarathonAppInstancePool::clear);
+}
+
+void MarathonAppInstancePool::setCapacity(int capacity) {
+    m_capacity = qMax(0, capacity);
+}
+
+void MarathonAppInstancePool::add(const QString &appId, QObject *instance) {
+    if (!instance)
+        return;
+    if (m_entries.value(appId).instance != instance)
+        remove(appId);
+
+    // The instance is handed to QML; keep its garbage collector away from it
+    QQmlEngine::setObjectOwnership(instance, QQmlEngine::CppOwnership);
+    instance->setParent(this);
+    connect(instance, &QObject::destroyed, this, [this, appId]() {
+        // Destroyed from elsewhere, e.g. by QML
+        auto it = m_entries.find(appId);
+        if (it != m_entries.end() && it->instance.isNull()) {
+            m_entries.erase(it);
+            m_suspended.removeOne(appId);
+        }
+    });
+
+    Entry entry;
+    entry.instance = instance;
+    m_entries.insert(appId, entry);
+}
+
+void MarathonAppInstancePool::remove(const QString &appId) {
+    const Entry entry = m_entries.take(appId);
+    m_suspended.removeOne(appId);
+    if (entry.instance) {
+        qDebug() << "[MarathonAppInstancePool] Destroying instance of" << appId;
+        entry.instance->deleteLater();
+    }
+}
+
+void MarathonAppInstancePool::clear() {
+    const QHash<QString, Entry> entries = std::exchange(m_entries, {});
+    m_suspended.clear();
+    for (const Entry &entry : entries)
+        delete entry.instance.data();
+}
+
+QObject *MarathonAppInstancePool::instance(const QString &appId) const {
+    return m_entries.value(appId).instance;
+}
+
+bool MarathonAppInstancePool::suspend(const QString &appId) {
+    auto it = m_entries.find(appId);
+    if (it == m_entries.end() || !it->instance)
+        return false;
+
+    m_suspended.removeOne(appId);
+    m_suspended.append(appId);
+    if (!it->suspended) {
+        freeze(*it);
+        it->suspended = true;
+        qDebug() << "[MarathonAppInstancePool] Suspended" << appId << ":"
+                 << it->stoppedTimers.size() << "timers," << it->pausedAnimations.size()
+                 << "animations";
+    }
+    return true;
+}
+
+QObject *MarathonAppInstancePool::resume(const QString &appId) {
+    auto it = m_entries.find(appId);
+    if (it == m_entries.end())
+        return nullptr;
+
+    if (it->suspended) {
+        thaw(*it);
+        it->suspended = false;
+        m_suspended.removeOne(appId);
+        qDebug() << "[MarathonAppInstancePool] Resumed" << appId;
+    }
+    return it->instance;
+}
+
+bool MarathonAppInstancePool::isSuspended(const QString &appId) const {
+    return m_entries.value(appId).suspended;
+}
+
+QStringList MarathonAppInstancePool::suspendedApps() const {
+    return m_suspended;
+}
+
+QStringList MarathonAppInstancePool::evictionCandidates(int keep) const {
+    const qsizetype excess = m_suspended.size() - qMax(0, keep);
+    return excess > 0 ? m_suspended.mid(0, excess) : QStringList();
+}
+
+void MarathonAppInstancePool::freeze(Entry &entry) {
+    const QList<QObject *> objects = entry.instance->findChildren<QObject *>();
+    for (QObject *object : objects) {
+        if (object->inherits("QQmlTimer")) {
+            if (object->property("running").toBool()) {
+                object->setProperty("running", false);
+                entry.stoppedTimers.append(object);
+            }
+        } else if (object->inherits("QQuickAbstractAnimation")) {
+            if (object->property("running").toBool() && !object->property("paused").toBool()) {
+                object->setProperty("paused", true);
+                entry.pausedAnimations.append(object);
+            }
+        }
+    }
+
+    // A hidden item is neither polished nor rendered
+    const QVariant visible = entry.instance->property("visible");
+    entry.wasVisible       = visible.toBool();
+    if (visible.isValid())
+        entry.instance->setProperty("visible", false);
+}
+
+void MarathonAppInstancePool::thaw(Entry &entry) {
+    for (const QPointer<QObject> &timer : std::as_const(entry.stoppedTimers)) {
+        if (timer)
+            timer->setProperty("running", true);
+    }
+    for (const QPointer<QObject> &animation : std::as_const(entry.pausedAnimations)) {
+        if (animation)
+            animation->setProperty("paused", false);
+    }
+    entry.stoppedTimers.clear();
+    entry.pausedAnimations.clear();
+
+    if (entry.instance && entry.wasVisible)
+        entry.instance->setProperty("visible", true);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief Live instances of in-process Marathon apps, kept warm while in the background
+ *
+ * The pool owns every instance the loader creates, until the app is unloaded.
+ * A minimized app is suspended instead of being thrown away: its running
+ * timers are stopped, its running animations paused and its root hidden, so
+ * it costs memory but no CPU. Resuming undoes exactly that and hands back the
+ * same instance, with all of its state, instead of building the app again.
+ *
+ * Suspended instances are kept least recently used first; the loader decides
+ * how many of them may stay (capacity, memory pressure) and unloads the rest.
+ * Whatever is left is destroyed when the application is about to quit, while
+ * the QML engine still exists.
+ */
+class MarathonAppInstancePool : public QObject {
+    Q_OBJECT
+
+  public:
+    static constexpr int kDefaultCapacity = 3;
+
+    explicit MarathonAppInstancePool(QObject *parent = nullptr);
+
+    // Suspended instances kept before the least recently used one is evicted
+    int capacity() const {
+        return m_capacity;
+    }
+    void setCapacity(int capacity);
+
+    // Takes ownership; an older instance of the same app is destroyed
+    void add(const QString &appId, QObject *instance);
+    // Destroys the app's instance, if the pool has one
+    void     remove(const QString &appId);
+    void     clear();
+    QObject *instance(const QString &appId) const;
+
+    bool     suspend(const QString &appId);
+    QObject *resume(const QString &appId);
+    bool     isSuspended(const QString &appId) const;
+
+    // Least recently used first
+    QStringList suspendedApps() const;
+    // Suspended apps beyond the newest keep ones, least recently used first
+    QStringList evictionCandidates(int keep) const;
+
+  private:
+    struct Entry {
+        QPointer<QObject>        instance;
+        bool                     suspended  = false;
+        bool                     wasVisible = false;
+        QList<QPointer<QObject>> stoppedTimers;
+        QList<QPointer<QObject>> pausedAnimations;
+    };
+
+    static void           freeze(Entry &entry);
+    static void           thaw(Entry &entry);
+
+    int                   m_capacity;
+    QHash<QString, Entry> m_entries;
+    QStringList           m_suspended; // least recently used first
+};
@@ -1,9 +1,27 @@
 #include "marathonapploader.h"
 #include "marathonappprocess.h"
+#include "marathonapprunnerpool.h"
+#include "launchhistory.h"
 #include <QDebug>
 #include <QDir>
+#include <QFile>
 #include <QFileInfo>
-#include <QStandardPaths>
+#include <QTimer>
+
+namespace {
+    // Predictive preloading waits this long after the last launch, then warms one app per step
+    constexpr int kIdleDelayMs   = 5000;
+    constexpr int kPreloadStepMs = 1000;
+    constexpr int kPredictedApps = 3;
+
+    // How often memory pressure is checked while apps are suspended
+    constexpr int kTrimIntervalMs = 10000;
+
+    // Memory pressure: tasks stalled on memory for 10% of the last 10 s (PSI), or less
+    // than 15% of RAM available
+    constexpr double kPressureAvg10     = 10.0;
+    constexpr double kMinAvailableShare = 0.15;
+} // namespace
 
 MarathonAppLoader::MarathonAppLoader(MarathonAppRegistry *registry, QQmlEngine *engine,
                                      QObject *parent)
@@ -11,7 +29,17 @@ MarathonAppLoader::MarathonAppLoader(MarathonAppRegistry *registry, QQmlEngine *
     , m_registry(registry)
     , m_engine(engine)
     , m_processIsolationEnabled(true) // ENABLED BY DEFAULT for safety
-{
+    , m_launchHistory(nullptr)
+    , m_idleTimer(new QTimer(this))
+    , m_trimTimer(new QTimer(this))
+    , m_instancePool(new MarathonAppInstancePool(this))
+    , m_runnerPool(new MarathonAppRunnerPool(this))
+    , m_importPaths(engine) {
+    m_idleTimer->setSingleShot(true);
+    connect(m_idleTimer, &QTimer::timeout, this, &MarathonAppLoader::preloadPredictedApps);
+    m_trimTimer->setInterval(kTrimIntervalMs);
+    connect(m_trimTimer, &QTimer::timeout, this, &MarathonAppLoader::trimInstancePool);
+
     qInfo() << "[MarathonAppLoader] Initialized";
     qInfo() << "[MarathonAppLoader] ✅ PROCESS ISOLATION: ENABLED";
     qInfo() << "[MarathonAppLoader]    Apps with C++ plugins will run in separate processes";
@@ -43,7 +71,7 @@ bool MarathonAppLoader::shouldUseProcessIsolation(const QString &appId) const {
     }
 
     // Check if app has C++ plugins (more likely to crash)
-    MarathonAppRegistry::AppInfo *appInfo = m_registry->getAppInfo(appId);
+    const MarathonAppRegistry::AppInfo *appInfo = m_registry->getAppInfo(appId);
     if (!appInfo) {
         return false;
     }
@@ -71,12 +99,14 @@ QObject *MarathonAppLoader::loadApp(const QString &appId) {
         return nullptr;
     }
 
-    // Don't cache - create fresh instance each time
-    // QML objects can only have one parent, so reusing breaks when switching apps
+    // Each load creates a new instance from the cached component and hands it to the instance
+    // pool, replacing any earlier one; resumeApp() is the way back to a suspended instance
     qDebug() << "[MarathonAppLoader] Creating new instance for:" << appId;
+    m_preloaded.remove(appId);
+    schedulePredictivePreload();
 
     // Get app info from registry
-    MarathonAppRegistry::AppInfo *appInfo = m_registry->getAppInfo(appId);
+    const MarathonAppRegistry::AppInfo *appInfo = m_registry->getAppInfo(appId);
     if (!appInfo) {
         qWarning() << "[MarathonAppLoader] App not found in registry:" << appId;
         emit loadError(appId, "App not found in registry");
@@ -87,25 +117,8 @@ QObject *MarathonAppLoader::loadApp(const QString &appId) {
     qDebug() << "  Path:" << appInfo->absolutePath;
     qDebug() << "  Entry:" << appInfo->entryPoint;
 
-    // Add app path to import paths so it can find its own components
-    QString appPath = appInfo->absolutePath;
-    if (!appPath.isEmpty()) {
-        m_engine->addImportPath(appPath);
-        qDebug() << "  Added import path:" << appPath;
-    }
-
-    // Ensure MarathonUI is available to apps (same paths as in main.cpp)
-    QString marathonUIPath =
-        QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/marathon-ui";
-    m_engine->addImportPath(marathonUIPath);
-    QString systemMarathonUIPath = "/usr/lib/qt6/qml/MarathonUI";
-    m_engine->addImportPath(systemMarathonUIPath);
-
-    // Add shell QML module path so apps can access MarathonOS.Shell singletons
-    m_engine->addImportPath("qrc:/");
-    m_engine->addImportPath(":/");
-
     // Build full path to entry point
+    QString appPath        = appInfo->absolutePath;
     QString entryPointPath = appPath + "/" + appInfo->entryPoint;
 
     // Check if file exists
@@ -115,6 +128,13 @@ QObject *MarathonAppLoader::loadApp(const QString &appId) {
         return nullptr;
     }
 
+    if (shouldUseProcessIsolation(appId)) {
+        startAppProcess(appId, *appInfo);
+        return nullptr;
+    }
+
+    // App's own directory, MarathonUI and the shell's modules
+    useImportPaths(appId, appPath);
     qDebug() << "  Loading from:" << entryPointPath;
 
     // Check if we already have this component cached
@@ -164,69 +184,120 @@ QObject *MarathonAppLoader::loadApp(const QString &appId) {
         return nullptr;
     }
 
-    // Create instance with exception protection
-    QObject *appInstance = nullptr;
-    try {
-        appInstance = component->create();
-    } catch (const std::exception &e) {
-        qCritical() << "[MarathonAppLoader] EXCEPTION during app creation:" << e.what();
-        emit loadError(appId, QString("Exception: %1").arg(e.what()));
-        m_components.remove(appId);
-        component->deleteLater();
-        return nullptr;
-    } catch (...) {
-        qCritical() << "[MarathonAppLoader] UNKNOWN EXCEPTION during app creation";
-        emit loadError(appId, "Unknown exception during app creation");
-        m_components.remove(appId);
-        component->deleteLater();
+    // Same path as loadAppAsync(): icon injection and ownership by the instance pool
+    QObject *appInstance = createAppInstance(appId, component);
+    if (!appInstance)
         return nullptr;
-    }
 
-    if (!appInstance) {
-        qWarning() << "[MarathonAppLoader] Failed to create app instance:"
-                   << component->errorString();
-        emit loadError(appId, component->errorString());
+    qDebug() << "[MarathonAppLoader] Successfully loaded app:" << appId;
+    emit appLoaded(appId);
 
-        // Remove from cache to prevent retry with broken component
-        m_components.remove(appId);
-        component->deleteLater();
-        return nullptr;
+    return appInstance;
+}
+
+void MarathonAppLoader::startAppProcess(const QString                     &appId,
+                                        const MarathonAppRegistry::AppInfo &appInfo) {
+    MarathonAppProcess *process = m_processes.value(appId, nullptr);
+    if (process && process->running()) {
+        qDebug() << "[MarathonAppLoader] Process already running for:" << appId;
+        emit appProcessStarted(appId);
+        return;
     }
 
-    // Inject icon path from registry into the app instance
-    // This ensures task switcher shows the correct icon
-    if (appInstance->property("appIcon").isValid()) {
-        QString iconPath = appInfo->icon;
-        if (!iconPath.isEmpty()) {
-            appInstance->setProperty("appIcon", iconPath);
-            qDebug() << "  Injected icon:" << iconPath;
-        }
+    if (!process) {
+        // The pool's template starts it from a warm runtime, with the compositor's environment
+        process = new MarathonAppProcess(appId, this);
+        process->setRunnerPool(m_runnerPool);
+        m_processes.insert(appId, process);
     }
 
-    // Component is already cached above, no need to cache again
+    if (!process->start(appInfo.absolutePath, appInfo.entryPoint)) {
+        emit loadError(appId, process->errorString());
+        m_processes.remove(appId);
+        process->deleteLater();
+        return;
+    }
 
-    qDebug() << "[MarathonAppLoader] Successfully loaded app:" << appId;
+    qDebug() << "[MarathonAppLoader] Started isolated app:" << appId;
+    emit appProcessStarted(appId);
     emit appLoaded(appId);
+}
 
-    return appInstance;
+void MarathonAppLoader::useImportPaths(const QString &appId, const QString &appPath) {
+    m_importPaths.addSharedPaths();
+
+    // One hold per app however often it is launched, dropped again by unloadApp()
+    const auto held = m_heldImportPaths.constFind(appId);
+    if (held != m_heldImportPaths.cend() && *held == appPath)
+        return;
+    releaseImportPaths(appId);
+    m_importPaths.acquireAppPath(appPath);
+    m_heldImportPaths.insert(appId, appPath);
+}
+
+void MarathonAppLoader::releaseImportPaths(const QString &appId) {
+    const QString appPath = m_heldImportPaths.take(appId);
+    if (!appPath.isEmpty())
+        m_importPaths.releaseAppPath(appPath);
 }
 
 void MarathonAppLoader::unloadApp(const QString &appId) {
     qDebug() << "[MarathonAppLoader] Unload requested for:" << appId;
 
-    // Since we don't cache instances anymore, just clean up the component
+    m_instancePool->remove(appId);
+    m_preloaded.remove(appId);
+    releaseImportPaths(appId);
     QQmlComponent *component = m_components.take(appId);
     if (component) {
         component->deleteLater();
         qDebug() << "[MarathonAppLoader] Cleaned up component for:" << appId;
     }
+    if (MarathonAppProcess *process = m_processes.take(appId)) {
+        process->stop();
+        process->deleteLater();
+        qDebug() << "[MarathonAppLoader] Stopped process for:" << appId;
+    }
 
     emit appUnloaded(appId);
 }
 
 bool MarathonAppLoader::isAppLoaded(const QString &appId) const {
-    // Check if component is cached (not instances since we don't cache those)
-    return m_components.contains(appId);
+    return m_components.contains(appId) || m_processes.contains(appId);
+}
+
+void MarathonAppLoader::suspendApp(const QString &appId) {
+    if (!m_instancePool->suspend(appId))
+        return;
+
+    trimInstancePool();
+    if (!m_instancePool->suspendedApps().isEmpty() && !m_trimTimer->isActive())
+        m_trimTimer->start();
+}
+
+QObject *MarathonAppLoader::resumeApp(const QString &appId) {
+    return m_instancePool->resume(appId);
+}
+
+bool MarathonAppLoader::isAppSuspended(const QString &appId) const {
+    return m_instancePool->isSuspended(appId);
+}
+
+void MarathonAppLoader::trimInstancePool() {
+    // Under memory pressure one app goes per check until the pressure eases
+    int keep = m_instancePool->capacity();
+    if (isUnderMemoryPressure())
+        keep = qMin(keep, static_cast<int>(m_instancePool->suspendedApps().size()) - 1);
+
+    for (const QString &appId : m_instancePool->evictionCandidates(keep)) {
+        qDebug() << "[MarathonAppLoader] Evicting suspended app:" << appId;
+        // The shell closes the app's task, which normally unloads it too
+        emit appEvicted(appId);
+        if (m_instancePool->instance(appId))
+            unloadApp(appId);
+    }
+
+    if (m_instancePool->suspendedApps().isEmpty())
+        m_trimTimer->stop();
 }
 
 void MarathonAppLoader::preloadApp(const QString &appId) {
@@ -238,33 +309,19 @@ void MarathonAppLoader::preloadApp(const QString &appId) {
         return;
     }
 
-    MarathonAppRegistry::AppInfo *appInfo = m_registry->getAppInfo(appId);
+    const MarathonAppRegistry::AppInfo *appInfo = m_registry->getAppInfo(appId);
     if (!appInfo) {
         qDebug() << "[MarathonAppLoader] Cannot preload - app not in registry:" << appId;
         return;
     }
 
-    QString appPath = appInfo->absolutePath;
-    if (!appPath.isEmpty()) {
-        m_engine->addImportPath(appPath);
-    }
-
-    // Ensure MarathonUI is available to apps (same paths as in main.cpp)
-    QString marathonUIPath =
-        QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/marathon-ui";
-    m_engine->addImportPath(marathonUIPath);
-    QString systemMarathonUIPath = "/usr/lib/qt6/qml/MarathonUI";
-    m_engine->addImportPath(systemMarathonUIPath);
-
-    // Add shell QML module path so apps can access MarathonOS.Shell singletons
-    m_engine->addImportPath("qrc:/");
-    m_engine->addImportPath(":/");
-
+    QString appPath        = appInfo->absolutePath;
     QString entryPointPath = appPath + "/" + appInfo->entryPoint;
     if (!QFileInfo::exists(entryPointPath)) {
         qDebug() << "[MarathonAppLoader] Cannot preload - entry point not found:" << entryPointPath;
         return;
     }
+    useImportPaths(appId, appPath);
 
     qDebug() << "[MarathonAppLoader] Preloading component:" << appId;
 
@@ -275,6 +332,7 @@ void MarathonAppLoader::preloadApp(const QString &appId) {
 
     // Cache for later use
     m_components.insert(appId, component);
+    m_preloaded.insert(appId);
 
     qDebug() << "[MarathonAppLoader] Component preloaded:" << appId;
 }
@@ -288,30 +346,18 @@ void MarathonAppLoader::loadAppAsync(const QString &appId) {
         emit loadError(appId, "No QML engine");
         return;
     }
+    schedulePredictivePreload();
 
     // Get app info from registry
-    MarathonAppRegistry::AppInfo *appInfo = m_registry->getAppInfo(appId);
+    const MarathonAppRegistry::AppInfo *appInfo = m_registry->getAppInfo(appId);
     if (!appInfo) {
         qWarning() << "[MarathonAppLoader] App not found in registry:" << appId;
         emit loadError(appId, "App not found in registry");
         return;
     }
 
-    // Add import paths
-    QString appPath = appInfo->absolutePath;
-    if (!appPath.isEmpty()) {
-        m_engine->addImportPath(appPath);
-    }
-
-    QString marathonUIPath =
-        QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/marathon-ui";
-    m_engine->addImportPath(marathonUIPath);
-    QString systemMarathonUIPath = "/usr/lib/qt6/qml/MarathonUI";
-    m_engine->addImportPath(systemMarathonUIPath);
-    m_engine->addImportPath("qrc:/");
-    m_engine->addImportPath(":/");
-
     // Build entry point path
+    QString appPath        = appInfo->absolutePath;
     QString entryPointPath = appPath + "/" + appInfo->entryPoint;
 
     // Check if file exists
@@ -321,8 +367,15 @@ void MarathonAppLoader::loadAppAsync(const QString &appId) {
         return;
     }
 
+    if (shouldUseProcessIsolation(appId)) {
+        startAppProcess(appId, *appInfo);
+        return;
+    }
+    useImportPaths(appId, appPath);
+
     // Check if component is already cached and ready
     QQmlComponent *component = m_components.value(appId, nullptr);
+    const bool     preloaded = m_preloaded.remove(appId);
 
     if (component && component->status() == QQmlComponent::Ready) {
         // Component already loaded, create instance immediately
@@ -338,7 +391,9 @@ void MarathonAppLoader::loadAppAsync(const QString &appId) {
     if (component && component->status() == QQmlComponent::Loading) {
         // Already loading, just wait for it
         qDebug() << "[MarathonAppLoader] Component already loading for:" << appId;
-        // Handler is already connected below
+        // Handler is already connected below, unless the load started as a preload
+        if (preloaded)
+            connectComponentStatus(appId, component);
         return;
     }
 
@@ -361,6 +416,16 @@ void MarathonAppLoader::loadAppAsync(const QString &appId) {
     emit appLoadProgress(appId, 30); // Component created
 
     // Connect to statusChanged signal for async handling
+    connectComponentStatus(appId, component);
+
+    // If component is already ready (sync load), handle immediately
+    if (component->status() == QQmlComponent::Ready) {
+        emit appLoadProgress(appId, 70);
+        handleComponentStatusAsync(appId, component);
+    }
+}
+
+void MarathonAppLoader::connectComponentStatus(const QString &appId, QQmlComponent *component) {
     connect(component, &QQmlComponent::statusChanged, this,
             [this, appId, component](QQmlComponent::Status status) {
                 qDebug() << "[MarathonAppLoader] Component status changed for" << appId << ":"
@@ -377,12 +442,6 @@ void MarathonAppLoader::loadAppAsync(const QString &appId) {
                     component->deleteLater();
                 }
             });
-
-    // If component is already ready (sync load), handle immediately
-    if (component->status() == QQmlComponent::Ready) {
-        emit appLoadProgress(appId, 70);
-        handleComponentStatusAsync(appId, component);
-    }
 }
 
 // Handle component status asynchronously
@@ -446,7 +505,7 @@ QObject *MarathonAppLoader::createAppInstance(const QString &appId, QQmlComponen
     }
 
     // Inject icon path from registry
-    MarathonAppRegistry::AppInfo *appInfo = m_registry->getAppInfo(appId);
+    const MarathonAppRegistry::AppInfo *appInfo = m_registry->getAppInfo(appId);
     if (appInfo && appInstance->property("appIcon").isValid()) {
         QString iconPath = appInfo->icon;
         if (!iconPath.isEmpty()) {
@@ -455,6 +514,111 @@ QObject *MarathonAppLoader::createAppInstance(const QString &appId, QQmlComponen
         }
     }
 
+    m_instancePool->add(appId, appInstance);
     qDebug() << "[MarathonAppLoader] Successfully created instance for:" << appId;
     return appInstance;
 }
+
+void MarathonAppLoader::setLaunchHistory(LaunchHistory *history) {
+    if (m_launchHistory == history)
+        return;
+    if (m_launchHistory)
+        disconnect(m_launchHistory, nullptr, this, nullptr);
+
+    m_launchHistory = history;
+    if (m_launchHistory) {
+        connect(m_launchHistory, &LaunchHistory::launchRecorded, this,
+                &MarathonAppLoader::schedulePredictivePreload);
+        // The first scan makes the predicted apps loadable
+        connect(m_registry, &MarathonAppRegistry::countChanged, this,
+                &MarathonAppLoader::schedulePredictivePreload, Qt::UniqueConnection);
+    }
+    schedulePredictivePreload();
+}
+
+void MarathonAppLoader::schedulePredictivePreload() {
+    if (m_launchHistory)
+        m_idleTimer->start(kIdleDelayMs);
+}
+
+void MarathonAppLoader::preloadPredictedApps() {
+    if (!m_launchHistory || !m_engine)
+        return;
+
+    // Warm components are only a cache; hand the memory back before the system has to reclaim it
+    if (isUnderMemoryPressure()) {
+        if (!m_preloaded.isEmpty())
+            qDebug() << "[MarathonAppLoader] Memory pressure, dropping preloaded apps:"
+                     << m_preloaded.values();
+        for (const QString &appId : std::as_const(m_preloaded)) {
+            if (QQmlComponent *component = m_components.take(appId))
+                component->deleteLater();
+            releaseImportPaths(appId);
+        }
+        m_preloaded.clear();
+        return;
+    }
+
+    // Likeliest apps that would run in this process; an isolated one instead needs the runner
+    // template up, which waits for the compositor so that its apps can reach it
+    QStringList predicted;
+    for (const QString &appId : m_launchHistory->topApps(0)) {
+        if (predicted.size() == kPredictedApps)
+            break;
+        if (!m_registry->getAppInfo(appId))
+            continue;
+        if (!shouldUseProcessIsolation(appId))
+            predicted.append(appId);
+        else if (m_runnerPool->hasEnvironment())
+            m_runnerPool->ensureRunning();
+    }
+
+    for (auto it = m_preloaded.begin(); it != m_preloaded.end();) {
+        if (predicted.contains(*it)) {
+            ++it;
+            continue;
+        }
+        qDebug() << "[MarathonAppLoader] Dropping preload that is no longer predicted:" << *it;
+        if (QQmlComponent *component = m_components.take(*it))
+            component->deleteLater();
+        releaseImportPaths(*it);
+        it = m_preloaded.erase(it);
+    }
+
+    // One app per step, so compiling never holds up the UI for long
+    for (const QString &appId : std::as_const(predicted)) {
+        if (m_components.contains(appId))
+            continue;
+        preloadApp(appId);
+        if (m_components.contains(appId)) {
+            m_idleTimer->start(kPreloadStepMs);
+            return;
+        }
+    }
+}
+
+bool MarathonAppLoader::isUnderMemoryPressure() {
+    // Pressure stall information (Linux 4.20+), first line:
+    // "some avg10=0.00 avg60=0.00 avg300=0.00 total=0"
+    QFile pressure("/proc/pressure/memory");
+    if (pressure.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        const QByteArray some  = pressure.readAll().split('\n').value(0);
+        const qsizetype  start = some.indexOf("avg10=");
+        if (start >= 0 && some.mid(start + 6).split(' ').value(0).toDouble() >= kPressureAvg10)
+            return true;
+    }
+
+    QFile meminfo("/proc/meminfo");
+    if (!meminfo.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+
+    qint64 totalKb     = 0;
+    qint64 availableKb = -1;
+    for (const QByteArray &line : meminfo.readAll().split('\n')) {
+        if (line.startsWith("MemTotal:"))
+            totalKb = line.mid(9).simplified().split(' ').value(0).toLongLong();
+        else if (line.startsWith("MemAvailable:"))
+            availableKb = line.mid(13).simplified().split(' ').value(0).toLongLong();
+    }
+    return totalKb > 0 && availableKb >= 0 && availableKb < totalKb * kMinAvailableShare;
+}
@@ -5,7 +5,14 @@
 #include <QQmlEngine>
 #include <QQmlComponent>
 #include <QHash>
+#include <QSet>
+#include "marathonappinstancepool.h"
 #include "marathonappregistry.h"
+#include "marathonimportpaths.h"
+
+class LaunchHistory;
+class MarathonAppRunnerPool;
+class QTimer;
 
 class MarathonAppLoader : public QObject {
     Q_OBJECT
@@ -20,19 +27,55 @@ class MarathonAppLoader : public QObject {
     }
     void                 setProcessIsolationEnabled(bool enabled);
 
+    // Apps with native plugins are started in a process of their own instead, see
+    // appProcessStarted(); loadApp() returns null for them
     Q_INVOKABLE QObject *loadApp(const QString &appId);
     Q_INVOKABLE void     loadAppAsync(const QString &appId); // New async method
     Q_INVOKABLE void     unloadApp(const QString &appId);
     Q_INVOKABLE bool     isAppLoaded(const QString &appId) const;
     Q_INVOKABLE void     preloadApp(const QString &appId);
 
+    /**
+     * @brief Keep a backgrounded app's instance alive but idle
+     *
+     * A suspended app is resumed as it was, without being created again. At
+     * most MarathonAppInstancePool::kDefaultCapacity apps stay suspended;
+     * under memory pressure they go one by one, least recently used first.
+     * An evicted app is unloaded after appEvicted() has been emitted.
+     */
+    Q_INVOKABLE void     suspendApp(const QString &appId);
+    Q_INVOKABLE QObject *resumeApp(const QString &appId);
+    Q_INVOKABLE bool     isAppSuspended(const QString &appId) const;
+
+    /**
+     * @brief Keep the components of the likeliest apps warm
+     *
+     * Once nothing has been launched for a few seconds, the top apps of the
+     * launch history are preloaded, one per idle tick. Preloads nobody has
+     * launched yet are dropped again when the app falls out of the top ranks
+     * or the system runs short of memory.
+     */
+    void                 setLaunchHistory(LaunchHistory *history);
+
+    // Import paths of the loader's engine, shared with anything else loading app QML
+    MarathonImportPaths *importPaths() {
+        return &m_importPaths;
+    }
+
+    // Warm runtimes for apps that run in their own process, see MarathonAppProcess
+    MarathonAppRunnerPool *runnerPool() const {
+        return m_runnerPool;
+    }
+
   signals:
     void appLoaded(const QString &appId);
     void loadError(const QString &appId, const QString &error);
     void appUnloaded(const QString &appId);
     void appLoadProgress(const QString &appId, int percent);        // New progress signal
     void appInstanceReady(const QString &appId, QObject *instance); // New async completion
+    void appProcessStarted(const QString &appId); // Isolated app, its window comes as a surface
     void processIsolationEnabledChanged();
+    void appEvicted(const QString &appId);
 
   private:
     MarathonAppRegistry                       *m_registry;
@@ -40,8 +83,24 @@ class MarathonAppLoader : public QObject {
     QHash<QString, QQmlComponent *>            m_components;
     QHash<QString, class MarathonAppProcess *> m_processes;
     bool                                       m_processIsolationEnabled;
+    LaunchHistory                             *m_launchHistory;
+    QTimer                                    *m_idleTimer;
+    QTimer                                    *m_trimTimer;
+    MarathonAppInstancePool                   *m_instancePool;
+    MarathonAppRunnerPool                     *m_runnerPool;
+    MarathonImportPaths                        m_importPaths;
+    QSet<QString>                              m_preloaded;       // preloaded, not launched since
+    QHash<QString, QString>                    m_heldImportPaths; // app id -> app path held
 
-    void     handleComponentStatusAsync(const QString &appId, QQmlComponent *component);
-    QObject *createAppInstance(const QString &appId, QQmlComponent *component);
-    bool     shouldUseProcessIsolation(const QString &appId) const;
+    void        handleComponentStatusAsync(const QString &appId, QQmlComponent *component);
+    void        connectComponentStatus(const QString &appId, QQmlComponent *component);
+    QObject    *createAppInstance(const QString &appId, QQmlComponent *component);
+    void        startAppProcess(const QString &appId, const MarathonAppRegistry::AppInfo &appInfo);
+    bool        shouldUseProcessIsolation(const QString &appId) const;
+    void        useImportPaths(const QString &appId, const QString &appPath);
+    void        releaseImportPaths(const QString &appId);
+    void        schedulePredictivePreload();
+    void        preloadPredictedApps();
+    void        trimInstancePool();
+    static bool isUnderMemoryPressure();
 };
@@ -1,18 +1,35 @@
 #include "marathonappprocess.h"
+#include "marathonapprunnerpool.h"
 #include <QDebug>
 #include <QCoreApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalSocket>
 #include <QTimer>
+#include <signal.h>
+
+namespace {
+    // Local socket round trip to the runner template; it answers as soon as it has forked
+    constexpr int kRunnerTimeoutMs = 2000;
+} // namespace
 
 MarathonAppProcess::MarathonAppProcess(const QString &appId, QObject *parent)
     : QObject(parent)
     , m_appId(appId)
     , m_process(nullptr)
+    , m_runnerPool(nullptr)
+    , m_runnerConnection(nullptr)
+    , m_runnerPid(0)
     , m_exitCode(0)
     , m_crashCount(0) {
     qDebug() << "[AppProcess]" << m_appId << "- Process manager created";
 }
 
 MarathonAppProcess::~MarathonAppProcess() {
+    if (m_runnerPid > 0) {
+        qDebug() << "[AppProcess]" << m_appId << "- Terminating process";
+        ::kill(static_cast<pid_t>(m_runnerPid), SIGTERM);
+    }
     if (m_process && m_process->state() != QProcess::NotRunning) {
         qDebug() << "[AppProcess]" << m_appId << "- Terminating process";
         m_process->terminate();
@@ -26,11 +43,17 @@ MarathonAppProcess::~MarathonAppProcess() {
 }
 
 bool MarathonAppProcess::running() const {
-    return m_process && m_process->state() == QProcess::Running;
+    return m_runnerPid > 0 || (m_process && m_process->state() == QProcess::Running);
+}
+
+qint64 MarathonAppProcess::processId() const {
+    if (m_runnerPid > 0)
+        return m_runnerPid;
+    return m_process ? m_process->processId() : 0;
 }
 
 bool MarathonAppProcess::start(const QString &appPath, const QString &entryPoint) {
-    if (m_process && m_process->state() != QProcess::NotRunning) {
+    if (m_runnerPid > 0 || (m_process && m_process->state() != QProcess::NotRunning)) {
         qWarning() << "[AppProcess]" << m_appId << "- Already running";
         return false;
     }
@@ -38,6 +61,9 @@ bool MarathonAppProcess::start(const QString &appPath, const QString &entryPoint
     m_appPath    = appPath;
     m_entryPoint = entryPoint;
 
+    if (m_runnerPool && startFromRunnerPool(appPath, entryPoint))
+        return true;
+
     if (!m_process) {
         m_process = new QProcess(this);
 
@@ -53,10 +79,8 @@ bool MarathonAppProcess::start(const QString &appPath, const QString &entryPoint
         m_process->setProcessChannelMode(QProcess::ForwardedChannels);
     }
 
-    // Build command to run the app
-    // For now, we'll run a standalone QML app runner
-    // TODO: Create marathon-app-runner executable
-    QString     program = QCoreApplication::applicationDirPath() + "/marathon-app-runner";
+    // Cold start: a runner of its own for this app
+    QString     program = MarathonAppRunnerPool::runnerPath();
     QStringList arguments;
     arguments << "--app-id" << m_appId;
     arguments << "--app-path" << appPath;
@@ -67,6 +91,9 @@ bool MarathonAppProcess::start(const QString &appPath, const QString &entryPoint
     qInfo() << "[AppProcess]   Arguments:" << arguments;
     qInfo() << "[AppProcess]   ✅ ISOLATED: App crashes won't affect the shell!";
 
+    // Same compositor connection as the template's runtimes
+    if (m_runnerPool && m_runnerPool->hasEnvironment())
+        m_process->setProcessEnvironment(m_runnerPool->environment());
     m_process->start(program, arguments);
 
     // Wait a bit to see if it starts
@@ -81,6 +108,20 @@ bool MarathonAppProcess::start(const QString &appPath, const QString &entryPoint
 }
 
 void MarathonAppProcess::stop() {
+    if (m_runnerPid > 0) {
+        qDebug() << "[AppProcess]" << m_appId << "- Stopping gracefully";
+        const qint64 pid = m_runnerPid;
+        ::kill(static_cast<pid_t>(pid), SIGTERM);
+        QTimer::singleShot(3000, this, [this, pid]() {
+            if (m_runnerPid == pid) {
+                qWarning() << "[AppProcess]" << m_appId
+                           << "- Didn't stop gracefully, force killing";
+                ::kill(static_cast<pid_t>(pid), SIGKILL);
+            }
+        });
+        return;
+    }
+
     if (!m_process || m_process->state() == QProcess::NotRunning) {
         return;
     }
@@ -98,6 +139,12 @@ void MarathonAppProcess::stop() {
 }
 
 void MarathonAppProcess::kill() {
+    if (m_runnerPid > 0) {
+        qDebug() << "[AppProcess]" << m_appId << "- Force killing";
+        ::kill(static_cast<pid_t>(m_runnerPid), SIGKILL);
+        return;
+    }
+
     if (!m_process || m_process->state() == QProcess::NotRunning) {
         return;
     }
@@ -116,7 +163,7 @@ void MarathonAppProcess::restart() {
 
 void MarathonAppProcess::handleStarted() {
     qInfo() << "[AppProcess]" << m_appId
-            << "- Process started successfully (PID:" << m_process->processId() << ")";
+            << "- Process started successfully (PID:" << processId() << ")";
     m_crashCount = 0; // Reset crash count on successful start
     emit runningChanged();
     emit started();
@@ -181,3 +228,75 @@ void MarathonAppProcess::handleStateChanged(QProcess::ProcessState state) {
 
     qDebug() << "[AppProcess]" << m_appId << "- State changed:" << stateStr;
 }
+
+bool MarathonAppProcess::startFromRunnerPool(const QString &appPath, const QString &entryPoint) {
+    if (!m_runnerPool->isRunning()) {
+        // This launch starts cold; the next ones find a warm runtime
+        m_runnerPool->ensureRunning();
+        return false;
+    }
+
+    auto *connection = new QLocalSocket(this);
+    connection->connectToServer(m_runnerPool->socketPath());
+    if (!connection->waitForConnected(kRunnerTimeoutMs)) {
+        qWarning() << "[AppProcess]" << m_appId << "- Runner template not reachable:"
+                   << connection->errorString();
+        delete connection;
+        return false;
+    }
+
+    QJsonObject request;
+    request["appId"]      = m_appId;
+    request["appPath"]    = appPath;
+    request["entryPoint"] = entryPoint;
+    connection->write(QJsonDocument(request).toJson(QJsonDocument::Compact) + '\n');
+
+    // The reply carries the PID of the runtime that took the app
+    while (!connection->canReadLine()) {
+        if (!connection->waitForReadyRead(kRunnerTimeoutMs))
+            break;
+    }
+    qint64 pid = 0;
+    if (connection->canReadLine())
+        pid = QJsonDocument::fromJson(connection->readLine()).object().value("pid").toInteger();
+    if (pid <= 0) {
+        qWarning() << "[AppProcess]" << m_appId << "- Runner template did not start the app";
+        delete connection;
+        return false;
+    }
+
+    m_runnerPid        = pid;
+    m_runnerConnection = connection;
+    connect(connection, &QLocalSocket::readyRead, this, &MarathonAppProcess::handleRunnerMessage);
+    connect(connection, &QLocalSocket::disconnected, this,
+            &MarathonAppProcess::handleRunnerMessage);
+
+    qInfo() << "[AppProcess]" << m_appId << "- Started in a warm runtime";
+    qInfo() << "[AppProcess]   ✅ ISOLATED: App crashes won't affect the shell!";
+    handleStarted();
+    return true;
+}
+
+void MarathonAppProcess::handleRunnerMessage() {
+    while (m_runnerConnection && m_runnerConnection->canReadLine()) {
+        const QJsonObject message =
+            QJsonDocument::fromJson(m_runnerConnection->readLine()).object();
+        if (message.contains("exitCode")) {
+            finishRunnerApp(message.value("exitCode").toInt(), message.value("crashed").toBool());
+            return;
+        }
+    }
+
+    // The template went away, and its runtimes went with it
+    if (m_runnerConnection && m_runnerConnection->state() == QLocalSocket::UnconnectedState)
+        finishRunnerApp(-1, true);
+}
+
+void MarathonAppProcess::finishRunnerApp(int exitCode, bool crashed) {
+    disconnect(m_runnerConnection, nullptr, this, nullptr);
+    m_runnerConnection->deleteLater();
+    m_runnerConnection = nullptr;
+    m_runnerPid        = 0;
+
+    handleFinished(exitCode, crashed ? QProcess::CrashExit : QProcess::NormalExit);
+}
@@ -5,12 +5,18 @@
 #include <QString>
 #include <QVariantMap>
 
+class MarathonAppRunnerPool;
+class QLocalSocket;
+
 /**
  * @brief MarathonAppProcess - Runs a Marathon app in a separate process
  * 
  * This provides true process isolation - if an app crashes, it won't take
  * down the shell. Each app runs in its own QProcess with proper lifecycle
  * management and IPC.
+ *
+ * With a runner pool set, the app is handed to a warm runtime forked from the
+ * pool's template; otherwise marathon-app-runner is started for it directly.
  */
 class MarathonAppProcess : public QObject {
     Q_OBJECT
@@ -35,6 +41,11 @@ class MarathonAppProcess : public QObject {
         return m_errorString;
     }
 
+    // Launch through the pool's warm runtimes when it is running, with its environment otherwise
+    void setRunnerPool(MarathonAppRunnerPool *pool) {
+        m_runnerPool = pool;
+    }
+
     // Start the app in a separate process
     Q_INVOKABLE bool start(const QString &appPath, const QString &entryPoint);
 
@@ -61,14 +72,22 @@ class MarathonAppProcess : public QObject {
     void handleFinished(int exitCode, QProcess::ExitStatus exitStatus);
     void handleErrorOccurred(QProcess::ProcessError error);
     void handleStateChanged(QProcess::ProcessState state);
+    void handleRunnerMessage();
 
   private:
-    QString          m_appId;
-    QProcess        *m_process;
-    QString          m_appPath;
-    QString          m_entryPoint;
-    int              m_exitCode;
-    QString          m_errorString;
-    int              m_crashCount;
-    static const int MAX_CRASHES = 3;
+    bool                   startFromRunnerPool(const QString &appPath, const QString &entryPoint);
+    void                   finishRunnerApp(int exitCode, bool crashed);
+    qint64                 processId() const;
+
+    QString                m_appId;
+    QProcess              *m_process;
+    MarathonAppRunnerPool *m_runnerPool;
+    QLocalSocket          *m_runnerConnection; // open while an app from the pool runs
+    qint64                 m_runnerPid;
+    QString                m_appPath;
+    QString                m_entryPoint;
+    int                    m_exitCode;
+    QString                m_errorString;
+    int                    m_crashCount;
+    static const int       MAX_CRASHES = 3;
 };
@@ -1,26 +1,35 @@
 #include "marathonappregistry.h"
 #include <QDebug>
+#include <QMutexLocker>
 
 MarathonAppRegistry::MarathonAppRegistry(QObject *parent)
-    : QAbstractListModel(parent) {
+    : QAbstractListModel(parent)
+    , m_snapshot(createSnapshot({})) {
     qDebug() << "[MarathonAppRegistry] Initialized";
 }
 
-MarathonAppRegistry::~MarathonAppRegistry() {
-    qDeleteAll(m_apps);
+MarathonAppRegistry::~MarathonAppRegistry() = default;
+
+bool MarathonAppRegistry::AppInfo::operator==(const AppInfo &other) const {
+    return id == other.id && name == other.name && icon == other.icon && type == other.type &&
+        absolutePath == other.absolutePath && entryPoint == other.entryPoint &&
+        version == other.version && isProtected == other.isProtected &&
+        permissions == other.permissions && searchKeywords == other.searchKeywords &&
+        deepLinksJson == other.deepLinksJson && categories == other.categories &&
+        handlesUriSchemes == other.handlesUriSchemes && defaultFor == other.defaultFor;
 }
 
 int MarathonAppRegistry::rowCount(const QModelIndex &parent) const {
     if (parent.isValid())
         return 0;
-    return m_apps.count();
+    return count();
 }
 
 QVariant MarathonAppRegistry::data(const QModelIndex &index, int role) const {
-    if (!index.isValid() || index.row() >= m_apps.count())
+    if (!index.isValid() || index.row() >= count())
         return QVariant();
 
-    const AppInfo *app = m_apps.at(index.row());
+    const AppInfo *app = m_snapshot->apps.at(index.row()).data();
 
     switch (role) {
         case IdRole: return app->id;
@@ -63,8 +72,7 @@ QHash<int, QByteArray> MarathonAppRegistry::roleNames() const {
 QVariantMap MarathonAppRegistry::getApp(const QString &appId) const {
     QVariantMap result;
 
-    if (m_appIndex.contains(appId)) {
-        const AppInfo *app          = m_appIndex.value(appId);
+    if (const AppInfo *app = m_snapshot->find(appId)) {
         result["id"]                = app->id;
         result["name"]              = app->name;
         result["icon"]              = app->icon;
@@ -88,29 +96,25 @@ void MarathonAppRegistry::registerApp(const QString &id, const QString &name, co
                                       int type, const QString &absolutePath,
                                       const QString &entryPoint, const QString &version,
                                       bool isProtected, const QStringList &permissions) {
-    if (m_appIndex.contains(id)) {
-        qWarning() << "[MarathonAppRegistry] App already registered:" << id;
-        return;
-    }
-
-    AppInfo *info = new AppInfo{id,           name,       icon,    static_cast<AppType>(type),
-                                absolutePath, entryPoint, version, isProtected,
-                                permissions};
-
-    registerAppInfo(*info);
+    registerAppInfo({id, name, icon, static_cast<AppType>(type), absolutePath, entryPoint, version,
+                     isProtected, permissions});
 }
 
 void MarathonAppRegistry::registerAppInfo(const AppInfo &info) {
-    if (m_appIndex.contains(info.id)) {
+    if (hasApp(info.id)) {
         qWarning() << "[MarathonAppRegistry] App already registered:" << info.id;
         return;
     }
 
-    AppInfo *appInfo = new AppInfo(info);
+    // Copy on write: readers holding the old snapshot keep a consistent list
+    const QSharedPointer<Snapshot> next = editableSnapshot();
+    const AppPtr                   app  = QSharedPointer<AppInfo>::create(info);
+    next->apps.append(app);
+    next->index.insert(info.id, app);
+    next->byPath.insert(info.absolutePath, app);
 
-    beginInsertRows(QModelIndex(), m_apps.size(), m_apps.size());
-    m_apps.append(appInfo);
-    m_appIndex.insert(info.id, appInfo);
+    beginInsertRows(QModelIndex(), count(), count());
+    swapSnapshot(next);
     endInsertRows();
 
     emit appRegistered(info.id);
@@ -120,21 +124,122 @@ void MarathonAppRegistry::registerAppInfo(const AppInfo &info) {
              << "| Type:" << static_cast<int>(info.type) << "| Protected:" << info.isProtected;
 }
 
-bool MarathonAppRegistry::isProtected(const QString &appId) const {
-    if (m_appIndex.contains(appId)) {
-        return m_appIndex.value(appId)->isProtected;
+bool MarathonAppRegistry::updateAppInfo(const AppInfo &info) {
+    const AppPtr previous = m_snapshot->index.value(info.id);
+    if (!previous) {
+        registerAppInfo(info);
+        return true;
     }
-    return false;
+    if (*previous == info)
+        return false;
+
+    const qsizetype                row  = m_snapshot->apps.indexOf(previous);
+    const QSharedPointer<Snapshot> next = editableSnapshot();
+    const AppPtr                   app  = QSharedPointer<AppInfo>::create(info);
+    next->apps[row]                     = app;
+    next->index.insert(info.id, app);
+    if (next->byPath.value(previous->absolutePath) == previous)
+        next->byPath.remove(previous->absolutePath);
+    next->byPath.insert(info.absolutePath, app);
+    swapSnapshot(next);
+
+    const QModelIndex changed = index(static_cast<int>(row));
+    emit              dataChanged(changed, changed);
+    emit              appUpdated(info.id);
+
+    qDebug() << "[MarathonAppRegistry] Updated app:" << info.id;
+    return true;
+}
+
+bool MarathonAppRegistry::unregisterApp(const QString &appId) {
+    const AppPtr previous = m_snapshot->index.value(appId);
+    if (!previous)
+        return false;
+
+    const int                      row  = static_cast<int>(m_snapshot->apps.indexOf(previous));
+    const QSharedPointer<Snapshot> next = editableSnapshot();
+    next->apps.remove(row);
+    next->index.remove(appId);
+    if (next->byPath.value(previous->absolutePath) == previous)
+        next->byPath.remove(previous->absolutePath);
+
+    beginRemoveRows(QModelIndex(), row, row);
+    swapSnapshot(next);
+    endRemoveRows();
+
+    emit appUnregistered(appId);
+    emit countChanged();
+
+    qDebug() << "[MarathonAppRegistry] Unregistered app:" << appId;
+    return true;
+}
+
+bool MarathonAppRegistry::isProtected(const QString &appId) const {
+    const AppInfo *app = m_snapshot->find(appId);
+    return app && app->isProtected;
 }
 
 bool MarathonAppRegistry::hasApp(const QString &appId) const {
-    return m_appIndex.contains(appId);
+    return m_snapshot->index.contains(appId);
 }
 
 QStringList MarathonAppRegistry::getAllAppIds() const {
-    return m_appIndex.keys();
+    return m_snapshot->index.keys();
+}
+
+const MarathonAppRegistry::AppInfo *MarathonAppRegistry::getAppInfo(const QString &appId) const {
+    return m_snapshot->find(appId);
+}
+
+MarathonAppRegistry::SnapshotPtr MarathonAppRegistry::snapshot() const {
+    QMutexLocker locker(&m_snapshotMutex);
+    return m_snapshot;
+}
+
+MarathonAppRegistry::SnapshotPtr MarathonAppRegistry::createSnapshot(QVector<AppInfo> apps) {
+    auto snapshot = QSharedPointer<Snapshot>::create();
+    snapshot->apps.reserve(apps.size());
+    snapshot->index.reserve(apps.size());
+    snapshot->byPath.reserve(apps.size());
+    for (AppInfo &info : apps) {
+        if (snapshot->index.contains(info.id))
+            continue;
+        const AppPtr app = QSharedPointer<AppInfo>::create(std::move(info));
+        snapshot->index.insert(app->id, app);
+        snapshot->byPath.insert(app->absolutePath, app);
+        snapshot->apps.append(app);
+    }
+    return snapshot;
+}
+
+QSharedPointer<MarathonAppRegistry::Snapshot> MarathonAppRegistry::editableSnapshot() const {
+    // The containers are implicitly shared; patching one copies its pointers, never an AppInfo
+    return QSharedPointer<Snapshot>::create(*m_snapshot);
+}
+
+void MarathonAppRegistry::setSnapshot(const SnapshotPtr &snapshot) {
+    const SnapshotPtr previous = m_snapshot;
+
+    beginResetModel();
+    swapSnapshot(snapshot);
+    endResetModel();
+
+    for (const AppPtr &app : snapshot->apps) {
+        if (!previous->index.contains(app->id))
+            emit appRegistered(app->id);
+    }
+    for (const AppPtr &app : previous->apps) {
+        if (!snapshot->index.contains(app->id))
+            emit appUnregistered(app->id);
+    }
+    if (previous->apps.size() != snapshot->apps.size())
+        emit countChanged();
+
+    qDebug() << "[MarathonAppRegistry] Now" << count() << "apps (was" << previous->apps.size()
+             << ")";
 }
 
-MarathonAppRegistry::AppInfo *MarathonAppRegistry::getAppInfo(const QString &appId) {
-    return m_appIndex.value(appId, nullptr);
+void MarathonAppRegistry::swapSnapshot(const SnapshotPtr &snapshot) {
+    QMutexLocker locker(&m_snapshotMutex);
+    m_snapshot = snapshot;
 }
@@ -2,9 +2,21 @@
 
 #include <QAbstractListModel>
 #include <QHash>
+#include <QMutex>
+#include <QSharedPointer>
 #include <QString>
 #include <QStringList>
+#include <QVector>
 
+/**
+ * @brief Marathon apps known to the shell, as a list model
+ *
+ * The apps live in an immutable Snapshot. Writers build a new snapshot and
+ * swap it in on the GUI thread; readers on other threads take their own
+ * reference through snapshot() and never see a half-updated list. The model
+ * and the Q_INVOKABLE accessors read the current snapshot directly, which is
+ * safe because only the GUI thread ever replaces it.
+ */
 class MarathonAppRegistry : public QAbstractListModel {
     Q_OBJECT
     Q_PROPERTY(int count READ count NOTIFY countChanged)
@@ -49,7 +61,29 @@ class MarathonAppRegistry : public QAbstractListModel {
         QStringList categories;
         QStringList handlesUriSchemes;
         QStringList defaultFor;
+
+        bool        operator==(const AppInfo &other) const;
+        bool        operator!=(const AppInfo &other) const {
+            return !(*this == other);
+        }
+    };
+
+    using AppPtr = QSharedPointer<const AppInfo>;
+
+    // Apps are shared between snapshots, so a per-app change copies pointers, not apps
+    struct Snapshot {
+        QVector<AppPtr>        apps;   // model rows
+        QHash<QString, AppPtr> index;  // id -> app
+        QHash<QString, AppPtr> byPath; // absolutePath -> app
+
+        const AppInfo         *find(const QString &appId) const {
+            return index.value(appId).data();
+        }
+        const AppInfo *findByPath(const QString &absolutePath) const {
+            return byPath.value(absolutePath).data();
+        }
     };
+    using SnapshotPtr = QSharedPointer<const Snapshot>;
 
     explicit MarathonAppRegistry(QObject *parent = nullptr);
     ~MarathonAppRegistry() override;
@@ -59,7 +93,7 @@ class MarathonAppRegistry : public QAbstractListModel {
     QHash<int, QByteArray> roleNames() const override;
 
     int                    count() const {
-        return m_apps.count();
+        return static_cast<int>(m_snapshot->apps.size());
     }
 
     Q_INVOKABLE QVariantMap getApp(const QString &appId) const;
@@ -72,14 +106,48 @@ class MarathonAppRegistry : public QAbstractListModel {
     Q_INVOKABLE QStringList getAllAppIds() const;
 
     void                    registerAppInfo(const AppInfo &info);
-    AppInfo                *getAppInfo(const QString &appId);
+
+    /**
+     * @brief Add or replace one app, touching only its row (GUI thread only)
+     * @return false if the registry already had exactly this app
+     */
+    bool updateAppInfo(const AppInfo &info);
+
+    // Remove one app and its row (GUI thread only); false if it was not registered
+    bool unregisterApp(const QString &appId);
+
+    // Valid until the registry is next changed; GUI thread only
+    const AppInfo *getAppInfo(const QString &appId) const;
+
+    // Current apps; may be called from any thread and stays valid while held
+    SnapshotPtr snapshot() const;
+
+    /**
+     * @brief Snapshot of the given apps, in order; the first app wins a duplicate id
+     *
+     * Touches no registry state, so scanners can build one on a worker thread.
+     */
+    static SnapshotPtr createSnapshot(QVector<AppInfo> apps);
+
+    /**
+     * @brief Replace all apps with the snapshot in one model reset (GUI thread only)
+     *
+     * Emits appRegistered/appUnregistered for the ids that came and went and
+     * countChanged once.
+     */
+    void setSnapshot(const SnapshotPtr &snapshot);
 
   signals:
     void appRegistered(const QString &appId);
+    void appUpdated(const QString &appId);
     void appUnregistered(const QString &appId);
     void countChanged();
 
   private:
-    QVector<AppInfo *>        m_apps;
-    QHash<QString, AppInfo *> m_appIndex;
+    void                     swapSnapshot(const SnapshotPtr &snapshot);
+    // Shallow copy of the current snapshot for a writer to patch
+    QSharedPointer<Snapshot> editableSnapshot() const;
+
+    SnapshotPtr              m_snapshot;
+    mutable QMutex           m_snapshotMutex; // guards the pointer for readers off the GUI thread
 };
@@ -0,0 +1,65 @@
+#include "marathonapprunnerpool.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+
+MarathonAppRunnerPool::MarathonAppRunnerPool(QObject *parent)
+    : QObject(parent)
+    , m_zygote(new QProcess(this)) {
+    QString runtimeDir = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    if (runtimeDir.isEmpty())
+        runtimeDir = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
+    m_socketPath = QString("%1/marathon-app-runner-%2.sock")
+                       .arg(runtimeDir)
+                       .arg(QCoreApplication::applicationPid());
+
+    m_zygote->setProcessChannelMode(QProcess::ForwardedChannels);
+    connect(m_zygote, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+            [](int exitCode, QProcess::ExitStatus exitStatus) {
+                qWarning() << "[MarathonAppRunnerPool] Runner template exited:" << exitCode
+                           << (exitStatus == QProcess::CrashExit ? "(crashed)" : "");
+            });
+}
+
+MarathonAppRunnerPool::~MarathonAppRunnerPool() {
+    if (m_zygote->state() != QProcess::NotRunning) {
+        m_zygote->terminate();
+        m_zygote->waitForFinished(1000);
+    }
+    QFile::remove(m_socketPath);
+}
+
+QString MarathonAppRunnerPool::runnerPath() {
+    return QCoreApplication::applicationDirPath() + "/marathon-app-runner";
+}
+
+bool MarathonAppRunnerPool::isRunning() const {
+    // The socket appears once the template is ready to take requests
+    return m_zygote->state() == QProcess::Running && QFileInfo::exists(m_socketPath);
+}
+
+void MarathonAppRunnerPool::setEnvironment(const QProcessEnvironment &environment) {
+    m_environment = environment;
+    m_zygote->setProcessEnvironment(environment);
+}
+
+void MarathonAppRunnerPool::ensureRunning() {
+    if (m_zygote->state() != QProcess::NotRunning)
+        return;
+    if (!hasEnvironment()) {
+        // Started now, the template's apps would not find the compositor
+        qDebug() << "[MarathonAppRunnerPool] No compositor environment yet, not starting";
+        return;
+    }
+    if (!QFileInfo::exists(runnerPath())) {
+        qWarning() << "[MarathonAppRunnerPool] Runner not installed:" << runnerPath();
+        return;
+    }
+
+    // A socket left behind would make the new template look ready before it is
+    QFile::remove(m_socketPath);
+    qInfo() << "[MarathonAppRunnerPool] Starting runner template on" << m_socketPath;
+    m_zygote->start(runnerPath(), {"--zygote", m_socketPath});
+}
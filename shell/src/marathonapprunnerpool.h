@@ -0,0 +1,49 @@
+#pragma once
+
+#include <QObject>
+#include <QProcess>
+#include <QString>
+
+/**
+ * @brief The marathon-app-runner template isolated apps are forked from
+ *
+ * Started on demand, the template keeps a warm app runtime ready, so an
+ * isolated app starts without paying for Qt and QML engine startup. The
+ * template and the apps it started exit together with the shell.
+ * MarathonAppProcess falls back to starting the runner directly while the
+ * template is not running.
+ *
+ * Apps are Wayland clients of the shell's compositor, so the template is only
+ * started once the compositor's launch environment has been set.
+ */
+class MarathonAppRunnerPool : public QObject {
+    Q_OBJECT
+
+  public:
+    explicit MarathonAppRunnerPool(QObject *parent = nullptr);
+    ~MarathonAppRunnerPool() override;
+
+    static QString runnerPath();
+
+    QString socketPath() const {
+        return m_socketPath;
+    }
+    bool isRunning() const;
+
+    // Environment of every runner, the template and cold started ones alike
+    QProcessEnvironment environment() const {
+        return m_environment;
+    }
+    bool hasEnvironment() const {
+        return !m_environment.isEmpty();
+    }
+    void setEnvironment(const QProcessEnvironment &environment);
+
+    // Starts the template unless it is running already or has no environment yet
+    void ensureRunning();
+
+  private:
+    QProcess           *m_zygote;
+    QString             m_socketPath;
+    QProcessEnvironment m_environment;
+};
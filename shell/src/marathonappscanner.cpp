@@ -1,34 +1,52 @@
 #include "marathonappscanner.h"
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QStandardPaths>
+#include <QThreadPool>
+#include <QTimer>
 #include <QDebug>
-#ifdef HAVE_QT_CONCURRENT
-#include <QtConcurrent>
-#endif
+#include <utility>
+
+namespace {
+    // An install writes many files; wait for it to settle before reading the manifest
+    constexpr int kChangeDelayMs = 300;
+} // namespace
 
 MarathonAppScanner::MarathonAppScanner(MarathonAppRegistry *registry, QObject *parent)
     : QObject(parent)
     , m_registry(registry)
-#ifdef HAVE_QT_CONCURRENT
-    , m_scanWatcher(new QFutureWatcher<int>(this))
-#else
-    , m_scanWatcher(nullptr)
-#endif
-{
+    , m_watcher(new QFileSystemWatcher(this))
+    , m_changeTimer(new QTimer(this))
+    , m_watching(false)
+    , m_scanning(0)
+    , m_generation(0) {
+    m_scanPool.setMaxThreadCount(1);
+
+    m_changeTimer->setSingleShot(true);
+    m_changeTimer->setInterval(kChangeDelayMs);
+    connect(m_changeTimer, &QTimer::timeout, this, &MarathonAppScanner::applyPendingChanges);
+
+    // Directory events cover apps being added or removed and manifests being replaced;
+    // file events cover manifests rewritten in place
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, [this](const QString &path) {
+        m_changedPaths.insert(path);
+        m_changeTimer->start();
+    });
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, this, [this](const QString &path) {
+        m_changedPaths.insert(QFileInfo(path).absolutePath());
+        m_changeTimer->start();
+    });
+
     qDebug() << "[MarathonAppScanner] Initialized";
+}
 
-#ifdef HAVE_QT_CONCURRENT
-    // Connect async scan completion
-    connect(m_scanWatcher, &QFutureWatcher<int>::finished, this, [this]() {
-        int count = m_scanWatcher->result();
-        qDebug() << "[MarathonAppScanner] Async scan complete. Discovered:" << count << "apps";
-        emit scanComplete(count);
-    });
-#endif
+MarathonAppScanner::~MarathonAppScanner() {
+    m_scanPool.waitForDone();
 }
 
 QStringList MarathonAppScanner::getSearchPaths() {
@@ -51,38 +69,53 @@ QStringList MarathonAppScanner::getSearchPaths() {
 }
 
 void MarathonAppScanner::scanApplications() {
-    // Keep synchronous version for backwards compatibility
+    // Any async scan still reading is older than this one
+    m_scanPool.waitForDone();
     emit scanStarted();
-    int  count = performScan();
+    int  count = applyScan(performScan());
     emit scanComplete(count);
 }
 
 void MarathonAppScanner::scanApplicationsAsync() {
+    // A scan already in flight will see the same directories
+    if (!m_scanning.testAndSetAcquire(0, 1)) {
+        qDebug() << "[MarathonAppScanner] Scan already running";
+        return;
+    }
+
     qDebug() << "[MarathonAppScanner] Starting async app scan...";
     emit scanStarted();
 
-#ifdef HAVE_QT_CONCURRENT
-    // Run scan in background thread using QtConcurrent
-    if (m_scanWatcher) {
-        QFuture<int> future = QtConcurrent::run([this]() { return this->performScan(); });
-        m_scanWatcher->setFuture(future);
-    } else {
-        // Fallback to synchronous if Concurrent not available
-        int  count = performScan();
-        emit scanComplete(count);
-    }
-#else
-    // Fallback to synchronous if Concurrent not available
-    int  count = performScan();
-    emit scanComplete(count);
-#endif
+    // The worker only builds a snapshot; the registry is changed on this thread once it is done
+    const int generation = m_generation;
+    m_scanPool.start([this, generation]() {
+        const MarathonAppRegistry::SnapshotPtr snapshot = performScan();
+        QMetaObject::invokeMethod(
+            this,
+            [this, generation, snapshot]() {
+                m_scanning.storeRelease(0);
+                if (generation != m_generation) {
+                    qDebug() << "[MarathonAppScanner] Dropping async scan, a newer one was applied";
+                } else {
+                    int count = applyScan(snapshot);
+                    qDebug() << "[MarathonAppScanner] Async scan complete. Discovered:" << count
+                             << "apps";
+                    emit scanComplete(count);
+                }
+
+                // Changes held back while the scan was reading, applied or not, are due now
+                if (!m_changedPaths.isEmpty())
+                    m_changeTimer->start();
+            },
+            Qt::QueuedConnection);
+    });
 }
 
-int MarathonAppScanner::performScan() {
+MarathonAppRegistry::SnapshotPtr MarathonAppScanner::performScan() {
     qDebug() << "[MarathonAppScanner] Performing app scan...";
 
-    int         discoveredCount = 0;
-    QStringList searchPaths     = getSearchPaths();
+    QVector<MarathonAppRegistry::AppInfo> apps;
+    QStringList                           searchPaths = getSearchPaths();
 
     for (const QString &searchPath : searchPaths) {
         QDir dir(searchPath);
@@ -110,25 +143,154 @@ int MarathonAppScanner::performScan() {
 
             MarathonAppRegistry::AppInfo appInfo = parseManifest(manifestPath, appPath);
 
-            if (validateManifest(appInfo)) {
-                // absolutePath already set in parseManifest
+            // absolutePath already set in parseManifest; system paths come first and win
+            if (validateManifest(appInfo))
+                apps.append(appInfo);
+        }
+    }
 
-                // Register with registry
-                if (!m_registry->hasApp(appInfo.id)) {
-                    m_registry->registerAppInfo(appInfo);
-                    emit appDiscovered(appInfo.id);
-                    discoveredCount++;
-                } else {
-                    qDebug() << "[MarathonAppScanner] App already registered:" << appInfo.id;
-                }
-            }
+    return MarathonAppRegistry::createSnapshot(std::move(apps));
+}
+
+int MarathonAppScanner::applyScan(const MarathonAppRegistry::SnapshotPtr &snapshot) {
+    const MarathonAppRegistry::SnapshotPtr previous = m_registry->snapshot();
+    m_registry->setSnapshot(snapshot);
+    ++m_generation;
+
+    int discoveredCount = 0;
+    for (const MarathonAppRegistry::AppPtr &app : snapshot->apps) {
+        if (!previous->index.contains(app->id)) {
+            emit appDiscovered(app->id);
+            discoveredCount++;
         }
     }
 
+    if (m_watching) {
+        for (const MarathonAppRegistry::AppPtr &app : snapshot->apps)
+            watchApp(app->absolutePath);
+    }
+
     qDebug() << "[MarathonAppScanner] Scan complete. Discovered:" << discoveredCount << "apps";
     return discoveredCount;
 }
 
+void MarathonAppScanner::startWatching() {
+    if (m_watching)
+        return;
+    m_watching = true;
+
+    for (const QString &searchPath : getSearchPaths()) {
+        if (QFileInfo::exists(searchPath))
+            m_watcher->addPath(searchPath);
+    }
+    for (const MarathonAppRegistry::AppPtr &app : m_registry->snapshot()->apps)
+        watchApp(app->absolutePath);
+
+    qDebug() << "[MarathonAppScanner] Watching" << m_watcher->directories().size()
+             << "directories for app changes";
+}
+
+void MarathonAppScanner::watchApp(const QString &appPath) {
+    // Also the search path, which may only have been created by the first install
+    const QStringList watched = m_watcher->directories() + m_watcher->files();
+    QStringList       paths   = {QFileInfo(appPath).absolutePath(), appPath,
+                                 getManifestPath(appPath)};
+    paths.removeIf([&watched](const QString &path) {
+        return watched.contains(path) || !QFileInfo::exists(path);
+    });
+    if (!paths.isEmpty())
+        m_watcher->addPaths(paths);
+}
+
+int MarathonAppScanner::searchPathRank(const QString &appPath) {
+    const QStringList searchPaths = getSearchPaths();
+    const qsizetype   rank        = searchPaths.indexOf(QFileInfo(appPath).absolutePath());
+    return static_cast<int>(rank < 0 ? searchPaths.size() : rank);
+}
+
+void MarathonAppScanner::applyPendingChanges() {
+    // The running scan picks these up once it has been applied
+    if (m_scanning.loadAcquire())
+        return;
+
+    const QSet<QString> changed     = std::exchange(m_changedPaths, {});
+    const QStringList   searchPaths = getSearchPaths();
+
+    for (const QString &path : changed) {
+        if (!searchPaths.contains(path)) {
+            rescanApp(path);
+            continue;
+        }
+
+        // Apps installed into or removed from a search path
+        const MarathonAppRegistry::SnapshotPtr snapshot = m_registry->snapshot();
+        QSet<QString>                          onDisk;
+        const QDir                             dir(path);
+        for (const QString &appDir : dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+            const QString appPath = dir.absoluteFilePath(appDir);
+            onDisk.insert(appPath);
+            if (!snapshot->findByPath(appPath))
+                rescanApp(appPath);
+        }
+        for (const MarathonAppRegistry::AppPtr &app : snapshot->apps) {
+            if (QFileInfo(app->absolutePath).absolutePath() == path &&
+                !onDisk.contains(app->absolutePath))
+                rescanApp(app->absolutePath);
+        }
+    }
+}
+
+void MarathonAppScanner::rescanApp(const QString &appPath) {
+    const QString path = QDir(appPath).absolutePath();
+    if (m_scanning.loadAcquire()) {
+        // Applied on top of the scan's snapshot once it lands
+        m_changedPaths.insert(path);
+        return;
+    }
+
+    // Held so the pointers below outlive any change made to the registry
+    const MarathonAppRegistry::SnapshotPtr current  = m_registry->snapshot();
+    const MarathonAppRegistry::AppInfo    *previous = current->findByPath(path);
+
+    MarathonAppRegistry::AppInfo           info;
+    bool                                   valid        = false;
+    const QString                          manifestPath = getManifestPath(path);
+    if (QFile::exists(manifestPath)) {
+        info  = parseManifest(manifestPath, path);
+        valid = validateManifest(info);
+    }
+
+    // The app is gone, or its manifest now declares another id
+    if (previous && (!valid || previous->id != info.id)) {
+        m_registry->unregisterApp(previous->id);
+        emit appRemoved(previous->id);
+
+        // A copy of the same app in another search path was hidden by this one
+        for (const QString &searchPath : getSearchPaths()) {
+            const QString other = searchPath + "/" + QFileInfo(path).fileName();
+            if (other != path && QFile::exists(getManifestPath(other)))
+                rescanApp(other);
+        }
+    }
+
+    if (!valid)
+        return;
+
+    // Like a full scan, the copy in the earlier search path wins
+    const MarathonAppRegistry::AppInfo *registered = current->find(info.id);
+    if (registered && registered->absolutePath != path &&
+        searchPathRank(registered->absolutePath) <= searchPathRank(path)) {
+        qDebug() << "[MarathonAppScanner] App" << info.id << "already provided by"
+                 << registered->absolutePath;
+        return;
+    }
+
+    if (m_registry->updateAppInfo(info))
+        emit appChanged(info.id);
+    if (m_watching)
+        watchApp(path);
+}
+
 QString MarathonAppScanner::getManifestPath(const QString &appPath) {
     return appPath + "/manifest.json";
 }
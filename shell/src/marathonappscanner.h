@@ -1,41 +1,78 @@
 #pragma once
 
+#include <QAtomicInt>
 #include <QObject>
+#include <QSet>
 #include <QString>
 #include <QStringList>
-#ifdef HAVE_QT_CONCURRENT
-#include <QFutureWatcher>
-#endif
+#include <QThreadPool>
 #include "marathonappregistry.h"
 
+class QFileSystemWatcher;
+class QTimer;
+
+/**
+ * @brief Finds Marathon apps (directories with a manifest.json) and registers them
+ *
+ * A full scan replaces the registry contents in one go. After startWatching()
+ * the search paths and every app directory are watched, and only the apps
+ * whose manifest was added, changed or removed are re-read; rescanApp() does
+ * the same for one directory on request (e.g. right after an install).
+ */
 class MarathonAppScanner : public QObject {
     Q_OBJECT
 
   public:
     explicit MarathonAppScanner(MarathonAppRegistry *registry, QObject *parent = nullptr);
+    ~MarathonAppScanner() override;
 
     Q_INVOKABLE void    scanApplications();
-    Q_INVOKABLE void    scanApplicationsAsync(); // New async method
+    Q_INVOKABLE void    scanApplicationsAsync(); // Reads manifests on a worker thread
     Q_INVOKABLE QString getManifestPath(const QString &appPath);
 
+    /**
+     * @brief Re-read one app directory and apply only its change to the registry
+     *
+     * Registers or updates the app if the directory holds a valid manifest and
+     * unregisters the app previously found there otherwise. Emits appChanged or
+     * appRemoved if the registry changed.
+     */
+    Q_INVOKABLE void rescanApp(const QString &appPath);
+
+    // Follow installs, updates and removals in the search paths from now on
+    Q_INVOKABLE void startWatching();
+
   signals:
     void scanStarted();
     void appDiscovered(const QString &appId);
     void scanProgress(int current, int total); // New progress signal
     void scanComplete(int count);
     void scanError(const QString &error);
+    void appChanged(const QString &appId); // added or updated outside a full scan
+    void appRemoved(const QString &appId);
 
   private:
     QStringList                  getSearchPaths();
     MarathonAppRegistry::AppInfo parseManifest(const QString &manifestPath,
                                                const QString &appDirPath);
     bool                         validateManifest(const MarathonAppRegistry::AppInfo &info);
-    int                          performScan(); // Actual scan logic (for thread), returns count
-
-    MarathonAppRegistry         *m_registry;
-#ifdef HAVE_QT_CONCURRENT
-    QFutureWatcher<int> *m_scanWatcher; // For async scanning
-#else
-    void *m_scanWatcher; // Placeholder when Concurrent not available
-#endif
+
+    // Reads every manifest without touching the registry, so it may run on any thread
+    MarathonAppRegistry::SnapshotPtr performScan();
+
+    // Swaps the scanned apps into the registry (GUI thread), returns the number of new apps
+    int                  applyScan(const MarathonAppRegistry::SnapshotPtr &snapshot);
+
+    void                 applyPendingChanges();
+    void                 watchApp(const QString &appPath);
+    int                  searchPathRank(const QString &appPath);
+
+    MarathonAppRegistry *m_registry;
+    QFileSystemWatcher  *m_watcher;
+    QTimer              *m_changeTimer;  // coalesces the burst of events from one install
+    QSet<QString>        m_changedPaths; // search paths and app directories to re-read
+    bool                 m_watching;
+    QAtomicInt           m_scanning;
+    int                  m_generation; // bumped by every applied scan, drops stale async results
+    QThreadPool          m_scanPool;   // one scan at a time
 };
@@ -0,0 +1,80 @@
+#include "marathonimportpaths.h"
+#include <QDebug>
+#include <QStandardPaths>
+
+MarathonImportPaths::MarathonImportPaths(QQmlEngine *engine)
+    : m_engine(engine)
+    , m_sharedPathsAdded(false) {}
+
+void MarathonImportPaths::addSharedPaths() {
+    if (m_sharedPathsAdded || !m_engine)
+        return;
+    m_sharedPathsAdded = true;
+
+    // Ensure MarathonUI is available to apps (same paths as in main.cpp)
+    addToEngine(QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) +
+                "/marathon-ui");
+    addToEngine("/usr/lib/qt6/qml/MarathonUI");
+
+    // Shell QML module path so apps can access MarathonOS.Shell singletons
+    addToEngine("qrc:/");
+    addToEngine(":/");
+}
+
+QString MarathonImportPaths::addToEngine(const QString &path) {
+    // The engine normalises the path; remember its form so it can be taken off the list again
+    const QStringList before = m_engine->importPathList();
+    m_engine->addImportPath(path);
+    for (const QString &added : m_engine->importPathList()) {
+        if (!before.contains(added))
+            return added;
+    }
+    return QString();
+}
+
+void MarathonImportPaths::acquireAppPath(const QString &appPath) {
+    if (!m_engine || appPath.isEmpty())
+        return;
+
+    auto it = m_appPaths.find(appPath);
+    if (it == m_appPaths.end()) {
+        it             = m_appPaths.insert(appPath, AppPath());
+        it->enginePath = addToEngine(appPath);
+    }
+    if (it->users++ == 0)
+        m_idle.removeOne(appPath);
+}
+
+void MarathonImportPaths::releaseAppPath(const QString &appPath) {
+    auto it = m_appPaths.find(appPath);
+    if (it == m_appPaths.end() || it->users == 0)
+        return;
+
+    if (--it->users == 0) {
+        m_idle.append(appPath);
+        evictIdlePaths();
+    }
+}
+
+QStringList MarathonImportPaths::appPaths() const {
+    return m_appPaths.keys();
+}
+
+void MarathonImportPaths::evictIdlePaths() {
+    if (m_idle.size() <= kMaxIdleAppPaths)
+        return;
+
+    QStringList importPaths = m_engine->importPathList();
+    bool        changed     = false;
+    while (m_idle.size() > kMaxIdleAppPaths) {
+        const AppPath evicted = m_appPaths.take(m_idle.takeFirst());
+        if (importPaths.removeOne(evicted.enginePath))
+            changed = true;
+    }
+
+    // Resets the engine's import caches, so once for the whole batch
+    if (changed) {
+        m_engine->setImportPathList(importPaths);
+        qDebug() << "[MarathonImportPaths] Import paths trimmed to" << importPaths.size();
+    }
+}
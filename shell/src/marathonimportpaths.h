@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QHash>
+#include <QQmlEngine>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief QML import paths for Marathon apps, kept bounded over a long session
+ *
+ * The paths every app needs (MarathonUI and the shell's own resources) are
+ * added to the engine once. An app's own directory is an import path only
+ * while something holds it: the loader from launch until the app is
+ * unloaded, the compiler while it compiles the app. Released directories stay
+ * for a few more launches, least recently used first out, and are then taken
+ * off the engine's list again.
+ *
+ * The engine's import path list therefore stays at the shared paths plus the
+ * apps in use plus kMaxIdleAppPaths, however many launches there are.
+ * Adding a path the engine already has is skipped entirely.
+ */
+class MarathonImportPaths {
+  public:
+    static constexpr int kMaxIdleAppPaths = 8;
+
+    explicit MarathonImportPaths(QQmlEngine *engine);
+
+    QQmlEngine *engine() const {
+        return m_engine;
+    }
+
+    // Adds the shared paths the first time, does nothing after that
+    void addSharedPaths();
+
+    // Makes appPath an import path until every acquire has been released
+    void acquireAppPath(const QString &appPath);
+    void releaseAppPath(const QString &appPath);
+
+    // App directories currently on the engine's list, in use or idle
+    QStringList appPaths() const;
+
+  private:
+    struct AppPath {
+        QString enginePath; // as the engine stored it, empty if it was there already
+        int     users = 0;
+    };
+
+    QString                 addToEngine(const QString &path);
+    void                    evictIdlePaths();
+
+    QQmlEngine             *m_engine;
+    bool                    m_sharedPathsAdded;
+    QHash<QString, AppPath> m_appPaths;
+    QStringList             m_idle; // released app paths, least recently used first
+};
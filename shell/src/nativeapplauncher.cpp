@@ -0,0 +1,141 @@
+#include "nativeapplauncher.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+namespace {
+    // Characters that make a command shell syntax rather than a plain argument list
+    const QString kShellSyntax = QStringLiteral("|&;<>()$`\\\"'*?[]{}~#!\n");
+} // namespace
+
+NativeAppLauncher::NativeAppLauncher(const QString &socketName,
+                                     const QString &desktopFileDirectory, QObject *parent)
+    : QObject(parent)
+    , m_environment(QProcessEnvironment::systemEnvironment())
+    , m_directory(desktopFileDirectory.isEmpty() ? QStringLiteral("/tmp/marathon-apps")
+                                                 : desktopFileDirectory)
+    , m_launches(0) {
+    QString runtimeDir = m_environment.value("XDG_RUNTIME_DIR");
+    if (runtimeDir.isEmpty()) {
+        qWarning() << "[NativeAppLauncher] XDG_RUNTIME_DIR not set! Apps may fail to connect.";
+        runtimeDir = "/tmp";
+    }
+
+    // CRITICAL: Remove parent compositor's WAYLAND_DISPLAY to force apps to use OUR compositor
+    m_environment.remove("WAYLAND_DISPLAY"); // Remove parent Wayland compositor
+    m_environment.remove("DISPLAY");         // Remove X11 display (force Wayland)
+
+    // Set OUR compositor variables
+    m_environment.insert("WAYLAND_DISPLAY", socketName);
+    m_environment.insert("XDG_RUNTIME_DIR", runtimeDir);
+    m_environment.insert("QT_QPA_PLATFORM", "wayland");
+    m_environment.insert("GDK_BACKEND", "wayland");
+    m_environment.insert("CLUTTER_BACKEND", "wayland");
+    m_environment.insert("SDL_VIDEODRIVER", "wayland");
+
+    // Mobile form factor environment variables
+    // These tell GTK4/libadwaita and Qt apps to use mobile/adaptive layouts
+    m_environment.insert("LIBADWAITA_MOBILE", "1");            // Force libadwaita mobile mode
+    m_environment.insert("PURISM_FORM_FACTOR", "phone");       // Phosh compatibility
+    m_environment.insert("QT_QUICK_CONTROLS_MOBILE", "1");     // Qt Quick Controls mobile mode
+    m_environment.insert("QT_QUICK_CONTROLS_STYLE", "Mobile"); // Qt Quick Controls mobile style
+    m_environment.insert("GTK_CSD", "1");                      // Client-side decorations (GTK)
+    m_environment.insert("GTK_USE_PORTAL", "0");               // Portals misbehave when nested
+
+    m_environment.insert("GIO_LAUNCHED_DESKTOP_FILE_PID",
+                         QString::number(QCoreApplication::applicationPid()));
+
+    // A properly formatted desktop file for GApplication
+    // GApplication uses the desktop file basename for D-Bus name generation and parses
+    // various fields. Including all standard fields prevents GLib warnings and ensures
+    // proper application behavior across GTK, Qt, and other toolkits.
+    m_desktopEntry = "[Desktop Entry]\n"
+                     "Version=1.0\n"
+                     "Type=Application\n"
+                     "Name=Marathon Embedded App\n"
+                     "GenericName=Application\n"
+                     "Comment=Application running in Marathon OS\n"
+                     "Terminal=false\n"
+                     "Categories=Utility;\n"
+                     "StartupNotify=true\n"
+                     "X-GNOME-UsesNotifications=false\n"
+                     "X-Marathon-Embedded=true\n";
+
+    QDir().mkpath(m_directory);
+    const int removed = removeStaleDesktopFiles();
+    if (removed > 0)
+        qDebug() << "[NativeAppLauncher] Removed" << removed << "stale desktop files";
+}
+
+QProcess *NativeAppLauncher::createProcess(const QString &command, QObject *parent) {
+    QProcess           *process = new QProcess(parent);
+    QProcessEnvironment env     = m_environment;
+
+    // CRITICAL: Force new instances of GApplication apps
+    // GApplication apps check D-Bus for existing instances and send commands to them instead
+    // of launching new windows, which would open them in the host compositor. A unique
+    // desktop file per launch gives each one a unique D-Bus name.
+    const QString desktopFile = writeDesktopFile(command);
+    if (!desktopFile.isEmpty()) {
+        env.insert("GIO_LAUNCHED_DESKTOP_FILE", desktopFile);
+        connect(process, &QObject::destroyed, [desktopFile]() { QFile::remove(desktopFile); });
+    }
+
+    process->setProcessEnvironment(env);
+    return process;
+}
+
+QString NativeAppLauncher::writeDesktopFile(const QString &command) {
+    const QString path = QString("%1/marathon-%2-%3-%4.desktop")
+                             .arg(m_directory)
+                             .arg(QCoreApplication::applicationPid())
+                             .arg(++m_launches)
+                             .arg(qHash(command));
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "[NativeAppLauncher] Failed to create desktop file:" << path;
+        return QString();
+    }
+    file.write(m_desktopEntry);
+    file.write("Exec=" + command.toUtf8() + "\n");
+    return path;
+}
+
+void NativeAppLauncher::start(QProcess *process, const QString &command) {
+    QStringList arguments = needsShell(command) ? QStringList() : QProcess::splitCommand(command);
+    if (arguments.isEmpty()) {
+        process->start("/bin/sh", {"-c", command});
+        return;
+    }
+
+    // Saves exec'ing a shell that would only exec the program in turn
+    const QString program = arguments.takeFirst();
+    process->start(program, arguments);
+}
+
+bool NativeAppLauncher::needsShell(const QString &command) {
+    for (const QChar c : command) {
+        if (kShellSyntax.contains(c))
+            return true;
+    }
+    // Leading VAR=value assignments
+    return command.trimmed().section(' ', 0, 0).contains('=');
+}
+
+int NativeAppLauncher::removeStaleDesktopFiles() {
+    // marathon-<shell pid>-<launch>-<hash>.desktop; older shells named them by timestamp
+    int        removed = 0;
+    const QDir dir(m_directory);
+    for (const QString &name : dir.entryList({"marathon-*.desktop"}, QDir::Files)) {
+        const qint64 pid = name.section('-', 1, 1).toLongLong();
+        if (pid == QCoreApplication::applicationPid() ||
+            (pid > 0 && QFileInfo::exists(QString("/proc/%1").arg(pid))))
+            continue;
+        if (QFile::remove(dir.filePath(name)))
+            ++removed;
+    }
+    return removed;
+}
@@ -0,0 +1,59 @@
+#ifndef NATIVEAPPLAUNCHER_H
+#define NATIVEAPPLAUNCHER_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QString>
+
+/**
+ * @brief Starts native apps on the shell's Wayland socket
+ *
+ * Everything that is the same for every launch is prepared once: the child
+ * environment (host display variables removed, ours and the mobile form
+ * factor hints set) and the fixed part of the launch desktop file. A launch
+ * only copies the environment, writes one small desktop file and starts the
+ * process, without a /bin/sh in between unless the command needs one.
+ *
+ * Each launch gets its own desktop file so GApplication apps register a
+ * unique D-Bus name instead of handing the request to a host instance. The
+ * file is removed together with the process object, and files left behind
+ * by shells that are no longer running are removed at startup.
+ */
+class NativeAppLauncher : public QObject {
+    Q_OBJECT
+
+  public:
+    // An empty desktopFileDirectory means /tmp/marathon-apps
+    explicit NativeAppLauncher(const QString &socketName,
+                               const QString &desktopFileDirectory = QString(),
+                               QObject *parent = nullptr);
+
+    QProcessEnvironment environment() const {
+        return m_environment;
+    }
+    QString desktopFileDirectory() const {
+        return m_directory;
+    }
+
+    // Process for command with environment and desktop file set up, not started yet
+    QProcess   *createProcess(const QString &command, QObject *parent);
+
+    // Starts command directly, or through /bin/sh if it uses shell syntax
+    static void start(QProcess *process, const QString &command);
+    static bool needsShell(const QString &command);
+
+    // Removes desktop files of shells that are gone, returns how many
+    int         removeStaleDesktopFiles();
+
+  private:
+    QString             writeDesktopFile(const QString &command);
+
+    QProcessEnvironment m_environment;
+    QString             m_directory;
+    QByteArray          m_desktopEntry; // everything but the Exec line
+    quint64             m_launches;
+};
+
+#endif // NATIVEAPPLAUNCHER_H
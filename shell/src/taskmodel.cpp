@@ -1,8 +1,10 @@
 #include "taskmodel.h"
+#include "tasksnapshotprovider.h"
 #include <QDebug>
 
 TaskModel::TaskModel(QObject *parent)
-    : QAbstractListModel(parent) {
+    : QAbstractListModel(parent)
+    , m_snapshots(QSharedPointer<TaskSnapshotCache>::create()) {
     qDebug() << "[TaskModel] Initialized";
 }
 
@@ -34,7 +36,7 @@ QVariant TaskModel::data(const QModelIndex &index, int role) const {
                     << "- surface:" << (task->waylandSurface() ? "PRESENT" : "NULL");
             return QVariant::fromValue(task->waylandSurface());
         case TimestampRole: return task->timestamp();
-        case SnapshotRole: return task->snapshot();
+        case SnapshotRole: return task->snapshotUrl();
         default: return QVariant();
     }
 }
@@ -94,6 +96,7 @@ void TaskModel::closeTask(const QString &taskId) {
         m_tasks.remove(index);
         m_taskIndex.remove(taskId);
         m_appIndex.remove(appId);
+        m_snapshots->remove(appId);
         endRemoveRows();
 
         emit taskCountChanged();
@@ -129,7 +132,9 @@ void TaskModel::updateTaskSnapshot(const QString &appId, const QImage &snapshot)
         return;
     }
 
-    task->setSnapshot(snapshot);
+    // Only the downscaled copy is kept; QML gets a URL with a fresh cache key
+    QString key = m_snapshots->insert(appId, snapshot);
+    task->setSnapshotUrl(key.isEmpty() ? QString() : TaskSnapshotProvider::url(key));
 
     // Notify model that this task's data changed
     int index = m_tasks.indexOf(task);
@@ -137,7 +142,7 @@ void TaskModel::updateTaskSnapshot(const QString &appId, const QImage &snapshot)
         QModelIndex modelIndex = createIndex(index, 0);
         emit        dataChanged(modelIndex, modelIndex, {SnapshotRole});
         qDebug() << "[TaskModel] Updated snapshot for:" << appId << "size:" << snapshot.width()
-                 << "x" << snapshot.height();
+                 << "x" << snapshot.height() << "key:" << key;
     }
 }
 
@@ -168,6 +173,7 @@ void TaskModel::clear() {
     m_tasks.clear();
     m_taskIndex.clear();
     m_appIndex.clear();
+    m_snapshots->clear();
     endResetModel();
 
     emit taskCountChanged();
@@ -7,6 +7,9 @@
 #include <QDateTime>
 #include <QImage>
 #include <QPointer>
+#include <QSharedPointer>
+
+class TaskSnapshotCache;
 
 class Task : public QObject {
     Q_OBJECT
@@ -18,7 +21,7 @@ class Task : public QObject {
     Q_PROPERTY(int surfaceId READ surfaceId CONSTANT)
     Q_PROPERTY(QObject *waylandSurface READ waylandSurface NOTIFY waylandSurfaceChanged)
     Q_PROPERTY(qint64 timestamp READ timestamp CONSTANT)
-    Q_PROPERTY(QImage snapshot READ snapshot NOTIFY snapshotChanged)
+    Q_PROPERTY(QString snapshotUrl READ snapshotUrl NOTIFY snapshotChanged)
 
   public:
     explicit Task(const QString &id, const QString &appId, const QString &title,
@@ -58,12 +61,13 @@ class Task : public QObject {
     qint64 timestamp() const {
         return m_timestamp;
     }
-    QImage snapshot() const {
-        return m_snapshot;
+    // image://tasksnapshot URL of the latest snapshot, empty if there is none
+    QString snapshotUrl() const {
+        return m_snapshotUrl;
     }
 
-    void setSnapshot(const QImage &snapshot) {
-        m_snapshot = snapshot;
+    void setSnapshotUrl(const QString &url) {
+        m_snapshotUrl = url;
         emit snapshotChanged();
     }
 
@@ -87,7 +91,7 @@ class Task : public QObject {
     int               m_surfaceId;
     QPointer<QObject> m_waylandSurface; // Use QPointer for safe lifecycle management
     qint64            m_timestamp;
-    QImage            m_snapshot;
+    QString           m_snapshotUrl;
 };
 
 class TaskModel : public QAbstractListModel {
@@ -118,6 +122,11 @@ class TaskModel : public QAbstractListModel {
         return m_tasks.count();
     }
 
+    // Shared with the image provider that serves the snapshot URLs
+    QSharedPointer<TaskSnapshotCache> snapshotCache() const {
+        return m_snapshots;
+    }
+
     Q_INVOKABLE void  launchTask(const QString &appId, const QString &appName,
                                  const QString &appIcon, const QString &appType, int surfaceId = -1,
                                  QObject *waylandSurface = nullptr);
@@ -135,9 +144,10 @@ class TaskModel : public QAbstractListModel {
     void taskClosed(const QString &taskId);
 
   private:
-    QVector<Task *>        m_tasks;
-    QHash<QString, Task *> m_taskIndex; // task ID -> Task
-    QHash<QString, Task *> m_appIndex;  // app ID -> Task (for quick lookup)
+    QVector<Task *>                   m_tasks;
+    QHash<QString, Task *>            m_taskIndex; // task ID -> Task
+    QHash<QString, Task *>            m_appIndex;  // app ID -> Task (for quick lookup)
+    QSharedPointer<TaskSnapshotCache> m_snapshots; // downscaled, served by TaskSnapshotProvider
 };
 
 #endif // TASKMODEL_H
@@ -0,0 +1,87 @@
+#include "tasksnapshotprovider.h"
+#include <QDebug>
+#include <QMutexLocker>
+
+QString TaskSnapshotCache::insert(const QString &appId, const QImage &snapshot) {
+    if (snapshot.isNull()) {
+        remove(appId);
+        return QString();
+    }
+
+    QImage scaled = downscale(snapshot, QSize(kMaxWidth, kMaxHeight));
+
+    QMutexLocker locker(&m_mutex);
+    Entry       &entry = m_entries[appId];
+    entry.image        = scaled;
+    entry.generation   = ++m_generation;
+    return key(appId, entry.generation);
+}
+
+void TaskSnapshotCache::remove(const QString &appId) {
+    QMutexLocker locker(&m_mutex);
+    m_entries.remove(appId);
+}
+
+void TaskSnapshotCache::clear() {
+    QMutexLocker locker(&m_mutex);
+    m_entries.clear();
+}
+
+QImage TaskSnapshotCache::image(const QString &key) const {
+    int separator = key.lastIndexOf('/');
+    if (separator <= 0)
+        return QImage();
+
+    bool    ok         = false;
+    quint64 generation = key.mid(separator + 1).toULongLong(&ok);
+    if (!ok)
+        return QImage();
+
+    QMutexLocker locker(&m_mutex);
+    auto         it = m_entries.constFind(key.left(separator));
+    if (it == m_entries.constEnd() || it->generation != generation)
+        return QImage();
+    return it->image;
+}
+
+int TaskSnapshotCache::count() const {
+    QMutexLocker locker(&m_mutex);
+    return m_entries.count();
+}
+
+QImage TaskSnapshotCache::downscale(const QImage &snapshot, const QSize &maxSize) {
+    if (snapshot.width() <= maxSize.width() && snapshot.height() <= maxSize.height())
+        return snapshot;
+    return snapshot.scaled(maxSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+}
+
+QString TaskSnapshotCache::key(const QString &appId, quint64 generation) {
+    return appId + '/' + QString::number(generation);
+}
+
+TaskSnapshotProvider::TaskSnapshotProvider(QSharedPointer<TaskSnapshotCache> cache)
+    : QQuickImageProvider(QQuickImageProvider::Image)
+    , m_cache(std::move(cache)) {}
+
+QImage TaskSnapshotProvider::requestImage(const QString &id, QSize *size,
+                                          const QSize &requestedSize) {
+    QImage image = m_cache ? m_cache->image(id) : QImage();
+    if (image.isNull()) {
+        qDebug() << "[TaskSnapshotProvider] No snapshot for:" << id;
+        return image;
+    }
+
+    if (size)
+        *size = image.size();
+
+    if (requestedSize.width() > 0 || requestedSize.height() > 0) {
+        QSize bounds(requestedSize.width() > 0 ? requestedSize.width() : image.width(),
+                     requestedSize.height() > 0 ? requestedSize.height() : image.height());
+        image = TaskSnapshotCache::downscale(image, bounds);
+    }
+    return image;
+}
+
+QString TaskSnapshotProvider::url(const QString &key) {
+    return QStringLiteral("image://%1/%2").arg(QLatin1String(kProviderId), key);
+}
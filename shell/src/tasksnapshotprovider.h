@@ -0,0 +1,73 @@
+#ifndef TASKSNAPSHOTPROVIDER_H
+#define TASKSNAPSHOTPROVIDER_H
+
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QQuickImageProvider>
+#include <QSharedPointer>
+#include <QSize>
+#include <QString>
+
+/**
+ * @brief Downscaled task snapshots, one per app
+ *
+ * Snapshots are scaled down to task switcher size when they are stored, so
+ * an open app costs a card's worth of pixels instead of a framebuffer. Every
+ * store gets a new cache key; QML only sees the key as part of an image URL,
+ * which makes the pixmap cache fetch each snapshot once and share it between
+ * all Image elements showing it.
+ *
+ * TaskModel writes on the GUI thread, the image provider may read from QML's
+ * image loader threads.
+ */
+class TaskSnapshotCache {
+  public:
+    // Largest stored snapshot, about a task card at 3x scale
+    static constexpr int kMaxWidth  = 480;
+    static constexpr int kMaxHeight = 960;
+
+    // Stores a downscaled copy and returns its cache key; a null image drops the
+    // app's snapshot and returns an empty key
+    QString insert(const QString &appId, const QImage &snapshot);
+    void    remove(const QString &appId);
+    void    clear();
+
+    // Image for a cache key, null if the key is unknown or was replaced
+    QImage        image(const QString &key) const;
+    int           count() const;
+
+    static QImage downscale(const QImage &snapshot, const QSize &maxSize);
+    // "<appId>/<generation>"
+    static QString key(const QString &appId, quint64 generation);
+
+  private:
+    struct Entry {
+        QImage  image;
+        quint64 generation = 0;
+    };
+
+    mutable QMutex        m_mutex;
+    QHash<QString, Entry> m_entries; // app ID -> snapshot
+    quint64               m_generation = 0;
+};
+
+/**
+ * @brief Serves TaskSnapshotCache entries as image://tasksnapshot/<key>
+ */
+class TaskSnapshotProvider : public QQuickImageProvider {
+  public:
+    static constexpr const char *kProviderId = "tasksnapshot";
+
+    explicit TaskSnapshotProvider(QSharedPointer<TaskSnapshotCache> cache);
+
+    QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize) override;
+
+    // Image source for a cache key
+    static QString url(const QString &key);
+
+  private:
+    QSharedPointer<TaskSnapshotCache> m_cache;
+};
+
+#endif // TASKSNAPSHOTPROVIDER_H
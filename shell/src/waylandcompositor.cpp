@@ -1,12 +1,11 @@
 #include "waylandcompositor.h"
 #include "settingsmanager.h"
+#include "nativeapplauncher.h"
+#include "waylandsurfaceregistry.h"
+#include "frametimingmonitor.h"
 #include <QDebug>
 #include <QTimer>
 #include <QPointer>
-#include <QDateTime>
-#include <QFile>
-#include <QDir>
-#include <QTextStream>
 #include <QWaylandXdgToplevel>
 #include <QWaylandXdgSurface>
 #include <QtMath>
@@ -20,10 +19,10 @@
 WaylandCompositor::WaylandCompositor(QQuickWindow *window, SettingsManager *settingsManager)
     : QWaylandCompositor()
     , m_window(window)
-    , m_settingsManager(settingsManager)
-    , m_nextSurfaceId(1) {
+    , m_settingsManager(settingsManager) {
     m_xdgShell = new QWaylandXdgShell(this);
     m_wlShell  = new QWaylandWlShell(this);
+    m_registry = new WaylandSurfaceRegistry(this);
 
     connect(this, &QWaylandCompositor::surfaceCreated, this,
             &WaylandCompositor::handleSurfaceCreated);
@@ -54,6 +53,8 @@ WaylandCompositor::WaylandCompositor(QQuickWindow *window, SettingsManager *sett
 
     create();
 
+    m_launcher = new NativeAppLauncher(socketName(), QString(), this);
+
     // Note: Keyboard focus is managed automatically by QWaylandCompositor in Qt6
     // The defaultInputDevice() API was removed in newer Qt6 versions
     // Keyboard focus handling is now done internally by the compositor
@@ -73,7 +74,7 @@ WaylandCompositor::WaylandCompositor(QQuickWindow *window, SettingsManager *sett
 }
 
 WaylandCompositor::~WaylandCompositor() {
-    for (auto process : m_processes.keys()) {
+    for (QProcess *process : m_processes.keys()) {
         if (process->state() != QProcess::NotRunning) {
             process->terminate();
             if (!process->waitForFinished(3000)) {
@@ -86,10 +87,6 @@ WaylandCompositor::~WaylandCompositor() {
     // NOTE: No custom D-Bus session to stop
 }
 
-QQmlListProperty<QObject> WaylandCompositor::surfaces() {
-    return QQmlListProperty<QObject>(this, &m_surfaces);
-}
-
 void WaylandCompositor::launchApp(const QString &command) {
     qDebug() << "[WaylandCompositor] Launching app:" << command;
     qDebug() << "[WaylandCompositor] Socket name:" << socketName();
@@ -120,99 +117,8 @@ void WaylandCompositor::launchApp(const QString &command) {
         qInfo() << "[WaylandCompositor] Run 'snap connections APP' to verify wayland interface";
     }
 
-    QProcess *process = new QProcess(this);
-
-    // Set up Wayland environment
-    QProcessEnvironment env        = QProcessEnvironment::systemEnvironment();
-    QString             runtimeDir = QString::fromLocal8Bit(qgetenv("XDG_RUNTIME_DIR"));
-
-    if (runtimeDir.isEmpty()) {
-        qWarning() << "[WaylandCompositor] XDG_RUNTIME_DIR not set! Apps may fail to connect.";
-        runtimeDir = "/tmp";
-    }
-
-    // CRITICAL: Remove parent compositor's WAYLAND_DISPLAY to force apps to use OUR compositor
-    env.remove("WAYLAND_DISPLAY"); // Remove parent Wayland compositor
-    env.remove("DISPLAY");         // Remove X11 display (force Wayland)
-
-    // CRITICAL FIX: Prevent GTK/GApplication apps from connecting to host/previous instances
-    // Apps like Nautilus/Clocks use GApplication's single-instance D-Bus mechanism
-    // They check D-Bus for existing instances and send "open window" commands to them
-    // This causes windows to open in host compositor OR connect to stale D-Bus names
-    //
-    // Solution: Generate UNIQUE GApplication ID per app launch (not just per Marathon instance!)
-    // This isolates each launch from host AND previous Marathon launches
-
-    // CRITICAL: Force new instances of GApplication apps
-    // GApplication apps check D-Bus for existing instances and send commands to them instead
-    // of launching new windows. This causes apps to open in the host compositor.
-    //
-    // Solution: Create a temporary unique desktop file for each launch
-    // GApplication extracts the app ID from the desktop file basename and uses it for D-Bus registration.
-    // A unique desktop file path forces a unique D-Bus name, preventing detection of host instances.
-    qint64 timestamp   = QDateTime::currentMSecsSinceEpoch();
-    uint   commandHash = qHash(actualCommand);
-
-    // Create /tmp/marathon-apps directory if it doesn't exist
-    QDir tmpDir("/tmp/marathon-apps");
-    if (!tmpDir.exists()) {
-        tmpDir.mkpath(".");
-    }
-
-    // Create unique desktop file path
-    QString uniqueDesktopFile =
-        QString("/tmp/marathon-apps/marathon-%1-%2.desktop").arg(timestamp).arg(commandHash);
-
-    // Create a properly formatted desktop file for GApplication
-    // GApplication uses the desktop file basename for D-Bus name generation and parses
-    // various fields. Including all standard fields prevents GLib warnings and ensures
-    // proper application behavior across GTK, Qt, and other toolkits.
-    QFile desktopFile(uniqueDesktopFile);
-    if (desktopFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QTextStream out(&desktopFile);
-        out << "[Desktop Entry]\n";
-        out << "Version=1.0\n"; // Desktop Entry Spec version
-        out << "Type=Application\n";
-        out << "Name=Marathon Embedded App\n";
-        out << "GenericName=Application\n";
-        out << "Comment=Application running in Marathon OS\n";
-        out << "Exec=" << actualCommand << "\n";
-        out << "Terminal=false\n";                  // Not a terminal app
-        out << "Categories=Utility;\n";             // FreeDesktop category
-        out << "StartupNotify=true\n";              // Supports startup notification
-        out << "X-GNOME-UsesNotifications=false\n"; // Prevent notification parsing
-        out << "X-Marathon-Embedded=true\n";        // Custom field for identification
-        desktopFile.close();
-
-        qDebug() << "[WaylandCompositor] Created desktop file with full specification compliance";
-    } else {
-        qWarning() << "[WaylandCompositor] Failed to create desktop file:" << uniqueDesktopFile;
-    }
-
-    env.insert("GIO_LAUNCHED_DESKTOP_FILE", uniqueDesktopFile);
-    env.insert("GIO_LAUNCHED_DESKTOP_FILE_PID",
-               QString::number(QCoreApplication::applicationPid()));
-
-    qDebug() << "[WaylandCompositor] Created unique desktop file:" << uniqueDesktopFile;
-
-    // Set OUR compositor variables
-    env.insert("WAYLAND_DISPLAY", socketName());
-    env.insert("XDG_RUNTIME_DIR", runtimeDir);
-    env.insert("QT_QPA_PLATFORM", "wayland");
-    env.insert("GDK_BACKEND", "wayland");
-    env.insert("CLUTTER_BACKEND", "wayland");
-    env.insert("SDL_VIDEODRIVER", "wayland");
-
-    // Mobile form factor environment variables
-    // These tell GTK4/libadwaita and Qt apps to use mobile/adaptive layouts
-    env.insert("LIBADWAITA_MOBILE", "1");        // Force libadwaita mobile mode
-    env.insert("PURISM_FORM_FACTOR", "phone");   // Phosh compatibility (used by Phosh/Purism apps)
-    env.insert("QT_QUICK_CONTROLS_MOBILE", "1"); // Qt Quick Controls mobile mode
-    env.insert("QT_QUICK_CONTROLS_STYLE", "Mobile"); // Qt Quick Controls mobile style
-    env.insert("GTK_CSD", "1");                      // Force client-side decorations for GTK apps
-    env.insert("GTK_USE_PORTAL", "0"); // Disable portals (can cause issues in nested compositors)
-
-    process->setProcessEnvironment(env);
+    // Environment and desktop file come prepared; see NativeAppLauncher
+    QProcess *process = m_launcher->createProcess(actualCommand, this);
 
     qDebug() << "[WaylandCompositor] Launching:" << command;
 
@@ -248,30 +154,29 @@ void WaylandCompositor::launchApp(const QString &command) {
         }
     });
 
-    m_processes[process] = actualCommand;
-
-    qDebug() << "[WaylandCompositor] Starting process:" << actualCommand;
-    process->start("/bin/sh", {"-c", actualCommand});
-
-    if (process->waitForStarted(3000)) {
+    // Reported once running instead of blocking the UI until then; a failed start ends up
+    // in handleProcessError()
+    connect(process, &QProcess::started, this, [this, process, command]() {
         qint64 pid = process->processId();
         qInfo() << "[WaylandCompositor] Started PID" << pid;
+        m_processes[process].pid = pid;
+        m_processByPid[pid]      = process;
         emit appLaunched(command, pid);
-    } else {
-        qWarning() << "[WaylandCompositor] Failed to start:" << actualCommand << "-"
-                   << process->errorString();
-        m_processes.remove(process);
-        process->deleteLater();
-    }
+    });
+
+    m_processes[process].command = actualCommand;
+
+    qDebug() << "[WaylandCompositor] Starting process:" << actualCommand;
+    NativeAppLauncher::start(process, actualCommand);
 }
 
 void WaylandCompositor::closeWindow(int surfaceId) {
-    if (!m_surfaceMap.contains(surfaceId)) {
+    if (!m_registry->contains(surfaceId)) {
         qWarning() << "[WaylandCompositor] closeWindow called for unknown surface ID:" << surfaceId;
         return;
     }
 
-    QWaylandSurface *surface = m_surfaceMap[surfaceId];
+    QWaylandSurface *surface = qobject_cast<QWaylandSurface *>(m_registry->surface(surfaceId));
     if (!surface) {
         qWarning() << "[WaylandCompositor] Surface is null for ID:" << surfaceId;
         return;
@@ -281,8 +186,9 @@ void WaylandCompositor::closeWindow(int surfaceId) {
     // This sends WM_DELETE_WINDOW equivalent, allowing app to save state
     // DO NOT use client->close() - that forcefully kills the connection!
 
-    // Get XDG surface from our map (stored in handleXdgToplevelCreated)
-    QWaylandXdgSurface *xdgSurface = m_xdgSurfaceMap.value(surfaceId, nullptr);
+    // Get XDG surface from the registry (stored in handleXdgToplevelCreated)
+    QWaylandXdgSurface *xdgSurface =
+        qobject_cast<QWaylandXdgSurface *>(m_registry->shellSurface(surfaceId));
     if (xdgSurface && xdgSurface->toplevel()) {
         qInfo()
             << "[WaylandCompositor] Sending graceful close request (XDG protocol) to surface ID:"
@@ -300,22 +206,13 @@ void WaylandCompositor::closeWindow(int surfaceId) {
     }
 
     // Find the specific process for this surface (by PID mapping)
-    qint64 pid = m_surfaceIdToPid.value(surfaceId, -1);
+    qint64 pid = m_registry->pid(surfaceId);
     if (pid <= 0) {
         qDebug() << "[WaylandCompositor] No PID mapping for surface ID:" << surfaceId;
         return; // Let the surface close naturally
     }
 
-    // Find the process for this PID
-    QProcess *targetProcess = nullptr;
-    for (auto it = m_processes.begin(); it != m_processes.end(); ++it) {
-        QProcess *process = it.key();
-        if (process && process->processId() == pid) {
-            targetProcess = process;
-            break;
-        }
-    }
-
+    QProcess *targetProcess = m_processByPid.value(pid, nullptr);
     if (!targetProcess) {
         qDebug() << "[WaylandCompositor] No process found for PID:" << pid;
         return; // Process already exited or doesn't exist
@@ -354,7 +251,7 @@ void WaylandCompositor::closeWindow(int surfaceId) {
 }
 
 QObject *WaylandCompositor::getSurfaceById(int surfaceId) {
-    return m_surfaceMap.value(surfaceId, nullptr);
+    return m_registry->surface(surfaceId);
 }
 
 void WaylandCompositor::handleSurfaceCreated(QWaylandSurface *surface) {
@@ -362,22 +259,20 @@ void WaylandCompositor::handleSurfaceCreated(QWaylandSurface *surface) {
 
     connect(surface, &QWaylandSurface::surfaceDestroyed, this,
             &WaylandCompositor::handleSurfaceDestroyed);
+    connect(surface, &QWaylandSurface::redraw, this, [this]() {
+        if (m_frameTiming)
+            m_frameTiming->recordCommit();
+    });
 
-    int surfaceId           = m_nextSurfaceId++;
-    m_surfaceMap[surfaceId] = surface;
+    QWaylandClient *client    = surface->client();
+    qint64          pid       = client ? client->processId() : 0;
+    int             surfaceId = m_registry->add(surface, client, pid);
     surface->setProperty("surfaceId", surfaceId);
 
-    if (surface->client()) {
-        qint64 pid = surface->client()->processId();
-        if (pid > 0) {
-            m_pidToSurfaceId[pid]       = surfaceId;
-            m_surfaceIdToPid[surfaceId] = pid;
-            qInfo() << "[WaylandCompositor] Linked PID" << pid << "to surface ID" << surfaceId;
-        }
+    if (pid > 0) {
+        qInfo() << "[WaylandCompositor] Linked PID" << pid << "to surface ID" << surfaceId;
     }
 
-    m_surfaces.append(surface);
-    emit surfacesChanged();
     // DON'T emit surfaceCreated yet - wait for XDG toplevel to be created first
 }
 
@@ -395,7 +290,9 @@ void WaylandCompositor::handleXdgToplevelCreated(QWaylandXdgToplevel *toplevel,
 
         int surfaceId = surface->property("surfaceId").toInt();
         // CRITICAL: Store xdgSurface for graceful close via sendClose()
-        m_xdgSurfaceMap[surfaceId] = xdgSurface;
+        m_registry->setShellSurface(surfaceId, xdgSurface);
+        m_registry->setTitle(surfaceId, toplevel->title());
+        m_registry->setAppId(surfaceId, toplevel->appId());
 
         // NOW emit surfaceCreated with surfaceId, xdgSurface AND toplevel
         emit surfaceCreated(surface, surfaceId, xdgSurface);
@@ -405,16 +302,18 @@ void WaylandCompositor::handleXdgToplevelCreated(QWaylandXdgToplevel *toplevel,
         QPointer<QWaylandSurface>     safeSurface(surface);
 
         connect(toplevel, &QWaylandXdgToplevel::titleChanged, this,
-                [this, safeToplevel, safeSurface]() {
+                [this, safeToplevel, safeSurface, surfaceId]() {
                     if (safeToplevel && safeSurface) {
                         safeSurface->setProperty("title", safeToplevel->title());
+                        m_registry->setTitle(surfaceId, safeToplevel->title());
                     }
                 });
 
         connect(toplevel, &QWaylandXdgToplevel::appIdChanged, this,
-                [this, safeToplevel, safeSurface]() {
+                [this, safeToplevel, safeSurface, surfaceId]() {
                     if (safeToplevel && safeSurface) {
                         safeSurface->setProperty("appId", safeToplevel->appId());
+                        m_registry->setAppId(surfaceId, safeToplevel->appId());
                     }
                 });
 
@@ -436,19 +335,8 @@ void WaylandCompositor::handleXdgToplevelCreated(QWaylandXdgToplevel *toplevel,
                     emit surfaceDestroyed(safeSurface.data(), surfaceId);
                     qInfo() << "[WaylandCompositor] surfaceDestroyed signal emitted";
 
-                    // Clean up our internal state
-                    if (m_surfaceIdToPid.contains(surfaceId)) {
-                        qint64 pid = m_surfaceIdToPid[surfaceId];
-                        m_pidToSurfaceId.remove(pid);
-                        m_surfaceIdToPid.remove(surfaceId);
-                        qDebug() << "[WaylandCompositor] Cleaned up PID mapping for" << pid;
-                    }
-
-                    m_surfaceMap.remove(surfaceId);
-                    m_xdgSurfaceMap.remove(surfaceId);
-                    m_surfaces.removeAll(safeSurface);
-
-                    emit surfacesChanged();
+                    // Clean up our internal state; the real destruction later is a no-op
+                    m_registry->remove(surfaceId);
                 }
             });
     }
@@ -462,14 +350,17 @@ void WaylandCompositor::handleWlShellSurfaceCreated(QWaylandWlShellSurface *wlSh
         int surfaceId = surface->property("surfaceId").toInt();
         surface->setProperty("wlShellSurface", QVariant::fromValue(wlShellSurface));
         surface->setProperty("title", wlShellSurface->title());
+        m_registry->setShellSurface(surfaceId, wlShellSurface);
+        m_registry->setTitle(surfaceId, wlShellSurface->title());
 
         // Connect signal with QPointer for safe access
         QPointer<QWaylandWlShellSurface> safeWlShell(wlShellSurface);
         QPointer<QWaylandSurface>        safeSurface(surface);
         connect(wlShellSurface, &QWaylandWlShellSurface::titleChanged, this,
-                [this, safeWlShell, safeSurface]() {
+                [this, safeWlShell, safeSurface, surfaceId]() {
                     if (safeWlShell && safeSurface) {
                         safeSurface->setProperty("title", safeWlShell->title());
+                        m_registry->setTitle(surfaceId, safeWlShell->title());
                     }
                 });
     }
@@ -483,19 +374,10 @@ void WaylandCompositor::handleSurfaceDestroyed() {
     int surfaceId = surface->property("surfaceId").toInt();
     qDebug() << "[WaylandCompositor] Surface destroyed, ID:" << surfaceId;
 
-    if (m_surfaceIdToPid.contains(surfaceId)) {
-        qint64 pid = m_surfaceIdToPid[surfaceId];
-        m_pidToSurfaceId.remove(pid);
-        m_surfaceIdToPid.remove(surfaceId);
-        qDebug() << "[WaylandCompositor] Cleaned up PID mapping for" << pid;
+    // Already reported if the surface lost its content first
+    if (m_registry->remove(surfaceId)) {
+        emit surfaceDestroyed(surface, surfaceId);
     }
-
-    m_surfaceMap.remove(surfaceId);
-    m_xdgSurfaceMap.remove(surfaceId); // Clean up XDG surface mapping too
-    m_surfaces.removeAll(surface);
-
-    emit surfacesChanged();
-    emit surfaceDestroyed(surface, surfaceId);
 }
 
 void WaylandCompositor::handleProcessFinished(int exitCode, QProcess::ExitStatus exitStatus) {
@@ -503,8 +385,9 @@ void WaylandCompositor::handleProcessFinished(int exitCode, QProcess::ExitStatus
     if (!process)
         return;
 
-    QString command = m_processes.value(process, "unknown");
-    qint64  pid     = process->processId();
+    LaunchedProcess launched = m_processes.value(process);
+    QString         command  = launched.command.isEmpty() ? "unknown" : launched.command;
+    qint64          pid      = launched.pid;
 
     // gapplication launch spawns a subprocess and exits immediately, so PID tracking doesn't work
     bool isGApplication = command.contains("gapplication launch");
@@ -524,21 +407,27 @@ void WaylandCompositor::handleProcessFinished(int exitCode, QProcess::ExitStatus
         }
     }
 
-    // Find and close the associated surface/window (only for PID-tracked apps)
-    if (pid > 0 && m_pidToSurfaceId.contains(pid)) {
-        int surfaceId = m_pidToSurfaceId[pid];
+    // Find and close the associated surfaces/windows (only for PID-tracked apps)
+    const QList<int> surfaceIds = pid > 0 ? m_registry->surfacesForPid(pid) : QList<int>();
+    for (int surfaceId : surfaceIds) {
         qInfo() << "[WaylandCompositor] Closing surface for PID" << pid
                 << "surfaceId:" << surfaceId;
 
         // Clean up the surface if it still exists
-        if (m_surfaceMap.contains(surfaceId)) {
-            QWaylandSurface *surface = m_surfaceMap[surfaceId];
-            if (surface && surface->client()) {
-                surface->client()->close();
-            }
+        QWaylandSurface *surface = qobject_cast<QWaylandSurface *>(m_registry->surface(surfaceId));
+        if (surface && surface->client()) {
+            surface->client()->close();
         }
     }
 
+    forgetProcess(process);
+}
+
+void WaylandCompositor::forgetProcess(QProcess *process) {
+    qint64 pid = m_processes.value(process).pid;
+    if (pid > 0 && m_processByPid.value(pid) == process) {
+        m_processByPid.remove(pid);
+    }
     m_processes.remove(process);
     process->deleteLater();
 }
@@ -650,7 +539,7 @@ void WaylandCompositor::handleProcessError(QProcess::ProcessError error) {
     if (!process)
         return;
 
-    QString command = m_processes.value(process, "unknown");
+    QString command = m_processes.value(process).command;
     QString errorString;
 
     switch (error) {
@@ -676,6 +565,20 @@ void WaylandCompositor::handleProcessError(QProcess::ProcessError error) {
     if (!errorOutput.isEmpty()) {
         qDebug() << "[WaylandCompositor] stderr:" << errorOutput;
     }
+
+    // A process that never started gets no finished signal
+    if (error == QProcess::FailedToStart) {
+        qWarning() << "[WaylandCompositor] Failed to start:" << command;
+        forgetProcess(process);
+    }
+}
+
+void WaylandCompositor::setFrameTimingMonitor(FrameTimingMonitor *monitor) {
+    m_frameTiming = monitor;
+}
+
+QProcessEnvironment WaylandCompositor::launchEnvironment() const {
+    return m_launcher->environment();
 }
 
 void WaylandCompositor::setCompositorActive(bool active) {
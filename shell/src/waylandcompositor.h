@@ -12,29 +12,42 @@
 #include <QWaylandClient>
 #include <QWaylandSeat>
 #include <QQuickWindow>
-#include <QMap>
+#include <QHash>
+#include <QPointer>
 #include <QProcess>
 
 // Forward declaration
 class SettingsManager;
+class NativeAppLauncher;
+class WaylandSurfaceRegistry;
+class FrameTimingMonitor;
 
 class WaylandCompositor : public QWaylandCompositor {
     Q_OBJECT
-    Q_PROPERTY(QQmlListProperty<QObject> surfaces READ surfaces NOTIFY surfacesChanged)
+    Q_PROPERTY(WaylandSurfaceRegistry *surfaces READ surfaces CONSTANT)
 
   public:
     explicit WaylandCompositor(QQuickWindow *window, SettingsManager *settingsManager);
     ~WaylandCompositor() override;
 
-    QQmlListProperty<QObject> surfaces();
-    Q_INVOKABLE void          launchApp(const QString &command);
-    Q_INVOKABLE void          closeWindow(int surfaceId);
-    Q_INVOKABLE QObject      *getSurfaceById(int surfaceId);
-    Q_INVOKABLE void          setCompositorActive(bool active);
-    Q_INVOKABLE void          setOutputOrientation(const QString &orientation);
+    // List model of the open surfaces, also the compositor's lookup tables
+    WaylandSurfaceRegistry *surfaces() const {
+        return m_registry;
+    }
+
+    Q_INVOKABLE void     launchApp(const QString &command);
+    Q_INVOKABLE void     closeWindow(int surfaceId);
+    Q_INVOKABLE QObject *getSurfaceById(int surfaceId);
+    Q_INVOKABLE void     setCompositorActive(bool active);
+    Q_INVOKABLE void     setOutputOrientation(const QString &orientation);
+
+    // Client commits are reported to monitor for commit-to-present latency
+    void                 setFrameTimingMonitor(FrameTimingMonitor *monitor);
+
+    // Environment clients are started with, connecting them to this compositor
+    QProcessEnvironment  launchEnvironment() const;
 
   signals:
-    void surfacesChanged();
     void surfaceCreated(QWaylandSurface *surface, int surfaceId, QWaylandXdgSurface *xdgSurface);
     void surfaceDestroyed(QWaylandSurface *surface, int surfaceId);
     void appLaunched(const QString &command, int pid);
@@ -49,23 +62,26 @@ class WaylandCompositor : public QWaylandCompositor {
     void handleProcessError(QProcess::ProcessError error);
 
   private:
-    void                            setCompositorRealtimePriority();
-    void                            calculateAndSetPhysicalSize();
+    struct LaunchedProcess {
+        QString command;
+        qint64  pid = 0; // known once started; processId() is 0 again after exit
+    };
 
-    QWaylandXdgShell               *m_xdgShell;
-    QWaylandWlShell                *m_wlShell;
-    QWaylandQuickOutput            *m_output;
-    QQuickWindow                   *m_window;
-    SettingsManager                *m_settingsManager;
+    void                               setCompositorRealtimePriority();
+    void                               calculateAndSetPhysicalSize();
+    void                               forgetProcess(QProcess *process);
 
-    QList<QObject *>                m_surfaces;
-    QMap<int, QWaylandSurface *>    m_surfaceMap;    // surfaceId -> surface
-    QMap<int, QWaylandXdgSurface *> m_xdgSurfaceMap; // surfaceId -> xdgSurface (for graceful close)
-    QMap<QProcess *, QString>       m_processes;     // process -> command
-    QMap<qint64, int>               m_pidToSurfaceId; // PID -> surfaceId
-    QMap<int, qint64>               m_surfaceIdToPid; // surfaceId -> PID
+    QWaylandXdgShell                  *m_xdgShell;
+    QWaylandWlShell                   *m_wlShell;
+    QWaylandQuickOutput               *m_output;
+    QQuickWindow                      *m_window;
+    SettingsManager                   *m_settingsManager;
+    NativeAppLauncher                 *m_launcher;
+    WaylandSurfaceRegistry            *m_registry;
+    QPointer<FrameTimingMonitor>       m_frameTiming;
 
-    int                             m_nextSurfaceId;
+    QHash<QProcess *, LaunchedProcess> m_processes;    // process -> command and PID
+    QHash<qint64, QProcess *>          m_processByPid; // PID -> process, while running
 };
 
 #endif // WAYLANDCOMPOSITOR_H
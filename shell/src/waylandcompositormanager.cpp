@@ -1,5 +1,6 @@
 #include "waylandcompositormanager.h"
 #include "settingsmanager.h"
+#include "marathonapprunnerpool.h"
 #include <QDebug>
 
 WaylandCompositorManager::WaylandCompositorManager(SettingsManager *settingsManager,
@@ -39,6 +40,9 @@ WaylandCompositor *WaylandCompositorManager::createCompositor(QQuickWindow *wind
 
     qInfo() << "[WaylandCompositorManager] Creating new WaylandCompositor...";
     m_compositor = new WaylandCompositor(window, m_settingsManager);
+    m_compositor->setFrameTimingMonitor(m_frameTiming);
+    if (m_runnerPool)
+        m_runnerPool->setEnvironment(m_compositor->launchEnvironment());
     qInfo() << "[WaylandCompositorManager] WaylandCompositor created successfully";
     qInfo() << "[WaylandCompositorManager] Compositor pointer:" << m_compositor;
     return m_compositor;
@@ -47,3 +51,19 @@ WaylandCompositor *WaylandCompositorManager::createCompositor(QQuickWindow *wind
     return nullptr;
 #endif
 }
+
+void WaylandCompositorManager::setFrameTimingMonitor(FrameTimingMonitor *monitor) {
+    m_frameTiming = monitor;
+#ifdef HAVE_WAYLAND
+    if (m_compositor)
+        m_compositor->setFrameTimingMonitor(monitor);
+#endif
+}
+
+void WaylandCompositorManager::setAppRunnerPool(MarathonAppRunnerPool *pool) {
+    m_runnerPool = pool;
+#ifdef HAVE_WAYLAND
+    if (m_compositor && m_runnerPool)
+        m_runnerPool->setEnvironment(m_compositor->launchEnvironment());
+#endif
+}
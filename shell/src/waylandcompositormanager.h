@@ -11,6 +11,8 @@
 // Forward declarations
 class WaylandCompositor;
 class SettingsManager;
+class FrameTimingMonitor;
+class MarathonAppRunnerPool;
 
 class WaylandCompositorManager : public QObject {
     Q_OBJECT
@@ -20,8 +22,16 @@ class WaylandCompositorManager : public QObject {
 
     Q_INVOKABLE WaylandCompositor *createCompositor(QQuickWindow *window);
 
+    // Handed to the compositor once it exists
+    void                           setFrameTimingMonitor(FrameTimingMonitor *monitor);
+
+    // Isolated Marathon apps are started with the compositor's launch environment
+    void                           setAppRunnerPool(MarathonAppRunnerPool *pool);
+
   private:
-    SettingsManager *m_settingsManager;
+    SettingsManager       *m_settingsManager;
+    FrameTimingMonitor    *m_frameTiming = nullptr;
+    MarathonAppRunnerPool *m_runnerPool  = nullptr;
 #ifdef HAVE_WAYLAND
     WaylandCompositor *m_compositor = nullptr;
 #endif
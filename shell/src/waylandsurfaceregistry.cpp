@@ -0,0 +1,148 @@
+#include "waylandsurfaceregistry.h"
+#include <algorithm>
+
+WaylandSurfaceRegistry::WaylandSurfaceRegistry(QObject *parent)
+    : QAbstractListModel(parent)
+    , m_nextSurfaceId(1) {}
+
+int WaylandSurfaceRegistry::rowCount(const QModelIndex &parent) const {
+    if (parent.isValid())
+        return 0;
+    return m_rows.count();
+}
+
+QVariant WaylandSurfaceRegistry::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= m_rows.count())
+        return QVariant();
+
+    int          surfaceId = m_rows.at(index.row());
+    const Entry &entry     = m_entries[surfaceId];
+
+    switch (role) {
+        case SurfaceIdRole: return surfaceId;
+        case SurfaceRole: return QVariant::fromValue(entry.surface.data());
+        case PidRole: return entry.pid;
+        case TitleRole: return entry.title;
+        case AppIdRole: return entry.appId;
+        default: return QVariant();
+    }
+}
+
+QHash<int, QByteArray> WaylandSurfaceRegistry::roleNames() const {
+    QHash<int, QByteArray> roles;
+    roles[SurfaceIdRole] = "surfaceId";
+    roles[SurfaceRole]   = "surface";
+    roles[PidRole]       = "pid";
+    roles[TitleRole]     = "title";
+    roles[AppIdRole]     = "appId";
+    return roles;
+}
+
+int WaylandSurfaceRegistry::add(QObject *surface, QObject *client, qint64 pid) {
+    int surfaceId = m_nextSurfaceId++;
+
+    Entry entry;
+    entry.surface = surface;
+    entry.client  = client;
+    entry.pid     = pid > 0 ? pid : 0;
+    entry.row     = m_rows.count();
+
+    beginInsertRows(QModelIndex(), m_rows.count(), m_rows.count());
+    m_entries.insert(surfaceId, entry);
+    m_rows.append(surfaceId);
+    if (entry.pid > 0)
+        m_byPid.insert(entry.pid, surfaceId);
+    if (client)
+        m_byClient.insert(client, surfaceId);
+    endInsertRows();
+
+    emit countChanged();
+    return surfaceId;
+}
+
+bool WaylandSurfaceRegistry::remove(int surfaceId) {
+    auto it = m_entries.find(surfaceId);
+    if (it == m_entries.end())
+        return false;
+
+    const int row = it->row;
+    beginRemoveRows(QModelIndex(), row, row);
+    if (it->pid > 0)
+        m_byPid.remove(it->pid, surfaceId);
+    if (it->client)
+        m_byClient.remove(it->client, surfaceId);
+    m_entries.erase(it);
+    m_rows.remove(row);
+    // The rows below move up; they shift in m_rows anyway
+    for (int r = row; r < m_rows.count(); ++r)
+        m_entries[m_rows.at(r)].row = r;
+    endRemoveRows();
+
+    emit countChanged();
+    return true;
+}
+
+bool WaylandSurfaceRegistry::contains(int surfaceId) const {
+    return m_entries.contains(surfaceId);
+}
+
+void WaylandSurfaceRegistry::setShellSurface(int surfaceId, QObject *shellSurface) {
+    auto it = m_entries.find(surfaceId);
+    if (it != m_entries.end())
+        it->shellSurface = shellSurface;
+}
+
+void WaylandSurfaceRegistry::setTitle(int surfaceId, const QString &title) {
+    auto it = m_entries.find(surfaceId);
+    if (it == m_entries.end() || it->title == title)
+        return;
+    it->title = title;
+    notifyChanged(it->row, TitleRole);
+}
+
+void WaylandSurfaceRegistry::setAppId(int surfaceId, const QString &appId) {
+    auto it = m_entries.find(surfaceId);
+    if (it == m_entries.end() || it->appId == appId)
+        return;
+    it->appId = appId;
+    notifyChanged(it->row, AppIdRole);
+}
+
+QObject *WaylandSurfaceRegistry::surface(int surfaceId) const {
+    auto it = m_entries.constFind(surfaceId);
+    return it != m_entries.constEnd() ? it->surface.data() : nullptr;
+}
+
+QObject *WaylandSurfaceRegistry::shellSurface(int surfaceId) const {
+    auto it = m_entries.constFind(surfaceId);
+    return it != m_entries.constEnd() ? it->shellSurface.data() : nullptr;
+}
+
+QObject *WaylandSurfaceRegistry::client(int surfaceId) const {
+    auto it = m_entries.constFind(surfaceId);
+    return it != m_entries.constEnd() ? it->client : nullptr;
+}
+
+qint64 WaylandSurfaceRegistry::pid(int surfaceId) const {
+    auto it = m_entries.constFind(surfaceId);
+    return it != m_entries.constEnd() ? it->pid : 0;
+}
+
+QList<int> WaylandSurfaceRegistry::surfacesForPid(qint64 pid) const {
+    return sorted(m_byPid.values(pid));
+}
+
+QList<int> WaylandSurfaceRegistry::surfacesForClient(QObject *client) const {
+    return sorted(m_byClient.values(client));
+}
+
+void WaylandSurfaceRegistry::notifyChanged(int row, int role) {
+    QModelIndex modelIndex = createIndex(row, 0);
+    emit        dataChanged(modelIndex, modelIndex, {role});
+}
+
+QList<int> WaylandSurfaceRegistry::sorted(QList<int> surfaceIds) const {
+    // Ids are handed out in increasing order, so this is creation order
+    std::sort(surfaceIds.begin(), surfaceIds.end());
+    return surfaceIds;
+}
@@ -0,0 +1,91 @@
+#ifndef WAYLANDSURFACEREGISTRY_H
+#define WAYLANDSURFACEREGISTRY_H
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QList>
+#include <QMultiHash>
+#include <QPointer>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief The compositor's surfaces, one record each, indexed by id, PID and client
+ *
+ * Everything the compositor knows about a surface (the surface, its shell
+ * surface, owning client and PID, title and app ID) lives in one record, so
+ * adding or dropping a surface updates every index at once instead of a set
+ * of maps kept in sync by hand. Lookups by id, PID and client are hashed.
+ *
+ * The registry is also the list model QML sees as WaylandCompositor.surfaces,
+ * in creation order. Each record knows its row, so a title or app ID change
+ * is reported without searching the rows. Objects are held as QObject so the bookkeeping does not
+ * depend on QtWaylandCompositor; the compositor casts them back.
+ */
+class WaylandSurfaceRegistry : public QAbstractListModel {
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+  public:
+    enum SurfaceRoles {
+        SurfaceIdRole = Qt::UserRole + 1,
+        SurfaceRole,
+        PidRole,
+        TitleRole,
+        AppIdRole
+    };
+
+    explicit WaylandSurfaceRegistry(QObject *parent = nullptr);
+
+    int      rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    int                    count() const {
+        return m_rows.count();
+    }
+
+    // Registers a new surface and returns its id; pid <= 0 means unknown
+    int      add(QObject *surface, QObject *client, qint64 pid);
+    // Drops the surface from every index, false if it was not registered
+    bool     remove(int surfaceId);
+    bool     contains(int surfaceId) const;
+
+    void     setShellSurface(int surfaceId, QObject *shellSurface);
+    void     setTitle(int surfaceId, const QString &title);
+    void     setAppId(int surfaceId, const QString &appId);
+
+    QObject *surface(int surfaceId) const;
+    QObject *shellSurface(int surfaceId) const;
+    QObject *client(int surfaceId) const;
+    qint64   pid(int surfaceId) const;
+
+    // Oldest first
+    QList<int> surfacesForPid(qint64 pid) const;
+    QList<int> surfacesForClient(QObject *client) const;
+
+  signals:
+    void countChanged();
+
+  private:
+    struct Entry {
+        QPointer<QObject> surface;
+        QPointer<QObject> shellSurface;
+        QObject          *client = nullptr; // only used as a key, may be gone already
+        qint64            pid    = 0;
+        QString           title;
+        QString           appId;
+        int               row = 0; // position in m_rows, kept current as rows shift
+    };
+
+    void                       notifyChanged(int row, int role);
+    QList<int>                 sorted(QList<int> surfaceIds) const;
+
+    QHash<int, Entry>          m_entries;  // surfaceId -> record
+    QVector<int>               m_rows;     // surfaceIds in model order
+    QMultiHash<qint64, int>    m_byPid;    // PID -> surfaceIds
+    QMultiHash<QObject *, int> m_byClient; // client -> surfaceIds
+    int                        m_nextSurfaceId;
+};
+
+#endif // WAYLANDSURFACEREGISTRY_H
@@ -0,0 +1,74 @@
+#include <QTest>
+#include <QDir>
+#include <QFile>
+#include "../apps/terminal/src/TerminalEngine.h"
+#include "../apps/terminal/src/VtParser.h"
+
+// Replays recorded PTY output (tests/data/terminal/*.vt) through the terminal's parser,
+// alone and together with the screen model.
+
+// Handler that discards everything, to time the state machine alone
+class NullHandler : public VtParser::Handler {
+  public:
+    void print(const uint32_t *, int) override {}
+    void execute(uint8_t) override {}
+    void escDispatch(const VtParser &, uint8_t) override {}
+    void csiDispatch(const VtParser &, uint8_t) override {}
+    void oscDispatch(const char *, int) override {}
+};
+
+class BenchTerminalParser : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void parser_data();
+    void parser();
+    void engine_data();
+    void engine();
+
+  private:
+    static void addFixtures();
+};
+
+void BenchTerminalParser::addFixtures() {
+    QTest::addColumn<QByteArray>("stream");
+
+    const QDir dir(TERMINAL_FIXTURES_DIR);
+    for (const QString &name : dir.entryList({"*.vt"}, QDir::Files, QDir::Name)) {
+        QFile file(dir.filePath(name));
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QTest::newRow(name.toUtf8().constData()) << file.readAll();
+    }
+}
+
+void BenchTerminalParser::parser_data() {
+    addFixtures();
+}
+
+void BenchTerminalParser::parser() {
+    QFETCH(QByteArray, stream);
+
+    NullHandler handler;
+    VtParser    parser(&handler);
+    QBENCHMARK {
+        parser.feed(stream.constData(), stream.size());
+    }
+}
+
+void BenchTerminalParser::engine_data() {
+    addFixtures();
+}
+
+void BenchTerminalParser::engine() {
+    QFETCH(QByteArray, stream);
+
+    // Not started: output is fed straight in, no PTY involved
+    TerminalEngine terminal;
+    terminal.screen()->resize(120, 40);
+    QBENCHMARK {
+        terminal.processOutput(stream);
+    }
+}
+
+QTEST_MAIN(BenchTerminalParser)
+#include "bench_terminalparser.moc"
@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+"""Generates the terminal parser benchmark fixtures.
+
+The .vt files are raw PTY output streams. They are reconstructions of what htop and
+vttest write (same sequence mix: alternate screen, absolute cursor addressing, SGR runs,
+scroll regions, insert/delete, line drawing), generated deterministically so the
+benchmark input is stable. Real captures can be added next to them, e.g.
+
+    script -q -O /dev/null --log-out htop.vt -c htop
+
+Usage: generate_fixtures.py [output-dir]
+"""
+
+import os
+import random
+import sys
+
+ESC = "\x1b"
+CSI = ESC + "["
+
+
+def cup(row, col):
+    return f"{CSI}{row};{col}H"
+
+
+def htop(frames=120, cols=120, rows=40):
+    rnd = random.Random(1)
+    out = [f"{ESC}]0;htop{chr(7)}", f"{CSI}?1049h", f"{CSI}?25l", f"{CSI}?1h", f"{ESC}=",
+           f"{CSI}1;{rows}r", f"{CSI}H{CSI}2J"]
+    names = ["/usr/bin/marathon-shell", "kworker/u8:2-events", "pipewire", "wireplumber",
+             "/usr/lib/systemd/systemd --user", "dbus-broker", "htop", "ModemManager",
+             "NetworkManager --no-daemon", "sshd: user@pts/0", "-bash", "Xwayland :0"]
+    procs = [(rnd.randint(1, 40000), rnd.choice(names)) for _ in range(rows - 8)]
+
+    for frame in range(frames):
+        # CPU and memory meters
+        for cpu in range(4):
+            load = rnd.randint(0, 40)
+            low = load * 2 // 3
+            out.append(cup(cpu + 1, 3))
+            out.append(f"{CSI}36m{cpu}{CSI}39m{CSI}1m[{CSI}22m")
+            out.append(f"{CSI}32m" + "|" * low + f"{CSI}31m" + "|" * (load - low))
+            out.append(" " * (40 - load) + f"{CSI}90m{load * 2.5:5.1f}%{CSI}39m{CSI}1m]{CSI}m")
+        mem = rnd.randint(10, 40)
+        out.append(cup(5, 3) + f"{CSI}36mMem{CSI}39m{CSI}1m[{CSI}22m{CSI}32m" + "|" * mem)
+        out.append(f"{CSI}34m" + "|" * 5 + f"{CSI}33m" + "|" * 3 + " " * (32 - mem))
+        out.append(f"{CSI}90m{mem * 40}M/3.71G{CSI}39m{CSI}1m]{CSI}m")
+        out.append(cup(2, 70) + f"{CSI}36mTasks: {CSI}1m{len(procs)}{CSI}22m, "
+                   f"{CSI}32m{rnd.randint(1, 9)} running{CSI}m{CSI}K")
+        out.append(cup(3, 70) + f"{CSI}36mLoad average: {CSI}1m{rnd.random():.2f} "
+                   f"{CSI}22m{rnd.random():.2f} {rnd.random():.2f}{CSI}m{CSI}K")
+
+        # Process table: header, then only the rows that changed
+        out.append(cup(7, 1) + f"{CSI}30;42m    PID USER      PRI  NI  VIRT   RES   SHR S "
+                   f"{CSI}30;46mCPU%{CSI}30;42m MEM%   TIME+  Command".ljust(cols + 20) + f"{CSI}m")
+        if frame % 10 == 0:
+            rnd.shuffle(procs)
+        for i, (pid, name) in enumerate(procs):
+            if frame % 10 != 0 and rnd.random() < 0.6:
+                continue
+            selected = i == frame % len(procs)
+            row = f"{pid:7d} user       20   0 {rnd.randint(1, 999):4d}M {rnd.randint(1, 400):4d}M "
+            row += f"{rnd.randint(1, 99):4d}M {rnd.choice('RSSSD')} {rnd.random() * 30:4.1f} "
+            row += f"{rnd.random() * 10:4.1f} {rnd.randint(0, 59)}:{rnd.randint(0, 59):02d}.{rnd.randint(0, 99):02d} "
+            out.append(cup(8 + i, 1))
+            out.append(f"{CSI}30;46m" if selected else "")
+            out.append(row + f"{CSI}1m{name}{CSI}22m" + (f"{CSI}m" if selected else "") + f"{CSI}K")
+
+        # Function key bar
+        out.append(cup(rows, 1))
+        for key, label in [("F1", "Help  "), ("F2", "Setup "), ("F3", "Search"), ("F4", "Filter"),
+                           ("F5", "Tree  "), ("F6", "SortBy"), ("F9", "Kill  "), ("F10", "Quit  ")]:
+            out.append(f"{CSI}m{key}{CSI}30;46m{label}")
+        out.append(f"{CSI}m{CSI}K")
+
+    out += [f"{CSI}?1l{ESC}>", f"{CSI}?25h", f"{CSI}?1049l"]
+    return "".join(out)
+
+
+def vttest(rounds=20, cols=80, rows=24):
+    out = []
+    for rnd_index in range(rounds):
+        # Cursor movements: DECALN, then a box drawn with absolute and relative moves
+        out.append(f"{CSI}?7h{CSI}2J{ESC}#8")
+        out.append(f"{cup(9, 10)}{CSI}1J{cup(18, 60)}{CSI}0J{CSI}1K")
+        for row in range(10, 17):
+            out.append(f"{cup(row, 10)}{CSI}1K{cup(row, 71)}{CSI}0K")
+        out.append(cup(1, 1) + "*" * cols + cup(rows, 1) + "*" * cols)
+        out.append(cup(2, 1))
+        for _ in range(rows - 2):
+            out.append(f"*{CSI}{cols - 2}C*{ESC}E")
+        out.append(cup(2, 2))
+        for _ in range(rows - 2):
+            out.append(f"+{CSI}1D{ESC}D")
+        out.append(cup(rows - 1, cols - 1))
+        for _ in range(rows - 2):
+            out.append(f"+{CSI}1D{ESC}M")
+        out.append(cup(12, 25) + "The screen should be cleared,  and have an unbroken bor-")
+
+        # Autowrap: fill the screen through the right margin
+        out.append(f"{CSI}2J{cup(1, 1)}")
+        for i in range(rows * 2):
+            out.append(chr(ord("A") + i % 26) * (cols // 2 + 7))
+
+        # Scroll regions: soft and jump scrolling inside a margin, up and down
+        out.append(f"{CSI}2J{CSI}12;13r{cup(12, 1)}")
+        for i in range(40):
+            out.append(f"{CSI}K{i:3d} I'm scrolling up in a two-line region\r\n")
+        out.append(f"{CSI}1;24r{CSI}?6h{cup(1, 1)}")
+        for i in range(40):
+            out.append(f"{ESC}M{CSI}K{i:3d} and now scrolling down\r")
+        out.append(f"{CSI}?6l{CSI}r")
+
+        # Insert/delete: lines and characters
+        out.append(f"{CSI}2J{cup(1, 1)}")
+        for row in range(rows):
+            out.append(cup(row + 1, 1) + chr(ord("A") + row) * cols)
+        out.append(cup(1, 1))
+        for _ in range(rows // 2):
+            out.append(f"{CSI}2M{CSI}B")
+        out.append(cup(1, 1))
+        for _ in range(rows // 2):
+            out.append(f"{CSI}L{CSI}2B")
+        for row in range(1, rows + 1):
+            out.append(f"{cup(row, 10)}{CSI}5P{cup(row, 30)}{CSI}3@abc")
+        out.append(f"{cup(rows, 1)}{CSI}4h" + "inserted" * 5 + f"{CSI}4l")
+
+        # Character attributes and the DEC Special Graphics set
+        out.append(f"{CSI}2J{cup(1, 1)}")
+        for attrs in ["0", "1", "4", "5", "7", "1;4", "4;7", "1;4;5;7"]:
+            for color in range(8):
+                out.append(f"{CSI}{attrs};3{color};4{7 - color}m Aa{CSI}0m ")
+            out.append("\r\n")
+        out.append(f"{ESC}(0lqqqqqqqqqqqqk\r\nx            x\r\nmqqqqqqqqqqqqj{ESC}(B\r\n")
+        out.append(f"{ESC}7{cup(20, 1)}saved{ESC}8restored{CSI}s{cup(22, 1)}{CSI}u")
+
+        # Device status reports the real vttest waits for
+        out.append(f"{CSI}6n{CSI}5n{CSI}c{CSI}>c")
+    return "".join(out)
+
+
+def main():
+    outdir = sys.argv[1] if len(sys.argv) > 1 else os.path.dirname(os.path.abspath(__file__))
+    for name, data in [("htop.vt", htop()), ("vttest.vt", vttest())]:
+        with open(os.path.join(outdir, name), "wb") as f:
+            f.write(data.encode("utf-8"))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,108 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QQmlEngine>
+#include "../shell/src/marathonappcompiler.h"
+
+class TestAppCompiler : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void initTestCase();
+    void init();
+    void testCompilesEveryFile();
+    void testMatchingStampSkipsCompile();
+    void testChangedContentSameMtimeIsTouched();
+
+  private:
+    void                writeFile(const QString &name, const QByteArray &contents);
+    // Compiles the test app with a fresh compiler, returns the appCompiled arguments
+    QList<QVariant>     compile();
+
+    QTemporaryDir       m_dir;
+    QString             m_appPath;
+    QQmlEngine          m_engine;
+    MarathonImportPaths m_importPaths{&m_engine};
+    MarathonAppRegistry m_registry;
+};
+
+void TestAppCompiler::initTestCase() {
+    QVERIFY(m_dir.isValid());
+    m_appPath = m_dir.filePath("apps/hello");
+
+    MarathonAppRegistry::AppInfo info;
+    info.id           = "hello";
+    info.name         = "Hello";
+    info.type         = MarathonAppRegistry::Marathon;
+    info.absolutePath = m_appPath;
+    info.entryPoint   = "Main.qml";
+    info.isProtected  = false;
+    m_registry.registerAppInfo(info);
+}
+
+void TestAppCompiler::init() {
+    QDir(m_dir.path()).removeRecursively();
+    QVERIFY(QDir().mkpath(m_appPath));
+    writeFile("Main.qml", "import QtQml\nQtObject { property int answer: 42 }\n");
+    writeFile("Broken.qml", "import QtQml\nQtObject { property int answer: }\n");
+    writeFile("util.js", ".pragma library\nfunction twice(x) { return 2 * x }\n");
+}
+
+void TestAppCompiler::writeFile(const QString &name, const QByteArray &contents) {
+    QFile file(m_appPath + "/" + name);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write(contents);
+}
+
+QList<QVariant> TestAppCompiler::compile() {
+    MarathonAppCompiler compiler(&m_registry, &m_importPaths);
+    compiler.setStampDirectory(m_dir.filePath("stamps"));
+    QSignalSpy compiled(&compiler, &MarathonAppCompiler::appCompiled);
+
+    compiler.compileApp("hello");
+    if (!compiled.wait(5000) || !compiler.isCompiled("hello"))
+        return {};
+    return compiled.takeFirst();
+}
+
+void TestAppCompiler::testCompilesEveryFile() {
+    const QList<QVariant> result = compile();
+    QCOMPARE(result.size(), 3);
+    QCOMPARE(result.at(0).toString(), QString("hello"));
+    QCOMPARE(result.at(1).toInt(), 2); // QML files
+    QCOMPARE(result.at(2).toInt(), 1); // Broken.qml
+    QVERIFY(QFile::exists(m_dir.filePath("stamps/hello.json")));
+}
+
+void TestAppCompiler::testMatchingStampSkipsCompile() {
+    QCOMPARE(compile().value(1).toInt(), 2);
+    QCOMPARE(compile().value(1).toInt(), 0);
+
+    // A new file invalidates the stamp
+    writeFile("Extra.qml", "import QtQml\nQtObject {}\n");
+    QCOMPARE(compile().value(1).toInt(), 3);
+}
+
+void TestAppCompiler::testChangedContentSameMtimeIsTouched() {
+    QCOMPARE(compile().value(1).toInt(), 2);
+
+    // Rewrite Main.qml but put its old timestamp back, as a timestamp-preserving copy would
+    const QString   path  = m_appPath + "/Main.qml";
+    const QDateTime mtime = QFileInfo(path).lastModified();
+    writeFile("Main.qml", "import QtQml\nQtObject { property int answer: 43 }\n");
+    {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        QVERIFY(file.setFileTime(mtime, QFileDevice::FileModificationTime));
+    }
+
+    QCOMPARE(compile().value(1).toInt(), 2);
+    QVERIFY(QFileInfo(path).lastModified() != mtime);
+}
+
+QTEST_MAIN(TestAppCompiler)
+#include "test_appcompiler.moc"
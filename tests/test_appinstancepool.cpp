@@ -0,0 +1,103 @@
+#include <QTest>
+#include <QPointer>
+#include <QQmlComponent>
+#include <QQmlEngine>
+#include "../shell/src/marathonappinstancepool.h"
+
+class TestAppInstancePool : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void testSuspendFreezesTimers();
+    void testEvictionCandidatesLeastRecentFirst();
+    void testRemoveDestroysInstance();
+    void testInstanceDestroyedElsewhere();
+
+  private:
+    // Stands in for an app: a running timer and a visible flag, as on an Item
+    QObject   *createApp();
+
+    QQmlEngine m_engine;
+};
+
+QObject *TestAppInstancePool::createApp() {
+    QQmlComponent component(&m_engine);
+    component.setData("import QtQml\n"
+                      "QtObject {\n"
+                      "    id: root\n"
+                      "    property int ticks: 0\n"
+                      "    property bool visible: true\n"
+                      "    property Timer timer: Timer {\n"
+                      "        interval: 5; running: true; repeat: true\n"
+                      "        onTriggered: root.ticks++\n"
+                      "    }\n"
+                      "}\n",
+                      QUrl());
+    return component.create();
+}
+
+void TestAppInstancePool::testSuspendFreezesTimers() {
+    MarathonAppInstancePool pool;
+    QObject                *app = createApp();
+    QVERIFY(app);
+    pool.add("clock", app);
+    QTRY_VERIFY(app->property("ticks").toInt() > 0);
+
+    QVERIFY(pool.suspend("clock"));
+    QVERIFY(pool.isSuspended("clock"));
+    QVERIFY(!app->property("visible").toBool());
+    const int ticks = app->property("ticks").toInt();
+    QTest::qWait(50);
+    QCOMPARE(app->property("ticks").toInt(), ticks);
+
+    QCOMPARE(pool.resume("clock"), app);
+    QVERIFY(!pool.isSuspended("clock"));
+    QVERIFY(app->property("visible").toBool());
+    QTRY_VERIFY(app->property("ticks").toInt() > ticks);
+}
+
+void TestAppInstancePool::testEvictionCandidatesLeastRecentFirst() {
+    MarathonAppInstancePool pool;
+    const QStringList       apps = {"a", "b", "c", "d"};
+    for (const QString &appId : apps) {
+        pool.add(appId, createApp());
+        QVERIFY(pool.suspend(appId));
+    }
+
+    // Suspending again counts as a use
+    QVERIFY(pool.suspend("a"));
+    QCOMPARE(pool.evictionCandidates(2), QStringList({"b", "c"}));
+
+    pool.resume("b");
+    QCOMPARE(pool.suspendedApps(), QStringList({"c", "d", "a"}));
+    QCOMPARE(pool.evictionCandidates(3), QStringList());
+    QCOMPARE(pool.evictionCandidates(0), QStringList({"c", "d", "a"}));
+}
+
+void TestAppInstancePool::testRemoveDestroysInstance() {
+    MarathonAppInstancePool pool;
+    QPointer<QObject>       app = createApp();
+    pool.add("clock", app);
+    pool.suspend("clock");
+
+    pool.remove("clock");
+    QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+    QVERIFY(app.isNull());
+    QVERIFY(!pool.instance("clock"));
+    QVERIFY(pool.suspendedApps().isEmpty());
+}
+
+void TestAppInstancePool::testInstanceDestroyedElsewhere() {
+    MarathonAppInstancePool pool;
+    QObject                *app = createApp();
+    pool.add("clock", app);
+    pool.suspend("clock");
+
+    delete app;
+    QVERIFY(!pool.instance("clock"));
+    QVERIFY(!pool.isSuspended("clock"));
+    QVERIFY(pool.suspendedApps().isEmpty());
+}
+
+QTEST_MAIN(TestAppInstancePool)
+#include "test_appinstancepool.moc"
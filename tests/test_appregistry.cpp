@@ -0,0 +1,221 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QDir>
+#include <QThread>
+#include "../shell/src/marathonappregistry.h"
+#include "../shell/src/marathonappscanner.h"
+
+class TestAppRegistry : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void initTestCase();
+    void init();
+    void testCreateSnapshotKeepsFirstDuplicate();
+    void testScanSwapsInOneReset();
+    void testHeldSnapshotSurvivesRescan();
+    void testAsyncScanAppliesOnGuiThread();
+    void testRescanAppTouchesOneRow();
+    void testDeltasShareUnchangedApps();
+    void testWatcherFollowsInstalls();
+
+  private:
+    void          writeManifest(const QString &id, const QString &name);
+
+    QTemporaryDir m_home;
+    QString       m_appsPath;
+};
+
+void TestAppRegistry::initTestCase() {
+    QVERIFY(m_home.isValid());
+    // The scanner looks in ~/.local/share/marathon-apps
+    qputenv("HOME", QFile::encodeName(m_home.path()));
+    m_appsPath = m_home.filePath(".local/share/marathon-apps");
+}
+
+void TestAppRegistry::init() {
+    QDir(m_appsPath).removeRecursively();
+    QVERIFY(QDir().mkpath(m_appsPath));
+}
+
+void TestAppRegistry::writeManifest(const QString &id, const QString &name) {
+    QVERIFY(QDir().mkpath(m_appsPath + "/" + id));
+    QFile file(m_appsPath + "/" + id + "/manifest.json");
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write("{\"id\": \"" + id.toUtf8() + "\", \"name\": \"" + name.toUtf8() +
+               "\", \"entryPoint\": \"Main.qml\"}");
+}
+
+void TestAppRegistry::testCreateSnapshotKeepsFirstDuplicate() {
+    MarathonAppRegistry::AppInfo first;
+    first.id   = "dup";
+    first.name = "First";
+    MarathonAppRegistry::AppInfo second = first;
+    second.name                         = "Second";
+
+    const auto snapshot = MarathonAppRegistry::createSnapshot({first, second});
+    QCOMPARE(snapshot->apps.size(), qsizetype(1));
+    QCOMPARE(snapshot->find("dup")->name, QString("First"));
+    QVERIFY(!snapshot->find("missing"));
+}
+
+void TestAppRegistry::testScanSwapsInOneReset() {
+    writeManifest("alpha", "Alpha");
+    writeManifest("beta", "Beta");
+
+    MarathonAppRegistry registry;
+    MarathonAppScanner  scanner(&registry);
+    QSignalSpy          resets(&registry, &QAbstractItemModel::modelReset);
+    QSignalSpy          counts(&registry, &MarathonAppRegistry::countChanged);
+    QSignalSpy          complete(&scanner, &MarathonAppScanner::scanComplete);
+
+    scanner.scanApplications();
+    QCOMPARE(resets.count(), 1);
+    QCOMPARE(counts.count(), 1);
+    QCOMPARE(complete.count(), 1);
+    QCOMPARE(complete.at(0).at(0).toInt(), 2);
+    QCOMPARE(registry.rowCount(), 2);
+    QCOMPARE(registry.getApp("beta").value("name").toString(), QString("Beta"));
+
+    // Removed apps leave the registry on the next scan
+    QSignalSpy removed(&registry, &MarathonAppRegistry::appUnregistered);
+    QVERIFY(QDir(m_appsPath + "/alpha").removeRecursively());
+    scanner.scanApplications();
+    QCOMPARE(removed.count(), 1);
+    QCOMPARE(removed.at(0).at(0).toString(), QString("alpha"));
+    QVERIFY(!registry.hasApp("alpha"));
+    QCOMPARE(complete.at(1).at(0).toInt(), 0);
+}
+
+void TestAppRegistry::testHeldSnapshotSurvivesRescan() {
+    writeManifest("alpha", "Alpha");
+
+    MarathonAppRegistry registry;
+    MarathonAppScanner  scanner(&registry);
+    scanner.scanApplications();
+
+    const auto held = registry.snapshot();
+    writeManifest("gamma", "Gamma");
+    scanner.scanApplications();
+
+    QCOMPARE(held->apps.size(), qsizetype(1));
+    QCOMPARE(registry.snapshot()->apps.size(), qsizetype(2));
+    QVERIFY(registry.hasApp("gamma"));
+}
+
+void TestAppRegistry::testAsyncScanAppliesOnGuiThread() {
+    writeManifest("alpha", "Alpha");
+    writeManifest("beta", "Beta");
+
+    MarathonAppRegistry registry;
+    MarathonAppScanner  scanner(&registry);
+    QSignalSpy          complete(&scanner, &MarathonAppScanner::scanComplete);
+    QThread            *modelThread = nullptr;
+    connect(&registry, &QAbstractItemModel::modelReset, this,
+            [&modelThread]() { modelThread = QThread::currentThread(); });
+
+    scanner.scanApplicationsAsync();
+    // Nothing is applied until the event loop delivers the scanned snapshot
+    QCOMPARE(registry.rowCount(), 0);
+
+    QTRY_COMPARE(complete.count(), 1);
+    QCOMPARE(complete.at(0).at(0).toInt(), 2);
+    QCOMPARE(registry.rowCount(), 2);
+    QCOMPARE(modelThread, QThread::currentThread());
+}
+
+void TestAppRegistry::testRescanAppTouchesOneRow() {
+    writeManifest("alpha", "Alpha");
+
+    MarathonAppRegistry registry;
+    MarathonAppScanner  scanner(&registry);
+    scanner.scanApplications();
+
+    QSignalSpy resets(&registry, &QAbstractItemModel::modelReset);
+    QSignalSpy inserted(&registry, &QAbstractItemModel::rowsInserted);
+    QSignalSpy changedRows(&registry, &QAbstractItemModel::dataChanged);
+    QSignalSpy removedRows(&registry, &QAbstractItemModel::rowsRemoved);
+    QSignalSpy changed(&scanner, &MarathonAppScanner::appChanged);
+    QSignalSpy removed(&scanner, &MarathonAppScanner::appRemoved);
+
+    writeManifest("beta", "Beta");
+    scanner.rescanApp(m_appsPath + "/beta");
+    QCOMPARE(inserted.count(), 1);
+    QCOMPARE(changed.count(), 1);
+    QVERIFY(registry.hasApp("beta"));
+
+    // Same manifest again: nothing to do
+    scanner.rescanApp(m_appsPath + "/beta");
+    QCOMPARE(changed.count(), 1);
+    QCOMPARE(changedRows.count(), 0);
+
+    writeManifest("beta", "Beta 2");
+    scanner.rescanApp(m_appsPath + "/beta");
+    QCOMPARE(changedRows.count(), 1);
+    QCOMPARE(changed.count(), 2);
+    QCOMPARE(registry.getApp("beta").value("name").toString(), QString("Beta 2"));
+
+    QVERIFY(QDir(m_appsPath + "/beta").removeRecursively());
+    scanner.rescanApp(m_appsPath + "/beta");
+    QCOMPARE(removedRows.count(), 1);
+    QCOMPARE(removed.count(), 1);
+    QVERIFY(!registry.hasApp("beta"));
+
+    QCOMPARE(resets.count(), 0);
+    QCOMPARE(registry.rowCount(), 1);
+}
+
+void TestAppRegistry::testDeltasShareUnchangedApps() {
+    MarathonAppRegistry          registry;
+    MarathonAppRegistry::AppInfo alpha;
+    alpha.id           = "alpha";
+    alpha.absolutePath = "/apps/alpha";
+    MarathonAppRegistry::AppInfo beta;
+    beta.id           = "beta";
+    beta.absolutePath = "/apps/beta";
+    registry.registerAppInfo(alpha);
+    registry.registerAppInfo(beta);
+
+    const auto held   = registry.snapshot();
+    beta.absolutePath = "/apps/beta-2";
+    QVERIFY(registry.updateAppInfo(beta));
+
+    // Only the changed app is new; the held snapshot still sees the old one
+    const auto updated = registry.snapshot();
+    QCOMPARE(updated->find("alpha"), held->find("alpha"));
+    QVERIFY(updated->find("beta") != held->find("beta"));
+    QCOMPARE(held->find("beta")->absolutePath, QString("/apps/beta"));
+    QCOMPARE(updated->findByPath("/apps/beta-2"), updated->find("beta"));
+    QVERIFY(!updated->findByPath("/apps/beta"));
+
+    QVERIFY(registry.unregisterApp("alpha"));
+    QCOMPARE(registry.snapshot()->find("beta"), updated->find("beta"));
+    QVERIFY(!registry.snapshot()->findByPath("/apps/alpha"));
+    QCOMPARE(registry.getAllAppIds(), QStringList({"beta"}));
+    QVERIFY(updated->find("alpha"));
+}
+
+void TestAppRegistry::testWatcherFollowsInstalls() {
+    writeManifest("alpha", "Alpha");
+
+    MarathonAppRegistry registry;
+    MarathonAppScanner  scanner(&registry);
+    scanner.startWatching();
+    scanner.scanApplications();
+
+    QSignalSpy changed(&scanner, &MarathonAppScanner::appChanged);
+    QSignalSpy removed(&scanner, &MarathonAppScanner::appRemoved);
+
+    writeManifest("gamma", "Gamma");
+    QTRY_VERIFY(registry.hasApp("gamma"));
+    QCOMPARE(changed.count(), 1);
+
+    QVERIFY(QDir(m_appsPath + "/alpha").removeRecursively());
+    QTRY_VERIFY(!registry.hasApp("alpha"));
+    QCOMPARE(removed.count(), 1);
+}
+
+QTEST_MAIN(TestAppRegistry)
+#include "test_appregistry.moc"
@@ -0,0 +1,129 @@
+#include <QTest>
+#include "../shell/src/appmodel.h"
+#include "../shell/src/appsearchindex.h"
+#include "../shell/src/marathonappregistry.h"
+
+class TestAppSearchIndex : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void init();
+    void cleanup();
+    void testTierOrder();
+    void testAccentsAndCaseAreFolded();
+    void testFuzzyMatch();
+    void testDeepLinksAndKeywords();
+    void testNativeAppsCanBeExcluded();
+    void testFollowsModelChanges();
+    void testLimit();
+
+  private:
+    static QStringList   titles(const QVariantList &results);
+
+    AppModel            *m_apps     = nullptr;
+    MarathonAppRegistry *m_registry = nullptr;
+    AppSearchIndex      *m_index    = nullptr;
+};
+
+void TestAppSearchIndex::init() {
+    m_apps     = new AppModel;
+    m_registry = new MarathonAppRegistry;
+    m_index    = new AppSearchIndex(m_apps, m_registry);
+
+    m_apps->addApp("camera", "Camera", "camera.svg", "marathon");
+    m_apps->addApp("calendar", "Calendar", "calendar.svg", "marathon");
+    m_apps->addApp("calc", "Calc", "calc.svg", "native");
+    m_apps->addApp("photos", "Photo Camera Roll", "photos.svg", "native");
+    m_apps->addApp("cafe", "Café Finder", "cafe.svg", "marathon");
+
+    MarathonAppRegistry::AppInfo settings;
+    settings.id             = "settings";
+    settings.name           = "Settings";
+    settings.icon           = "settings.svg";
+    settings.type           = MarathonAppRegistry::Marathon;
+    settings.isProtected    = true;
+    settings.searchKeywords = {"Preferences"};
+    settings.deepLinksJson  = R"({"wifi": {"title": "Wi-Fi", "keywords": ["wireless", "network"]},
+                                  "bluetooth": {"description": "Pair devices"}})";
+    m_registry->registerAppInfo(settings);
+    m_apps->addApp("settings", "Settings", "settings.svg", "marathon");
+}
+
+void TestAppSearchIndex::cleanup() {
+    delete m_index;
+    delete m_registry;
+    delete m_apps;
+}
+
+QStringList TestAppSearchIndex::titles(const QVariantList &results) {
+    QStringList result;
+    for (const QVariant &item : results)
+        result.append(item.toMap().value("title").toString());
+    return result;
+}
+
+void TestAppSearchIndex::testTierOrder() {
+    // Exact title beats a title word, which is an exact keyword
+    const QVariantList results = m_index->search("camera");
+    QCOMPARE(titles(results).mid(0, 2), QStringList({"Camera", "Photo Camera Roll"}));
+    QCOMPARE(results.at(0).toMap().value("score").toInt(), 10100);
+    QCOMPARE(results.at(1).toMap().value("score").toInt(), 3100);
+
+    // Equal scores in title order, ahead of fuzzy matches
+    QCOMPARE(titles(m_index->search("cal")).mid(0, 2), QStringList({"Calc", "Calendar"}));
+    QVERIFY(m_index->search("   ").isEmpty());
+}
+
+void TestAppSearchIndex::testAccentsAndCaseAreFolded() {
+    QCOMPARE(titles(m_index->search("CAFE")), QStringList({"Café Finder"}));
+    QCOMPARE(titles(m_index->search("café")), QStringList({"Café Finder"}));
+    QCOMPARE(AppSearchIndex::fold("Ünïcödé"), QString("unicode"));
+}
+
+void TestAppSearchIndex::testFuzzyMatch() {
+    // Letters in order, not adjacent
+    const QVariantList results = m_index->search("clndr");
+    QCOMPARE(titles(results), QStringList({"Calendar"}));
+    QVERIFY(results.at(0).toMap().value("score").toInt() < 500);
+}
+
+void TestAppSearchIndex::testDeepLinksAndKeywords() {
+    const QVariantList wifi = m_index->search("wireless");
+    QCOMPARE(titles(wifi), QStringList({"Wi-Fi"}));
+    const QVariantMap link = wifi.at(0).toMap();
+    QCOMPARE(link.value("type").toString(), QString("deeplink"));
+    QCOMPARE(link.value("appId").toString(), QString("settings"));
+    QCOMPARE(link.value("data").toMap().value("route").toString(), QString("wifi"));
+
+    // Falls back to the route and the app name
+    const QVariantList bluetooth = m_index->search("bluetooth");
+    QCOMPARE(titles(bluetooth), QStringList({"bluetooth"}));
+    QCOMPARE(bluetooth.at(0).toMap().value("subtitle").toString(), QString("Pair devices"));
+
+    // Registry search keywords find the app itself
+    QCOMPARE(titles(m_index->search("prefer")).value(0), QString("Settings"));
+}
+
+void TestAppSearchIndex::testNativeAppsCanBeExcluded() {
+    QVERIFY(titles(m_index->search("calc")).contains("Calc"));
+    m_index->setIncludeNativeApps(false);
+    QVERIFY(!titles(m_index->search("calc")).contains("Calc"));
+}
+
+void TestAppSearchIndex::testFollowsModelChanges() {
+    const int before = m_index->count();
+    m_apps->addApp("weather", "Weather", "weather.svg", "marathon");
+    QCOMPARE(titles(m_index->search("weather")), QStringList({"Weather"}));
+    QCOMPARE(m_index->count(), before + 1);
+
+    m_apps->removeApp("weather");
+    QVERIFY(m_index->search("weather").isEmpty());
+}
+
+void TestAppSearchIndex::testLimit() {
+    QCOMPARE(m_index->search("c").size(), m_index->search("c", 2).size() + 3);
+    QCOMPARE(titles(m_index->search("c", 2)), titles(m_index->search("c")).mid(0, 2));
+}
+
+QTEST_MAIN(TestAppSearchIndex)
+#include "test_appsearchindex.moc"
@@ -0,0 +1,174 @@
+#include <QTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QDir>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "../shell/src/desktopfileparser.h"
+
+class TestDesktopFileParser : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void init();
+    void testUnchangedFilesComeFromCache();
+    void testAddedAndRemovedFiles();
+    void testCorruptCacheIsIgnored();
+    void testAsyncScanDeliversBatches();
+    void testWatchReportsOnlyChanges();
+
+  private:
+    void                          writeEntry(const QString &fileName, const QString &name);
+    static void                   setMtime(const QString &path, qint64 secsSinceEpoch);
+    static QStringList            names(const QVariantList &apps);
+    QStringList                   scan();
+
+    QScopedPointer<QTemporaryDir> m_dir;
+    QString                       m_appsPath;
+    QString                       m_cachePath;
+};
+
+// Old enough that the parser trusts the timestamps
+static const qint64 kLongAgo = 1600000000;
+
+void TestDesktopFileParser::init() {
+    m_dir.reset(new QTemporaryDir);
+    QVERIFY(m_dir->isValid());
+    m_appsPath  = m_dir->filePath("applications");
+    m_cachePath = m_dir->filePath("cache/desktop-entries.cache");
+    QVERIFY(QDir().mkpath(m_appsPath));
+}
+
+void TestDesktopFileParser::writeEntry(const QString &fileName, const QString &name) {
+    QFile file(m_appsPath + "/" + fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write("[Desktop Entry]\nType=Application\nName=" + name.toUtf8() + "\nExec=" +
+               name.toLower().toUtf8() + "\n");
+}
+
+void TestDesktopFileParser::setMtime(const QString &path, qint64 secsSinceEpoch) {
+    const struct timespec times[2] = {{time_t(secsSinceEpoch), 0}, {time_t(secsSinceEpoch), 0}};
+    QCOMPARE(::utimensat(AT_FDCWD, QFile::encodeName(path).constData(), times, 0), 0);
+}
+
+QStringList TestDesktopFileParser::names(const QVariantList &apps) {
+    QStringList result;
+    for (const QVariant &app : apps)
+        result.append(app.toMap().value("name").toString());
+    return result;
+}
+
+QStringList TestDesktopFileParser::scan() {
+    // A fresh parser each time, so only the cache file carries state
+    DesktopFileParser parser(m_cachePath);
+    return names(parser.scanApplications({m_appsPath}));
+}
+
+void TestDesktopFileParser::testUnchangedFilesComeFromCache() {
+    writeEntry("alpha.desktop", "Alpha");
+    setMtime(m_appsPath + "/alpha.desktop", kLongAgo);
+    setMtime(m_appsPath, kLongAgo);
+
+    QCOMPARE(scan(), QStringList({"Alpha"}));
+    QVERIFY(QFile::exists(m_cachePath));
+
+    // Same inode, size and mtime: the stale cached entry must win
+    writeEntry("alpha.desktop", "Omega");
+    setMtime(m_appsPath + "/alpha.desktop", kLongAgo);
+    QCOMPARE(scan(), QStringList({"Alpha"}));
+
+    // Touched: parsed again
+    setMtime(m_appsPath + "/alpha.desktop", kLongAgo + 60);
+    QCOMPARE(scan(), QStringList({"Omega"}));
+}
+
+void TestDesktopFileParser::testAddedAndRemovedFiles() {
+    writeEntry("alpha.desktop", "Alpha");
+    setMtime(m_appsPath + "/alpha.desktop", kLongAgo);
+    setMtime(m_appsPath, kLongAgo);
+    QCOMPARE(scan(), QStringList({"Alpha"}));
+
+    writeEntry("beta.desktop", "Beta");
+    setMtime(m_appsPath + "/beta.desktop", kLongAgo);
+    setMtime(m_appsPath, kLongAgo + 60);
+    QCOMPARE(scan(), QStringList({"Alpha", "Beta"}));
+
+    QVERIFY(QFile::remove(m_appsPath + "/alpha.desktop"));
+    setMtime(m_appsPath, kLongAgo + 120);
+    QCOMPARE(scan(), QStringList({"Beta"}));
+}
+
+void TestDesktopFileParser::testCorruptCacheIsIgnored() {
+    writeEntry("alpha.desktop", "Alpha");
+    QVERIFY(QDir().mkpath(QFileInfo(m_cachePath).absolutePath()));
+
+    QFile cache(m_cachePath);
+    QVERIFY(cache.open(QIODevice::WriteOnly));
+    cache.write("MDEC but not really a cache");
+    cache.close();
+
+    QCOMPARE(scan(), QStringList({"Alpha"}));
+    QCOMPARE(scan(), QStringList({"Alpha"}));
+}
+
+void TestDesktopFileParser::testAsyncScanDeliversBatches() {
+    // Enough files to be split over several parse tasks, one of them already cached
+    for (int i = 0; i < 40; ++i)
+        writeEntry(QString("app%1.desktop").arg(i, 2, 10, QChar('0')), QString("App%1").arg(i));
+    setMtime(m_appsPath + "/app00.desktop", kLongAgo);
+    setMtime(m_appsPath, kLongAgo);
+    {
+        DesktopFileParser parser(m_cachePath);
+        parser.scanApplications({m_appsPath});
+    }
+
+    DesktopFileParser parser(m_cachePath);
+    QStringList       found;
+    int               batches  = 0;
+    int               finished = -1;
+    // Queued to this thread: the parser emits from its workers
+    connect(&parser, &DesktopFileParser::applicationsFound, this,
+            [&](const QVariantList &apps) {
+                found += names(apps);
+                ++batches;
+            });
+    connect(&parser, &DesktopFileParser::scanFinished, this, [&](int count) { finished = count; });
+
+    parser.scanApplicationsAsync({m_appsPath}, false);
+    QTRY_COMPARE(finished, 40);
+
+    found.sort();
+    QCOMPARE(found.size(), 40);
+    QCOMPARE(found.first(), QString("App0"));
+    QVERIFY(batches > 1);
+}
+
+void TestDesktopFileParser::testWatchReportsOnlyChanges() {
+    writeEntry("keep.desktop", "Keep");
+    writeEntry("gone.desktop", "Gone");
+    writeEntry("edit.desktop", "Edit");
+
+    DesktopFileParser parser(m_cachePath);
+    parser.scanApplications({m_appsPath});
+
+    QStringList changed;
+    QStringList removedIds;
+    connect(&parser, &DesktopFileParser::applicationsChanged, this,
+            [&](const QVariantList &apps, const QStringList &removed) {
+                changed    += names(apps);
+                removedIds += removed;
+            });
+    parser.watchDirectories({m_appsPath}, false);
+
+    writeEntry("new.desktop", "New");
+    writeEntry("edit.desktop", "Edited");
+    QVERIFY(QFile::remove(m_appsPath + "/gone.desktop"));
+
+    QTRY_VERIFY(changed.size() + removedIds.size() >= 3);
+    changed.sort();
+    QCOMPARE(changed, QStringList({"Edited", "New"}));
+    QCOMPARE(removedIds, QStringList({"gone"}));
+}
+
+QTEST_MAIN(TestDesktopFileParser)
+#include "test_desktopfileparser.moc"
@@ -0,0 +1,101 @@
+#include <QTest>
+#include <QThread>
+#include <atomic>
+#include "../shell/src/frametimingring.h"
+
+class TestFrameTimingRing : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void testLatestOldestFirst();
+    void testWrapsAround();
+    void testConcurrentReadsAreNeverTorn();
+
+  private:
+    // Every field derived from n, so a torn read shows up as a mismatch
+    static FrameTiming sample(qint64 n);
+    static bool        isConsistent(const FrameTiming &timing);
+};
+
+FrameTiming TestFrameTimingRing::sample(qint64 n) {
+    FrameTiming timing;
+    timing.presentedNs         = n;
+    timing.intervalUs          = qint32(n % 100000);
+    timing.frameTimeUs         = qint32(n % 100000) + 1;
+    timing.droppedFrames       = qint32(n % 7);
+    timing.callbackToPresentUs = qint32(n % 100000) + 2;
+    timing.commitToPresentUs   = qint32(n % 100000) + 3;
+    timing.inputToPresentUs    = qint32(n % 100000) + 4;
+    return timing;
+}
+
+bool TestFrameTimingRing::isConsistent(const FrameTiming &timing) {
+    FrameTiming expected = sample(timing.presentedNs);
+    return timing.intervalUs == expected.intervalUs && timing.frameTimeUs == expected.frameTimeUs &&
+           timing.droppedFrames == expected.droppedFrames &&
+           timing.callbackToPresentUs == expected.callbackToPresentUs &&
+           timing.commitToPresentUs == expected.commitToPresentUs &&
+           timing.inputToPresentUs == expected.inputToPresentUs;
+}
+
+void TestFrameTimingRing::testLatestOldestFirst() {
+    FrameTimingRing ring;
+    QVERIFY(ring.latest(10).isEmpty());
+
+    for (qint64 n = 1; n <= 5; ++n)
+        ring.push(sample(n));
+
+    QCOMPARE(ring.pushed(), quint64(5));
+    QVector<FrameTiming> latest = ring.latest(3);
+    QCOMPARE(int(latest.count()), 3);
+    QCOMPARE(latest.at(0).presentedNs, qint64(3));
+    QCOMPARE(latest.at(2).presentedNs, qint64(5));
+    QCOMPARE(int(ring.latest(100).count()), 5);
+    QVERIFY(ring.latest(-1).isEmpty());
+}
+
+void TestFrameTimingRing::testWrapsAround() {
+    FrameTimingRing ring;
+    const qint64    total = FrameTimingRing::kCapacity * 2 + 10;
+    for (qint64 n = 1; n <= total; ++n)
+        ring.push(sample(n));
+
+    QVector<FrameTiming> latest = ring.latest(FrameTimingRing::kCapacity * 4);
+    QCOMPARE(int(latest.count()), FrameTimingRing::kCapacity);
+    QCOMPARE(latest.first().presentedNs, total - FrameTimingRing::kCapacity + 1);
+    QCOMPARE(latest.last().presentedNs, total);
+}
+
+void TestFrameTimingRing::testConcurrentReadsAreNeverTorn() {
+    FrameTimingRing   ring;
+    std::atomic<bool> done{false};
+
+    QThread *producer = QThread::create([&ring, &done]() {
+        for (qint64 n = 1; n <= 200000; ++n)
+            ring.push(sample(n));
+        done = true;
+    });
+    producer->start();
+
+    // Failures are counted, not reported in the loop, so the producer is always joined
+    int reads = 0, torn = 0, unordered = 0;
+    do {
+        qint64 last = 0;
+        for (const FrameTiming &timing : ring.latest(256)) {
+            torn      += isConsistent(timing) ? 0 : 1;
+            unordered += timing.presentedNs > last ? 0 : 1;
+            last       = timing.presentedNs;
+        }
+        ++reads;
+    } while (!done);
+
+    producer->wait();
+    delete producer;
+    QVERIFY(reads > 0);
+    QCOMPARE(torn, 0);
+    QCOMPARE(unordered, 0);
+    QCOMPARE(ring.latest(1).first().presentedNs, qint64(200000));
+}
+
+QTEST_MAIN(TestFrameTimingRing)
+#include "test_frametimingring.moc"
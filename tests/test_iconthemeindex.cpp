@@ -0,0 +1,122 @@
+#include <QTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QDir>
+#include "../shell/src/iconthemeindex.h"
+
+class TestIconThemeIndex : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void initTestCase();
+    void testThemeChain();
+    void testThemeOrderBeatsSize();
+    void testSizeSelection();
+    void testExtensionPreference();
+    void testPixmapsFallback();
+    void testRefreshPicksUpNewIcons();
+
+  private:
+    void          touch(const QString &relativePath, const QByteArray &contents = QByteArray());
+    QString       path(const QString &relativePath) const {
+        return m_dir.filePath(relativePath);
+    }
+
+    QTemporaryDir m_dir;
+};
+
+void TestIconThemeIndex::touch(const QString &relativePath, const QByteArray &contents) {
+    QVERIFY(QDir().mkpath(QFileInfo(path(relativePath)).absolutePath()));
+    QFile file(path(relativePath));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(contents);
+}
+
+void TestIconThemeIndex::initTestCase() {
+    QVERIFY(m_dir.isValid());
+
+    touch("icons/Child/index.theme", "[Icon Theme]\n"
+                                     "Name=Child\n"
+                                     "Inherits=Parent\n"
+                                     "Directories=48x48/apps,scalable/apps\n\n"
+                                     "[48x48/apps]\nSize=48\nType=Fixed\n\n"
+                                     "[scalable/apps]\nSize=48\nMinSize=16\nMaxSize=256\n"
+                                     "Type=Scalable\n");
+    touch("icons/Child/48x48/apps/childicon.png");
+    touch("icons/Child/48x48/apps/both.svg");
+    touch("icons/Child/48x48/apps/both.png");
+    touch("icons/Child/scalable/apps/vector.svg");
+
+    touch("icons/Parent/index.theme", "[Icon Theme]\nName=Parent\nDirectories=32x32/apps\n\n"
+                                      "[32x32/apps]\nSize=32\n");
+    touch("icons/Parent/32x32/apps/parenticon.png");
+
+    // No index.theme: the layout on disk is used as is
+    touch("icons/hicolor/48x48/apps/parenticon.png");
+    touch("icons/hicolor/64x64/apps/sized.png");
+    touch("icons/hicolor/256x256/apps/sized.png");
+    touch("icons/hicolor/scalable/apps/sized.svg");
+
+    touch("pixmaps/legacy.xpm");
+    touch("pixmaps/childicon.png");
+}
+
+void TestIconThemeIndex::testThemeChain() {
+    IconThemeIndex index("Child");
+    index.setDataDirectories({m_dir.path()});
+    index.refresh();
+    QCOMPARE(index.themeChain(), QStringList({"Child", "Parent", "hicolor"}));
+
+    index.setTheme("Missing");
+    index.refresh();
+    QCOMPARE(index.themeChain(), QStringList({"hicolor"}));
+}
+
+void TestIconThemeIndex::testThemeOrderBeatsSize() {
+    IconThemeIndex index("Child");
+    index.setDataDirectories({m_dir.path()});
+
+    QCOMPARE(index.lookup("childicon", 48), path("icons/Child/48x48/apps/childicon.png"));
+    // Parent only has 32px, hicolor has 48px, but the parent theme comes first
+    QCOMPARE(index.lookup("parenticon", 48), path("icons/Parent/32x32/apps/parenticon.png"));
+    QCOMPARE(index.lookup("vector", 128), path("icons/Child/scalable/apps/vector.svg"));
+    QVERIFY(index.lookup("nonexistent", 48).isEmpty());
+}
+
+void TestIconThemeIndex::testSizeSelection() {
+    IconThemeIndex index;
+    index.setDataDirectories({m_dir.path()});
+
+    QCOMPARE(index.lookup("sized", 64), path("icons/hicolor/64x64/apps/sized.png"));
+    QCOMPARE(index.lookup("sized", 256), path("icons/hicolor/256x256/apps/sized.png"));
+    QCOMPARE(index.lookup("sized", 128), path("icons/hicolor/scalable/apps/sized.svg"));
+}
+
+void TestIconThemeIndex::testExtensionPreference() {
+    IconThemeIndex index("Child");
+    index.setDataDirectories({m_dir.path()});
+    QCOMPARE(index.lookup("both", 48), path("icons/Child/48x48/apps/both.png"));
+}
+
+void TestIconThemeIndex::testPixmapsFallback() {
+    IconThemeIndex index;
+    index.setDataDirectories({m_dir.path()});
+    QCOMPARE(index.lookup("legacy", 48), path("pixmaps/legacy.xpm"));
+    // Themed icons win over pixmaps
+    QCOMPARE(index.lookup("parenticon", 48), path("icons/hicolor/48x48/apps/parenticon.png"));
+}
+
+void TestIconThemeIndex::testRefreshPicksUpNewIcons() {
+    IconThemeIndex index("Child");
+    index.setDataDirectories({m_dir.path()});
+    QVERIFY(index.lookup("installed", 48).isEmpty());
+
+    touch("icons/Child/48x48/apps/installed.png");
+    QVERIFY(index.lookup("installed", 48).isEmpty());
+
+    index.refresh();
+    QCOMPARE(index.lookup("installed", 48), path("icons/Child/48x48/apps/installed.png"));
+}
+
+QTEST_MAIN(TestIconThemeIndex)
+#include "test_iconthemeindex.moc"
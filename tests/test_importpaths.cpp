@@ -0,0 +1,96 @@
+#include <QTest>
+#include <QTemporaryDir>
+#include <QDir>
+#include <QQmlEngine>
+#include "../shell/src/marathonimportpaths.h"
+
+class TestImportPaths : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void initTestCase();
+    void testSharedPathsAddedOnce();
+    void testRepeatedLaunchesKeepListFlat();
+    void testIdlePathsEvictedLeastRecentFirst();
+    void testPathInUseIsNeverEvicted();
+
+  private:
+    QString       appPath(int i) const {
+        return m_dir.filePath(QString("app%1").arg(i));
+    }
+    // The engine may store a canonical form of the directory
+    bool          onEngine(const QQmlEngine &engine, const QString &path) const {
+        const QStringList list = engine.importPathList();
+        return list.contains(path) || list.contains(QDir(path).canonicalPath());
+    }
+
+    QTemporaryDir m_dir;
+};
+
+void TestImportPaths::initTestCase() {
+    QVERIFY(m_dir.isValid());
+    for (int i = 0; i < MarathonImportPaths::kMaxIdleAppPaths + 4; ++i)
+        QVERIFY(QDir().mkpath(appPath(i)));
+}
+
+void TestImportPaths::testSharedPathsAddedOnce() {
+    QQmlEngine          engine;
+    MarathonImportPaths paths(&engine);
+
+    paths.addSharedPaths();
+    const QStringList shared = engine.importPathList();
+    paths.addSharedPaths();
+    QCOMPARE(engine.importPathList(), shared);
+}
+
+void TestImportPaths::testRepeatedLaunchesKeepListFlat() {
+    QQmlEngine          engine;
+    MarathonImportPaths paths(&engine);
+    paths.addSharedPaths();
+
+    paths.acquireAppPath(appPath(0));
+    const qsizetype size = engine.importPathList().size();
+    for (int i = 0; i < 1000; ++i) {
+        paths.releaseAppPath(appPath(0));
+        paths.acquireAppPath(appPath(0));
+    }
+    QCOMPARE(engine.importPathList().size(), size);
+    QVERIFY(onEngine(engine, appPath(0)));
+}
+
+void TestImportPaths::testIdlePathsEvictedLeastRecentFirst() {
+    QQmlEngine          engine;
+    MarathonImportPaths paths(&engine);
+
+    const int apps = MarathonImportPaths::kMaxIdleAppPaths + 2;
+    for (int i = 0; i < apps; ++i) {
+        paths.acquireAppPath(appPath(i));
+        paths.releaseAppPath(appPath(i));
+    }
+
+    QCOMPARE(paths.appPaths().size(), qsizetype(MarathonImportPaths::kMaxIdleAppPaths));
+    QVERIFY(!onEngine(engine, appPath(0)));
+    QVERIFY(!onEngine(engine, appPath(1)));
+    for (int i = 2; i < apps; ++i)
+        QVERIFY(onEngine(engine, appPath(i)));
+}
+
+void TestImportPaths::testPathInUseIsNeverEvicted() {
+    QQmlEngine          engine;
+    MarathonImportPaths paths(&engine);
+
+    // Held twice (e.g. loader and compiler), released once
+    paths.acquireAppPath(appPath(0));
+    paths.acquireAppPath(appPath(0));
+    paths.releaseAppPath(appPath(0));
+
+    for (int i = 1; i < MarathonImportPaths::kMaxIdleAppPaths + 4; ++i) {
+        paths.acquireAppPath(appPath(i));
+        paths.releaseAppPath(appPath(i));
+    }
+    QVERIFY(onEngine(engine, appPath(0)));
+    QCOMPARE(paths.appPaths().size(), qsizetype(MarathonImportPaths::kMaxIdleAppPaths + 1));
+}
+
+QTEST_MAIN(TestImportPaths)
+#include "test_importpaths.moc"
@@ -0,0 +1,94 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include "../shell/src/launchhistory.h"
+
+class TestLaunchHistory : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void init();
+    void testRankedByCount();
+    void testOldLaunchesDecay();
+    void testTimeOfDay();
+    void testPersistence();
+
+  private:
+    QString                       historyPath() const {
+        return m_dir->filePath("launch-history.json");
+    }
+
+    QScopedPointer<QTemporaryDir> m_dir;
+    QDateTime                     m_morning;
+};
+
+void TestLaunchHistory::init() {
+    m_dir.reset(new QTemporaryDir);
+    QVERIFY(m_dir->isValid());
+    m_morning = QDateTime(QDate::currentDate(), QTime(9, 0));
+}
+
+void TestLaunchHistory::testRankedByCount() {
+    LaunchHistory history(historyPath());
+    QSignalSpy    recorded(&history, &LaunchHistory::launchRecorded);
+
+    for (int i = 0; i < 3; ++i)
+        history.recordLaunch("browser", m_morning);
+    history.recordLaunch("clock", m_morning);
+    history.recordLaunch("notes", m_morning);
+    history.recordLaunch("notes", m_morning);
+
+    QCOMPARE(recorded.count(), 6);
+    QCOMPARE(history.count(), 3);
+    QCOMPARE(history.topApps(0, m_morning), QStringList({"browser", "notes", "clock"}));
+    QCOMPARE(history.topApps(2, m_morning), QStringList({"browser", "notes"}));
+    QCOMPARE(history.score("unknown", m_morning), 0.0);
+}
+
+void TestLaunchHistory::testOldLaunchesDecay() {
+    LaunchHistory history(historyPath());
+
+    // Heavy use two months ago loses to a single launch yesterday
+    for (int i = 0; i < 5; ++i)
+        history.recordLaunch("old", m_morning.addDays(-60));
+    history.recordLaunch("recent", m_morning.addDays(-1));
+
+    QCOMPARE(history.topApps(1, m_morning), QStringList({"recent"}));
+    QVERIFY(history.score("old", m_morning) < 0.1);
+}
+
+void TestLaunchHistory::testTimeOfDay() {
+    LaunchHistory   history(historyPath());
+    const QDateTime evening = m_morning.addSecs(11 * 60 * 60);
+
+    for (int day = 3; day > 0; --day) {
+        history.recordLaunch("news", m_morning.addDays(-day));
+        history.recordLaunch("music", evening.addDays(-day));
+    }
+
+    QCOMPARE(history.topApps(1, m_morning), QStringList({"news"}));
+    QCOMPARE(history.topApps(1, evening), QStringList({"music"}));
+}
+
+void TestLaunchHistory::testPersistence() {
+    const QDateTime now = QDateTime::currentDateTime();
+    {
+        LaunchHistory history(historyPath());
+        history.recordLaunch("browser", now);
+        history.recordLaunch("browser", now);
+        history.recordLaunch("clock", now);
+        history.recordLaunch("notes", now);
+        history.forget("notes");
+    }
+
+    LaunchHistory reloaded(historyPath());
+    QCOMPARE(reloaded.count(), 2);
+    QCOMPARE(reloaded.topApps(0, now), QStringList({"browser", "clock"}));
+
+    reloaded.clear();
+    reloaded.save();
+    QCOMPARE(LaunchHistory(historyPath()).count(), 0);
+}
+
+QTEST_MAIN(TestLaunchHistory)
+#include "test_launchhistory.moc"
@@ -0,0 +1,159 @@
+#include <QTest>
+#include <QBuffer>
+#include <QDateTime>
+#include <QDir>
+#include <QTemporaryDir>
+#include "../marathon-keyboard/src/marathonlexicon.h"
+
+class TestLexicon : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void testCompleteRanksByFrequency();
+    void testCaseIsRestored();
+    void testDuplicatesKeepBestFrequency();
+    void testLoadFromFile();
+    void testReadWordList();
+    void testRejectsCorruptImage();
+    void testLocateCompilesInstalledWordList();
+};
+
+static QList<MarathonLexicon::Entry> sampleWords() {
+    return {{"the", 1000}, {"they", 300}, {"then", 400}, {"there", 500},
+            {"this", 600}, {"I", 900},    {"NASA", 5},   {"Thursday", 350}};
+}
+
+void TestLexicon::testCompleteRanksByFrequency() {
+    MarathonLexicon lexicon;
+    QVERIFY(lexicon.loadData(MarathonLexicon::build(sampleWords())));
+
+    QCOMPARE(lexicon.wordCount(), 8);
+    QCOMPARE(lexicon.complete("th", 4), QStringList({"the", "this", "there", "then"}));
+    QCOMPARE(lexicon.complete("the", 10), QStringList({"the", "there", "then", "they"}));
+    QVERIFY(lexicon.complete("x", 3).isEmpty());
+    QVERIFY(lexicon.complete("th", 0).isEmpty());
+}
+
+void TestLexicon::testCaseIsRestored() {
+    MarathonLexicon lexicon;
+    QVERIFY(lexicon.loadData(MarathonLexicon::build(sampleWords())));
+
+    QCOMPARE(lexicon.complete("i", 3), QStringList({"I"}));
+    QCOMPARE(lexicon.complete("Nas", 3), QStringList({"NASA"}));
+    QCOMPARE(lexicon.complete("thu", 3), QStringList({"Thursday"}));
+    QCOMPARE(lexicon.complete("Th", 2), QStringList({"The", "This"}));
+    QCOMPARE(lexicon.frequency("THE"), 1000u);
+    QVERIFY(lexicon.contains("Then"));
+    QVERIFY(!lexicon.contains("th"));
+}
+
+void TestLexicon::testDuplicatesKeepBestFrequency() {
+    MarathonLexicon lexicon;
+    QVERIFY(lexicon.loadData(MarathonLexicon::build({{"us", 40}, {"US", 90}, {"use", 0}})));
+
+    QCOMPARE(lexicon.wordCount(), 2);
+    QCOMPARE(lexicon.frequency("us"), 90u);
+    QCOMPARE(lexicon.frequency("use"), 1u);
+    QCOMPARE(lexicon.complete("u", 3), QStringList({"US", "use"}));
+}
+
+void TestLexicon::testLoadFromFile() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    QFile file(dir.filePath("en_US.lex"));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(MarathonLexicon::build(sampleWords()));
+    file.close();
+
+    MarathonLexicon lexicon;
+    QVERIFY(lexicon.load(file.fileName()));
+    QCOMPARE(lexicon.complete("th", 1), QStringList({"the"}));
+
+    QVERIFY(!lexicon.load(dir.filePath("missing.lex")));
+    QVERIFY(!lexicon.isValid());
+}
+
+void TestLexicon::testReadWordList() {
+    QByteArray text = "# comment\n"
+                      "3\n"
+                      "hello 40\n"
+                      "world/MS\n"
+                      "  café\t7  # trailing\n"
+                      "\n";
+    QBuffer    buffer(&text);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+    const QList<MarathonLexicon::Entry> entries = MarathonLexicon::readWordList(&buffer);
+    QCOMPARE(entries.size(), 3);
+    QCOMPARE(entries.at(0).word, QString("hello"));
+    QCOMPARE(entries.at(0).frequency, 40u);
+    QCOMPARE(entries.at(1).word, QString("world"));
+    QCOMPARE(entries.at(1).frequency, 1u);
+    QCOMPARE(entries.at(2).word, QString("café"));
+    QCOMPARE(entries.at(2).frequency, 7u);
+}
+
+void TestLexicon::testRejectsCorruptImage() {
+    MarathonLexicon  lexicon;
+    const QByteArray image = MarathonLexicon::build(sampleWords());
+
+    QVERIFY(!lexicon.loadData(image.left(image.size() - 1)));
+    QVERIFY(!lexicon.loadData("MLEX"));
+
+    // Point the last edge past the end of the node table
+    QByteArray broken = image;
+    broken[broken.size() - 8] = char(0xFF);
+    broken[broken.size() - 7] = char(0xFF);
+    QVERIFY(!lexicon.loadData(broken));
+    QVERIFY(!lexicon.isValid());
+}
+
+void TestLexicon::testLocateCompilesInstalledWordList() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    qputenv("XDG_DATA_HOME", dir.path().toUtf8());
+    qputenv("XDG_DATA_DIRS", dir.filePath("none").toUtf8());
+    qputenv("XDG_CACHE_HOME", dir.filePath("cache").toUtf8());
+
+    // What a cross build without a host lexicon compiler installs
+    QVERIFY(QDir().mkpath(dir.filePath("marathon-keyboard/dictionaries")));
+    QFile wordList(dir.filePath("marathon-keyboard/dictionaries/xx.txt"));
+    QVERIFY(wordList.open(QIODevice::WriteOnly));
+    wordList.write("hello 50\nhelp 80\n");
+    wordList.close();
+
+    const QString path = MarathonLexicon::locate("xx_YY");
+    QCOMPARE(path, dir.filePath("cache/marathon-keyboard/dictionaries/xx.lex"));
+
+    MarathonLexicon lexicon;
+    QVERIFY(lexicon.load(path));
+    QCOMPARE(lexicon.complete("hel", 2), QStringList({"help", "hello"}));
+    QCOMPARE(MarathonLexicon::locate("xx"), path);
+    QVERIFY(MarathonLexicon::locate("zz").isEmpty());
+
+    // An upgrade ships a changed list, compiled again on the next lookup
+    QVERIFY(wordList.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    wordList.write("hello 90\nhelp 80\nhelmet 10\n");
+    QVERIFY(wordList.flush());
+    QVERIFY(wordList.setFileTime(QDateTime::currentDateTime().addSecs(60),
+                                 QFileDevice::FileModificationTime));
+    wordList.close();
+
+    MarathonLexicon upgraded;
+    QVERIFY(upgraded.load(MarathonLexicon::locate("xx")));
+    QCOMPARE(upgraded.complete("hel", 3), QStringList({"hello", "help", "helmet"}));
+
+    // A prebuilt lexicon newer than the list wins over the compiled one
+    QFile prebuilt(dir.filePath("marathon-keyboard/dictionaries/xx.lex"));
+    QVERIFY(prebuilt.open(QIODevice::WriteOnly));
+    prebuilt.write(MarathonLexicon::build({{"hero", 5}}));
+    QVERIFY(prebuilt.flush());
+    QVERIFY(prebuilt.setFileTime(QDateTime::currentDateTime().addSecs(120),
+                                 QFileDevice::FileModificationTime));
+    prebuilt.close();
+    QCOMPARE(MarathonLexicon::locate("xx"), prebuilt.fileName());
+}
+
+QTEST_MAIN(TestLexicon)
+#include "test_lexicon.moc"
@@ -0,0 +1,94 @@
+#include <QTest>
+#include <QTemporaryDir>
+#include <QCoreApplication>
+#include <QFile>
+#include "../shell/src/nativeapplauncher.h"
+
+class TestNativeAppLauncher : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void initTestCase();
+    void testEnvironmentTemplate();
+    void testNeedsShell();
+    void testDesktopFileRemovedWithProcess();
+    void testStaleDesktopFilesRemoved();
+    void testStartWithAndWithoutShell();
+
+  private:
+    QString       run(NativeAppLauncher &launcher, const QString &command);
+
+    QTemporaryDir m_dir;
+};
+
+void TestNativeAppLauncher::initTestCase() {
+    QVERIFY(m_dir.isValid());
+    qputenv("DISPLAY", ":0");
+}
+
+QString TestNativeAppLauncher::run(NativeAppLauncher &launcher, const QString &command) {
+    QProcess *process = launcher.createProcess(command, this);
+    NativeAppLauncher::start(process, command);
+    process->waitForFinished(5000);
+    const QString output = QString::fromLocal8Bit(process->readAllStandardOutput());
+    delete process;
+    return output;
+}
+
+void TestNativeAppLauncher::testEnvironmentTemplate() {
+    NativeAppLauncher         launcher("marathon-test-0", m_dir.path());
+    const QProcessEnvironment env = launcher.environment();
+    QCOMPARE(env.value("WAYLAND_DISPLAY"), QString("marathon-test-0"));
+    QVERIFY(!env.contains("DISPLAY"));
+    QVERIFY(!env.value("XDG_RUNTIME_DIR").isEmpty());
+    QCOMPARE(env.value("QT_QPA_PLATFORM"), QString("wayland"));
+}
+
+void TestNativeAppLauncher::testNeedsShell() {
+    QVERIFY(!NativeAppLauncher::needsShell("gnome-clocks"));
+    QVERIFY(!NativeAppLauncher::needsShell("flatpak run org.gnome.Maps --socket=wayland"));
+    QVERIFY(NativeAppLauncher::needsShell("foo && bar"));
+    QVERIFY(NativeAppLauncher::needsShell("echo $HOME"));
+    QVERIFY(NativeAppLauncher::needsShell("app '--name=a b'"));
+    QVERIFY(NativeAppLauncher::needsShell("GDK_SCALE=2 app"));
+}
+
+void TestNativeAppLauncher::testDesktopFileRemovedWithProcess() {
+    NativeAppLauncher launcher("marathon-test-0", m_dir.path());
+    QProcess         *process = launcher.createProcess("gnome-clocks", nullptr);
+    const QString     path    = process->processEnvironment().value("GIO_LAUNCHED_DESKTOP_FILE");
+    QVERIFY(path.startsWith(m_dir.path()));
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QVERIFY(file.readAll().contains("\nExec=gnome-clocks\n"));
+    file.close();
+
+    delete process;
+    QVERIFY(!QFile::exists(path));
+}
+
+void TestNativeAppLauncher::testStaleDesktopFilesRemoved() {
+    // Old timestamp naming, and a file of this (running) process
+    const QString stale = m_dir.filePath("marathon-1700000000000-42.desktop");
+    const QString live  = m_dir.filePath(
+        QString("marathon-%1-1-42.desktop").arg(QCoreApplication::applicationPid()));
+    for (const QString &path : {stale, live}) {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+    }
+
+    NativeAppLauncher launcher("marathon-test-0", m_dir.path());
+    QVERIFY(!QFile::exists(stale));
+    QVERIFY(QFile::exists(live));
+    QFile::remove(live);
+}
+
+void TestNativeAppLauncher::testStartWithAndWithoutShell() {
+    NativeAppLauncher launcher("marathon-test-0", m_dir.path());
+    QCOMPARE(run(launcher, "echo hello"), QString("hello\n"));
+    QCOMPARE(run(launcher, "echo $WAYLAND_DISPLAY | tr - _"), QString("marathon_test_0\n"));
+}
+
+QTEST_MAIN(TestNativeAppLauncher)
+#include "test_nativeapplauncher.moc"
@@ -0,0 +1,87 @@
+#include <QTest>
+#include <QImage>
+#include "../shell/src/taskmodel.h"
+#include "../shell/src/tasksnapshotprovider.h"
+
+class TestTaskSnapshotProvider : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void testSnapshotsAreDownscaled();
+    void testNewSnapshotReplacesKey();
+    void testProviderHonoursRequestedSize();
+    void testTaskModelServesUrls();
+};
+
+void TestTaskSnapshotProvider::testSnapshotsAreDownscaled() {
+    TaskSnapshotCache cache;
+    QImage            frame(1080, 2340, QImage::Format_ARGB32_Premultiplied);
+    frame.fill(Qt::red);
+
+    QString key = cache.insert("clock", frame);
+    QVERIFY(!key.isEmpty());
+    QImage stored = cache.image(key);
+    QVERIFY(stored.width() <= TaskSnapshotCache::kMaxWidth);
+    QVERIFY(stored.height() <= TaskSnapshotCache::kMaxHeight);
+    QCOMPARE(stored.width() * 2340 / 1080, stored.height());
+
+    // Already small enough: kept as is
+    QImage card(200, 400, QImage::Format_ARGB32_Premultiplied);
+    card.fill(Qt::blue);
+    QCOMPARE(cache.image(cache.insert("notes", card)).size(), QSize(200, 400));
+    QCOMPARE(cache.count(), 2);
+}
+
+void TestTaskSnapshotProvider::testNewSnapshotReplacesKey() {
+    TaskSnapshotCache cache;
+    QImage            frame(100, 200, QImage::Format_RGB32);
+    frame.fill(Qt::white);
+
+    QString first  = cache.insert("clock", frame);
+    QString second = cache.insert("clock", frame);
+    QVERIFY(first != second);
+    QVERIFY(cache.image(first).isNull());
+    QVERIFY(!cache.image(second).isNull());
+    QCOMPARE(cache.count(), 1);
+
+    QVERIFY(cache.insert("clock", QImage()).isEmpty());
+    QVERIFY(cache.image(second).isNull());
+    QVERIFY(cache.image("nonsense").isNull());
+}
+
+void TestTaskSnapshotProvider::testProviderHonoursRequestedSize() {
+    auto   cache = QSharedPointer<TaskSnapshotCache>::create();
+    QImage frame(200, 400, QImage::Format_RGB32);
+    frame.fill(Qt::green);
+    QString key = cache->insert("clock", frame);
+
+    TaskSnapshotProvider provider(cache);
+    QSize                size;
+    QCOMPARE(provider.requestImage(key, &size, QSize()).size(), QSize(200, 400));
+    QCOMPARE(size, QSize(200, 400));
+    QCOMPARE(provider.requestImage(key, &size, QSize(100, -1)).size(), QSize(100, 200));
+    QVERIFY(provider.requestImage("clock/0", &size, QSize()).isNull());
+
+    QCOMPARE(TaskSnapshotProvider::url(key), "image://tasksnapshot/" + key);
+}
+
+void TestTaskSnapshotProvider::testTaskModelServesUrls() {
+    TaskModel model;
+    model.launchTask("clock", "Clock", "", "marathon");
+    QModelIndex index = model.index(0);
+    QVERIFY(model.data(index, TaskModel::SnapshotRole).toString().isEmpty());
+
+    QImage frame(200, 400, QImage::Format_RGB32);
+    frame.fill(Qt::black);
+    model.updateTaskSnapshot("clock", frame);
+
+    QString url = model.data(index, TaskModel::SnapshotRole).toString();
+    QVERIFY(url.startsWith("image://tasksnapshot/clock/"));
+    QCOMPARE(model.snapshotCache()->count(), 1);
+
+    model.closeTask(model.getTaskByAppId("clock")->id());
+    QCOMPARE(model.snapshotCache()->count(), 0);
+}
+
+QTEST_MAIN(TestTaskSnapshotProvider)
+#include "test_tasksnapshotprovider.moc"
@@ -0,0 +1,263 @@
+#include <QTest>
+#include "../apps/terminal/src/TerminalScreen.h"
+
+class TestTerminalScreen : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void testCellIsPacked();
+    void testSoftWrapIntoHistory();
+    void testReflowNarrowAndWiden();
+    void testReflowKeepsCursorOnLine();
+    void testWideCharacters();
+    void testScrollbackLimit();
+    void testTrueColor();
+    void testTrueColorTableIsReclaimed();
+    void testDamageTracking();
+    void testScrollRegion();
+    void testInsertDeleteLines();
+    void testAlternateScreen();
+
+  private:
+    static void    write(TerminalScreen &screen, const QString &text);
+    static QString rowText(const TerminalScreen &screen, int y);
+};
+
+void TestTerminalScreen::write(TerminalScreen &screen, const QString &text) {
+    for (uint cp : text.toUcs4()) {
+        if (cp == '\n') {
+            screen.setCursorX(0);
+            screen.newLine();
+        } else {
+            screen.putChar(cp);
+        }
+    }
+}
+
+QString TestTerminalScreen::rowText(const TerminalScreen &screen, int y) {
+    QString text;
+    for (int x = 0; x < screen.cols(); ++x) {
+        const TerminalCell &c = screen.cell(x, y);
+        if (!c.isWideContinuation())
+            appendCodePoint(text, c.codePoint);
+    }
+    while (text.endsWith(' '))
+        text.chop(1);
+    return text;
+}
+
+void TestTerminalScreen::testCellIsPacked() {
+    QCOMPARE(sizeof(TerminalCell), size_t(8));
+}
+
+void TestTerminalScreen::testSoftWrapIntoHistory() {
+    TerminalScreen screen;
+    screen.resize(10, 3);
+    write(screen, "hello world this wraps\nnext");
+
+    QCOMPARE(screen.historyLines(), 1);
+    QCOMPARE(rowText(screen, -1), QString("hello worl"));
+    QCOMPARE(rowText(screen, 0), QString("d this wra"));
+    QCOMPARE(rowText(screen, 1), QString("ps"));
+    QCOMPARE(rowText(screen, 2), QString("next"));
+}
+
+void TestTerminalScreen::testReflowNarrowAndWiden() {
+    TerminalScreen screen;
+    screen.resize(10, 4);
+    write(screen, "hello world this wraps\nline2");
+
+    // Narrowing pushes the re-wrapped rows into the scrollback instead of truncating
+    screen.resize(5, 4);
+    QCOMPARE(rowText(screen, -screen.historyLines()), QString("hello"));
+    QCOMPARE(rowText(screen, 3), QString("line2"));
+
+    // Widening joins the soft-wrapped rows back together
+    screen.resize(30, 4);
+    QCOMPARE(screen.historyLines(), 0);
+    QCOMPARE(rowText(screen, 0), QString("hello world this wraps"));
+    QCOMPARE(rowText(screen, 1), QString("line2"));
+    QCOMPARE(screen.cursorY(), 1);
+    QCOMPARE(screen.cursorX(), 5);
+}
+
+void TestTerminalScreen::testReflowKeepsCursorOnLine() {
+    TerminalScreen screen;
+    screen.resize(8, 4);
+    write(screen, "$ abcdefghij");
+    QCOMPARE(screen.cursorY(), 1);
+    QCOMPARE(screen.cursorX(), 4);
+
+    screen.resize(20, 4);
+    QCOMPARE(screen.cursorY(), 0);
+    QCOMPARE(screen.cursorX(), 12);
+}
+
+void TestTerminalScreen::testWideCharacters() {
+    TerminalScreen screen;
+    screen.resize(4, 2);
+    write(screen, QString::fromUtf8("a中文"));
+
+    // "a" + two double-width characters: the second one doesn't fit and wraps whole
+    QVERIFY(screen.cell(1, 0).has(TerminalCell::Wide));
+    QVERIFY(screen.cell(2, 0).isWideContinuation());
+    QCOMPARE(screen.cell(3, 0).codePoint, uint32_t(' '));
+    QCOMPARE(screen.cell(0, 1).codePoint, uint32_t(0x6587));
+    QCOMPARE(screen.cursorX(), 2);
+
+    // Overwriting the right half of a wide character blanks its left half
+    screen.moveCursor(2, 0);
+    screen.putChar('x');
+    QCOMPARE(screen.cell(1, 0).codePoint, uint32_t(' '));
+    QVERIFY(!screen.cell(1, 0).has(TerminalCell::Wide));
+}
+
+void TestTerminalScreen::testScrollbackLimit() {
+    TerminalScreen screen;
+    screen.resize(10, 3);
+    screen.setScrollbackLines(50);
+    for (int i = 0; i < 500; ++i) {
+        write(screen, QString("line %1\n").arg(i));
+    }
+
+    QCOMPARE(screen.historyLines(), 50);
+    QCOMPARE(rowText(screen, 1), QString("line 499"));
+    QCOMPARE(rowText(screen, -50), QString("line 448"));
+
+    screen.setScrollbackLines(10);
+    QCOMPARE(screen.historyLines(), 10);
+    QCOMPARE(rowText(screen, 1), QString("line 499"));
+}
+
+void TestTerminalScreen::testTrueColor() {
+    TerminalScreen screen;
+    screen.setFgRgb(0x123456);
+    screen.putChar('x');
+    screen.setFgColor(196);
+    screen.putChar('y');
+
+    const TerminalCell &trueColor = screen.cell(0, 0);
+    QVERIFY(trueColor.fg >= TerminalCell::FirstTrueColor);
+    QCOMPARE(screen.colorValue(trueColor.fg), uint32_t(0xFF123456));
+    QCOMPARE(screen.colorValue(screen.cell(1, 0).fg), uint32_t(0xFFFF0000));
+    QCOMPARE(screen.cell(2, 0).fg, TerminalCell::DefaultFg);
+}
+
+void TestTerminalScreen::testTrueColorTableIsReclaimed() {
+    TerminalScreen screen;
+    screen.setFgRgb(0x123456);
+    screen.putChar('x');
+
+    // More distinct colors than the table holds; only the first one stays on screen
+    for (uint32_t rgb = 0x200000; rgb < 0x200000 + 70000; ++rgb)
+        screen.setFgRgb(rgb);
+    screen.setFgRgb(0xABCDEF);
+    screen.putChar('y');
+
+    QCOMPARE(screen.colorValue(screen.cell(0, 0).fg), uint32_t(0xFF123456));
+    QVERIFY(screen.cell(1, 0).fg >= TerminalCell::FirstTrueColor);
+    QCOMPARE(screen.colorValue(screen.cell(1, 0).fg), uint32_t(0xFFABCDEF));
+
+    // Once the screen is cleared by a reset its colors are released
+    screen.reset();
+    screen.setFgRgb(0x654321);
+    screen.putChar('z');
+    QCOMPARE(screen.cell(0, 0).fg, TerminalCell::FirstTrueColor);
+    QCOMPARE(screen.colorValue(screen.cell(0, 0).fg), uint32_t(0xFF654321));
+}
+
+void TestTerminalScreen::testDamageTracking() {
+    TerminalScreen   screen;
+    TerminalSnapshot snapshot;
+    screen.resize(10, 4);
+
+    // First snapshot after a resize carries every row
+    screen.takeSnapshot(snapshot);
+    QVERIFY(snapshot.full);
+    QCOMPARE(snapshot.rowIndices.size(), 4);
+
+    screen.moveCursor(0, 2);
+    write(screen, "ab");
+    screen.takeSnapshot(snapshot);
+    QVERIFY(!snapshot.full);
+    QCOMPARE(snapshot.rowIndices, QVector<int>({2}));
+    QCOMPARE(snapshot.cells.size(), 10);
+    QCOMPARE(snapshot.cells[1].codePoint, uint32_t('b'));
+
+    // Nothing changed since
+    screen.takeSnapshot(snapshot);
+    QVERIFY(snapshot.rowIndices.isEmpty());
+
+    // A scroll is reported as a shift plus the newly exposed bottom row
+    screen.moveCursor(0, 3);
+    screen.newLine();
+    screen.takeSnapshot(snapshot);
+    QCOMPARE(snapshot.scrolled, 1);
+    QCOMPARE(snapshot.rowIndices, QVector<int>({3}));
+}
+
+void TestTerminalScreen::testScrollRegion() {
+    TerminalScreen screen;
+    screen.resize(10, 5);
+    write(screen, "top");
+    screen.moveCursor(0, 4);
+    write(screen, "bottom");
+
+    // Lines fed at the bottom of the region scroll only the region, never into history
+    screen.setScrollRegion(1, 3);
+    screen.moveCursor(0, 1);
+    write(screen, "a\nb\nc\nd\ne");
+    QCOMPARE(rowText(screen, 0), QString("top"));
+    QCOMPARE(rowText(screen, 1), QString("c"));
+    QCOMPARE(rowText(screen, 3), QString("e"));
+    QCOMPARE(rowText(screen, 4), QString("bottom"));
+    QCOMPARE(screen.historyLines(), 0);
+
+    // Reverse index at the top margin scrolls the region down
+    screen.moveCursor(0, 1);
+    screen.reverseIndex();
+    QCOMPARE(rowText(screen, 1), QString());
+    QCOMPARE(rowText(screen, 2), QString("c"));
+    QCOMPARE(rowText(screen, 3), QString("d"));
+}
+
+void TestTerminalScreen::testInsertDeleteLines() {
+    TerminalScreen screen;
+    screen.resize(10, 4);
+    write(screen, "1\n2\n3\n4");
+
+    screen.moveCursor(3, 1);
+    screen.insertLines(1);
+    QCOMPARE(screen.cursorX(), 0);
+    QCOMPARE(rowText(screen, 1), QString());
+    QCOMPARE(rowText(screen, 2), QString("2"));
+    QCOMPARE(rowText(screen, 3), QString("3"));
+
+    screen.deleteLines(2);
+    QCOMPARE(rowText(screen, 1), QString("3"));
+    QCOMPARE(rowText(screen, 2), QString());
+    QCOMPARE(rowText(screen, 3), QString());
+}
+
+void TestTerminalScreen::testAlternateScreen() {
+    TerminalScreen screen;
+    screen.resize(10, 3);
+    write(screen, "1\n2\n3\nprompt");
+    QCOMPARE(screen.historyLines(), 1);
+
+    screen.setAlternateScreen(true);
+    QCOMPARE(screen.historyLines(), 0);
+    QCOMPARE(rowText(screen, 2), QString());
+    write(screen, "a\nb\nc\nd\ne");
+    QCOMPARE(screen.historyLines(), 0);
+
+    // Resizing underneath the alternate screen still reflows the primary one
+    screen.resize(8, 4);
+    screen.setAlternateScreen(false);
+    QCOMPARE(rowText(screen, 0), QString("1"));
+    QCOMPARE(rowText(screen, 3), QString("prompt"));
+    QCOMPARE(screen.historyLines(), 0);
+}
+
+QTEST_MAIN(TestTerminalScreen)
+#include "test_terminalscreen.moc"
@@ -0,0 +1,169 @@
+#include <QTest>
+#include <QDateTime>
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include "../marathon-keyboard/src/marathonlexicon.h"
+#include "../marathon-keyboard/src/marathonuserdictionary.h"
+
+class TestUserDictionary : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void init();
+    void testLearnedWordsOutrankLexicon();
+    void testFlushAndReload();
+    void testJournalIsCompacted();
+    void testLegacyWordList();
+    void testOldWordsFade();
+    void testLowerCaseSpellingWins();
+    void testInstancesShareTheFile();
+
+  private:
+    QString         path() const {
+        return m_dir->filePath("user_dictionary.txt");
+    }
+
+    QScopedPointer<QTemporaryDir> m_dir;
+    MarathonLexicon               m_lexicon;
+};
+
+void TestUserDictionary::init() {
+    m_dir.reset(new QTemporaryDir);
+    QVERIFY(m_dir->isValid());
+    QVERIFY(m_lexicon.loadData(
+        MarathonLexicon::build({{"the", 1000}, {"there", 500}, {"then", 400}, {"they", 300}})));
+}
+
+void TestUserDictionary::testLearnedWordsOutrankLexicon() {
+    MarathonUserDictionary dictionary(path());
+
+    QCOMPARE(dictionary.complete(m_lexicon, "the", 3), QStringList({"the", "there", "then"}));
+
+    dictionary.learn("theorem");
+    dictionary.learn("theorem");
+    dictionary.learn("they");
+    QCOMPARE(dictionary.complete(m_lexicon, "the", 3), QStringList({"theorem", "they", "the"}));
+    QCOMPARE(dictionary.complete(m_lexicon, "Theo", 3), QStringList({"Theorem"}));
+    QVERIFY(dictionary.contains("Theorem"));
+    QVERIFY(!dictionary.contains("thermal"));
+}
+
+void TestUserDictionary::testFlushAndReload() {
+    {
+        MarathonUserDictionary dictionary(path());
+        dictionary.learn("marathon");
+        dictionary.learn("marathon");
+        dictionary.learn("wayland");
+        // Nothing written until the batch is flushed
+        QVERIFY(!QFile::exists(path()));
+    }
+
+    MarathonUserDictionary dictionary(path());
+    dictionary.load();
+    QCOMPARE(dictionary.size(), 2);
+    QCOMPARE(dictionary.words(), QStringList({"marathon", "wayland"}));
+    QVERIFY(dictionary.score("marathon") > dictionary.score("wayland"));
+}
+
+void TestUserDictionary::testJournalIsCompacted() {
+    MarathonUserDictionary dictionary(path());
+    for (int i = 0; i < 1000; ++i) {
+        dictionary.learn("repeat");
+        dictionary.flush();
+    }
+
+    QFile file(path());
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QVERIFY(file.readAll().count('\n') < 300);
+    file.close();
+
+    MarathonUserDictionary reloaded(path());
+    reloaded.load();
+    QCOMPARE(reloaded.size(), 1);
+    QCOMPARE(qRound(reloaded.score("repeat")), 1000);
+}
+
+void TestUserDictionary::testLegacyWordList() {
+    QFile file(path());
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("kde\nplasma\nkde\n");
+    file.close();
+
+    MarathonUserDictionary dictionary(path());
+    dictionary.load();
+    QCOMPARE(dictionary.size(), 2);
+    QCOMPARE(qRound(dictionary.score("kde")), 2);
+    QCOMPARE(qRound(dictionary.score("plasma")), 1);
+}
+
+void TestUserDictionary::testOldWordsFade() {
+    const qint64           day = 24 * 3600;
+    const qint64           now = QDateTime::currentSecsSinceEpoch();
+    MarathonUserDictionary dictionary(path());
+
+    // Typed a lot two months ago, twice today
+    for (int i = 0; i < 4; ++i)
+        dictionary.learn("thesis", now - 60 * day);
+    dictionary.learn("theme", now);
+    dictionary.learn("theme", now);
+
+    QVERIFY(dictionary.score("thesis") < dictionary.score("theme"));
+    QCOMPARE(dictionary.complete(m_lexicon, "thes", 1), QStringList({"thesis"}));
+    QCOMPARE(dictionary.complete(m_lexicon, "the", 2), QStringList({"theme", "the"}));
+}
+
+void TestUserDictionary::testLowerCaseSpellingWins() {
+    MarathonUserDictionary dictionary(path());
+    dictionary.learn("Sunrise");
+    QCOMPARE(dictionary.words(), QStringList({"Sunrise"}));
+
+    dictionary.learn("sunrise");
+    dictionary.learn("Sunrise");
+    QCOMPARE(dictionary.words(), QStringList({"sunrise"}));
+    QCOMPARE(qRound(dictionary.score("SUNRISE")), 3);
+}
+
+void TestUserDictionary::testInstancesShareTheFile() {
+    // The shell's WordEngine and the keyboard each keep their own instance of one file
+    MarathonUserDictionary shell(path());
+    MarathonUserDictionary keyboard(path());
+    QSignalSpy             changed(&shell, &MarathonUserDictionary::changed);
+    shell.load();
+    keyboard.load();
+
+    shell.learn("marathon");
+    shell.learn("marathon");
+    keyboard.learn("marathon");
+    keyboard.learn("wayland");
+    shell.flush();
+    keyboard.flush();
+
+    // Each sees the other's words, with the uses added up
+    shell.sync();
+    QCOMPARE(changed.count(), 1);
+    QCOMPARE(shell.words(), QStringList({"marathon", "wayland"}));
+    QCOMPARE(qRound(shell.score("marathon")), 3);
+    QCOMPARE(qRound(keyboard.score("marathon")), 3);
+    shell.sync();
+    QCOMPARE(changed.count(), 1);
+
+    // One compacting the journal keeps the other's words, written or not
+    keyboard.learn("compositor");
+    for (int i = 0; i < 600; ++i) {
+        shell.learn("repeat");
+        shell.flush();
+    }
+    keyboard.flush();
+
+    MarathonUserDictionary reloaded(path());
+    reloaded.load();
+    QCOMPARE(reloaded.words(), QStringList({"compositor", "marathon", "repeat", "wayland"}));
+    QCOMPARE(qRound(reloaded.score("marathon")), 3);
+    QCOMPARE(qRound(reloaded.score("repeat")), 600);
+    keyboard.sync();
+    QCOMPARE(qRound(keyboard.score("repeat")), 600);
+}
+
+QTEST_MAIN(TestUserDictionary)
+#include "test_userdictionary.moc"
@@ -0,0 +1,147 @@
+#include <QTest>
+#include "../apps/terminal/src/VtParser.h"
+
+// Records everything the parser dispatches as readable strings
+class RecordingHandler : public VtParser::Handler {
+  public:
+    QStringList events;
+    QString     printed;
+
+    void        print(const uint32_t *codePoints, int count) override {
+        printed.append(QString::fromUcs4(reinterpret_cast<const char32_t *>(codePoints), count));
+    }
+    void execute(uint8_t control) override {
+        events.append(QString("exec %1").arg(int(control)));
+    }
+    void escDispatch(const VtParser &parser, uint8_t final) override {
+        QString intermediates;
+        for (int i = 0; i < parser.intermediateCount(); ++i)
+            intermediates.append(QChar(parser.intermediate(i)));
+        events.append(QString("esc %1%2").arg(intermediates, QChar(final)));
+    }
+    void csiDispatch(const VtParser &parser, uint8_t final) override {
+        QStringList params;
+        for (int i = 0; i < parser.paramCount(); ++i)
+            params.append(QString::number(parser.rawParam(i)));
+        QString marker = parser.privateMarker() ? QString(QChar(parser.privateMarker())) : "";
+        events.append(QString("csi %1%2%3").arg(marker, params.join(';'), QChar(final)));
+    }
+    void oscDispatch(const char *data, int length) override {
+        events.append("osc " + QString::fromUtf8(data, length));
+    }
+};
+
+static void feed(VtParser &parser, const char *data) {
+    parser.feed(data, static_cast<int>(qstrlen(data)));
+}
+
+class TestVtParser : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void testPrintRuns();
+    void testCsiParameters();
+    void testPrivateMarker();
+    void testSequenceSplitAcrossFeeds();
+    void testParameterLimits();
+    void testOsc();
+    void testCancel();
+    void testDcsIgnored();
+    void testUtf8InterruptedByControl();
+};
+
+void TestVtParser::testPrintRuns() {
+    RecordingHandler handler;
+    VtParser         parser(&handler);
+    const QByteArray data = QString("ab中c").toUtf8();
+    parser.feed(data.constData(), data.size());
+
+    QCOMPARE(handler.printed, QString("ab中c"));
+    QVERIFY(handler.events.isEmpty());
+}
+
+void TestVtParser::testCsiParameters() {
+    RecordingHandler handler;
+    VtParser         parser(&handler);
+    feed(parser, "\x1b[1;;23mX\x1b[H");
+
+    QCOMPARE(handler.events, QStringList({"csi 1;0;23m", "csi H"}));
+    QCOMPARE(handler.printed, QString("X"));
+}
+
+void TestVtParser::testPrivateMarker() {
+    RecordingHandler handler;
+    VtParser         parser(&handler);
+    feed(parser, "\x1b[?1049h\x1b[>c");
+
+    QCOMPARE(handler.events, QStringList({"csi ?1049h", "csi >c"}));
+}
+
+void TestVtParser::testSequenceSplitAcrossFeeds() {
+    RecordingHandler handler;
+    VtParser         parser(&handler);
+    const char      *data = "\x1b[38;5;196mred";
+    for (const char *p = data; *p; ++p)
+        parser.feed(p, 1);
+
+    QCOMPARE(handler.events, QStringList({"csi 38;5;196m"}));
+    QCOMPARE(handler.printed, QString("red"));
+}
+
+void TestVtParser::testParameterLimits() {
+    RecordingHandler handler;
+    VtParser         parser(&handler);
+    const QByteArray data = "\x1b[" + QByteArray("1;").repeated(40) + "99999999999999m";
+    parser.feed(data.constData(), data.size());
+
+    QCOMPARE(handler.events.size(), 1);
+    QCOMPARE(handler.events.first().count(';'), VtParser::MaxParams - 1);
+
+    handler.events.clear();
+    feed(parser, "\x1b[99999999999999H");
+    QCOMPARE(handler.events, QStringList({"csi 65535H"}));
+}
+
+void TestVtParser::testOsc() {
+    RecordingHandler handler;
+    VtParser         parser(&handler);
+    const QByteArray data = QString("\x1b]0;tïtle\x07\x1b]2;other\x1b\\").toUtf8();
+    parser.feed(data.constData(), data.size());
+
+    QCOMPARE(handler.events, QStringList({"osc 0;tïtle", "osc 2;other", "esc \\"}));
+}
+
+void TestVtParser::testCancel() {
+    RecordingHandler handler;
+    VtParser         parser(&handler);
+    feed(parser, "\x1b[12\x18x");
+
+    QCOMPARE(handler.events, QStringList({"exec 24"}));
+    QCOMPARE(handler.printed, QString("x"));
+
+    // An OSC string is dropped, not dispatched
+    handler.events.clear();
+    feed(parser, "\x1b]0;one\x18\x1b]2;two\x1a\x1b]0;three\x07");
+    QCOMPARE(handler.events, QStringList({"exec 24", "exec 26", "osc 0;three"}));
+}
+
+void TestVtParser::testDcsIgnored() {
+    RecordingHandler handler;
+    VtParser         parser(&handler);
+    feed(parser, "\x1bPq#0;2;0;0;0\x1b\\ok");
+
+    QCOMPARE(handler.events, QStringList({"esc \\"}));
+    QCOMPARE(handler.printed, QString("ok"));
+}
+
+void TestVtParser::testUtf8InterruptedByControl() {
+    RecordingHandler handler;
+    VtParser         parser(&handler);
+    feed(parser, "\xe4\xb8\r");
+
+    QCOMPARE(handler.printed, QString(QChar(0xFFFD)));
+    QCOMPARE(handler.events, QStringList({"exec 13"}));
+}
+
+QTEST_MAIN(TestVtParser)
+#include "test_vtparser.moc"
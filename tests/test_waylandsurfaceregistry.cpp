@@ -0,0 +1,101 @@
+#include <QTest>
+#include <QSignalSpy>
+#include "../shell/src/waylandsurfaceregistry.h"
+
+class TestWaylandSurfaceRegistry : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void testIndicesFollowAddAndRemove();
+    void testModelRowsAndRoles();
+    void testDestroyedSurfaceStaysIndexed();
+};
+
+void TestWaylandSurfaceRegistry::testIndicesFollowAddAndRemove() {
+    WaylandSurfaceRegistry registry;
+    QObject                surfaceA, surfaceB, surfaceC, clientA, clientB;
+
+    int a = registry.add(&surfaceA, &clientA, 100);
+    int b = registry.add(&surfaceB, &clientA, 100);
+    int c = registry.add(&surfaceC, &clientB, 0);
+    QVERIFY(a != b && b != c);
+
+    QCOMPARE(registry.surface(b), &surfaceB);
+    QCOMPARE(registry.pid(a), qint64(100));
+    QCOMPARE(registry.pid(c), qint64(0));
+    QCOMPARE(registry.surfacesForPid(100), QList<int>({a, b}));
+    QCOMPARE(registry.surfacesForClient(&clientA), QList<int>({a, b}));
+    QCOMPARE(registry.surfacesForClient(&clientB), QList<int>({c}));
+    QVERIFY(registry.surfacesForPid(0).isEmpty());
+
+    QVERIFY(registry.remove(a));
+    QVERIFY(!registry.remove(a));
+    QVERIFY(!registry.contains(a));
+    QVERIFY(!registry.surface(a));
+    QCOMPARE(registry.surfacesForPid(100), QList<int>({b}));
+    QCOMPARE(registry.surfacesForClient(&clientA), QList<int>({b}));
+
+    // Ids are never reused
+    QVERIFY(registry.add(&surfaceA, &clientA, 100) > c);
+}
+
+void TestWaylandSurfaceRegistry::testModelRowsAndRoles() {
+    WaylandSurfaceRegistry registry;
+    QObject                surfaceA, surfaceB, client;
+    QSignalSpy             countSpy(&registry, &WaylandSurfaceRegistry::countChanged);
+    QSignalSpy             changedSpy(&registry, &QAbstractItemModel::dataChanged);
+
+    int a = registry.add(&surfaceA, &client, 42);
+    int b = registry.add(&surfaceB, &client, 42);
+    QCOMPARE(registry.rowCount(), 2);
+    QCOMPARE(countSpy.count(), 2);
+
+    registry.setTitle(b, "Files");
+    registry.setTitle(b, "Files");
+    registry.setAppId(b, "org.gnome.Nautilus");
+    QCOMPARE(changedSpy.count(), 2);
+
+    QModelIndex second = registry.index(1);
+    QCOMPARE(registry.data(second, WaylandSurfaceRegistry::SurfaceIdRole).toInt(), b);
+    QCOMPARE(registry.data(second, WaylandSurfaceRegistry::SurfaceRole).value<QObject *>(),
+             &surfaceB);
+    QCOMPARE(registry.data(second, WaylandSurfaceRegistry::PidRole).toLongLong(), qint64(42));
+    QCOMPARE(registry.data(second, WaylandSurfaceRegistry::TitleRole).toString(), "Files");
+    QCOMPARE(registry.data(second, WaylandSurfaceRegistry::AppIdRole).toString(),
+             "org.gnome.Nautilus");
+
+    registry.remove(a);
+    QCOMPARE(registry.rowCount(), 1);
+    QCOMPARE(registry.count(), 1);
+    QCOMPARE(registry.data(registry.index(0), WaylandSurfaceRegistry::SurfaceIdRole).toInt(), b);
+
+    // Changes are reported at the row the surface moved up to
+    registry.setTitle(b, "Documents");
+    QCOMPARE(changedSpy.count(), 3);
+    QCOMPARE(changedSpy.last().at(0).value<QModelIndex>().row(), 0);
+    QCOMPARE(registry.data(registry.index(0), WaylandSurfaceRegistry::TitleRole).toString(),
+             "Documents");
+}
+
+void TestWaylandSurfaceRegistry::testDestroyedSurfaceStaysIndexed() {
+    WaylandSurfaceRegistry registry;
+    QObject                client;
+    QObject               *surface = new QObject;
+    QObject               *shell   = new QObject;
+
+    int id = registry.add(surface, &client, 7);
+    registry.setShellSurface(id, shell);
+    QCOMPARE(registry.shellSurface(id), shell);
+
+    // Objects may go away before the compositor removes the record
+    delete shell;
+    delete surface;
+    QVERIFY(!registry.surface(id));
+    QVERIFY(!registry.shellSurface(id));
+    QCOMPARE(registry.surfacesForPid(7), QList<int>({id}));
+    QVERIFY(registry.remove(id));
+    QVERIFY(registry.surfacesForClient(&client).isEmpty());
+}
+
+QTEST_MAIN(TestWaylandSurfaceRegistry)
+#include "test_waylandsurfaceregistry.moc"
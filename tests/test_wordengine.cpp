@@ -0,0 +1,105 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include "../shell/qml/keyboard/Data/WordEngine.h"
+
+class TestWordEngine : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void initTestCase();
+    void testStaleRequestsAreDropped();
+    void testTypingForwardMatchesFreshSearch();
+    void testCaseFollowsPrefix();
+    void testLearnedWordsArePredicted();
+
+  private:
+    static QStringList predict(WordEngineWorker &worker, const QString &prefix);
+
+    QTemporaryDir      m_dataDir;
+    QTemporaryDir      m_configDir;
+};
+
+void TestWordEngine::initTestCase() {
+    QVERIFY(m_dataDir.isValid());
+    QVERIFY(QDir(m_dataDir.path()).mkpath("marathon-keyboard/dictionaries"));
+
+    QList<MarathonLexicon::Entry> words = {{"he", 200},    {"her", 150},  {"hello", 100},
+                                           {"help", 90},   {"hell", 80},  {"held", 60},
+                                           {"helmet", 40}, {"hero", 30},  {"heron", 5}};
+    // Enough filler under "hel" to overflow a cached candidate set
+    for (int i = 0; i < 40; ++i)
+        words.append({QString("helix%1").arg(i, 2, 10, QChar('0')), quint32(20 - i / 2)});
+
+    QFile lexicon(m_dataDir.filePath("marathon-keyboard/dictionaries/en_US.lex"));
+    QVERIFY(lexicon.open(QIODevice::WriteOnly));
+    lexicon.write(MarathonLexicon::build(words));
+    lexicon.close();
+
+    qputenv("XDG_DATA_HOME", m_dataDir.path().toUtf8());
+    // Keep the user dictionary away from the real one
+    QVERIFY(m_configDir.isValid());
+    qputenv("XDG_CONFIG_HOME", m_configDir.path().toUtf8());
+}
+
+QStringList TestWordEngine::predict(WordEngineWorker &worker, const QString &prefix) {
+    QSignalSpy spy(&worker, &WordEngineWorker::predictionsReady);
+    worker.computePredictions(prefix, 3, worker.beginRequest());
+    return spy.isEmpty() ? QStringList() : spy.first().at(1).toStringList();
+}
+
+void TestWordEngine::testStaleRequestsAreDropped() {
+    WordEngineWorker worker;
+    worker.setLanguage("en_US");
+
+    QSignalSpy    spy(&worker, &WordEngineWorker::predictionsReady);
+    const quint64 first  = worker.beginRequest();
+    const quint64 second = worker.beginRequest();
+
+    worker.computePredictions("h", 3, first);
+    QCOMPARE(spy.count(), 0);
+
+    worker.computePredictions("he", 3, second);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.first().at(0).toString(), QString("he"));
+    QCOMPARE(spy.first().at(1).toStringList(), QStringList({"he", "her", "hello"}));
+}
+
+void TestWordEngine::testTypingForwardMatchesFreshSearch() {
+    WordEngineWorker typing;
+    typing.setLanguage("en_US");
+
+    for (const QString &prefix : {"h", "he", "hel", "hell", "hello", "hel", "helm", "her", "hero"}) {
+        WordEngineWorker fresh;
+        fresh.setLanguage("en_US");
+        QCOMPARE(predict(typing, prefix), predict(fresh, prefix));
+    }
+
+    QCOMPARE(predict(typing, "hel"), QStringList({"hello", "help", "hell"}));
+    QCOMPARE(predict(typing, "heli"), QStringList({"helix00", "helix01", "helix02"}));
+}
+
+void TestWordEngine::testCaseFollowsPrefix() {
+    WordEngineWorker worker;
+    worker.setLanguage("en_US");
+
+    QCOMPARE(predict(worker, "he"), QStringList({"he", "her", "hello"}));
+    QCOMPARE(predict(worker, "He"), QStringList({"He", "Her", "Hello"}));
+}
+
+void TestWordEngine::testLearnedWordsArePredicted() {
+    WordEngineWorker worker;
+    worker.setLanguage("en_US");
+
+    QCOMPARE(predict(worker, "hel"), QStringList({"hello", "help", "hell"}));
+
+    // Unknown to the lexicon, and "helmet" is below the top three
+    worker.addWord("helvetica");
+    worker.addWord("helmet");
+    worker.addWord("helmet");
+    QCOMPARE(predict(worker, "hel"), QStringList({"helmet", "helvetica", "hello"}));
+    QCOMPARE(predict(worker, "Helv"), QStringList({"Helvetica"}));
+}
+
+QTEST_MAIN(TestWordEngine)
+#include "test_wordengine.moc"
@@ -0,0 +1,89 @@
+#include "appruntime.h"
+#include <QDebug>
+#include <QEventLoop>
+#include <QGuiApplication>
+#include <QQuickItem>
+#include <QQuickWindow>
+#include <QStandardPaths>
+#include <QUrl>
+
+AppRuntime::AppRuntime(QObject *parent)
+    : QObject(parent)
+    , m_root(nullptr) {
+    for (const QString &path : marathonUiImportPaths())
+        m_engine.addImportPath(path);
+}
+
+AppRuntime::~AppRuntime() {
+    delete m_root;
+}
+
+QStringList AppRuntime::marathonUiImportPaths() {
+    // Same paths as the shell's main.cpp
+    return {QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/marathon-ui",
+            "/usr/lib/qt6/qml"};
+}
+
+QStringList AppRuntime::commonModules() {
+    return {"QtQuick", "QtQuick.Layouts", "QtQuick.Controls", "MarathonUI.Theme",
+            "MarathonUI.Core", "MarathonUI.Containers", "MarathonUI.Navigation"};
+}
+
+void AppRuntime::warmUp() {
+    // One component per module, so a module that is not installed only costs itself
+    for (const QString &module : commonModules()) {
+        auto *component = new QQmlComponent(&m_engine, this);
+        component->setData(QString("import QtQml\nimport %1\nQtObject {}\n").arg(module).toUtf8(),
+                           QUrl());
+        if (component->isError()) {
+            qWarning() << "[AppRuntime] Cannot preload" << module << ":"
+                       << component->errorString().trimmed();
+            delete component;
+            continue;
+        }
+        m_warmComponents.append(component);
+    }
+    qDebug() << "[AppRuntime] Preloaded" << m_warmComponents.size() << "modules";
+}
+
+bool AppRuntime::load(const QString &appId, const QString &appPath, const QString &entryPoint) {
+    QCoreApplication::setApplicationName(appId);
+    // Becomes the xdg-shell app id the compositor sees
+    QGuiApplication::setDesktopFileName(appId);
+    m_engine.addImportPath(appPath);
+
+    QQmlComponent component(&m_engine, QUrl::fromLocalFile(appPath + "/" + entryPoint));
+    if (component.isLoading()) {
+        QEventLoop loop;
+        connect(&component, &QQmlComponent::statusChanged, &loop, &QEventLoop::quit);
+        loop.exec();
+    }
+    if (component.isError()) {
+        qCritical() << "[AppRuntime]" << appId << "failed to load:" << component.errorString();
+        return false;
+    }
+
+    m_root = component.create();
+    if (!m_root) {
+        qCritical() << "[AppRuntime]" << appId << "failed to create:" << component.errorString();
+        return false;
+    }
+
+    if (auto *window = qobject_cast<QQuickWindow *>(m_root)) {
+        window->show();
+    } else if (auto *item = qobject_cast<QQuickItem *>(m_root)) {
+        // MApp roots are Items; give them a window that they fill
+        m_window = std::make_unique<QQuickWindow>();
+        m_window->setTitle(appId);
+        item->setParentItem(m_window->contentItem());
+        connect(m_window.get(), &QWindow::widthChanged, item, &QQuickItem::setWidth);
+        connect(m_window.get(), &QWindow::heightChanged, item, &QQuickItem::setHeight);
+        m_window->show();
+    } else {
+        qCritical() << "[AppRuntime]" << appId << "root is neither a Window nor an Item";
+        return false;
+    }
+
+    qInfo() << "[AppRuntime] Running" << appId;
+    return true;
+}
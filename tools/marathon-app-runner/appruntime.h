@@ -0,0 +1,43 @@
+#ifndef APPRUNTIME_H
+#define APPRUNTIME_H
+
+#include <QList>
+#include <QObject>
+#include <QQmlComponent>
+#include <QQmlEngine>
+#include <QString>
+#include <QStringList>
+#include <memory>
+
+class QQuickWindow;
+
+/**
+ * @brief The QML runtime one isolated Marathon app runs in
+ *
+ * Uses the same MarathonUI import paths as the shell. warmUp() loads the
+ * modules nearly every app imports, so an app handed to a warm runtime only
+ * has to compile its own files.
+ */
+class AppRuntime : public QObject {
+    Q_OBJECT
+
+  public:
+    explicit AppRuntime(QObject *parent = nullptr);
+    ~AppRuntime() override;
+
+    // Where MarathonUI modules are installed, as import paths
+    static QStringList marathonUiImportPaths();
+    // Modules loaded by warmUp()
+    static QStringList commonModules();
+
+    void warmUp();
+    bool load(const QString &appId, const QString &appPath, const QString &entryPoint);
+
+  private:
+    QQmlEngine                    m_engine;
+    QList<QQmlComponent *>        m_warmComponents; // keep the common types referenced
+    std::unique_ptr<QQuickWindow> m_window;         // only for apps whose root is an Item
+    QObject                      *m_root;
+};
+
+#endif // APPRUNTIME_H
@@ -0,0 +1,53 @@
+#include <QCommandLineParser>
+#include <QGuiApplication>
+#include <QTextStream>
+#include "appruntime.h"
+#include "runnerzygote.h"
+
+// Runs an isolated Marathon app. Started by the shell either for one app
+// (--app-id, --app-path, --entry-point), or as the template apps are forked
+// from (--zygote <socket>), see RunnerZygote.
+
+void printError(const QString &message) {
+    QTextStream err(stderr);
+    err << "marathon-app-runner: " << message << Qt::endl;
+}
+
+int main(int argc, char *argv[]) {
+    // Parsed without an application object: the zygote must not create one before forking
+    QStringList arguments;
+    for (int i = 0; i < argc; ++i)
+        arguments << QString::fromLocal8Bit(argv[i]);
+
+    QCommandLineParser parser;
+    QCommandLineOption appIdOption("app-id", "Id of the app to run.", "id");
+    QCommandLineOption appPathOption("app-path", "Directory of the app.", "path");
+    QCommandLineOption entryPointOption("entry-point", "QML file the app starts from.", "file");
+    QCommandLineOption zygoteOption("zygote", "Serve launch requests on this socket.", "socket");
+    QCommandLineOption sparesOption("spares", "Warm runtimes kept ready.", "count", "1");
+    parser.addOptions({appIdOption, appPathOption, entryPointOption, zygoteOption, sparesOption});
+    if (!parser.parse(arguments)) {
+        printError(parser.errorText());
+        return 1;
+    }
+
+    if (parser.isSet(zygoteOption)) {
+        RunnerZygote zygote(parser.value(zygoteOption), parser.value(sparesOption).toInt(), argc,
+                            argv);
+        return zygote.exec();
+    }
+
+    if (!parser.isSet(appIdOption) || !parser.isSet(appPathOption) ||
+        !parser.isSet(entryPointOption)) {
+        printError("usage: marathon-app-runner --app-id <id> --app-path <path> "
+                   "--entry-point <file> | --zygote <socket> [--spares <count>]");
+        return 1;
+    }
+
+    QGuiApplication app(argc, argv);
+    AppRuntime      runtime;
+    if (!runtime.load(parser.value(appIdOption), parser.value(appPathOption),
+                      parser.value(entryPointOption)))
+        return 1;
+    return app.exec();
+}
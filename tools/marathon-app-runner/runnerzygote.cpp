@@ -0,0 +1,349 @@
+#include "runnerzygote.h"
+#include "appruntime.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLibraryInfo>
+#include <QSocketNotifier>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifdef Q_OS_LINUX
+#include <sys/prctl.h>
+#endif
+
+namespace {
+    // A new spare waits until the app it replaces has had the CPU to itself for a while
+    constexpr qint64 kReplenishDelayMs = 2000;
+    // A spare that exits sooner than this failed to start up
+    constexpr qint64 kSpareStartupMs   = 10000;
+    constexpr int    kMaxRequestBytes  = 64 * 1024;
+
+    int              s_signalPipe[2] = {-1, -1};
+
+    void             handleChildSignal(int) {
+        const int  savedErrno = errno;
+        const char byte       = 0;
+        (void)::write(s_signalPipe[1], &byte, 1);
+        errno = savedErrno;
+    }
+
+    // SIGPIPE is ignored in the template, a closed peer only fails the write
+    bool writeAll(int fd, const QByteArray &data) {
+        qsizetype written = 0;
+        while (written < data.size()) {
+            const ssize_t n = ::write(fd, data.constData() + written, data.size() - written);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            written += n;
+        }
+        return true;
+    }
+
+    QByteArray toLine(const QJsonObject &object) {
+        return QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n';
+    }
+
+    void dieWithParent() {
+#ifdef Q_OS_LINUX
+        ::prctl(PR_SET_PDEATHSIG, SIGTERM);
+#endif
+    }
+} // namespace
+
+RunnerZygote::RunnerZygote(const QString &socketPath, int spares, int &argc, char **argv)
+    : m_socketPath(socketPath)
+    , m_spareCount(qMax(0, spares))
+    , m_argc(argc)
+    , m_argv(argv)
+    , m_templatePid(::getpid())
+    , m_listenFd(-1)
+    , m_spareFailures(0)
+    , m_replenishAt(0) {
+    m_clock.start();
+}
+
+int RunnerZygote::exec() {
+    dieWithParent();
+    preloadLibraries();
+    if (!listen())
+        return 1;
+
+    if (::pipe2(s_signalPipe, O_CLOEXEC | O_NONBLOCK) != 0) {
+        qCritical() << "[RunnerZygote] pipe2 failed:" << std::strerror(errno);
+        return 1;
+    }
+    struct sigaction action = {};
+    action.sa_handler       = handleChildSignal;
+    action.sa_flags         = SA_RESTART | SA_NOCLDSTOP;
+    ::sigaction(SIGCHLD, &action, nullptr);
+    ::signal(SIGPIPE, SIG_IGN);
+
+    for (int i = 0; i < m_spareCount; ++i)
+        forkSpare();
+    qInfo() << "[RunnerZygote] Ready on" << m_socketPath << "with" << m_spares.size() << "spares";
+
+    for (;;) {
+        QList<pollfd> fds  = {{m_listenFd, POLLIN, 0}, {s_signalPipe[0], POLLIN, 0}};
+        QList<pid_t>  apps = m_clients.keys();
+        for (pid_t pid : std::as_const(apps))
+            fds.append({m_clients.value(pid), POLLIN, 0});
+
+        int timeout = -1;
+        if (m_replenishAt > 0)
+            timeout = static_cast<int>(qMax<qint64>(0, m_replenishAt - m_clock.elapsed()));
+
+        if (::poll(fds.data(), fds.size(), timeout) < 0) {
+            if (errno == EINTR)
+                continue;
+            qCritical() << "[RunnerZygote] poll failed:" << std::strerror(errno);
+            return 1;
+        }
+
+        if (fds.at(1).revents) {
+            char drain[64];
+            while (::read(s_signalPipe[0], drain, sizeof drain) > 0) {}
+            reapChildren();
+        }
+        if (fds.at(0).revents & POLLIN)
+            acceptClient();
+
+        // The shell has nothing more to say on a connection; it went away
+        for (qsizetype i = 2; i < fds.size(); ++i) {
+            if (fds.at(i).revents)
+                closeClient(apps.at(i - 2));
+        }
+
+        if (m_replenishAt > 0 && m_clock.elapsed() >= m_replenishAt) {
+            m_replenishAt = 0;
+            while (m_spares.size() < m_spareCount && m_spareFailures < kMaxSpareFailures &&
+                   forkSpare()) {}
+        }
+    }
+}
+
+void RunnerZygote::preloadLibraries() {
+    // Plugin libraries of the common modules, wherever they may be installed
+    QStringList directories;
+    for (const QString &module : AppRuntime::commonModules()) {
+        const QString relative = QString(module).replace('.', '/');
+        directories << QLibraryInfo::path(QLibraryInfo::QmlImportsPath) + "/" + relative;
+        for (const QString &importPath : AppRuntime::marathonUiImportPaths())
+            directories << importPath + "/" + relative;
+    }
+    directories.removeDuplicates();
+
+    // Resolved now, in the template, instead of in every runtime
+    int loaded = 0;
+    for (const QString &directory : std::as_const(directories)) {
+        const QFileInfoList libraries = QDir(directory).entryInfoList({"*.so"}, QDir::Files);
+        for (const QFileInfo &library : libraries) {
+            if (::dlopen(QFile::encodeName(library.absoluteFilePath()).constData(),
+                         RTLD_NOW | RTLD_LOCAL))
+                ++loaded;
+            else
+                qWarning() << "[RunnerZygote] Cannot preload" << library.fileName() << ":"
+                           << ::dlerror();
+        }
+    }
+    qDebug() << "[RunnerZygote] Preloaded" << loaded << "QML plugin libraries";
+}
+
+bool RunnerZygote::listen() {
+    const QByteArray path    = QFile::encodeName(m_socketPath);
+    sockaddr_un      address = {};
+    address.sun_family       = AF_UNIX;
+    if (path.size() >= static_cast<qsizetype>(sizeof(address.sun_path))) {
+        qCritical() << "[RunnerZygote] Socket path too long:" << m_socketPath;
+        return false;
+    }
+    std::memcpy(address.sun_path, path.constData(), path.size());
+
+    ::unlink(path.constData());
+    m_listenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (m_listenFd < 0 ||
+        ::bind(m_listenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+        ::listen(m_listenFd, 8) != 0) {
+        qCritical() << "[RunnerZygote] Cannot listen on" << m_socketPath << ":"
+                    << std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+bool RunnerZygote::forkSpare() {
+    int assignment[2];
+    if (::pipe2(assignment, O_CLOEXEC) != 0)
+        return false;
+
+    const pid_t pid = ::fork();
+    if (pid < 0) {
+        qWarning() << "[RunnerZygote] fork failed:" << std::strerror(errno);
+        ::close(assignment[0]);
+        ::close(assignment[1]);
+        return false;
+    }
+    if (pid == 0) {
+        ::close(assignment[1]);
+        runSpare(assignment[0]);
+    }
+
+    ::close(assignment[0]);
+    m_spares.append({pid, assignment[1], m_clock.elapsed()});
+    return true;
+}
+
+void RunnerZygote::runSpare(int assignmentFd) {
+    // Nothing of the template's stays open in the runtime
+    ::close(m_listenFd);
+    ::close(s_signalPipe[0]);
+    ::close(s_signalPipe[1]);
+    for (const Spare &spare : std::as_const(m_spares))
+        ::close(spare.assignmentFd);
+    for (int connection : std::as_const(m_clients))
+        ::close(connection);
+    ::signal(SIGCHLD, SIG_DFL);
+    ::signal(SIGPIPE, SIG_DFL);
+
+    dieWithParent();
+    if (::getppid() != m_templatePid)
+        ::_exit(0);
+
+    int status = 0;
+    {
+        QGuiApplication app(m_argc, m_argv);
+        AppRuntime      runtime;
+        runtime.warmUp();
+
+        // Idle until the template hands over an app, or closes the pipe to retire the spare
+        QByteArray      request;
+        QSocketNotifier notifier(assignmentFd, QSocketNotifier::Read);
+        QObject::connect(&notifier, &QSocketNotifier::activated, &app, [&]() {
+            char          buffer[4096];
+            const ssize_t n = ::read(assignmentFd, buffer, sizeof buffer);
+            if (n > 0) {
+                request.append(buffer, n);
+                if (!request.contains('\n'))
+                    return;
+            }
+            notifier.setEnabled(false);
+            ::close(assignmentFd);
+
+            const QJsonObject object = QJsonDocument::fromJson(request.trimmed()).object();
+            if (object.isEmpty()) {
+                QCoreApplication::exit(request.isEmpty() ? 0 : 1);
+                return;
+            }
+            if (!runtime.load(object.value("appId").toString(), object.value("appPath").toString(),
+                              object.value("entryPoint").toString()))
+                QCoreApplication::exit(1);
+        });
+        status = app.exec();
+    }
+    ::exit(status);
+}
+
+void RunnerZygote::acceptClient() {
+    const int connection = ::accept4(m_listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (connection < 0)
+        return;
+
+    // The shell writes its request right away; never let a stuck client hold up the template
+    timeval timeout = {1, 0};
+    ::setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    QByteArray request;
+    while (!request.contains('\n') && request.size() < kMaxRequestBytes) {
+        char          buffer[4096];
+        const ssize_t n = ::read(connection, buffer, sizeof buffer);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        request.append(buffer, n);
+    }
+
+    const QJsonObject object =
+        QJsonDocument::fromJson(request.left(request.indexOf('\n'))).object();
+    if (object.value("appId").toString().isEmpty() ||
+        object.value("appPath").toString().isEmpty()) {
+        qWarning() << "[RunnerZygote] Invalid launch request";
+        ::close(connection);
+        return;
+    }
+
+    if (m_spares.isEmpty() && !forkSpare()) {
+        ::close(connection);
+        return;
+    }
+    const Spare spare    = m_spares.takeFirst();
+    const bool  assigned = writeAll(spare.assignmentFd, toLine(object));
+    ::close(spare.assignmentFd);
+
+    QJsonObject reply;
+    reply["pid"] = static_cast<qint64>(assigned ? spare.pid : 0);
+    if (assigned && writeAll(connection, toLine(reply))) {
+        m_clients.insert(spare.pid, connection);
+        qInfo() << "[RunnerZygote] Started" << object.value("appId").toString() << "in PID"
+                << spare.pid;
+    } else {
+        ::close(connection);
+    }
+
+    if (m_replenishAt == 0)
+        m_replenishAt = m_clock.elapsed() + kReplenishDelayMs;
+}
+
+void RunnerZygote::reapChildren() {
+    int   status = 0;
+    pid_t pid    = 0;
+    while ((pid = ::waitpid(-1, &status, WNOHANG)) > 0) {
+        for (qsizetype i = 0; i < m_spares.size(); ++i) {
+            const Spare spare = m_spares.at(i);
+            if (spare.pid != pid)
+                continue;
+            ::close(spare.assignmentFd);
+            m_spares.removeAt(i);
+            if (m_clock.elapsed() - spare.forkedAt < kSpareStartupMs)
+                ++m_spareFailures;
+            qWarning() << "[RunnerZygote] Spare" << pid << "exited before it was used";
+            if (m_spareFailures >= kMaxSpareFailures)
+                qWarning() << "[RunnerZygote] Spares keep failing, forking per launch instead";
+            else if (m_replenishAt == 0)
+                m_replenishAt = m_clock.elapsed() + kReplenishDelayMs;
+            break;
+        }
+
+        const int connection = m_clients.take(pid);
+        if (connection <= 0)
+            continue;
+
+        QJsonObject result;
+        result["pid"]      = static_cast<qint64>(pid);
+        result["exitCode"] = WIFEXITED(status) ? WEXITSTATUS(status) : 0;
+        result["crashed"]  = WIFSIGNALED(status);
+        writeAll(connection, toLine(result));
+        ::close(connection);
+    }
+}
+
+void RunnerZygote::closeClient(pid_t pid) {
+    // The app keeps running; only nobody is waiting for its exit any more
+    const int connection = m_clients.take(pid);
+    if (connection > 0)
+        ::close(connection);
+}
@@ -0,0 +1,67 @@
+#ifndef RUNNERZYGOTE_H
+#define RUNNERZYGOTE_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <sys/types.h>
+
+/**
+ * @brief Template process isolated Marathon apps are forked from
+ *
+ * The template loads the Qt Quick, Qt Quick Controls and MarathonUI plugin
+ * libraries once, so every runtime forked from it shares their relocated
+ * pages. It keeps a spare child ready that has already built its
+ * QGuiApplication and QML engine with the common modules loaded. A launch
+ * request hands the app to that spare, and a new spare is forked once the
+ * launch has settled.
+ *
+ * The template itself never creates a QGuiApplication or a QML engine: both
+ * start threads and hold a display connection, which a fork cannot carry.
+ *
+ * Protocol on the local socket: the shell sends one JSON line
+ * {"appId", "appPath", "entryPoint"} and gets {"pid"} back. The connection
+ * stays open until the app exits, which is reported as
+ * {"pid", "exitCode", "crashed"}. The template and all of its children exit
+ * together with the shell.
+ */
+class RunnerZygote {
+  public:
+    static constexpr int kMaxSpareFailures = 3;
+
+    RunnerZygote(const QString &socketPath, int spares, int &argc, char **argv);
+
+    // Serves launch requests until the shell goes away
+    int exec();
+
+  private:
+    struct Spare {
+        pid_t  pid;
+        int    assignmentFd; // write end of the pipe the spare waits on
+        qint64 forkedAt;
+    };
+
+    void              preloadLibraries();
+    bool              listen();
+    bool              forkSpare();
+    [[noreturn]] void runSpare(int assignmentFd);
+    void              acceptClient();
+    void              reapChildren();
+    void              closeClient(pid_t pid);
+
+    QString           m_socketPath;
+    int               m_spareCount;
+    int              &m_argc;
+    char            **m_argv;
+    pid_t             m_templatePid;
+    int               m_listenFd;
+    QList<Spare>      m_spares;
+    QHash<pid_t, int> m_clients; // app pid -> connection waiting for its exit
+    int               m_spareFailures;
+    QElapsedTimer     m_clock;
+    qint64            m_replenishAt; // when to fork the next spare, 0 for none due
+};
+
+#endif // RUNNERZYGOTE_H
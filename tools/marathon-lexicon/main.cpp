@@ -0,0 +1,75 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QSaveFile>
+#include <QTextStream>
+#include "../../marathon-keyboard/src/marathonlexicon.h"
+
+// Compiles word lists into the lexicon image the keyboard maps at runtime.
+// Inputs are merged; a word listed more than once keeps its highest frequency,
+// so a Hunspell .dic (coverage) can be combined with a frequency list (ranking).
+
+void printError(const QString &message) {
+    QTextStream err(stderr);
+    err << "marathon-lexicon: " << message << Qt::endl;
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("marathon-lexicon");
+    QCoreApplication::setApplicationVersion("1.0.0");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Compile word lists into a Marathon keyboard lexicon");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("word-lists",
+                                 "Text files with one \"word [frequency]\" per line, or Hunspell "
+                                 ".dic files",
+                                 "<word-list>...");
+
+    QCommandLineOption outputOption({"o", "output"}, "Lexicon file to write.", "file");
+    QCommandLineOption verboseOption({"v", "verbose"}, "Print statistics.");
+    parser.addOption(outputOption);
+    parser.addOption(verboseOption);
+    parser.process(app);
+
+    const QStringList inputs = parser.positionalArguments();
+    if (inputs.isEmpty() || !parser.isSet(outputOption)) {
+        parser.showHelp(1);
+    }
+
+    QList<MarathonLexicon::Entry> entries;
+    for (const QString &input : inputs) {
+        QFile file(input);
+        if (!file.open(QIODevice::ReadOnly)) {
+            printError("cannot read " + input + ": " + file.errorString());
+            return 1;
+        }
+        entries.append(MarathonLexicon::readWordList(&file));
+    }
+
+    const QByteArray image = MarathonLexicon::build(entries);
+
+    // Check the image the same way the runtime loader will
+    MarathonLexicon lexicon;
+    if (!lexicon.loadData(image)) {
+        printError("produced an invalid lexicon");
+        return 1;
+    }
+
+    QSaveFile output(parser.value(outputOption));
+    if (!output.open(QIODevice::WriteOnly) || output.write(image) != image.size() ||
+        !output.commit()) {
+        printError("cannot write " + output.fileName() + ": " + output.errorString());
+        return 1;
+    }
+
+    if (parser.isSet(verboseOption)) {
+        QTextStream out(stdout);
+        out << output.fileName() << ": " << lexicon.wordCount() << " words, " << image.size()
+            << " bytes" << Qt::endl;
+    }
+
+    return 0;
+}